@@ -53,6 +53,14 @@ void dbgLcdMsg(const char *format, ...);
 
 #endif // APP_DEVICE_EVENTS_LOGGING
 
+#if (APP_ENABLE_CONSOLE == 1) && defined(_SYS_FLIGHT_RECORDER_ON_)
+#include <console.h>
+
+/**************************************************************************//**
+\brief Print flight recorder content to the console
+******************************************************************************/
+void dbgPrintFlightRecorder(const ScanValue_t *args);
+#endif // (APP_ENABLE_CONSOLE == 1) && defined(_SYS_FLIGHT_RECORDER_ON_)
 
 #endif // _DEBUG_H_
 
@@ -74,4 +74,39 @@ void dbgLcdMsg(const char *format, ...)
 
 #endif // APP_DEVICE_EVENTS_LOGGING == 1
 
+#if (APP_ENABLE_CONSOLE == 1) && defined(_SYS_FLIGHT_RECORDER_ON_)
+
+/******************************************************************************
+                    Includes section
+******************************************************************************/
+#include <debug.h>
+#include <console.h>
+#include <sysFlightRecorder.h>
+#include <stdio.h>
+
+/******************************************************************************
+                    Implementations section
+******************************************************************************/
+/**************************************************************************//**
+\brief Print flight recorder content to the console. Intended to be used
+  as a console command handler with "d" arguments format.
+
+\param[in] args - args[0]: 0 - print the live ring, otherwise print
+  the snapshot taken at boot (restored from NV after power loss)
+******************************************************************************/
+void dbgPrintFlightRecorder(const ScanValue_t *args)
+{
+  SYS_FlightRecord_t record;
+  char str[48];
+
+  for (uint16_t i = 0; SYS_FlightRecorderGetRecord(0 != args[0].uint8, i, &record); i++)
+  {
+    snprintf(str, sizeof(str), "%lu %u 0x%04x 0x%02x\r\n", (unsigned long)record.timestamp,
+      record.type, record.arg, record.aux);
+    consoleTxStr(str);
+  }
+}
+
+#endif // (APP_ENABLE_CONSOLE == 1) && defined(_SYS_FLIGHT_RECORDER_ON_)
+
 // eof debug.c
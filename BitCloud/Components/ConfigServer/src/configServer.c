@@ -27,6 +27,7 @@
 #include <sysAssert.h>
 #ifdef _ENABLE_PERSISTENT_SERVER_
 #include <pdsDataServer.h>
+#include <sysFlightRecorder.h>
 #endif /* _ENABLE_PERSISTENT_SERVER_ */
 #ifndef _MAC2_
 #include <zdoZib.h>
@@ -103,6 +104,17 @@ void CS_Init(void)
   csSetToDefault();
 #ifdef _ENABLE_PERSISTENT_SERVER_
   PDS_Init();
+#ifdef _SYS_FLIGHT_RECORDER_ON_
+  /* Keep history which led to the last warm reset in NV storage. After
+     a power loss the ring is lost, so the last stored history is restored. */
+  if (SYS_FlightRecorderIsSnapshotPending())
+  {
+    if (PDS_Store(SYS_FLIGHT_RECORDER_MEM_ID))
+      SYS_FlightRecorderSnapshotSaved();
+  }
+  else if (PDS_IsAbleToRestore(SYS_FLIGHT_RECORDER_MEM_ID))
+    PDS_Restore(SYS_FLIGHT_RECORDER_MEM_ID);
+#endif /* _SYS_FLIGHT_RECORDER_ON_ */
 #endif /* _ENABLE_PERSISTENT_SERVER_ */
 }
 
@@ -23,6 +23,7 @@
 #include <macenvMem.h>
 #include <csSIB.h>
 #include <csBuffers.h>
+#include <sysFlightRecorder.h>
 #ifndef _MAC2_
 #include <apsConfigServer.h>
 #include <nwkConfigServer.h>
@@ -450,6 +451,15 @@ PDS_DECLARE_DIR(PDS_DirDescr_t BCRejoinParamsDirDescr) =
 };
 
 #endif /* PDS_ENABLE_WEAR_LEVELING != 1  */
+
+#ifdef _SYS_FLIGHT_RECORDER_ON_
+/* Flight recorder snapshot taken at boot. Shall be placed in the PDS_FF code segment. */
+#if PDS_ENABLE_WEAR_LEVELING != 1
+PDS_DECLARE_FILE(SYS_FLIGHT_RECORDER_MEM_ID, sizeof(SYS_FlightRecorder_t), &sysFlightRecorderSnapshot, NO_FILE_MARKS);
+#else /* PDS_ENABLE_WEAR_LEVELING != 1  */
+PDS_DECLARE_ITEM(SYS_FLIGHT_RECORDER_ITEM_ID, sizeof(SYS_FlightRecorder_t), &sysFlightRecorderSnapshot, NULL, NO_ITEM_FLAGS);
+#endif /* PDS_ENABLE_WEAR_LEVELING != 1  */
+#endif /* _SYS_FLIGHT_RECORDER_ON_ */
 #endif /* _ENABLE_PERSISTENT_SERVER_ */
 #endif /* !ZAPPSI_HOST */
 /* eof csPersistentMem.c */
@@ -38,6 +38,11 @@
 
 #define HAL_GET_INDEX_BY_CHANNEL(channel)  (USART_CHANNEL_0 == (channel) ? 0 : 1)
 
+/* Receiver idle time in ms after which rxIdleCallback is called. */
+#ifndef HAL_USART_RX_IDLE_TIMEOUT
+  #define HAL_USART_RX_IDLE_TIMEOUT  10ul
+#endif
+
 /******************************************************************************
                    Types section
 ******************************************************************************/
@@ -194,6 +199,8 @@ typedef struct
   volatile uint16_t rxPointOfRead;
   volatile uint16_t rxPointOfWrite;
   volatile uint16_t rxBytesInBuffer;
+  uint32_t rxTimestamp;
+  uint8_t  rxIdlePending;
   uint8_t  usartShiftRegisterEmpty;
 #if defined(_USE_USART_ERROR_EVENT_)
   uint8_t  errorReason;
@@ -215,6 +222,15 @@ extern UsartChannelInfo_t usartChannel[2];
 ******************************************************************************/
 void halUsartRxBufferFiller(UsartChannel_t tty, uint8_t data);
 
+/**************************************************************************//**
+\brief Sends the next byte from the cyclic buffer. Is called from the data
+  register empty interrupt.
+
+\param[in]
+  tty - channel number.
+******************************************************************************/
+void halUsartTxBufferDrainer(UsartChannel_t tty);
+
 /**************************************************************************//**
 \brief Checks the channel number.
 
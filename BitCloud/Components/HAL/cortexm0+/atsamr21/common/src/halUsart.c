@@ -68,16 +68,25 @@ void usart0Handler(void)
   } /* is any data received */
   else if (intFlags & SERCOM_USART_INTFLAG_RXC)
   {
-    data =tty->sercom->DATA.reg;
     halWakeupFromIrq();
-    halUsartRxBufferFiller(tty, data);
+    /* read all bytes accumulated in the receive buffer of the module */
+    do
+    {
+      data = tty->sercom->DATA.reg;
+      halUsartRxBufferFiller(tty, data);
+    } while (tty->sercom->INTFLAG.reg & SERCOM_USART_INTFLAG_RXC);
     halPostUsartTask(HAL_USART_TASK_USART0_RXC );
   }/* is data register empty */
   else if((intFlags & SERCOM_USART_INTFLAG_DRE) && (tty->sercom->INTENSET.bit.DRE == 1))
   {
+  #ifdef HW_CONTROL_PINS_PORT_ASSIGNMENT
     halDisableUsartDremInterrupt(tty);
     halWakeupFromIrq();
     halPostUsartTask(HAL_USART_TASK_USART0_DRE) ;
+  #else
+    /* without flow control pins the buffer is drained directly from interrupt */
+    halUsartTxBufferDrainer(tty);
+  #endif
   } /* is transmission completed */ 
   else if ((intFlags & SERCOM_USART_INTFLAG_TXC)&& (tty->sercom->INTENSET.bit.TXC == 1))
   {
@@ -115,16 +124,25 @@ void usart1Handler(void)
   } /* is any data received */
   else if (intFlags & SERCOM_USART_INTFLAG_RXC)
   {
-    data =tty->sercom->DATA.reg;
     halWakeupFromIrq();
-    halUsartRxBufferFiller(tty, data);
+    /* read all bytes accumulated in the receive buffer of the module */
+    do
+    {
+      data = tty->sercom->DATA.reg;
+      halUsartRxBufferFiller(tty, data);
+    } while (tty->sercom->INTFLAG.reg & SERCOM_USART_INTFLAG_RXC);
     halPostUsartTask(HAL_USART_TASK_USART1_RXC );
   }/* is data register empty */
   else if((intFlags & SERCOM_USART_INTFLAG_DRE) && (tty->sercom->INTENSET.bit.DRE == 1))
   {
+  #ifdef HW_CONTROL_PINS_PORT_ASSIGNMENT
     halDisableUsartDremInterrupt(tty);
     halWakeupFromIrq();
     halPostUsartTask(HAL_USART_TASK_USART1_DRE) ;
+  #else
+    /* without flow control pins the buffer is drained directly from interrupt */
+    halUsartTxBufferDrainer(tty);
+  #endif
   } /* is transmission completed */ 
   else if ((intFlags & SERCOM_USART_INTFLAG_TXC)&& (tty->sercom->INTENSET.bit.TXC == 1))
   {
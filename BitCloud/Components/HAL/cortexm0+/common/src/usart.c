@@ -28,6 +28,7 @@
 #include <gpio.h>
 #include <sysAssert.h>
 #include <sysEvents.h>
+#include <sysUtils.h>
 
 /******************************************************************************
                    Define(s) section
@@ -138,6 +139,9 @@ static void halUsartHwController(UsartChannel_t tty);
 static void halSigUsartReceptionComplete(UsartChannel_t tty);
 static void halSetUsartPin(HAL_UsartDescriptor_t *descriptor);
 static void isUsartBusyRequest(SYS_EventId_t eventId, SYS_EventData_t data);
+static void halUsartRxRelease(HAL_UsartDescriptor_t *descriptor, uint16_t poR, uint16_t length);
+static void halStartUsartRxIdleTimer(uint32_t interval);
+static void halUsartRxIdleTimerFired(void);
 
 /******************************************************************************
                    Static variables section
@@ -178,6 +182,8 @@ static HalUsartTask_t PROGMEM_DECLARE(halUsartHandlers[HAL_USART_TASKS_NUMBER])
 }; // List Of possible HAL USART tasks.
 
 static SYS_EventReceiver_t usartBusyCheck = { .func = isUsartBusyRequest};
+static HAL_AppTimer_t halUsartRxIdleTimer;
+static bool halUsartRxIdleTimerStarted = false;
 
 /******************************************************************************
                    Implementations section
@@ -291,6 +297,43 @@ void halUsartRxBufferFiller(UsartChannel_t tty, uint8_t data)
   }
 }
 
+/**************************************************************************//**
+\brief Sends the next byte from the cyclic buffer. When the buffer is drained
+  data register empty interrupt is replaced by transmit complete one.
+
+\param[in]
+  tty - channel number.
+******************************************************************************/
+void halUsartTxBufferDrainer(UsartChannel_t tty)
+{
+  uint16_t           poR;
+  uint8_t            i;
+  HalUsartService_t *halUsartControl;
+
+  i = HAL_GET_INDEX_BY_CHANNEL(tty);
+  if (NULL == halPointDescrip[i])
+  {// abnormal
+    halDisableUsartDremInterrupt(tty);
+    return;
+  }
+
+  halUsartControl = &halPointDescrip[i]->service;
+  poR = halUsartControl->txPointOfRead;
+
+  if (poR != halUsartControl->txPointOfWrite)
+  {
+    halSendUsartByte(tty, halPointDescrip[i]->txBuffer[poR]);
+    if (++poR == halPointDescrip[i]->txBufferLength)
+      poR = 0;
+    halUsartControl->txPointOfRead = poR;
+  }
+  else
+  {
+    halDisableUsartDremInterrupt(tty);
+    halEnableUsartTxcInterrupt(tty);
+  }
+}
+
 #if defined(_USE_USART_ERROR_EVENT_)
 /**************************************************************************//**
 \brief Save status register for analyzing of the error reason.
@@ -384,6 +427,7 @@ int HAL_OpenUsart(HAL_UsartDescriptor_t *descriptor)
     descriptor->txBufferLength = 0;
   descriptor->service.rxPointOfRead = 0;
   descriptor->service.rxPointOfWrite = 0;
+  descriptor->service.rxIdlePending = 0;
   descriptor->service.usartShiftRegisterEmpty = 1;
 
   halSetUsartConfig(descriptor);
@@ -516,9 +560,8 @@ int HAL_WriteUsart(HAL_UsartDescriptor_t *descriptor, uint8_t *buffer, uint16_t
   uint8_t            i;
   uint16_t           poW;
   uint16_t           poR;
-  uint16_t           old;
+  uint16_t           span;
   uint16_t           wasWrote = 0;
-  bool               needStartTrmt = false;
   HalUsartService_t *halUsartControl;
 
   if (NULL == descriptor)
@@ -537,9 +580,8 @@ int HAL_WriteUsart(HAL_UsartDescriptor_t *descriptor, uint8_t *buffer, uint16_t
     if (halUsartControl->txPointOfWrite != halUsartControl->txPointOfRead)
       return -1; // there is unsent data
     descriptor->txBuffer = buffer;
-    halUsartControl->txPointOfWrite = length;
     halUsartControl->txPointOfRead = 0;
-    needStartTrmt = true;
+    halUsartControl->txPointOfWrite = length;
     wasWrote = length;
   } // Callback mode.
   else
@@ -549,23 +591,24 @@ int HAL_WriteUsart(HAL_UsartDescriptor_t *descriptor, uint8_t *buffer, uint16_t
       poR = halUsartControl->txPointOfRead;
     ATOMIC_SECTION_LEAVE
 
-    if (poW == poR)
-      needStartTrmt = true; // Buffer empty.
-
+    // Data is copied by contiguous spans. One byte is kept free to
+    // distinguish full buffer from empty one.
     while (wasWrote < length)
     {
-      old = poW;
+      if (poW < poR)
+        span = poR - poW - 1;
+      else
+        span = descriptor->txBufferLength - poW - ((0 == poR) ? 1 : 0);
 
-      if (++poW == descriptor->txBufferLength)
-        poW = 0;
+      if (0 == span)
+        break; // Buffer full.
 
-      if (poW == poR)
-      { // Buffer full.
-        poW = old;
-        break;
-      } // Buffer full.
-
-      descriptor->txBuffer[old] = buffer[wasWrote++];
+      span = MIN(span, length - wasWrote);
+      memcpy(&descriptor->txBuffer[poW], &buffer[wasWrote], span);
+      wasWrote += span;
+      poW += span;
+      if (poW == descriptor->txBufferLength)
+        poW = 0;
     }
 
     ATOMIC_SECTION_ENTER
@@ -573,10 +616,11 @@ int HAL_WriteUsart(HAL_UsartDescriptor_t *descriptor, uint8_t *buffer, uint16_t
     ATOMIC_SECTION_LEAVE
   } // Polling mode
 
-  if (needStartTrmt)
+  if (wasWrote)
   {
     halUsartControl->usartShiftRegisterEmpty = 0; // Buffer and shift register is full
-    // Enable interrupt. Transaction will be launched in the callback.
+    // Enable interrupt. Transaction will be launched in the callback. Interrupt
+    // is disabled as soon as the buffer is drained, so it is enabled on every write.
     halEnableUsartDremInterrupt(descriptor->tty);
   }
 
@@ -603,10 +647,8 @@ int HAL_ReadUsart(HAL_UsartDescriptor_t *descriptor, uint8_t *buffer, uint16_t l
   uint16_t           wasRead = 0;
   uint16_t           poW;
   uint16_t           poR;
+  uint16_t           span;
   HalUsartService_t *halUsartControl;
-#ifdef HW_CONTROL_PINS_PORT_ASSIGNMENT
-  uint16_t           number;
-#endif // HW_CONTROL_PINS_PORT_ASSIGNMENT
 
   if (NULL == descriptor)
     return -1;
@@ -624,17 +666,118 @@ int HAL_ReadUsart(HAL_UsartDescriptor_t *descriptor, uint8_t *buffer, uint16_t l
     poR = halUsartControl->rxPointOfRead;
   ATOMIC_SECTION_LEAVE
 
+  // At most two spans: up to the end of the buffer and from its start
   while ((poR != poW) && (wasRead < length))
   {
-    buffer[wasRead] = descriptor->rxBuffer[poR];
-    if (++poR == descriptor->rxBufferLength)
+    span = (poR < poW) ? (poW - poR) : (descriptor->rxBufferLength - poR);
+    span = MIN(span, length - wasRead);
+    memcpy(&buffer[wasRead], &descriptor->rxBuffer[poR], span);
+    wasRead += span;
+    poR += span;
+    if (poR == descriptor->rxBufferLength)
       poR = 0;
-    wasRead++;
   }
 
+  halUsartRxRelease(descriptor, poR, wasRead);
+
+  return wasRead;
+}
+
+/**************************************************************************//**
+\brief Gets contiguous block of received data directly from receive buffer.
+The block stays in the buffer until it is released by HAL_ReleaseUsartRxSpan().
+
+\param[in]
+  descriptor - usart descriptor;
+\param[out]
+  span - pointer to the first byte of the block.
+
+\return
+  Length of the block, 0 if there is no received data or bad descriptor.
+******************************************************************************/
+uint16_t HAL_GetUsartRxSpan(HAL_UsartDescriptor_t *descriptor, uint8_t **span)
+{
+  uint16_t           poW;
+  uint16_t           poR;
+  HalUsartService_t *halUsartControl;
+
+  *span = NULL;
+  if (NULL == descriptor)
+    return 0;
+  if (false == halIsUsartChannelCorrect(descriptor->tty))
+    return 0;
+  if (descriptor != halPointDescrip[HAL_GET_INDEX_BY_CHANNEL(descriptor->tty)])
+    return 0; // Channel is not opened.
+  if (NULL == descriptor->rxBuffer)
+    return 0;
+
+  halUsartControl = &descriptor->service;
+  ATOMIC_SECTION_ENTER
+    poW = halUsartControl->rxPointOfWrite;
+    poR = halUsartControl->rxPointOfRead;
+  ATOMIC_SECTION_LEAVE
+
+  *span = &descriptor->rxBuffer[poR];
+  if (poR <= poW)
+    return poW - poR;
+  return descriptor->rxBufferLength - poR;
+}
+
+/**************************************************************************//**
+\brief Releases data processed from the block got by HAL_GetUsartRxSpan().
+
+\param[in]
+  descriptor - usart descriptor;
+\param[in]
+  length - number of bytes to be released.
+
+\return
+  -1 - bad descriptor; \n
+  Number of released bytes - success.
+******************************************************************************/
+int HAL_ReleaseUsartRxSpan(HAL_UsartDescriptor_t *descriptor, uint16_t length)
+{
+  uint8_t *span;
+  uint16_t poR;
+
+  if (NULL == descriptor)
+    return -1;
+  if (false == halIsUsartChannelCorrect(descriptor->tty))
+    return -1;
+  if (descriptor != halPointDescrip[HAL_GET_INDEX_BY_CHANNEL(descriptor->tty)])
+    return -1; // Channel is not opened.
+
+  length = MIN(length, HAL_GetUsartRxSpan(descriptor, &span));
+  poR = descriptor->service.rxPointOfRead + length;
+  if (poR == descriptor->rxBufferLength)
+    poR = 0;
+
+  halUsartRxRelease(descriptor, poR, length);
+
+  return length;
+}
+
+/**************************************************************************//**
+\brief Moves read pointer of receive buffer after data has been read and
+  allows the host to transmit if there is enough space.
+
+\param[in]
+  descriptor - usart descriptor;
+\param[in]
+  poR - new read pointer;
+\param[in]
+  length - number of read bytes.
+******************************************************************************/
+static void halUsartRxRelease(HAL_UsartDescriptor_t *descriptor, uint16_t poR, uint16_t length)
+{
+  HalUsartService_t *halUsartControl = &descriptor->service;
+#ifdef HW_CONTROL_PINS_PORT_ASSIGNMENT
+  uint16_t           number;
+#endif // HW_CONTROL_PINS_PORT_ASSIGNMENT
+
   ATOMIC_SECTION_ENTER
     halUsartControl->rxPointOfRead = poR;
-    halUsartControl->rxBytesInBuffer -= wasRead;
+    halUsartControl->rxBytesInBuffer -= length;
 #ifdef HW_CONTROL_PINS_PORT_ASSIGNMENT
     number = halUsartControl->rxBytesInBuffer;
 #endif // HW_CONTROL_PINS_PORT_ASSIGNMENT
@@ -645,8 +788,6 @@ int HAL_ReadUsart(HAL_UsartDescriptor_t *descriptor, uint8_t *buffer, uint16_t l
     if (number <= (descriptor->rxBufferLength >> BUFFER_RESERV))
       GPIO_clr(&descriptor->tty->usartPinConfig[USART_CTS_SIG]);
 #endif // HW_CONTROL_PINS_PORT_ASSIGNMENT
-
-  return wasRead;
 }
 
 /**************************************************************************//**
@@ -855,11 +996,75 @@ static void halSigUsartReceptionComplete(UsartChannel_t tty)
     number = halUsartControl->rxBytesInBuffer;
   ATOMIC_SECTION_LEAVE
 
+  if (NULL != halPointDescrip[i]->rxIdleCallback)
+  {
+    halUsartControl->rxTimestamp = (uint32_t)HAL_GetSystemTime();
+    halUsartControl->rxIdlePending = 1;
+    halStartUsartRxIdleTimer(HAL_USART_RX_IDLE_TIMEOUT);
+  }
+
   if (number)
     if (NULL != halPointDescrip[i]->rxCallback)
       halPointDescrip[i]->rxCallback(number);
 }
 
+/**************************************************************************//**
+\brief Starts timer to detect receiver idle if it isn't started yet.
+  The timer is shared by all channels.
+
+\param[in]
+  interval - timer interval in ms.
+******************************************************************************/
+static void halStartUsartRxIdleTimer(uint32_t interval)
+{
+  if (halUsartRxIdleTimerStarted)
+    return;
+
+  halUsartRxIdleTimerStarted = true;
+  halUsartRxIdleTimer.interval = interval;
+  halUsartRxIdleTimer.mode = TIMER_ONE_SHOT_MODE;
+  halUsartRxIdleTimer.callback = halUsartRxIdleTimerFired;
+  HAL_StartAppTimer(&halUsartRxIdleTimer);
+}
+
+/**************************************************************************//**
+\brief Receiver idle timer callback. Notifies channels which haven't received
+  anything during HAL_USART_RX_IDLE_TIMEOUT and restarts the timer for the rest.
+******************************************************************************/
+static void halUsartRxIdleTimerFired(void)
+{
+  uint32_t               now = (uint32_t)HAL_GetSystemTime();
+  uint32_t               elapsed;
+  uint32_t               interval = HAL_USART_RX_IDLE_TIMEOUT;
+  bool                   restart = false;
+  HAL_UsartDescriptor_t *descriptor;
+
+  halUsartRxIdleTimerStarted = false;
+
+  for (uint8_t i = 0; i < sizeof(halPointDescrip)/sizeof(halPointDescrip[0]); i++)
+  {
+    descriptor = halPointDescrip[i];
+    if ((NULL == descriptor) || !descriptor->service.rxIdlePending)
+      continue;
+
+    elapsed = now - descriptor->service.rxTimestamp;
+    if (elapsed >= HAL_USART_RX_IDLE_TIMEOUT)
+    {
+      descriptor->service.rxIdlePending = 0;
+      if (NULL != descriptor->rxIdleCallback)
+        descriptor->rxIdleCallback(descriptor->service.rxBytesInBuffer);
+    }
+    else
+    {
+      interval = MIN(interval, HAL_USART_RX_IDLE_TIMEOUT - elapsed);
+      restart = true;
+    }
+  }
+
+  if (restart)
+    halStartUsartRxIdleTimer(interval);
+}
+
 #if defined(_USE_USART_ERROR_EVENT_)
 /**************************************************************************//**
 \brief Error occurred action handler.
@@ -46,6 +46,35 @@ uint8_t getCharFromTunnel(void);
 ******************************************************************************/
 bool putCharInTunnel(uint8_t ch);
 
+/**************************************************************************//**
+\brief Puts block of data in rx tunneling buffer. Overwrites the oldest data
+  if upper layer doesn't free the buffer on rx callback.
+
+\param[in] data - data to write
+\param[in] length - data length
+
+\return true if data was written correctly, false otherwise.
+******************************************************************************/
+bool putDataInTunnel(const uint8_t *data, uint16_t length);
+
+/**************************************************************************//**
+\brief Gets contiguous block of data from tx tunneling buffer. The block stays
+  in the buffer and shall be released by commitTunnelTxSpan() after
+  transmission, so it can be sent directly from the buffer.
+
+\param[out] span - pointer to the first byte of the block
+
+\return length of the block, zero if there is nothing to send.
+******************************************************************************/
+uint16_t getTunnelTxSpan(uint8_t **span);
+
+/**************************************************************************//**
+\brief Releases sent data in tx tunneling buffer.
+
+\param[in] length - amount of sent bytes from the block got by getTunnelTxSpan()
+******************************************************************************/
+void commitTunnelTxSpan(uint16_t length);
+
 /**************************************************************************//**
 \brief Check is allocated buffers for tunneling or not.
 
@@ -30,6 +30,7 @@
 #else
 #include <usart.h>
 #endif
+#include <sysUtils.h>
 #include <isdConsoleTunneling.h>
 
 /******************************************************************************
@@ -61,7 +62,11 @@ static void raiseTunnelTxCallback(void);
 static void initRingBuffer(RingBuffer_t *ring, uint8_t *buffer, uint16_t bufSize);
 static void writeRingBuffer(RingBuffer_t *ring, uint8_t ch);
 static uint8_t readRingBuffer(RingBuffer_t *ring);
-static uint8_t lengthRingBuffer(RingBuffer_t *ring);
+static uint16_t lengthRingBuffer(RingBuffer_t *ring);
+static uint16_t getRingBufferReadSpan(RingBuffer_t *ring, uint8_t **span);
+static void commitRingBufferRead(RingBuffer_t *ring, uint16_t size);
+static uint16_t getRingBufferWriteSpan(RingBuffer_t *ring, uint8_t **span);
+static void commitRingBufferWrite(RingBuffer_t *ring, uint16_t size);
 //static bool setRingBufferFull(RingBuffer_t *ring);
 
 /******************************************************************************
@@ -140,14 +145,19 @@ int ISD_CloseTunnel(ISD_TunnelDescriptor_t *descriptor)
 int ISD_ReadTunnel(ISD_TunnelDescriptor_t *descriptor, uint8_t *buffer, uint16_t length)
 {
   uint16_t wasReaded = 0;
+  uint16_t spanSize;
+  uint8_t *span;
 
   if ((!tunnelDescriptor) || (tunnelDescriptor != descriptor))
     return -1;
 
-  while ((!rxfifo.isEmpty) && (wasReaded < length))
+  // At most two spans: up to the end of the buffer and from its start
+  while ((wasReaded < length) && (spanSize = getRingBufferReadSpan(&rxfifo, &span)))
   {
-    *buffer++ = readRingBuffer(&rxfifo);
-    wasReaded++;
+    spanSize = MIN(spanSize, length - wasReaded);
+    memcpy(buffer + wasReaded, span, spanSize);
+    commitRingBufferRead(&rxfifo, spanSize);
+    wasReaded += spanSize;
   }
 
   return wasReaded;
@@ -165,14 +175,18 @@ int ISD_ReadTunnel(ISD_TunnelDescriptor_t *descriptor, uint8_t *buffer, uint16_t
 int ISD_WriteTunnel(ISD_TunnelDescriptor_t *descriptor, uint8_t *buffer, uint16_t length)
 {
   uint16_t wasWrote = 0;
+  uint16_t spanSize;
+  uint8_t *span;
 
   if ((!tunnelDescriptor) || (tunnelDescriptor != descriptor))
     return -1;
 
-  while ((!txfifo.isFull) && (wasWrote < length))
+  while ((wasWrote < length) && (spanSize = getRingBufferWriteSpan(&txfifo, &span)))
   {
-    writeRingBuffer(&txfifo, *buffer++);
-    wasWrote++;
+    spanSize = MIN(spanSize, length - wasWrote);
+    memcpy(span, buffer + wasWrote, spanSize);
+    commitRingBufferWrite(&txfifo, spanSize);
+    wasWrote += spanSize;
   }
   isdSendTunnelingDate();
   return wasWrote;
@@ -197,6 +211,45 @@ bool putCharInTunnel(uint8_t ch)
   return true;
 }
 
+/**************************************************************************//**
+\brief Puts block of data in rx tunneling buffer. As well as putCharInTunnel()
+  overwrites the oldest data if upper layer doesn't free the buffer on
+  rx callback.
+
+\param[in] data - data to write
+\param[in] length - data length
+
+\return true if data was written correctly, false otherwise.
+******************************************************************************/
+bool putDataInTunnel(const uint8_t *data, uint16_t length)
+{
+  uint16_t spanSize;
+  uint8_t *span;
+
+  if (!tunnelDescriptor)
+    return false;
+
+  while (length)
+  {
+    if (rxfifo.isFull)
+    {
+      raiseTunnelRxCallback();
+
+      // Buffer is full, so read and write pointers are equal
+      if (rxfifo.isFull)
+        commitRingBufferRead(&rxfifo, MIN(getRingBufferReadSpan(&rxfifo, &span), length));
+    }
+
+    spanSize = MIN(getRingBufferWriteSpan(&rxfifo, &span), length);
+    memcpy(span, data, spanSize);
+    commitRingBufferWrite(&rxfifo, spanSize);
+    data += spanSize;
+    length -= spanSize;
+  }
+
+  return true;
+}
+
 /**************************************************************************//**
 \brief Gets char from tx tunneling buffer.
 
@@ -208,6 +261,39 @@ uint8_t getCharFromTunnel(void)
   return readRingBuffer(&txfifo);
 }
 
+/**************************************************************************//**
+\brief Gets contiguous block of data from tx tunneling buffer. The block stays
+  in the buffer and shall be released by commitTunnelTxSpan() after
+  transmission, so it can be sent directly from the buffer.
+
+\param[out] span - pointer to the first byte of the block
+
+\return length of the block, zero if there is nothing to send.
+******************************************************************************/
+uint16_t getTunnelTxSpan(uint8_t **span)
+{
+  if (!tunnelDescriptor)
+    return 0;
+
+  return getRingBufferReadSpan(&txfifo, span);
+}
+
+/**************************************************************************//**
+\brief Releases sent data in tx tunneling buffer.
+
+\param[in] length - amount of sent bytes from the block got by getTunnelTxSpan()
+******************************************************************************/
+void commitTunnelTxSpan(uint16_t length)
+{
+  uint8_t *span;
+
+  if ((!tunnelDescriptor) || (!length))
+    return;
+
+  commitRingBufferRead(&txfifo, MIN(length, getRingBufferReadSpan(&txfifo, &span)));
+  wasSomethingSent = true;
+}
+
 /**************************************************************************//**
 \brief Check there is something to tunneling from upper layer.
 
@@ -333,7 +419,7 @@ static uint8_t readRingBuffer(RingBuffer_t *ring)
 
 \return length
 ******************************************************************************/
-static uint8_t lengthRingBuffer(RingBuffer_t *ring)
+static uint16_t lengthRingBuffer(RingBuffer_t *ring)
 {
   if (ring->isEmpty)
     return 0;
@@ -348,6 +434,86 @@ static uint8_t lengthRingBuffer(RingBuffer_t *ring)
             (ring->ptw - ring->start) / sizeof(uint8_t);
 }
 
+/**************************************************************************//**
+\brief Gets contiguous block of data from circle buffer.
+
+\param[out] span - pointer to the first byte of the block
+
+\return length of the block
+******************************************************************************/
+static uint16_t getRingBufferReadSpan(RingBuffer_t *ring, uint8_t **span)
+{
+  *span = ring->ptr;
+
+  if (ring->isEmpty)
+    return 0;
+
+  if (ring->ptr < ring->ptw)
+    return (ring->ptw - ring->ptr) / sizeof(uint8_t);
+  else
+    return (ring->end - ring->ptr) / sizeof(uint8_t);
+}
+
+/**************************************************************************//**
+\brief Releases data read from block got by getRingBufferReadSpan().
+
+\param[in] size - amount of read bytes
+******************************************************************************/
+static void commitRingBufferRead(RingBuffer_t *ring, uint16_t size)
+{
+  if (!size)
+    return;
+
+  ring->ptr += size;
+
+  if (ring->end == ring->ptr)
+    ring->ptr = ring->start;
+
+  ring->isFull = false;
+  if (ring->ptw == ring->ptr)
+    ring->isEmpty = true;
+}
+
+/**************************************************************************//**
+\brief Gets contiguous block of free space in circle buffer.
+
+\param[out] span - pointer to the first byte of the block
+
+\return length of the block
+******************************************************************************/
+static uint16_t getRingBufferWriteSpan(RingBuffer_t *ring, uint8_t **span)
+{
+  *span = ring->ptw;
+
+  if (ring->isFull)
+    return 0;
+
+  if (ring->ptw < ring->ptr)
+    return (ring->ptr - ring->ptw) / sizeof(uint8_t);
+  else
+    return (ring->end - ring->ptw) / sizeof(uint8_t);
+}
+
+/**************************************************************************//**
+\brief Commits data written to block got by getRingBufferWriteSpan().
+
+\param[in] size - amount of written bytes
+******************************************************************************/
+static void commitRingBufferWrite(RingBuffer_t *ring, uint16_t size)
+{
+  if (!size)
+    return;
+
+  ring->ptw += size;
+
+  if (ring->end == ring->ptw)
+    ring->ptw = ring->start;
+
+  ring->isEmpty = false;
+  if (ring->ptw == ring->ptr)
+    ring->isFull = true;
+}
+
 /**************************************************************************//**
 \brief Changing state circle buffer from empty to full.
 ******************************************************************************/
@@ -388,6 +554,44 @@ bool putCharInTunnel(uint8_t ch)
   return false;
 }
 
+/**************************************************************************//**
+\brief Puts block of data in rx tunneling buffer.
+
+\param[in] data - data to write
+\param[in] length - data length
+
+\return true if data was written correctly, false otherwise.
+******************************************************************************/
+bool putDataInTunnel(const uint8_t *data, uint16_t length)
+{
+  (void)data;
+  (void)length;
+  return false;
+}
+
+/**************************************************************************//**
+\brief Gets contiguous block of data from tx tunneling buffer.
+
+\param[out] span - pointer to the first byte of the block
+
+\return length of the block, zero if there is nothing to send.
+******************************************************************************/
+uint16_t getTunnelTxSpan(uint8_t **span)
+{
+  *span = NULL;
+  return 0;
+}
+
+/**************************************************************************//**
+\brief Releases sent data in tx tunneling buffer.
+
+\param[in] length - amount of sent bytes
+******************************************************************************/
+void commitTunnelTxSpan(uint16_t length)
+{
+  (void)length;
+}
+
 /**************************************************************************//**
 \brief Check is allocated buffers for tunneling or not.
 
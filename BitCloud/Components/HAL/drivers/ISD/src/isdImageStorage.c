@@ -185,6 +185,9 @@ static TxState_t txState = TX_ERR_OR_OFF;
 static uint8_t usartDescriptorRxBuffer[USART_RX_BUFFER_LENGTH];
 static IsdCommandFrame_t isdBuffer;
 static uint16_t rxCnt = 0;
+#if APP_USE_ISD_CONSOLE_TUNNELING == 1
+static uint16_t tunnelTxLength = 0;
+#endif
 
 static HAL_AppTimer_t interbyteTimer =
 {
@@ -467,14 +470,7 @@ static void isdUsartReceivedHandler(uint16_t bytesReceived)
 ******************************************************************************/
 static void putMessageInTunnel(uint16_t rxCnt)
 {
-  uint16_t wasWrote = 0;
-  uint8_t *ptr = (uint8_t *)&isdBuffer;
-
-  while (wasWrote < (sizeof(isdBuffer.length) + rxCnt))
-  {
-    putCharInTunnel(*ptr++);
-    wasWrote++;
-  }
+  putDataInTunnel((uint8_t *)&isdBuffer, sizeof(isdBuffer.length) + rxCnt);
 }
 
 /**************************************************************************//**
@@ -498,22 +494,29 @@ static void isdSendCommandFrame(void)
 }
 
 /**************************************************************************//**
-\brief Starts sending char from tx tunneling buffer through usart.
+\brief Starts sending data from tx tunneling buffer through usart. Contiguous
+  block of data is sent directly from the buffer and released on transmit
+  completion.
 ******************************************************************************/
 void isdSendTunnelingDate(void)
 {
 #if APP_USE_ISD_CONSOLE_TUNNELING == 1
   if ((TX_IDLE == txState) && (isTunnelInitialized()) && (isTunnelingDateToSend()))
   {
-    static uint8_t ch;
-    ch = getCharFromTunnel();
-    if (WRITE_USART(&usartDescriptor, &ch, sizeof(ch)) <= 0)
+    uint8_t *span;
+    uint16_t spanSize = getTunnelTxSpan(&span);
+    int wasWrote = WRITE_USART(&usartDescriptor, span, spanSize);
+
+    if (wasWrote <= 0)
     {
       txState = TX_ERR_OR_OFF;
       isdSetState(ISD_HARDWARE_FAULT);
     }
     else
+    {
+      tunnelTxLength = wasWrote;
       txState = TX_TUNNELING;
+    }
   }
 #endif // APP_USE_ISD_CONSOLE_TUNNELING == 1
 }
@@ -540,8 +543,13 @@ static void isdUsartTransmittedHandler(void)
       }
       break;
 
-    case TX_SENDING_DATA:
     case TX_TUNNELING:
+#if APP_USE_ISD_CONSOLE_TUNNELING == 1
+        commitTunnelTxSpan(tunnelTxLength);
+        tunnelTxLength = 0;
+#endif
+        // no break
+    case TX_SENDING_DATA:
         txState = TX_IDLE;
         isdSendTunnelingDate();
       break;
@@ -116,6 +116,11 @@ typedef struct
    If rxCallback is NULL then polling method is used. \n
    If rxCallback isn't NULL then callback method is used.*/
   void (*rxCallback)(uint16_t);
+  /** \brief It's receiver idle usart callback. \n
+   If rxIdleCallback isn't NULL then it is called with amount of bytes in
+   receive buffer when nothing was received during HAL_USART_RX_IDLE_TIMEOUT ms
+   after the last received byte, so frame boundaries can be detected. */
+  void (*rxIdleCallback)(uint16_t);
   /** \brief It's transmitting was completed usart callback. \n
    If txBuffer isn't NULL then txCallback notify about end of bytes sending.  */
   void (*txCallback)(void);
@@ -212,6 +217,40 @@ int HAL_WriteUsart(HAL_UsartDescriptor_t *descriptor, uint8_t *buffer, uint16_t
 *****************************************************************************/
 int HAL_ReadUsart(HAL_UsartDescriptor_t *descriptor, uint8_t *buffer, uint16_t length);
 
+/**************************************************************************//**
+\brief Gets contiguous block of received data directly from receive buffer.
+The block stays in the buffer until it is released by HAL_ReleaseUsartRxSpan().
+
+\ingroup hal_usart
+
+\param[in]
+  descriptor - pointer to HAL_UsartDescriptor_t structure;
+
+\param[out]
+  span - pointer to the first byte of the block;
+
+\return
+  Length of the block, 0 if there is no received data or bad descriptor.
+******************************************************************************/
+uint16_t HAL_GetUsartRxSpan(HAL_UsartDescriptor_t *descriptor, uint8_t **span);
+
+/**************************************************************************//**
+\brief Releases data processed from the block got by HAL_GetUsartRxSpan().
+
+\ingroup hal_usart
+
+\param[in]
+  descriptor - pointer to HAL_UsartDescriptor_t structure;
+
+\param[in]
+  length - number of bytes to be released;
+
+\return
+  -1 - bad descriptor; \n
+  Number of released bytes - success.
+******************************************************************************/
+int HAL_ReleaseUsartRxSpan(HAL_UsartDescriptor_t *descriptor, uint16_t length);
+
 /**************************************************************************//**
 \brief Forbids the host to transmit data.
 Only USART_CHANNEL_1 can be used for hardware flow control for avr.
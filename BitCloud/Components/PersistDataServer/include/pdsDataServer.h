@@ -75,6 +75,13 @@
 /* Highlight non-volatile memory writing with onboard LED */
 //#define PDS_HIGHLIGHT_WRITING_PROCESS
 
+/* Interval in ms during which BitCloud events subscribed by PDS_StoreByEvents()
+   are coalesced into a single store. Zero disables debouncing, so memory is
+   stored on every event occurrence. */
+#ifndef PDS_EVENTS_DEBOUNCE_INTERVAL
+  #define PDS_EVENTS_DEBOUNCE_INTERVAL    0U
+#endif
+
 /* PDS working status flags */
 #define PDS_STOPPED_FLAG                 (1U << 0U)
 #define PDS_WRITING_INPROGRESS_FLAG      (1U << 1U)
@@ -30,7 +30,19 @@
 /******************************************************************************
                    Defines section
 ******************************************************************************/
-#define PDS_CRC_INITIAL_VALUE   0U
+#define PDS_CRC_INITIAL_VALUE         0U
+#define PDS_SHADOW_CRC_INITIAL_VALUE  0xFFFFU
+
+/* Size of the stack buffer used to read stored files data chunk by chunk */
+#ifndef PDS_COMMIT_CHUNK_SIZE
+  #define PDS_COMMIT_CHUNK_SIZE       16U
+#endif
+
+/* Changed spans of a file closer to each other than this amount of bytes are
+   written to non-volatile memory by a single write operation */
+#ifndef PDS_COMMIT_SPAN_GAP
+  #define PDS_COMMIT_SPAN_GAP         4U
+#endif
 
 #ifdef _ENABLE_PERSISTENT_SERVER_
 /******************************************************************************
@@ -47,6 +59,17 @@
 ******************************************************************************/
 PDS_FileCrc_t pdsCalculateRAMDataCrc(PDS_FileCrc_t initValue, uint8_t *data, uint16_t length);
 
+/******************************************************************************
+\brief Calculates shadow CRC of specified data. Shadow CRC is kept in RAM
+       only and is stronger than file CRC stored in non-volatile memory.
+
+\param[in] data - pointer to data to be processed.
+\param[in] length - data length in bytes.
+
+\return Result of calculation.
+******************************************************************************/
+uint16_t pdsCalculateShadowCrc(const uint8_t *data, uint16_t length);
+
 /******************************************************************************
 \brief Check file data within non-volatile storage.
 
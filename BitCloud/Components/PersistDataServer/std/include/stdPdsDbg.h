@@ -42,12 +42,15 @@ typedef enum
   PDSINIT_PDSINIT0                      = 0xA020,
   PDSINIT_PDSINIT1                      = 0xA021,
   PDSINIT_PDSINIT2                      = 0xA022,
+  PDSINIT_PDSINIT3                      = 0xA023,
+  PDSINIT_PDSINITDIRCONTENTCACHE0       = 0xA024,
 
   PDSDATASERVER_PDSMARKDATATORESTORE0   = 0xA030,
   PDSDATASERVER_PDSSETTODEFAULT0        = 0xA031,
   PDSDATASERVER_PDSCLEARRESTOREDMEMORY0 = 0xA032,
 
   PDSEVENTS_PDSOBSERVER0                = 0xA040,
+  PDSEVENTS_PDSBUILDEVENTINDEX0         = 0xA041,
 } PDS_DbgCodeId_t;
 
 #endif /* _PDSDBG_H_ */
@@ -50,6 +50,16 @@ typedef struct _PdsMem_t
   /* Configuration-dependent list of memory identifiers, allowed for storing in 
      non-volatile memory */
   PDS_MemMask_t allowedForStoring;
+  /* Files descriptor records and offsets indexed by memory identifier */
+  PdsFileCacheEntry_t fileCache[PDS_FILE_IDS_AMOUNT];
+  /* Files contained in directories indexed by directory memory identifier
+     starting from PDS_FIRST_DIR_MEM_ID */
+  PDS_MemMask_t dirContent[PDS_DIR_IDS_AMOUNT];
+  /* Shadow CRCs of files contents stored in non-volatile memory. Allows
+     to skip commitment of unchanged files without memory access */
+  uint16_t shadowCrc[PDS_MEM_IDS_AMOUNT];
+  /* List of file identifiers with valid shadow CRC */
+  PDS_MemMask_t shadowCrcValid;
   /* Timer for periodic commit to non-volatile memory */
   HAL_AppTimer_t periodicCommitTimer;
   /* Persistent data memory identifier. Specifies file or directory that is
@@ -63,12 +63,25 @@
 #define PDS_MEM_MASK_CLEAR_BIT(mask, bitN)  {mask[bitN/8] &= ~(1U << bitN%8U);}
 #define PDS_MEM_MASK_IS_BIT_SET(mask, bitN) (mask[bitN/8] & (1U << bitN%8U))
 
+/* Directories identifiers range */
+#define PDS_FIRST_DIR_MEM_ID  (PDS_FILE_IDS_AMOUNT + 1U)
+#define PDS_DIR_IDS_AMOUNT    (PDS_ALL_EXISTENT_MEMORY - PDS_FIRST_DIR_MEM_ID)
+
 /******************************************************************************
                    Types section
 ******************************************************************************/
 /* Non-volatile memory mask; bit index corresponds to file or directory unique identifier */
 typedef uint8_t PDS_MemMask_t[PDS_MEM_MASK_LENGTH];
 
+/* Cached information about file allowed for storing */
+typedef struct _PdsFileCacheEntry_t
+{
+  /* File descriptor record, NULL if file is not allowed for storing */
+  PDS_FileDescrRec_t descrRec;
+  /* Offset of the file header in non-volatile memory */
+  uint16_t offset;
+} PdsFileCacheEntry_t;
+
 /* Context to access to stored value in non-volatile memory */
 typedef struct _PdsDataAccessContext_t
 {
@@ -131,6 +144,12 @@ void pdsPrepareAccessContext(PdsDataAccessContext_t *accessContext, const uint8_
 bool pdsPrepareMemoryAccess(PdsDataAccessContext_t *accessContext,
                             MEMORY_DESCRIPTOR *fileDataDescr);
 
+/******************************************************************************
+\brief Fills directories content cache. Nested directories are replaced with
+       their content, so any directory is expanded by a single lookup.
+******************************************************************************/
+void pdsInitDirContentCache(void);
+
 /******************************************************************************
 \brief If memory mask contains any directory memoryIds they'll be expanded
        into set of file memoryIds.
@@ -81,6 +81,9 @@ typedef enum _PDS_MemIdsTable_t
 
   NWK_RREQ_IDENTIFIER_MEM_ID             =  0x0026,
   NWK_SECURITY_COUNTERS_MEM_ID           =  0x0027,
+#ifdef _SYS_FLIGHT_RECORDER_ON_
+  SYS_FLIGHT_RECORDER_MEM_ID             =  0x0028, //!< Refers to the flight recorder snapshot taken at boot
+#endif
 
   /* Service value */
   PDS_FILE_IDS_AMOUNT,
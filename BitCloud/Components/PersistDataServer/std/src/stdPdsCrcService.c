@@ -29,6 +29,7 @@
 #include <sysTaskManager.h>
 #include <stdPdsWriteData.h>
 #include <stdPdsMem.h>
+#include <sysUtils.h>
 
 /******************************************************************************
                    Implementation section
@@ -52,6 +53,24 @@ PDS_FileCrc_t pdsCalculateRAMDataCrc(PDS_FileCrc_t initValue, uint8_t *data, uin
   return crc;
 }
 
+/******************************************************************************
+\brief Calculates shadow CRC of specified data.
+
+\param[in] data - pointer to data to be processed.
+\param[in] length - data length in bytes.
+
+\return Result of calculation.
+******************************************************************************/
+uint16_t pdsCalculateShadowCrc(const uint8_t *data, uint16_t length)
+{
+  uint16_t crc = PDS_SHADOW_CRC_INITIAL_VALUE;
+
+  for (uint16_t i = 0; i < length; i++)
+    crc = SYS_Crc16Ccitt(crc, data[i]);
+
+  return crc;
+}
+
 /******************************************************************************
 \brief Check if any valid data exists in non-volatile memory.
 
@@ -89,7 +108,7 @@ PDS_DataServerState_t pdsCheckStorage(PDS_MemMask_t memoryMask)
 ******************************************************************************/
 PDS_DataServerState_t pdsCheckFile(PDS_MemId_t memoryId, const MEMORY_DESCRIPTOR *const fileDataDescr)
 {
-  uint8_t data;
+  uint8_t data[PDS_COMMIT_CHUNK_SIZE];
   PDS_FileHeader_t header;
   MEMORY_DESCRIPTOR accessDescriptor;
   PDS_FileCrc_t fileCrc = PDS_CRC_INITIAL_VALUE;
@@ -103,15 +122,15 @@ PDS_DataServerState_t pdsCheckFile(PDS_MemId_t memoryId, const MEMORY_DESCRIPTOR
       fileDataDescr->length != header.size)
     return PDS_CRC_ERROR;
 
-  accessDescriptor.data = &data;
-  accessDescriptor.length = 1;
+  accessDescriptor.data = data;
 
-  /* Check for any changes in byte-by-byte order */
-  for (uint16_t i = 0; i < fileDataDescr->length; i++)
+  /* Calculate CRC of stored data chunk by chunk */
+  for (uint16_t i = 0; i < fileDataDescr->length; i += accessDescriptor.length)
   {
     accessDescriptor.address = fileDataDescr->address + i;
+    accessDescriptor.length = MIN(PDS_COMMIT_CHUNK_SIZE, (uint16_t)(fileDataDescr->length - i));
     pdsRead(&accessDescriptor, pdsDummyCallback);
-    fileCrc = pdsCalculateRAMDataCrc(fileCrc, accessDescriptor.data, 1);
+    fileCrc = pdsCalculateRAMDataCrc(fileCrc, accessDescriptor.data, accessDescriptor.length);
   }
 
   if (fileCrc != header.crc)
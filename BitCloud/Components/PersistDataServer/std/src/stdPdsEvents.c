@@ -27,8 +27,13 @@
 #include <stdPdsMem.h>
 #include <sysEvents.h>
 #include <stdPdsMemAccess.h>
+#include <stdPdsWriteData.h>
+#include <sysAssert.h>
+#include <appTimer.h>
 
 #define EVENT_TO_MEM_ID_MAPPING(event, id)  {.eventId = event, .memoryId = id}
+/* Events with identifiers below this value can be mapped to memory */
+#define PDS_MAPPED_EVENTS_AMOUNT            (BC_EVENT_NWK_RREQ_ID_UPDATED + 1U)
 
 typedef struct _EventToMemoryIdMapping_t
 {
@@ -40,6 +45,10 @@ typedef struct _EventToMemoryIdMapping_t
                     Prototypes section
 ******************************************************************************/
 static void pdsObserver(SYS_EventId_t eventId, SYS_EventData_t data);
+static void pdsBuildEventIndex(void);
+#if PDS_EVENTS_DEBOUNCE_INTERVAL > 0
+static void pdsDebounceTimerFired(void);
+#endif
 
 /******************************************************************************
                     Static variables section
@@ -79,6 +88,26 @@ static EventToMemoryIdMapping_t PROGMEM_DECLARE(pdsMemoryMap[]) =
   EVENT_TO_MEM_ID_MAPPING(BC_EVENT_NWK_RREQ_ID_UPDATED,         NWK_RREQ_IDENTIFIER_MEM_ID)
 };
 
+/* Memory map index. Memory map entries relevant to event N are referenced by
+   eventIndexOrder[eventIndexStart[N]] .. eventIndexOrder[eventIndexStart[N + 1] - 1].
+   Entries without memory specified are not indexed. */
+static uint8_t eventIndexStart[PDS_MAPPED_EVENTS_AMOUNT + 1U];
+static uint8_t eventIndexOrder[ARRAY_SIZE(pdsMemoryMap)];
+static bool eventIndexBuilt = false;
+
+#if PDS_EVENTS_DEBOUNCE_INTERVAL > 0
+/* Memory to be stored when debounce interval expires */
+static PDS_MemMask_t debouncedMemory;
+/* Debounce timer is running */
+static bool debouncePending = false;
+static HAL_AppTimer_t debounceTimer =
+{
+  .mode     = TIMER_ONE_SHOT_MODE,
+  .interval = PDS_EVENTS_DEBOUNCE_INTERVAL,
+  .callback = pdsDebounceTimerFired
+};
+#endif /* PDS_EVENTS_DEBOUNCE_INTERVAL > 0 */
+
 /******************************************************************************
                    Implementation section
 ******************************************************************************/
@@ -99,6 +128,9 @@ void PDS_StoreByEvents(PDS_MemId_t memoryId)
   PDS_MemMask_t eventMemMask;
   EventToMemoryIdMapping_t evMemoryIdMapping;
 
+  if (!eventIndexBuilt)
+    pdsBuildEventIndex();
+
   PDS_MEM_MASK_CLEAR_ALL(eventMemMask);
   pdsInitMemMask(memoryId, reqMemMask);
 
@@ -110,6 +142,9 @@ void PDS_StoreByEvents(PDS_MemId_t memoryId)
     /* Unsubscribe from all events at first */
     SYS_UnsubscribeFromEvent(evMemoryIdMapping.eventId, &pdsEventReceiver);
 
+    if (PDS_NO_MEMORY_SPECIFIED == evMemoryIdMapping.memoryId)
+      continue;
+
     PDS_MEM_MASK_SET_BIT(eventMemMask, evMemoryIdMapping.memoryId);
     pdsExpandWithDirContent(eventMemMask);
 
@@ -138,17 +173,94 @@ static void pdsObserver(SYS_EventId_t eventId, SYS_EventData_t data)
   if (pdsMemory()->status & PDS_STOPPED_FLAG)
     return;
 
+  if (eventId >= PDS_MAPPED_EVENTS_AMOUNT)
+    return;
+
+  for (uint8_t i = eventIndexStart[eventId]; i < eventIndexStart[eventId + 1U]; i++)
+  {
+    memcpy_P(&evMemoryIdMapping, &pdsMemoryMap[eventIndexOrder[i]], sizeof(EventToMemoryIdMapping_t));
+
+#if PDS_EVENTS_DEBOUNCE_INTERVAL > 0
+    PDS_MEM_MASK_SET_BIT(debouncedMemory, evMemoryIdMapping.memoryId);
+#else
+    PDS_Store(evMemoryIdMapping.memoryId);
+#endif
+  }
+
+#if PDS_EVENTS_DEBOUNCE_INTERVAL > 0
+  /* Timer is not restarted by subsequent events, so storing is delayed by
+     not more than debounce interval */
+  if ((eventIndexStart[eventId] != eventIndexStart[eventId + 1U]) && !debouncePending)
+  {
+    debouncePending = true;
+    HAL_StartAppTimer(&debounceTimer);
+  }
+#endif
+
+  (void)data;
+}
+
+/******************************************************************************
+\brief Builds memory map index grouping memory map entries by event.
+******************************************************************************/
+static void pdsBuildEventIndex(void)
+{
+  EventToMemoryIdMapping_t evMemoryIdMapping;
+  uint8_t position[PDS_MAPPED_EVENTS_AMOUNT];
+
+  memset(eventIndexStart, 0, sizeof(eventIndexStart));
+
+  /* Count entries for every event */
   for (uint8_t i = 0U; i < ARRAY_SIZE(pdsMemoryMap); i++)
   {
     memcpy_P(&evMemoryIdMapping, &pdsMemoryMap[i], sizeof(EventToMemoryIdMapping_t));
+    SYS_E_ASSERT_FATAL((evMemoryIdMapping.eventId < PDS_MAPPED_EVENTS_AMOUNT), PDSEVENTS_PDSBUILDEVENTINDEX0);
 
-    if (evMemoryIdMapping.eventId == eventId &&
-        PDS_NO_MEMORY_SPECIFIED != evMemoryIdMapping.memoryId)
-      PDS_Store(evMemoryIdMapping.memoryId);
+    if (PDS_NO_MEMORY_SPECIFIED != evMemoryIdMapping.memoryId)
+      eventIndexStart[evMemoryIdMapping.eventId + 1U]++;
   }
 
-  (void)data;
+  for (uint8_t eventId = 0U; eventId < PDS_MAPPED_EVENTS_AMOUNT; eventId++)
+    eventIndexStart[eventId + 1U] += eventIndexStart[eventId];
+
+  /* Place entries to the ranges of their events */
+  memcpy(position, eventIndexStart, sizeof(position));
+
+  for (uint8_t i = 0U; i < ARRAY_SIZE(pdsMemoryMap); i++)
+  {
+    memcpy_P(&evMemoryIdMapping, &pdsMemoryMap[i], sizeof(EventToMemoryIdMapping_t));
+
+    if (PDS_NO_MEMORY_SPECIFIED != evMemoryIdMapping.memoryId)
+      eventIndexOrder[position[evMemoryIdMapping.eventId]++] = i;
+  }
+
+  eventIndexBuilt = true;
+}
+
+#if PDS_EVENTS_DEBOUNCE_INTERVAL > 0
+/******************************************************************************
+\brief Debounce interval expiration callback. Stores memory collected from
+       events occured during the interval.
+******************************************************************************/
+static void pdsDebounceTimerFired(void)
+{
+  debouncePending = false;
+  pdsExpandWithDirContent(debouncedMemory);
+
+  for (uint8_t i = 0U; i < PDS_MEM_MASK_LENGTH; i++)
+    debouncedMemory[i] &= pdsMemory()->allowedForStoring[i];
+
+  if (!(pdsMemory()->status & PDS_STOPPED_FLAG) && pdsMemMaskIsAnyBitSet(debouncedMemory))
+  {
+    pdsAddDataForCommitment(debouncedMemory);
+
+    if (!(pdsMemory()->status & PDS_WRITING_INPROGRESS_FLAG))
+      pdsStartCommitment();
+  }
+
+  PDS_MEM_MASK_CLEAR_ALL(debouncedMemory);
 }
+#endif /* PDS_EVENTS_DEBOUNCE_INTERVAL > 0 */
 
 #endif /* _ENABLE_PERSISTENT_SERVER_ */
 #endif /* PDS_ENABLE_WEAR_LEVELING != 1 */
@@ -94,17 +94,21 @@ void PDS_Init(void)
 
     pdsMemory()->totalMemorySize = 0;
     PDS_MEM_MASK_CLEAR_ALL(pdsMemory()->allowedForStoring);
+    memset(pdsMemory()->fileCache, 0, sizeof(pdsMemory()->fileCache));
 
     for (uint8_t i = 0; i < pdsMemory()->ffSize; i++)
     {
       memcpy_P(&fDescr, fDescrRec, sizeof(PDS_FileDescr_t));
+      SYS_E_ASSERT_FATAL((fDescr.memoryId < PDS_FILE_IDS_AMOUNT), PDSINIT_PDSINIT3);
       pdsMemory()->totalMemorySize += fDescr.size + sizeof(PDS_FileHeader_t);
       PDS_MEM_MASK_SET_BIT(pdsMemory()->allowedForStoring, fDescr.memoryId);
+      pdsMemory()->fileCache[fDescr.memoryId].descrRec = fDescrRec;
       fDescrRec++;
     }
   }
 
   pdsInitFileOffsetTable();
+  pdsInitDirContentCache();
   pdsTimerInit();
 
 #ifdef PDS_HIGHLIGHT_WRITING_PROCESS
@@ -113,7 +117,8 @@ void PDS_Init(void)
 }
 
 /******************************************************************************
-\brief Filling file offset table in non-volatile memory.
+\brief Filling file offset table in non-volatile memory. Offsets are also kept
+       in the files cache, so the table is not read after initialization.
 *******************************************************************************/
 static void pdsInitFileOffsetTable(void)
 {
@@ -142,6 +147,8 @@ static void pdsInitFileOffsetTable(void)
         pdsWrite(&descriptor, pdsDummyCallback);
       }
 
+      pdsMemory()->fileCache[memoryId].offset = (uint16_t)currentFileOffset;
+
       fileDescrRec = pdsGetFileDescrRec(memoryId);
       SYS_E_ASSERT_FATAL(fileDescrRec, PDSINIT_PDSINIT2);
       memcpy_P(&fileDescr, fileDescrRec, sizeof(PDS_FileDescr_t));
@@ -27,16 +27,6 @@
 #include <stdPdsWriteData.h>
 #include <sysAssert.h>
 
-/*****************************************************************************
-                   Definitions section
-******************************************************************************/
-#define BAD_FILE_INDEX      0xFFFF
-
-/****************************************************************************
-                   Static functions prototypes section
-******************************************************************************/
-static uint16_t pdsGetFileOffsetTableIndex(PDS_MemId_t memoryId);
-
 /******************************************************************************
                    Implementation section
 ******************************************************************************/
@@ -49,17 +39,12 @@ static uint16_t pdsGetFileOffsetTableIndex(PDS_MemId_t memoryId);
 ******************************************************************************/
 PDS_FileDescrRec_t pdsGetFileDescrRec(PDS_MemId_t memoryId)
 {
-  PDS_FileDescrRec_t ffTable = pdsMemory()->ffStart;
-  PDS_MemId_t fileMemoryId;
+  if (memoryId < PDS_FILE_IDS_AMOUNT)
+    return pdsMemory()->fileCache[memoryId].descrRec;
 
-  for (uint16_t recordIndex = 0; recordIndex < pdsMemory()->ffSize; recordIndex++)
-  {
-    memcpy_P(&fileMemoryId, &ffTable[recordIndex].memoryId, sizeof(fileMemoryId));
-    if (fileMemoryId == memoryId)
-      return &ffTable[recordIndex];
-  }
   return NULL;
 }
+
 /******************************************************************************
 \brief Obtains appropriate directory descriptor record by specified memory identifier.
 
@@ -81,40 +66,6 @@ PDS_DirDescrRec_t pdsGetDirectoryDescrRec(PDS_MemId_t memoryId)
   return NULL;
 }
 
-/******************************************************************************
-\brief Calculates file sequence number by memory mask of allowed for storing
-       files.
-
-\param[in] memoryId - an unique file identifier.
-
-\return File index or BAD_FILE_INDEX if error is occured.
-*******************************************************************************/
-static uint16_t pdsGetFileOffsetTableIndex(PDS_MemId_t memoryId)
-{
-  PDS_MemMask_t memoryMask;
-  uint16_t index = 0;
-  uint8_t i;
-
-  if (!PDS_MEM_MASK_IS_BIT_SET(pdsMemory()->allowedForStoring, memoryId))
-    return BAD_FILE_INDEX;
-
-  memcpy(memoryMask, pdsMemory()->allowedForStoring, PDS_MEM_MASK_LENGTH);
-
-  /* Count bits set in mask before byte which contains bit specified by memoryId */
-  for (i = 0; i < memoryId / 8; i++)
-  {
-    memoryMask[i] = (memoryMask[i] & 0x55) + ((memoryMask[i] >> 1) & 0x55);
-    memoryMask[i] = (memoryMask[i] & 0x33) + ((memoryMask[i] >> 2) & 0x33);
-    index += (memoryMask[i] & 0x0f) + ((memoryMask[i] >> 4) & 0x0f);
-  }
-
-  /* Count bits set in byte which contains bit specified by memoryId */
-  for (i = 0; i < memoryId % 8; i++)
-    index += (memoryMask[memoryId / 8] & (1U << i)) ? 1 : 0;
-
-  return index;
-}
-
 /******************************************************************************
 \brief Calculates file offset within non-volatile memory.
 
@@ -124,18 +75,9 @@ static uint16_t pdsGetFileOffsetTableIndex(PDS_MemId_t memoryId)
 ******************************************************************************/
 void pdsGetFileOffset(PDS_MemId_t memoryId, uint16_t *fileOffset)
 {
-  MEMORY_DESCRIPTOR descriptor;
-  PDS_FileOffsetInfo_t fileOffsetInfo;
-  uint16_t offsetTableIndex = pdsGetFileOffsetTableIndex(memoryId);
-
-  descriptor.data = (uint8_t *)&fileOffsetInfo;
-  descriptor.address = SYSTEM_BASE_STORAGE_ADDRESS + offsetTableIndex * sizeof(PDS_FileOffsetInfo_t);
-  descriptor.length = sizeof(PDS_FileOffsetInfo_t);
-  pdsRead(&descriptor, pdsDummyCallback);
+  SYS_E_ASSERT_FATAL(pdsGetFileDescrRec(memoryId), PDSMEMACCESS_PDSPREPAREACCESSCONTEXT1);
 
-  SYS_E_ASSERT_FATAL((memoryId == fileOffsetInfo.memoryId), PDSMEMACCESS_PDSPREPAREACCESSCONTEXT1);
-
-  *fileOffset = fileOffsetInfo.offset;
+  *fileOffset = pdsMemory()->fileCache[memoryId].offset;
 }
 
 /******************************************************************************
@@ -175,14 +117,23 @@ bool pdsPrepareMemoryAccess(PdsDataAccessContext_t *accessContext,
   PDS_FileDescrRec_t fileDescrRec = NULL;
   PDS_FileDescr_t fileDescr;
 
-  /* Obtain currently processed file memoryId */
-  for (memoryId = 0; memoryId < PDS_MEM_IDS_AMOUNT; memoryId++)
+  /* Obtain currently processed file memoryId. Access context contains files only. */
+  for (memoryId = 0; memoryId < PDS_FILE_IDS_AMOUNT; memoryId++)
+  {
+    /* Skip whole byte of the mask if no bits are set */
+    if (!accessContext->memoryMask[memoryId / 8U])
+    {
+      memoryId |= 7U;
+      continue;
+    }
+
     if (PDS_MEM_MASK_IS_BIT_SET(accessContext->memoryMask, memoryId))
     {
       PDS_MEM_MASK_CLEAR_BIT(accessContext->memoryMask, memoryId);
       fileDescrRec = pdsGetFileDescrRec(memoryId);
       break;
     }
+  }
 
   // Fill memory descriptor if file descroptor is found
   if (fileDescrRec)
@@ -205,50 +156,85 @@ bool pdsPrepareMemoryAccess(PdsDataAccessContext_t *accessContext,
 }
 
 /******************************************************************************
-\brief If memory mask contains any directory memoryIds they'll be expanded
-       into set of file memoryIds.
-
-\param[in] accessContext - access context pointer
-\param[in] memoryId - unique memory identifier
+\brief Fills directories content cache. Nested directories are replaced with
+       their content, so any directory is expanded by a single lookup.
 ******************************************************************************/
-void pdsExpandWithDirContent(PDS_MemMask_t memoryMask)
+void pdsInitDirContentCache(void)
 {
   PDS_DirDescrRec_t dirDescrRec = pdsMemory()->fdStart;
   PDS_DirDescr_t dir;
   PDS_MemId_t memoryId;
   bool expanded;
 
-  if (PDS_MEM_MASK_IS_BIT_SET(memoryMask, PDS_ALL_EXISTENT_MEMORY))
+  memset(pdsMemory()->dirContent, 0, sizeof(pdsMemory()->dirContent));
+
+  for (uint16_t recordIndex = 0; recordIndex < pdsMemory()->fdSize; recordIndex++)
   {
-    PDS_MEM_MASK_SET_ALL(memoryMask);
-    return;
+    memcpy_P(&dir, &dirDescrRec[recordIndex], sizeof(PDS_DirDescr_t));
+    SYS_E_ASSERT_FATAL(((PDS_FIRST_DIR_MEM_ID <= dir.memoryId) && (dir.memoryId < PDS_ALL_EXISTENT_MEMORY)),
+                       PDSINIT_PDSINITDIRCONTENTCACHE0);
+
+    for (uint8_t i = 0; i < dir.filesCount; i++)
+    {
+      memcpy_P(&memoryId, &dir.list[i], sizeof(PDS_MemId_t));
+      PDS_MEM_MASK_SET_BIT(pdsMemory()->dirContent[dir.memoryId - PDS_FIRST_DIR_MEM_ID], memoryId);
+    }
   }
 
-  /* Looping through all directories, including nested ones and expanding them */
+  /* Looping through all directories, replacing nested directories with their content */
   do
   {
     expanded = false;
 
-    for (uint16_t recordIndex = 0; recordIndex < pdsMemory()->fdSize; recordIndex++)
-    {
-      memcpy_P(&dir, &dirDescrRec[recordIndex], sizeof(PDS_DirDescr_t));
-
-      if (PDS_MEM_MASK_IS_BIT_SET(memoryMask, dir.memoryId))
+    for (uint8_t dirIndex = 0; dirIndex < PDS_DIR_IDS_AMOUNT; dirIndex++)
+      for (uint8_t nestedIndex = 0; nestedIndex < PDS_DIR_IDS_AMOUNT; nestedIndex++)
       {
-        PDS_MEM_MASK_CLEAR_BIT(memoryMask, dir.memoryId);
+        memoryId = PDS_FIRST_DIR_MEM_ID + nestedIndex;
 
-        /* Loop one more time in case of nested directory */
-        expanded = true;
-        for (uint8_t i = 0; i < dir.filesCount; i++)
+        if (PDS_MEM_MASK_IS_BIT_SET(pdsMemory()->dirContent[dirIndex], memoryId))
         {
-          memcpy_P(&memoryId, &dir.list[i], sizeof(PDS_MemId_t));
-          PDS_MEM_MASK_SET_BIT(memoryMask, memoryId);
+          PDS_MEM_MASK_CLEAR_BIT(pdsMemory()->dirContent[dirIndex], memoryId);
+
+          for (uint8_t i = 0; i < PDS_MEM_MASK_LENGTH; i++)
+            pdsMemory()->dirContent[dirIndex][i] |= pdsMemory()->dirContent[nestedIndex][i];
+
+          /* Loop one more time in case of deeper nesting */
+          expanded = true;
         }
       }
-    }
   } while (expanded);
 }
 
+/******************************************************************************
+\brief If memory mask contains any directory memoryIds they'll be expanded
+       into set of file memoryIds.
+
+\param[in] memoryMask - bitmask of non-volatile memory contents
+******************************************************************************/
+void pdsExpandWithDirContent(PDS_MemMask_t memoryMask)
+{
+  PDS_MemId_t memoryId;
+
+  if (PDS_MEM_MASK_IS_BIT_SET(memoryMask, PDS_ALL_EXISTENT_MEMORY))
+  {
+    PDS_MEM_MASK_SET_ALL(memoryMask);
+    return;
+  }
+
+  for (uint8_t dirIndex = 0; dirIndex < PDS_DIR_IDS_AMOUNT; dirIndex++)
+  {
+    memoryId = PDS_FIRST_DIR_MEM_ID + dirIndex;
+
+    if (PDS_MEM_MASK_IS_BIT_SET(memoryMask, memoryId))
+    {
+      PDS_MEM_MASK_CLEAR_BIT(memoryMask, memoryId);
+
+      for (uint8_t i = 0; i < PDS_MEM_MASK_LENGTH; i++)
+        memoryMask[i] |= pdsMemory()->dirContent[dirIndex][i];
+    }
+  }
+}
+
 #endif /* _ENABLE_PERSISTENT_SERVER_ */
 #endif /* PDS_ENABLE_WEAR_LEVELING != 1 */
 // eof pdsMemAccess.c
@@ -28,6 +28,7 @@
 #include <sysTaskManager.h>
 #include <stdPdsMem.h>
 #include <sysEvents.h>
+#include <sysUtils.h>
 
 #ifdef _ENABLE_PERSISTENT_SERVER_
 /******************************************************************************
@@ -35,6 +36,8 @@
 ******************************************************************************/
 static PDS_DataServerState_t pdsCommit(void);
 static bool pdsCommitStarted(PDS_MemId_t memoryId, MEMORY_DESCRIPTOR *fileDataDescr);
+static bool pdsWriteChangedSpans(const MEMORY_DESCRIPTOR *fileDataDescr, PDS_DataServerState_t *status);
+static PDS_DataServerState_t pdsWriteSpan(const MEMORY_DESCRIPTOR *fileDataDescr, uint16_t start, uint16_t end);
 
 /******************************************************************************
                    Implementation section
@@ -65,6 +68,10 @@ PDS_DataServerState_t pdsUpdate(const uint8_t *const memoryToRestore)
         return status;
       // Update restored memory mask
       PDS_MEM_MASK_SET_BIT(pdsMemory()->restoredMemory, accessContext.memoryId);
+      // Restored data is the same as stored one
+      pdsMemory()->shadowCrc[accessContext.memoryId] =
+        pdsCalculateShadowCrc(fileDataDescr.data, fileDataDescr.length);
+      PDS_MEM_MASK_SET_BIT(pdsMemory()->shadowCrcValid, accessContext.memoryId);
     }
   }
 
@@ -146,11 +153,19 @@ static PDS_DataServerState_t pdsCommit(void)
 ******************************************************************************/
 static bool pdsCommitStarted(PDS_MemId_t memoryId, MEMORY_DESCRIPTOR *fileDataDescr)
 {
-  uint8_t data;
-  bool commitNeeded = false;
-  PDS_FileCrc_t ramDataCrc;
+  bool commitNeeded;
+  uint16_t shadowCrc;
   PDS_FileHeader_t header;
+  PDS_FileCrc_t ramDataCrc;
   MEMORY_DESCRIPTOR accessDescriptor;
+  PDS_DataServerState_t status = PDS_SUCCESS;
+
+  shadowCrc = pdsCalculateShadowCrc(fileDataDescr->data, fileDataDescr->length);
+
+  /* File content is the same as was stored last time - skip memory access */
+  if (PDS_MEM_MASK_IS_BIT_SET(pdsMemory()->shadowCrcValid, memoryId) &&
+      shadowCrc == pdsMemory()->shadowCrc[memoryId])
+    return false;
 
   accessDescriptor.data = (uint8_t *)&header;
   accessDescriptor.length = sizeof(PDS_FileHeader_t);
@@ -159,30 +174,20 @@ static bool pdsCommitStarted(PDS_MemId_t memoryId, MEMORY_DESCRIPTOR *fileDataDe
 
   ramDataCrc = pdsCalculateRAMDataCrc(PDS_CRC_INITIAL_VALUE, fileDataDescr->data, fileDataDescr->length);
 
-  if (ramDataCrc == header.crc &&
-      memoryId == header.memoryId &&
+  if (memoryId == header.memoryId &&
       fileDataDescr->length == header.size)
   {
-    accessDescriptor.data = &data;
-    accessDescriptor.length = 1;
-    /* Check for any changes in byte-by-byte order */
-    for (uint16_t i = 0; i < fileDataDescr->length; i++)
-    {
-      accessDescriptor.address = fileDataDescr->address + i;
-      pdsRead(&accessDescriptor, pdsDummyCallback);
-      if (*accessDescriptor.data != *((fileDataDescr->data) + i))
-      {
-        commitNeeded = true;
-        break;
-      }
-    }
+    commitNeeded = pdsWriteChangedSpans(fileDataDescr, &status);
+    commitNeeded |= (ramDataCrc != header.crc);
   }
   else
   {
+    status = pdsWrite(fileDataDescr, pdsDummyCallback);
     commitNeeded = true;
   }
 
-  /* Start rewrite out of date data in persist memory*/
+  /* Start rewrite out of date file header in persist memory. Header is written
+     after the data, so interrupted commitment leaves the file with wrong CRC. */
   if (commitNeeded)
   {
     header.crc = ramDataCrc;
@@ -191,13 +196,100 @@ static bool pdsCommitStarted(PDS_MemId_t memoryId, MEMORY_DESCRIPTOR *fileDataDe
     accessDescriptor.data = (uint8_t *)&header;
     accessDescriptor.length = sizeof(PDS_FileHeader_t);
     accessDescriptor.address = fileDataDescr->address - sizeof(PDS_FileHeader_t);
-    pdsWrite(fileDataDescr, pdsStartCommitment);
-    pdsWrite(&accessDescriptor, pdsDummyCallback);
+    if (PDS_SUCCESS != pdsWrite(&accessDescriptor, pdsStartCommitment))
+      status = PDS_STORAGE_ERROR;
+  }
+
+  if (PDS_SUCCESS == status)
+  {
+    pdsMemory()->shadowCrc[memoryId] = shadowCrc;
+    PDS_MEM_MASK_SET_BIT(pdsMemory()->shadowCrcValid, memoryId);
   }
+  else
+    PDS_MEM_MASK_CLEAR_BIT(pdsMemory()->shadowCrcValid, memoryId);
 
   return commitNeeded;
 }
 
+/******************************************************************************
+\brief Compares file data in non-volatile memory with RAM data chunk by chunk
+\      and writes changed spans only.
+\
+\param[in] fileDataDescr - file payload memory access descriptor.
+\param[out] status - set to PDS_STORAGE_ERROR if any memory access failed.
+
+\return true - if any changes found; false - otherwise.
+******************************************************************************/
+static bool pdsWriteChangedSpans(const MEMORY_DESCRIPTOR *fileDataDescr, PDS_DataServerState_t *status)
+{
+  uint8_t data[PDS_COMMIT_CHUNK_SIZE];
+  MEMORY_DESCRIPTOR accessDescriptor;
+  uint16_t spanStart = 0;
+  uint16_t spanEnd = 0;
+  bool changed = false;
+
+  accessDescriptor.data = data;
+
+  for (uint16_t offset = 0; offset < fileDataDescr->length; offset += accessDescriptor.length)
+  {
+    accessDescriptor.address = fileDataDescr->address + offset;
+    accessDescriptor.length = MIN(PDS_COMMIT_CHUNK_SIZE, (uint16_t)(fileDataDescr->length - offset));
+    if (PDS_SUCCESS != pdsRead(&accessDescriptor, pdsDummyCallback))
+    {
+      /* Stored data is unknown - rewrite the rest of the file */
+      if (changed)
+        offset = spanStart;
+      *status = pdsWriteSpan(fileDataDescr, offset, fileDataDescr->length);
+      return true;
+    }
+
+    for (uint16_t i = 0; i < accessDescriptor.length; i++)
+    {
+      uint16_t position = offset + i;
+
+      if (data[i] == fileDataDescr->data[position])
+        continue;
+
+      if (!changed)
+        spanStart = position;
+      else if ((uint16_t)(position - spanEnd) > PDS_COMMIT_SPAN_GAP)
+      {
+        if (PDS_SUCCESS != pdsWriteSpan(fileDataDescr, spanStart, spanEnd))
+          *status = PDS_STORAGE_ERROR;
+        spanStart = position;
+      }
+
+      spanEnd = position + 1;
+      changed = true;
+    }
+  }
+
+  if (changed && PDS_SUCCESS != pdsWriteSpan(fileDataDescr, spanStart, spanEnd))
+    *status = PDS_STORAGE_ERROR;
+
+  return changed;
+}
+
+/******************************************************************************
+\brief Writes the span of file data to non-volatile memory.
+\
+\param[in] fileDataDescr - file payload memory access descriptor.
+\param[in] start - offset of the first byte of the span within the file.
+\param[in] end - offset of the byte following the span.
+
+\return Operation result.
+******************************************************************************/
+static PDS_DataServerState_t pdsWriteSpan(const MEMORY_DESCRIPTOR *fileDataDescr, uint16_t start, uint16_t end)
+{
+  MEMORY_DESCRIPTOR accessDescriptor;
+
+  accessDescriptor.address = fileDataDescr->address + start;
+  accessDescriptor.data = fileDataDescr->data + start;
+  accessDescriptor.length = end - start;
+
+  return pdsWrite(&accessDescriptor, pdsDummyCallback);
+}
+
 /******************************************************************************
 \brief Resets specified area in non-volatile memory. All stored data will be lost.
 
@@ -215,6 +307,8 @@ PDS_DataServerState_t pdsCorruptFiles(const uint8_t *const memoryMask)
 
   while (pdsPrepareMemoryAccess(&accessContext, &fileDataDescr))
   {
+    PDS_MEM_MASK_CLEAR_BIT(pdsMemory()->shadowCrcValid, accessContext.memoryId);
+
     fileDataDescr.data = &byteToWrite;
     fileDataDescr.length = 1;
     status = pdsRead(&fileDataDescr, pdsDummyCallback);
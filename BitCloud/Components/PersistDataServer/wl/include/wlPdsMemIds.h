@@ -125,17 +125,32 @@
 #endif // OTAU_MAX_DIRECTORIES_AMOUNT
 #endif // APP_USE_OTAU == 1
 
+/* System flight recorder file ID */
+#ifdef _SYS_FLIGHT_RECORDER_ON_
+#if APP_USE_OTAU == 1
+  #define SYS_FLIGHT_RECORDER_ITEM_ID       0x002AU
+#else
+  #define SYS_FLIGHT_RECORDER_ITEM_ID       0x0021U
+#endif // APP_USE_OTAU == 1
+  #define SYS_FLIGHT_RECORDER_MEM_ID        SYS_FLIGHT_RECORDER_ITEM_ID
+  #define SYS_FLIGHT_RECORDER_FILES_AMOUNT  0x0001U
+#else
+  #define SYS_FLIGHT_RECORDER_FILES_AMOUNT  0x0000U
+#endif // _SYS_FLIGHT_RECORDER_ON_
+
 #if APP_USE_OTAU == 1
 #define PDS_ITEM_AMOUNT             (BITCLOUD_MAX_ITEMS_AMOUNT +    \
                                      APPLICATION_MAX_FILES_AMOUNT + \
-                                     OTAU_MAX_FILES_AMOUNT)
+                                     OTAU_MAX_FILES_AMOUNT +        \
+                                     SYS_FLIGHT_RECORDER_FILES_AMOUNT)
 
 #define PDS_DIRECTORIES_AMOUNT      (BITCLOUD_MAX_DIRECTORIES_AMOUNT +    \
                                      APPLICATION_MAX_DIRECTORIES_AMOUNT + \
                                      OTAU_MAX_DIRECTORIES_AMOUNT)
 #else
-#define PDS_ITEM_AMOUNT             (BITCLOUD_MAX_ITEMS_AMOUNT + \
-                                     APPLICATION_MAX_FILES_AMOUNT)
+#define PDS_ITEM_AMOUNT             (BITCLOUD_MAX_ITEMS_AMOUNT +    \
+                                     APPLICATION_MAX_FILES_AMOUNT + \
+                                     SYS_FLIGHT_RECORDER_FILES_AMOUNT)
 
 #define PDS_DIRECTORIES_AMOUNT      (BITCLOUD_MAX_DIRECTORIES_AMOUNT + \
                                      APPLICATION_MAX_DIRECTORIES_AMOUNT)
@@ -31,12 +31,15 @@
 #include <D_Nv_Init.h>
 #include <sysEvents.h>
 #include <wlPdsTypes.h>
+#include <appTimer.h>
 
 /******************************************************************************
                               Defines section
 ******************************************************************************/
 #define EVENT_TO_MEM_ID_MAPPING(event, id)  {.eventId = event, .itemId = id}
 #define COMPID "wlPdsDataServer"
+/* Events with identifiers below this value can be mapped to items */
+#define PDS_MAPPED_EVENTS_AMOUNT            (BC_EVENT_NWK_RREQ_ID_UPDATED + 1U)
 
 /******************************************************************************
                             Types section
@@ -56,6 +59,10 @@ static void pdsObserver(SYS_EventId_t eventId, SYS_EventData_t data);
 static void pdsStoreItem(S_Nv_ItemId_t id);
 static bool pdsRestoreItem(S_Nv_ItemId_t id);
 static bool pdsInitItemMask(S_Nv_ItemId_t memoryId, uint8_t *itemMask);
+static void pdsBuildEventIndex(void);
+#if PDS_EVENTS_DEBOUNCE_INTERVAL > 0
+static void pdsDebounceTimerFired(void);
+#endif
 
 /******************************************************************************
                     Static variables section
@@ -121,6 +128,23 @@ static EventToMemoryIdMapping_t PROGMEM_DECLARE(pdsMemoryMap[]) =
 
 static uint8_t itemsToStore[PDS_ITEM_MASK_SIZE];
 
+/* Memory map index. Memory map entries relevant to event N are referenced by
+   eventIndexOrder[eventIndexStart[N]] .. eventIndexOrder[eventIndexStart[N + 1] - 1]. */
+static uint8_t eventIndexStart[PDS_MAPPED_EVENTS_AMOUNT + 1U];
+static uint8_t eventIndexOrder[ARRAY_SIZE(pdsMemoryMap)];
+static bool eventIndexBuilt = false;
+
+#if PDS_EVENTS_DEBOUNCE_INTERVAL > 0
+/* Debounce timer is running */
+static bool debouncePending = false;
+static HAL_AppTimer_t debounceTimer =
+{
+  .mode     = TIMER_ONE_SHOT_MODE,
+  .interval = PDS_EVENTS_DEBOUNCE_INTERVAL,
+  .callback = pdsDebounceTimerFired
+};
+#endif /* PDS_EVENTS_DEBOUNCE_INTERVAL > 0 */
+
 /******************************************************************************
                    Implementation section
 ******************************************************************************/
@@ -283,6 +307,9 @@ void PDS_StoreByEvents(PDS_MemId_t memoryId)
 {
   EventToMemoryIdMapping_t evMemoryIdMapping;
 
+  if (!eventIndexBuilt)
+    pdsBuildEventIndex();
+
   for (uint8_t i = 0U; i < ARRAY_SIZE(pdsMemoryMap); i++)
   {
     memcpy_P(&evMemoryIdMapping, &pdsMemoryMap[i], sizeof(EventToMemoryIdMapping_t));
@@ -341,24 +368,76 @@ bool PDS_IsAbleToRestore(PDS_MemId_t memoryId)
 static void pdsObserver(SYS_EventId_t eventId, SYS_EventData_t data)
 {
   EventToMemoryIdMapping_t evMemoryIdMapping;
-  bool post = false;
 
+  if ((eventId >= PDS_MAPPED_EVENTS_AMOUNT) ||
+      (eventIndexStart[eventId] == eventIndexStart[eventId + 1U]))
+    return;
+
+  for (uint8_t i = eventIndexStart[eventId]; i < eventIndexStart[eventId + 1U]; i++)
+  {
+    memcpy_P(&evMemoryIdMapping, &pdsMemoryMap[eventIndexOrder[i]], sizeof(EventToMemoryIdMapping_t));
+    itemsToStore[evMemoryIdMapping.itemId / 8U] |= 1U << (evMemoryIdMapping.itemId % 8U);
+  }
+
+#if PDS_EVENTS_DEBOUNCE_INTERVAL > 0
+  /* Timer is not restarted by subsequent events, so storing is delayed by
+     not more than debounce interval */
+  if (!debouncePending)
+  {
+    debouncePending = true;
+    HAL_StartAppTimer(&debounceTimer);
+  }
+#else
+  pdsPostTask(PDS_STORE_ITEM_TASK_ID);
+#endif
+
+  (void)data;
+}
+
+/******************************************************************************
+\brief Builds memory map index grouping memory map entries by event
+******************************************************************************/
+static void pdsBuildEventIndex(void)
+{
+  EventToMemoryIdMapping_t evMemoryIdMapping;
+  uint8_t position[PDS_MAPPED_EVENTS_AMOUNT];
+
+  memset(eventIndexStart, 0, sizeof(eventIndexStart));
+
+  /* Count entries for every event */
   for (uint8_t i = 0U; i < ARRAY_SIZE(pdsMemoryMap); i++)
   {
     memcpy_P(&evMemoryIdMapping, &pdsMemoryMap[i], sizeof(EventToMemoryIdMapping_t));
+    N_ERRH_ASSERT_FATAL(evMemoryIdMapping.eventId < PDS_MAPPED_EVENTS_AMOUNT);
+    eventIndexStart[evMemoryIdMapping.eventId + 1U]++;
+  }
 
-    if (evMemoryIdMapping.eventId == eventId)
-    {
-      itemsToStore[evMemoryIdMapping.itemId / 8U] |= 1U << (evMemoryIdMapping.itemId % 8U);
-      post = true;
-    }
+  for (uint8_t eventId = 0U; eventId < PDS_MAPPED_EVENTS_AMOUNT; eventId++)
+    eventIndexStart[eventId + 1U] += eventIndexStart[eventId];
+
+  /* Place entries to the ranges of their events */
+  memcpy(position, eventIndexStart, sizeof(position));
+
+  for (uint8_t i = 0U; i < ARRAY_SIZE(pdsMemoryMap); i++)
+  {
+    memcpy_P(&evMemoryIdMapping, &pdsMemoryMap[i], sizeof(EventToMemoryIdMapping_t));
+    eventIndexOrder[position[evMemoryIdMapping.eventId]++] = i;
   }
 
-  if (post)
-    pdsPostTask(PDS_STORE_ITEM_TASK_ID);
+  eventIndexBuilt = true;
+}
 
-  (void)data;
+#if PDS_EVENTS_DEBOUNCE_INTERVAL > 0
+/******************************************************************************
+\brief Debounce interval expiration callback. Stores items collected from
+       events occured during the interval
+******************************************************************************/
+static void pdsDebounceTimerFired(void)
+{
+  debouncePending = false;
+  pdsPostTask(PDS_STORE_ITEM_TASK_ID);
 }
+#endif /* PDS_EVENTS_DEBOUNCE_INTERVAL > 0 */
 
 /******************************************************************************
 \brief Stores item
@@ -0,0 +1,128 @@
+/**************************************************************************//**
+  \file  sysFlightRecorder.h
+
+  \brief Interface of the system flight recorder. The recorder keeps the last
+    SYS_FLIGHT_RECORDER_SIZE asserts, task dispatches and events in the RAM
+    area which is not cleared on warm reset, so the history which led to
+    a reset can be read after the device has restarted.
+
+  \author
+      Atmel Corporation: http://www.atmel.com \n
+      Support email: avr@atmel.com
+
+    Copyright (c) 2008-2015, Atmel Corporation. All rights reserved.
+    Licensed under Atmel's Limited License Agreement (BitCloudTM).
+
+  \internal
+    History:
+     19/10/26 - Created
+ ******************************************************************************/
+#ifndef _SYS_FLIGHT_RECORDER_H_
+#define _SYS_FLIGHT_RECORDER_H_
+
+/******************************************************************************
+                   Includes section
+******************************************************************************/
+#include <sysTypes.h>
+
+/******************************************************************************
+                   Define(s) section
+******************************************************************************/
+/* Number of records kept in the ring. Shall be a power of two. */
+#ifndef SYS_FLIGHT_RECORDER_SIZE
+  #define SYS_FLIGHT_RECORDER_SIZE    32U
+#endif
+
+#ifdef _SYS_FLIGHT_RECORDER_ON_
+  #define SYS_FLIGHT_RECORD(type, arg, aux) SYS_FlightRecorderRecord(type, arg, aux);
+#else
+  #define SYS_FLIGHT_RECORD(type, arg, aux)
+#endif
+
+/******************************************************************************
+                   Types section
+******************************************************************************/
+/** \brief Type of the flight recorder entry */
+typedef enum
+{
+  SYS_FLIGHT_RECORD_EMPTY  = 0x00, //!< Unused ring slot
+  SYS_FLIGHT_RECORD_BOOT   = 0x01, //!< arg - reset reason, aux - low byte of boot counter
+  SYS_FLIGHT_RECORD_ASSERT = 0x02, //!< arg - dbgCode, aux - assert level
+  SYS_FLIGHT_RECORD_TASK   = 0x03, //!< arg - task id
+  SYS_FLIGHT_RECORD_EVENT  = 0x04, //!< arg - event id, aux - low byte of event data
+} SYS_FlightRecordType_t;
+
+/** \brief Single flight recorder entry */
+typedef struct
+{
+  uint32_t timestamp; //!< System time in ms at the moment of recording
+  uint16_t arg;       //!< Type specific argument
+  uint8_t  type;      //!< Entry type, one of SYS_FlightRecordType_t values
+  uint8_t  aux;       //!< Type specific auxiliary byte
+} SYS_FlightRecord_t;
+
+/** \brief Flight recorder ring. The same layout is used for the live ring
+    kept in the no-init RAM and for the snapshot saved in non-volatile memory */
+typedef struct
+{
+  uint32_t           magic;
+  uint16_t           head;      //!< Index of the slot to be written next
+  uint16_t           count;     //!< Amount of valid records
+  uint32_t           bootCount; //!< Amount of warm resets survived by the ring
+  SYS_FlightRecord_t records[SYS_FLIGHT_RECORDER_SIZE];
+} SYS_FlightRecorder_t;
+
+/******************************************************************************
+                   Prototypes section
+******************************************************************************/
+#ifdef _SYS_FLIGHT_RECORDER_ON_
+/**************************************************************************//**
+\brief Validates the ring after reset. If the ring survived the reset its
+  content is copied to the snapshot, otherwise the ring is cleared.
+  Shall be called once after HAL initialization.
+******************************************************************************/
+void SYS_FlightRecorderInit(void);
+
+/**************************************************************************//**
+\brief Puts a record to the ring. Costs a few stores only.
+
+\param[in] type - record type
+\param[in] arg  - type specific argument
+\param[in] aux  - type specific auxiliary byte
+******************************************************************************/
+void SYS_FlightRecorderRecord(SYS_FlightRecordType_t type, uint16_t arg, uint8_t aux);
+
+/**************************************************************************//**
+\brief Reads a record from the live ring or from the snapshot of the ring
+  taken at boot. Records are indexed from the oldest to the newest one.
+
+\param[in] snapshot - true to read the snapshot, false to read the live ring
+\param[in] index    - record index
+\param[out] record  - buffer for the record
+
+\return true if record exists, false - otherwise
+******************************************************************************/
+bool SYS_FlightRecorderGetRecord(bool snapshot, uint16_t index, SYS_FlightRecord_t *record);
+
+/**************************************************************************//**
+\brief Checks whether the ring survived the last reset and the snapshot
+  has not been saved to non-volatile memory yet.
+
+\return true if the snapshot shall be stored, false - otherwise
+******************************************************************************/
+bool SYS_FlightRecorderIsSnapshotPending(void);
+
+/**************************************************************************//**
+\brief Marks the snapshot as saved to non-volatile memory.
+******************************************************************************/
+void SYS_FlightRecorderSnapshotSaved(void);
+
+/******************************************************************************
+                   External variables section
+******************************************************************************/
+/* Copy of the ring taken at boot. Backed by SYS_FLIGHT_RECORDER_MEM_ID PDS file. */
+extern SYS_FlightRecorder_t sysFlightRecorderSnapshot;
+#endif /* _SYS_FLIGHT_RECORDER_ON_ */
+
+#endif /* _SYS_FLIGHT_RECORDER_H_ */
+// eof sysFlightRecorder.h
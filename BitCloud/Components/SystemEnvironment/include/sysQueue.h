@@ -88,5 +88,89 @@ bool putQueueElem(QueueDescriptor_t *queue, void *element);
 void *deleteHeadQueueElem(QueueDescriptor_t *queue);
 bool  deleteQueueElem(QueueDescriptor_t *queue, void *element);
 
+/***************************************************************************
+  Fast queue. Keeps the tail pointer and the queue an element belongs to,
+  so put, head removal and membership check take constant time. Removal of
+  an arbitrary element takes constant time if the queue is doubly linked.
+  Elements should be zero-initialized before the first put and should have
+  the FastQueueElement_t as first field.
+****************************************************************************/
+#ifndef SYS_FAST_QUEUE_DOUBLY_LINKED
+  #define SYS_FAST_QUEUE_DOUBLY_LINKED 1
+#endif
+
+/***************************************************************************
+  Declare a fast queue and reset to the default state
+  Parameters:
+    queue - the name of object.
+  Returns:
+    None
+****************************************************************************/
+#define DECLARE_FAST_QUEUE(queue) FastQueueDescriptor_t queue = {.head = NULL, .tail = NULL}
+
+struct _FastQueueDescriptor_t;
+
+// Type of fast queue element
+typedef struct _FastQueueElement_t
+{
+  struct _FastQueueElement_t *next;
+#if SYS_FAST_QUEUE_DOUBLY_LINKED == 1
+  struct _FastQueueElement_t *prev;
+#endif
+  // Queue the element belongs to, NULL if the element is not queued
+  const struct _FastQueueDescriptor_t *queue;
+} FastQueueElement_t;
+
+// Fast queue descriptor
+typedef struct _FastQueueDescriptor_t
+{
+  FastQueueElement_t *head;
+  FastQueueElement_t *tail;
+} FastQueueDescriptor_t;
+
+/***************************************************************************
+  Get a element from a fast queue. Element is got from the head
+  Parameters:
+    queue - pointer to a queue descriptor
+  Returns:
+    Head element, NULL if the queue is empty
+****************************************************************************/
+INLINE void *getFastQueueElem(const FastQueueDescriptor_t *queue)
+{
+  return queue->head;
+}
+
+/***************************************************************************
+  Get next element of fast queue after current element.
+  Parameters:
+    currElement - current element
+  Returns:
+    NULL     - no next element
+    NOT NULL - next element is got
+****************************************************************************/
+INLINE void* getNextFastQueueElem(const void *currElem)
+{
+  return currElem? ((const FastQueueElement_t*) currElem)->next: NULL;
+}
+
+/***************************************************************************
+  Check if element is a member of specified fast queue.
+  Parameters:
+    queue - pointer to a queue descriptor
+    element - pointer to an element
+  Returns:
+    True - if element is a queue member, false - otherwise.
+****************************************************************************/
+INLINE bool isFastQueueElem(const FastQueueDescriptor_t *const queue, const void *const element)
+{
+  return queue == ((const FastQueueElement_t*) element)->queue;
+}
+
+void resetFastQueue(FastQueueDescriptor_t *queue);
+bool putFastQueueElem(FastQueueDescriptor_t *queue, void *element);
+bool putHeadFastQueueElem(FastQueueDescriptor_t *queue, void *element);
+void *deleteHeadFastQueueElem(FastQueueDescriptor_t *queue);
+bool  deleteFastQueueElem(FastQueueDescriptor_t *queue, void *element);
+
 #endif
 //eof sysQueue.h
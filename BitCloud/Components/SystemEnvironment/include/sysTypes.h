@@ -294,6 +294,16 @@ END_PACK
 #define COMPILER_WORD_ALIGNED         COMPILER_PRAGMA(data_alignment = 4)
 #endif
 
+/**
+ * \brief Place variable to the RAM area which is not cleared by the startup
+ *        code, so its content survives a warm reset.
+ */
+#if (defined __GNUC__) || defined(__CC_ARM)
+#define SYS_NOINIT                    __attribute__((section(".noinit")))
+#elif (defined __ICCARM__) || (defined __ICCAVR__)
+#define SYS_NOINIT                    __no_init
+#endif
+
 #endif
 // eof sysTypes.h
 
@@ -26,6 +26,7 @@
                           Includes section.
 **********************************************************************************/
 #include <dbg.h>
+#include <sysFlightRecorder.h>
 #ifdef _SYS_LOG_ON_
   #if defined(_HAL_LOG_INTERFACE_UART0_) || defined(_HAL_LOG_INTERFACE_UART1_)
     #include <usart.h>
@@ -168,6 +169,10 @@
   *********************************************************************************/
   void sysAssert(bool condition, uint16_t dbgCode)
   {
+  #ifdef _SYS_FLIGHT_RECORDER_ON_
+    if (!condition)
+      SYS_FlightRecorderRecord(SYS_FLIGHT_RECORD_ASSERT, dbgCode, 0U);
+  #endif
     SYS_ASSERT(condition, dbgCode)
   }
 #endif  // _SYS_ASSERT_ON_
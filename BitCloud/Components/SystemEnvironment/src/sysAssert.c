@@ -22,6 +22,7 @@
  ******************************************************************************/
 #include <sysTypes.h>
 #include <sysAssert.h>
+#include <sysFlightRecorder.h>
 #ifndef MAP_ALL_ASSERT_LEVEL_TO_SYSASSERT
 /******************************************************************************
                               Definitions section
@@ -29,6 +30,12 @@
 
 void SYS_AssertSubscribe(SYS_AssertCallback_t pCallback);
 
+#ifdef USE_DBGCODE
+  #define RECORD_ASSERT() SYS_FLIGHT_RECORD(SYS_FLIGHT_RECORD_ASSERT, gAssertParam.dbgCode, (uint8_t)gAssertParam.level)
+#else
+  #define RECORD_ASSERT() SYS_FLIGHT_RECORD(SYS_FLIGHT_RECORD_ASSERT, 0U, (uint8_t)gAssertParam.level)
+#endif
+
 /******************************************************************************
                               Global variable section
  ******************************************************************************/
@@ -87,6 +94,7 @@ void SYS_DefAssertCallbackWarn()
 #ifdef USE_FILENAME
   gAssertParam.file = gAssertFile;
 #endif
+  RECORD_ASSERT()
 
   if ( NULL != s_pAssertSubscriber ) 
     s_pAssertSubscriber(&gAssertParam); 
@@ -114,6 +122,7 @@ void SYS_DefAssertCallbackError()
 #ifdef USE_FILENAME
   gAssertParam.file = gAssertFile;
 #endif
+  RECORD_ASSERT()
 
   if ( NULL !=  s_pAssertSubscriber  ) 
     s_pAssertSubscriber(&gAssertParam); 
@@ -141,6 +150,7 @@ void SYS_DefAssertCallbackFatal()
 #ifdef USE_FILENAME
   gAssertParam.file = gAssertFile;
 #endif
+  RECORD_ASSERT()
 
   if ( NULL != s_pAssertSubscriber ) 
     s_pAssertSubscriber(&gAssertParam); 
@@ -22,6 +22,7 @@
 #include <sysDbg.h>
 #include <sysEvents.h>
 #include <sysAssert.h>
+#include <sysFlightRecorder.h>
 
 /******************************************************************************
                     Static variables section
@@ -131,6 +132,12 @@ void SYS_PostEvent(SYS_EventId_t id, SYS_EventData_t data)
   if (!(subscribed[pos] & mask))  // There is no one listening
     return;
 
+#ifdef _SYS_FLIGHT_RECORDER_ON_
+  // Task processing is already recorded on dispatch
+  if (SYS_EVENT_TASK_PROCESSED != id)
+    SYS_FlightRecorderRecord(SYS_FLIGHT_RECORD_EVENT, id, (uint8_t)data);
+#endif
+
   for (const SYS_EventReceiver_t *hnd = getQueueElem(&eventReceivers); hnd; hnd = getNextQueueElem(hnd))
   {
     if (hnd->service.evmask[pos] & mask)
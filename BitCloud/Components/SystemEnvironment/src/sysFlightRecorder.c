@@ -0,0 +1,147 @@
+/**************************************************************************//**
+  \file  sysFlightRecorder.c
+
+  \brief Implementation of the system flight recorder.
+
+  \author
+      Atmel Corporation: http://www.atmel.com \n
+      Support email: avr@atmel.com
+
+    Copyright (c) 2008-2015, Atmel Corporation. All rights reserved.
+    Licensed under Atmel's Limited License Agreement (BitCloudTM).
+
+  \internal
+    History:
+     19/10/26 - Created
+ ******************************************************************************/
+#ifdef _SYS_FLIGHT_RECORDER_ON_
+/******************************************************************************
+                   Includes section
+******************************************************************************/
+#include <sysFlightRecorder.h>
+#include <dbg.h>
+#include <atomic.h>
+#include <appTimer.h>
+#include <resetReason.h>
+
+/******************************************************************************
+                   Define(s) section
+******************************************************************************/
+#define SYS_FLIGHT_RECORDER_MAGIC     0x46524543UL
+#define SYS_FLIGHT_RECORDER_MASK      (SYS_FLIGHT_RECORDER_SIZE - 1U)
+
+/******************************************************************************
+                   Global variables section
+******************************************************************************/
+SYS_FlightRecorder_t sysFlightRecorderSnapshot;
+
+/******************************************************************************
+                   Static variables section
+******************************************************************************/
+/* Live ring. Is not initialized by the startup code to survive warm reset. */
+static SYS_NOINIT SYS_FlightRecorder_t sysFlightRecorder;
+static bool snapshotPending = false;
+
+/******************************************************************************
+                   Implementations section
+******************************************************************************/
+/**************************************************************************//**
+\brief Validates the ring after reset. If the ring survived the reset its
+  content is copied to the snapshot, otherwise the ring is cleared.
+******************************************************************************/
+void SYS_FlightRecorderInit(void)
+{
+  assert_static(0U == (SYS_FLIGHT_RECORDER_SIZE & SYS_FLIGHT_RECORDER_MASK));
+
+  if ((SYS_FLIGHT_RECORDER_MAGIC == sysFlightRecorder.magic) &&
+      (sysFlightRecorder.head < SYS_FLIGHT_RECORDER_SIZE) &&
+      (sysFlightRecorder.count <= SYS_FLIGHT_RECORDER_SIZE))
+  {
+    memcpy(&sysFlightRecorderSnapshot, &sysFlightRecorder, sizeof(SYS_FlightRecorder_t));
+    snapshotPending = (sysFlightRecorder.count > 0U);
+    sysFlightRecorder.bootCount++;
+  }
+  else
+  {
+    memset(&sysFlightRecorder, 0U, sizeof(SYS_FlightRecorder_t));
+    sysFlightRecorder.magic = SYS_FLIGHT_RECORDER_MAGIC;
+  }
+
+  SYS_FlightRecorderRecord(SYS_FLIGHT_RECORD_BOOT, (uint16_t)HAL_ReadResetReason(),
+    (uint8_t)sysFlightRecorder.bootCount);
+}
+
+/**************************************************************************//**
+\brief Puts a record to the ring.
+
+\param[in] type - record type
+\param[in] arg  - type specific argument
+\param[in] aux  - type specific auxiliary byte
+******************************************************************************/
+void SYS_FlightRecorderRecord(SYS_FlightRecordType_t type, uint16_t arg, uint8_t aux)
+{
+  uint32_t timestamp = (uint32_t)HAL_GetSystemTime();
+  SYS_FlightRecord_t *record;
+
+  ATOMIC_SECTION_ENTER
+    record = &sysFlightRecorder.records[sysFlightRecorder.head];
+    sysFlightRecorder.head = (sysFlightRecorder.head + 1U) & SYS_FLIGHT_RECORDER_MASK;
+    if (sysFlightRecorder.count < SYS_FLIGHT_RECORDER_SIZE)
+      sysFlightRecorder.count++;
+
+    record->timestamp = timestamp;
+    record->arg = arg;
+    record->type = type;
+    record->aux = aux;
+  ATOMIC_SECTION_LEAVE
+}
+
+/**************************************************************************//**
+\brief Reads a record from the live ring or from the snapshot of the ring
+  taken at boot. Records are indexed from the oldest to the newest one.
+
+\param[in] snapshot - true to read the snapshot, false to read the live ring
+\param[in] index    - record index
+\param[out] record  - buffer for the record
+
+\return true if record exists, false - otherwise
+******************************************************************************/
+bool SYS_FlightRecorderGetRecord(bool snapshot, uint16_t index, SYS_FlightRecord_t *record)
+{
+  const SYS_FlightRecorder_t *ring = snapshot ? &sysFlightRecorderSnapshot : &sysFlightRecorder;
+  uint16_t slot;
+
+  if ((SYS_FLIGHT_RECORDER_MAGIC != ring->magic) ||
+      (ring->count > SYS_FLIGHT_RECORDER_SIZE) || (index >= ring->count))
+    return false;
+
+  slot = (ring->head - ring->count + index) & SYS_FLIGHT_RECORDER_MASK;
+
+  ATOMIC_SECTION_ENTER
+    *record = ring->records[slot];
+  ATOMIC_SECTION_LEAVE
+
+  return true;
+}
+
+/**************************************************************************//**
+\brief Checks whether the ring survived the last reset and the snapshot
+  has not been saved to non-volatile memory yet.
+
+\return true if the snapshot shall be stored, false - otherwise
+******************************************************************************/
+bool SYS_FlightRecorderIsSnapshotPending(void)
+{
+  return snapshotPending;
+}
+
+/**************************************************************************//**
+\brief Marks the snapshot as saved to non-volatile memory.
+******************************************************************************/
+void SYS_FlightRecorderSnapshotSaved(void)
+{
+  snapshotPending = false;
+}
+
+#endif /* _SYS_FLIGHT_RECORDER_ON_ */
+// eof sysFlightRecorder.c
@@ -29,23 +29,26 @@
 ****************************************************************************/
 bool putQueueElem(QueueDescriptor_t *queue, void *element)
 {
+  QueueElement_t *last = queue->head;
 
-  if (isQueueElem(queue, element))
+  /* Look for the tail and check for double put within the same pass */
+  if (last)
   {
-    SYS_E_ASSERT_ERROR(false, SYS_ASSERT_ID_DOUBLE_QUEUE_PUT);
-    return false;
+    while (last != element && last->next)
+      last = last->next;
+
+    if (last == element)
+    {
+      SYS_E_ASSERT_ERROR(false, SYS_ASSERT_ID_DOUBLE_QUEUE_PUT);
+      return false;
+    }
   }
 
   ((QueueElement_t*)element)->next = NULL;
-  if(!queue->head)
+  if (!last)
     queue->head = element;
   else
-  {
-    QueueElement_t *last = queue->head;
-    while(last->next)
-      last = last->next;
     last->next = element;
-  }
 
   return true;
 }
@@ -123,4 +126,164 @@ bool isQueueElem(const QueueDescriptor_t *const queue, const void *const element
   return false;
 }
 
+/***************************************************************************
+  Reset a fast queue. Elements of the queue are marked as not queued
+  Parameters:
+    queue - pointer to a queue descriptor
+  Returns:
+    None
+****************************************************************************/
+void resetFastQueue(FastQueueDescriptor_t *queue)
+{
+  FastQueueElement_t *it = queue->head;
+
+  while (it)
+  {
+    FastQueueElement_t *next = it->next;
+
+    it->next = NULL;
+    it->queue = NULL;
+    it = next;
+  }
+
+  queue->head = NULL;
+  queue->tail = NULL;
+}
+
+/***************************************************************************
+  Put a element to a fast queue. Element is added to the tail
+  Parameters:
+    queue   - pointer to a queue descriptor
+    element - pointer to new element
+  Returns:
+    True - succesfully queued, False - element is already queued
+****************************************************************************/
+bool putFastQueueElem(FastQueueDescriptor_t *queue, void *element)
+{
+  FastQueueElement_t *elem = element;
+
+  if (elem->queue)
+  {
+    SYS_E_ASSERT_ERROR(false, SYS_ASSERT_ID_DOUBLE_QUEUE_PUT);
+    return false;
+  }
+
+  elem->next = NULL;
+#if SYS_FAST_QUEUE_DOUBLY_LINKED == 1
+  elem->prev = queue->tail;
+#endif
+  elem->queue = queue;
+
+  if (queue->tail)
+    queue->tail->next = elem;
+  else
+    queue->head = elem;
+  queue->tail = elem;
+
+  return true;
+}
+
+/***************************************************************************
+  Put a element to a fast queue. Element is added to the head
+  Parameters:
+    queue   - pointer to a queue descriptor
+    element - pointer to new element
+  Returns:
+    True - succesfully queued, False - element is already queued
+****************************************************************************/
+bool putHeadFastQueueElem(FastQueueDescriptor_t *queue, void *element)
+{
+  FastQueueElement_t *elem = element;
+
+  if (elem->queue)
+  {
+    SYS_E_ASSERT_ERROR(false, SYS_ASSERT_ID_DOUBLE_QUEUE_PUT);
+    return false;
+  }
+
+  elem->next = queue->head;
+#if SYS_FAST_QUEUE_DOUBLY_LINKED == 1
+  elem->prev = NULL;
+  if (queue->head)
+    queue->head->prev = elem;
+#endif
+  elem->queue = queue;
+
+  if (!queue->tail)
+    queue->tail = elem;
+  queue->head = elem;
+
+  return true;
+}
+
+/***************************************************************************
+  Delete a head element from a fast queue
+  Parameters:
+    queue - pointer to a queue descriptor
+  Returns:
+    Deleted element, NULL if the queue is empty
+****************************************************************************/
+void* deleteHeadFastQueueElem(FastQueueDescriptor_t *queue)
+{
+  FastQueueElement_t *elem = queue->head;
+
+  if (!elem)
+    return NULL;
+
+  queue->head = elem->next;
+  if (queue->head)
+  {
+#if SYS_FAST_QUEUE_DOUBLY_LINKED == 1
+    queue->head->prev = NULL;
+#endif
+  }
+  else
+    queue->tail = NULL;
+
+  elem->next = NULL;
+  elem->queue = NULL;
+  return elem;
+}
+
+/***************************************************************************
+  Delete the certain element of a fast queue.
+  Parameters:
+    element - element to be deleted
+    queue   - pointer to a queue descriptor
+  Returns:
+    true if element was removed otherwise false
+****************************************************************************/
+bool deleteFastQueueElem(FastQueueDescriptor_t *queue, void *element)
+{
+  FastQueueElement_t *elem = element;
+  FastQueueElement_t *prev;
+
+  if (!elem || queue != elem->queue)
+    return false;
+
+#if SYS_FAST_QUEUE_DOUBLY_LINKED == 1
+  prev = elem->prev;
+  if (elem->next)
+    elem->next->prev = prev;
+#else
+  if (queue->head == elem)
+    prev = NULL;
+  else
+    for (prev = queue->head; prev->next != elem; prev = prev->next)
+    {}
+#endif
+
+  if (prev)
+    prev->next = elem->next;
+  else
+    queue->head = elem->next;
+
+  if (queue->tail == elem)
+    queue->tail = prev;
+
+  elem->next = NULL;
+  elem->queue = NULL;
+  return true;
+}
+
 //eof sysQueue.c
@@ -23,6 +23,7 @@
 #include <sysEvents.h>
 #include <sysIdleHandler.h>
 #include <sysAssert.h>
+#include <sysFlightRecorder.h>
 
 #if defined(_USE_KF_MAC_)
 #include <mac_api.h>
@@ -175,6 +176,10 @@ SYS_InitStatus_t SYS_SysInit(void)
 
 #endif // defined(_USE_KF_MAC_)
 
+#ifdef _SYS_FLIGHT_RECORDER_ON_
+  SYS_FlightRecorderInit(); // It must be after HAL_Init()
+#endif
+
 #if defined(_SYS_ZDO_TASK_) && !defined(ZAPPSI_HOST)
   SYS_PostTask(ZDO_TASK_ID); // ZDO task must be started first to initialize the stack
 #elif defined(ZAPPSI_HOST)
@@ -258,6 +263,7 @@ static void processManagerTask(void)
       ATOMIC_SECTION_LEAVE
 
       SYS_E_ASSERT_FATAL(taskHandlers[taskId], SYS_TASKHANDLER_NULLCALLBACK0);
+      SYS_FLIGHT_RECORD(SYS_FLIGHT_RECORD_TASK, taskId, 0U)
       taskHandlers[taskId]();
 
       break;
@@ -52,7 +52,7 @@ typedef struct _ZsiDriver_t
   uint8_t            sequenceNumber;
   QueueDescriptor_t  bearingEntities;
   QueueDescriptor_t  postponedAreqs;
-  QueueDescriptor_t  commandsToReceive;
+  FastQueueDescriptor_t commandsToReceive;
   QueueDescriptor_t  completedAreqs;
   ZsiCommandFrame_t  *srsp;
 } ZsiDriver_t;
@@ -57,7 +57,7 @@
 ******************************************************************************/
 typedef struct _ZsiMemoryBuffer_t
 {
-  QueueElement_t next;
+  FastQueueElement_t next;
   bool busy;
   TOP_GUARD
   union
@@ -86,7 +86,7 @@ typedef struct _ZsiSerialController_t
   HAL_AppTimer_t              ackWaitTimer;
   HAL_AppTimer_t              overflowTimer;
   ZsiSerialSynchroModeTimer_t synchroModeTimer;
-  QueueDescriptor_t           txQueue;
+  FastQueueDescriptor_t       txQueue;
 } ZsiSerialController_t;
 
 /******************************************************************************
@@ -47,6 +47,8 @@
   }
   #define WRITE_ZAPPSI_INTERFACE           HAL_WriteUsart
   #define READ_ZAPPSI_INTERFACE            HAL_ReadUsart
+  #define GET_ZAPPSI_INTERFACE_RX_SPAN     HAL_GetUsartRxSpan
+  #define RELEASE_ZAPPSI_INTERFACE_RX_SPAN HAL_ReleaseUsartRxSpan
   #define ZAPPSI_INTERFACE_TASK            HAL_TASK_USART
   #define HOLD_ADDITIONAL_ZAPPSI_INTERFACE_TASKS(TTY)  HAL_HoldOnOthersUsartTasks(TTY)
   #define RELEASE_ADDITIONAL_ZAPPSI_INTERFACE_TASKS()  HAL_ReleaseAllHeldUsartTasks()
@@ -81,7 +81,7 @@ void zsiResetDriver(void)
 
   resetQueue(&(zsiDriver()->bearingEntities));
   resetQueue(&(zsiDriver()->postponedAreqs));
-  resetQueue(&(zsiDriver()->commandsToReceive));
+  resetFastQueue(&(zsiDriver()->commandsToReceive));
   resetQueue(&(zsiDriver()->completedAreqs));
   zsiDriver()->state = ZSI_DRIVER_STATE_IDLE;
 }
@@ -101,7 +101,7 @@ void zsiDriverTaskHandler(void)
       uint8_t *memory = NULL;
 
       /* Process AREQs received from remote device with highest priority */
-      if ((NULL != (buffer = getQueueElem(&zsiDriver()->commandsToReceive))) &&
+      if ((NULL != (buffer = getFastQueueElem(&zsiDriver()->commandsToReceive))) &&
           ZSI_ACK_TX_QUANTITY(ackTxState))
       {
         ZSI_ACK_TX_COUNT_DOWN(ackTxState);
@@ -121,7 +121,7 @@ void zsiDriverTaskHandler(void)
 
         if (memory)
         {
-          deleteHeadQueueElem(&zsiDriver()->commandsToReceive);
+          deleteHeadFastQueueElem(&zsiDriver()->commandsToReceive);
           zsiDriverReceiveCommand(memory, &buffer->commandFrame);
         }
 
@@ -155,7 +155,7 @@ void zsiDriverTaskHandler(void)
       /* Post task if any AREQ is still pending and required memory is available */
       if (getQueueElem(&zsiDriver()->completedAreqs) ||
           (zsiIsMemoryAvailable() &&
-           (getQueueElem(&zsiDriver()->commandsToReceive) ||
+           (getFastQueueElem(&zsiDriver()->commandsToReceive) ||
             getQueueElem(&zsiDriver()->postponedAreqs))))
       {
         zsiPostTask(ZSI_DRIVER_TASK_ID);
@@ -169,19 +169,19 @@ void zsiDriverTaskHandler(void)
         ZsiMemoryBuffer_t *srspBuffer = NULL;
         uint8_t queueSize = 0;
 
-        curBuffer = getQueueElem(&zsiDriver()->commandsToReceive);
+        curBuffer = getFastQueueElem(&zsiDriver()->commandsToReceive);
         while (curBuffer)
         {
           queueSize++;
           if (IS_SRSP_CMD_FRAME(&curBuffer->commandFrame))
             srspBuffer = curBuffer;
-          curBuffer = getNextQueueElem(curBuffer);
+          curBuffer = getNextFastQueueElem(curBuffer);
         }
 
         if ((queueSize == ZSI_ACK_TX_QUANTITY(ackTxState)) && srspBuffer)
         {
           ZSI_ACK_TX_COUNT_DOWN(ackTxState);
-          deleteQueueElem(&zsiDriver()->commandsToReceive, srspBuffer);
+          deleteFastQueueElem(&zsiDriver()->commandsToReceive, srspBuffer);
           zsiSrspReceived(&srspBuffer->commandFrame);
         }
         zsiPostTask(ZSI_DRIVER_TASK_ID);
@@ -396,7 +396,7 @@ void zsiDriverStoreRxCmd(const ZsiCommandFrame_t *const cmdFrame)
 {
   ZsiMemoryBuffer_t *buffer = GET_PARENT_BY_FIELD(ZsiMemoryBuffer_t,
     commandFrame, cmdFrame);
-  putQueueElem(&zsiDriver()->commandsToReceive, buffer);
+  putFastQueueElem(&zsiDriver()->commandsToReceive, buffer);
 }
 
 /******************************************************************************
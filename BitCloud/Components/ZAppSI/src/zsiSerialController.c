@@ -198,10 +198,10 @@ void zsiSerialTaskHandler(void)
       ZsiMemoryBuffer_t *buffer;
 
       /* Process frames to transmit with highest priority */
-      if (NULL != (buffer = getQueueElem(&zsiSerial()->txQueue)))
+      if (NULL != (buffer = getFastQueueElem(&zsiSerial()->txQueue)))
         if (!zsiSerialIsBusy())
         {
-          deleteHeadQueueElem(&zsiSerial()->txQueue);
+          deleteHeadFastQueueElem(&zsiSerial()->txQueue);
           zsiSerialSend(&buffer->commandFrame);
         }
     }
@@ -239,7 +239,7 @@ void zsiSerialTaskHandler(void)
   }
 
   /* Post task if any command is still pending */
-  if (getQueueElem(&zsiSerial()->txQueue))
+  if (getFastQueueElem(&zsiSerial()->txQueue))
     zsiPostTask(ZSI_SERIAL_TASK_ID);
 }
 
@@ -556,17 +556,12 @@ void zsiSerialStoreTxCmd(const ZsiCommandFrame_t *const cmdFrame)
 {
   ZsiMemoryBuffer_t *buffer = GET_PARENT_BY_FIELD(ZsiMemoryBuffer_t,
     commandFrame, cmdFrame);
-  ZsiMemoryBuffer_t *topElement = getQueueElem(&zsiSerial()->txQueue);
 
   /* SRSP frames should be transmitted first */
-  if (IS_SRSP_CMD_FRAME(cmdFrame) && topElement)
-  {
-    zsiSerial()->txQueue.head = NULL;
-    putQueueElem(&zsiSerial()->txQueue, buffer);
-    putQueueElem(&zsiSerial()->txQueue, topElement);
-  }
+  if (IS_SRSP_CMD_FRAME(cmdFrame))
+    putHeadFastQueueElem(&zsiSerial()->txQueue, buffer);
   else
-    putQueueElem(&zsiSerial()->txQueue, buffer);
+    putFastQueueElem(&zsiSerial()->txQueue, buffer);
 
   zsiPostTask(ZSI_SERIAL_TASK_ID);
 }
@@ -62,6 +62,7 @@ void zsiMediumHandler(void);
                               Static functions prototypes section
 ******************************************************************************/
 static void zsiUsartRxCallback(uint16_t bytesAmount);
+static void zsiUsartRxIdleCallback(uint16_t bytesAmount);
 static void zsiUsartLinkSafetyTimerFired(void);
 
 /******************************************************************************
@@ -112,6 +113,7 @@ int zsiMediumInit(void)
   zsiUsartDescriptor.txBuffer       = NULL;
   zsiUsartDescriptor.txBufferLength = 0U;
   zsiUsartDescriptor.rxCallback     = zsiUsartRxCallback;
+  zsiUsartDescriptor.rxIdleCallback = zsiUsartRxIdleCallback;
   zsiUsartDescriptor.txCallback     = zsiMediumSendingDone;
   return OPEN_ZAPPSI_INTERFACE(&zsiUsartDescriptor);
 }
@@ -133,6 +135,30 @@ static void zsiUsartLinkSafetyTimerFired(void)
   rxState = ZSI_USART_WAITING_SOF_STATE;
 }
 
+/******************************************************************************
+  \brief Receiver idle callback. A frame is sent without gaps, so idle line in
+         the middle of a frame means the rest of it is lost. The partial frame
+         is dropped and receiver waits for the next SOF.
+
+  \param[in] bytesAmount - amount of received bytes not read yet.
+
+  \return None.
+ ******************************************************************************/
+static void zsiUsartRxIdleCallback(uint16_t bytesAmount)
+{
+  /* Unread bytes are processed by rx callback first */
+  if (bytesAmount || (ZSI_USART_WAITING_SOF_STATE == rxState))
+    return;
+
+  HAL_StopAppTimer(&usartLinkSafetyTimer);
+  if (rxBuffer)
+  {
+    zsiFreeMemory(rxBuffer);
+  }
+  poW = rxBuffer = NULL;
+  rxState = ZSI_USART_WAITING_SOF_STATE;
+}
+
 /******************************************************************************
   \brief Pass data for transmission through medium.
 
@@ -305,9 +331,15 @@ static void zsiUsartRxCallback(uint16_t bytesAmount)
 
       /* Pass the rest of the data to the buffer, if allocated */
       case ZSI_USART_RECEIVING_DATA_STATE:
-        if (bytesToReceive--)
+        if (bytesToReceive)
         {
-          if (READ_ZAPPSI_INTERFACE(&zsiUsartDescriptor, &byte, sizeof(byte)) <= 0)
+          uint16_t chunk = MIN(bytesToReceive, bytesAmount);
+#ifdef GET_ZAPPSI_INTERFACE_RX_SPAN
+          /* Take received data directly from the medium buffer */
+          uint8_t *span;
+
+          chunk = MIN(chunk, GET_ZAPPSI_INTERFACE_RX_SPAN(&zsiUsartDescriptor, &span));
+          if (0U == chunk)
           {
             rxState = ZSI_USART_ERROR_STATE;
             return;
@@ -315,9 +347,31 @@ static void zsiUsartRxCallback(uint16_t bytesAmount)
 
           if (rxBuffer)
           {
-            *poW++ = byte;
+            memcpy(poW, span, chunk);
+            poW += chunk;
+          }
+          RELEASE_ZAPPSI_INTERFACE_RX_SPAN(&zsiUsartDescriptor, chunk);
+#else
+          int wasRead;
+
+          if (rxBuffer)
+          {
+            wasRead = READ_ZAPPSI_INTERFACE(&zsiUsartDescriptor, poW, chunk);
+            if (wasRead > 0)
+              poW += wasRead;
+          }
+          else
+            wasRead = READ_ZAPPSI_INTERFACE(&zsiUsartDescriptor, &byte, sizeof(byte));
+
+          if (wasRead <= 0)
+          {
+            rxState = ZSI_USART_ERROR_STATE;
+            return;
           }
-          bytesAmount--;
+          chunk = wasRead;
+#endif
+          bytesToReceive -= chunk;
+          bytesAmount -= chunk;
         }
         /* Frame completely received - notify serial controller */
         if (0U == bytesToReceive)
@@ -40,6 +40,15 @@
 #define MCE_ERR_NULL_EPHEM_PUB_KEY 0x08
 #define MCE_ERR_BAD_INPUT          0x09
 
+//! Returned by ZSE_ECCContinue() while the operation is not finished
+#define ZSE_ECC_IN_PROGRESS        0x80
+
+//! 1 if the ECC backend executes operations in slices natively. Otherwise
+//! an operation is executed by the monolithic call within the first slice.
+#ifndef ZSE_ECC_RESUMABLE
+#define ZSE_ECC_RESUMABLE          0
+#endif
+
 /*******************************************************************************
                    Prototypes section
 *******************************************************************************/
@@ -47,6 +56,31 @@ typedef int GetRandomDataFunc(unsigned char *buffer, unsigned long sz);
 typedef int HashFunc(unsigned char *digest, unsigned long sz, unsigned char *data);
 typedef int YieldFunc(void);
 
+/** Resumable ECC operation identifiers */
+typedef enum
+{
+  ZSE_ECC_NO_OPERATION,
+  ZSE_ECC_GENERATE_KEY_OPERATION,
+  ZSE_ECC_KEY_BIT_GENERATE_OPERATION
+} ZSE_EccOperation_t;
+
+/** Progress of a resumable ECC operation. Shall not be modified by the user
+    between ZSE_ECC...Start() and the end of the operation. */
+typedef struct
+{
+  unsigned char      operation;     //!< One of ZSE_EccOperation_t values
+  unsigned long      fieldOpsDone;  //!< Field operations executed so far
+  unsigned char      *privateKey;
+  unsigned char      *ephemeralPrivateKey;
+  unsigned char      *ephemeralPublicKey;
+  unsigned char      *remoteCertificate;
+  unsigned char      *remoteEphemeralPublicKey;
+  unsigned char      *caPublicKey;
+  unsigned char      *output;       //!< Generated public key or key bits
+  GetRandomDataFunc  *GetRandomData;
+  HashFunc           *Hash;
+} ZSE_EccContext_t;
+
 int ZSE_ECDSASign(unsigned char *privateKey,
                   unsigned char *msgDigest,
                   GetRandomDataFunc *GetRandomData,
@@ -85,5 +119,52 @@ int ZSE_ECQVReconstructPublicKey(unsigned char* certificate,
                                  HashFunc *Hash,
                                  YieldFunc *yield,
                                  unsigned long yieldLevel);
+
+/**************************************************************************//**
+\brief Starts resumable generation of an ephemeral key pair. See
+       ZSE_ECCGenerateKey() for parameters.
+
+\param[in] ctx Operation context.
+
+\return MCE_SUCCESS if the operation is started, error code of
+        ZSE_ECCGenerateKey() otherwise.
+******************************************************************************/
+int ZSE_ECCGenerateKeyStart(ZSE_EccContext_t *ctx,
+                            unsigned char *privateKey,
+                            unsigned char *publicKey,
+                            GetRandomDataFunc *GetRandomData);
+
+/**************************************************************************//**
+\brief Starts resumable derivation of a shared secret using the ECMQV
+       algorithm. See ZSE_ECCKeyBitGenerate() for parameters.
+
+\param[in] ctx Operation context.
+
+\return MCE_SUCCESS if the operation is started, error code of
+        ZSE_ECCKeyBitGenerate() otherwise.
+******************************************************************************/
+int ZSE_ECCKeyBitGenerateStart(ZSE_EccContext_t *ctx,
+                               unsigned char *privateKey,
+                               unsigned char *ephemeralPrivateKey,
+                               unsigned char *ephemeralPublicKey,
+                               unsigned char *remoteCertificate,
+                               unsigned char *remoteEphemeralPublicKey,
+                               unsigned char *caPublicKey,
+                               unsigned char *keyBits,
+                               HashFunc *Hash);
+
+/**************************************************************************//**
+\brief Continues the started operation. Executes at most fieldOps field
+       operations and returns, so the caller is able to give control back
+       to the scheduler between the calls.
+
+\param[in] ctx      Operation context.
+\param[in] fieldOps Maximum amount of field operations to be executed.
+
+\return ZSE_ECC_IN_PROGRESS if the operation is not finished,
+        result of the operation otherwise.
+******************************************************************************/
+int ZSE_ECCContinue(ZSE_EccContext_t *ctx, unsigned long fieldOps);
+
 #endif //_GENERICECC_H
 // eof genericEcc.h
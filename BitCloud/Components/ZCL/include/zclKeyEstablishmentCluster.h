@@ -65,6 +65,18 @@ ZigBee devices.
 #define ZCL_KE_TIMEOUT                                50
 #endif
 
+//!Amount of Key Establishment sessions run simultaneously. Trust center serves
+//!a session per device being commissioned, other devices need a single one.
+#ifndef ZCL_KE_MAX_SESSIONS
+#define ZCL_KE_MAX_SESSIONS                           1
+#endif
+
+//!Amount of ECC field operations Key Establishment executes within a single task.
+//!Lower values reduce the time other tasks wait, higher ones speed up KE.
+#ifndef ZCL_KE_ECC_FIELD_OPS_PER_SLICE
+#define ZCL_KE_ECC_FIELD_OPS_PER_SLICE                16
+#endif
+
 #define ZCL_KE_INITIATE_RANDOM_SEQ_SIZE               16 // 16 bytes
 
 /***************************************************************************//**
@@ -115,6 +115,13 @@ extern uint32_t __d_nv_mem_end;
 /* frequency of write(in bytes) = total-file-size/OTAU_NUM_OF_PDS_WRITES */
 #define OTAU_NUM_OF_PDS_WRITES               20
 
+/* On resume the external flash is verified up to the end of the last page of
+   this size completed before the checkpoint. Shall be a power of two and a
+   multiple of OFD_BLOCK_FOR_CHECK_CRC. */
+#ifndef OTAU_CHECKPOINT_PAGE_SIZE
+  #define OTAU_CHECKPOINT_PAGE_SIZE          256ul
+#endif
+
 #define REPOST_OFD_ACTION                    10ul
 #define AMOUNT_MSEC_IN_SEC                   1000ul
 #define WAIT_FOR_RUN_UPGRADE_REQ             0xFF
@@ -133,21 +140,30 @@ extern uint32_t __d_nv_mem_end;
 #define IS_IMGNTFY_PENDING(server)           (server.busy)
 
 #define OTAU_IMGFILES_MEMORY_MEM_ID          OTAU_DIR1_MEM_ID
-#define OTAU_AUXFILES_MEMORY_MEM_ID          OTAU_DIR2_MEM_ID
 #define OTAU_OFFSETFILES_MEMORY_MEM_ID       OTAU_DIR3_MEM_ID
 #define OTAU_SERVER_EXT_ADDR_MEM_ID          OTAU_PARAM1_MEM_ID
 #define OTAU_IMAGE_VERSION_MEM_ID            OTAU_PARAM2_MEM_ID
 #define OTAU_IMAGE_SIZE_MEM_ID               OTAU_PARAM3_MEM_ID
-#define OTAU_NEXT_OFFSET_MEM_ID              OTAU_PARAM4_MEM_ID
-#define OTAU_RUNNING_CHECKSUM_MEM_ID         OTAU_PARAM5_MEM_ID
-#define OTAU_INTERNAL_LENGTH_MEM_ID          OTAU_PARAM6_MEM_ID
-#define OTAU_IMAGE_REMAINDER_MEM_ID          OTAU_PARAM7_MEM_ID
-#define OTAU_ADDRESS_STATUS_MEM_ID           OTAU_PARAM8_MEM_ID
-#define OTAU_IMAGE_WRITE_OFFSET_ID           OTAU_PARAM9_MEM_ID
+#define OTAU_CHECKPOINT_MEM_ID               OTAU_PARAM4_MEM_ID
 
 /******************************************************************************
                    Types section
 ******************************************************************************/
+/* Download state needed to resume an interrupted download, taken after
+   a completed flash write. Is stored as a single PDS file, so it is always
+   written as a whole. */
+typedef struct
+{
+  uint32_t nextOffset;
+  uint32_t internalLength;
+  uint32_t flashWriteOffset;
+  uint32_t imageRemainder;
+  uint32_t verifiedLength;    //!< end of the last completed page
+  uint8_t  internalAddrStatus;
+  uint8_t  runningChecksum;
+  uint8_t  verifiedChecksum;  //!< running checksum up to verifiedLength
+  uint8_t  crc;               //!< CRC over all the fields above
+} OtauCheckpoint_t;
 
 /******************************************************************************
                    Constants section
@@ -243,6 +259,11 @@ ZCL_Status_t upgradeEndRespInd(ZCL_Addressing_t *addressing, uint8_t payloadLeng
 // helper functions
 void otauClearPdsParams(void);
 void otauConfigureNextPdsWriteOffset(void);
+void otauResetCheckpoint(void);
+void otauSaveCheckpoint(void);
+bool otauRestoreCheckpoint(void);
+void otauResumeDownload(void);
+void otauTrackCheckpoint(const OFD_MemoryAccessParam_t *memParam);
 uint8_t otauCalcCrc(uint8_t crc, uint8_t *pcBlock, uint8_t length);
 uint8_t otauCalculateRunningChecksum(uint8_t *data);
 void otauContinueWritingImageToFlash(void);
@@ -39,6 +39,7 @@ typedef enum _ZclTaskId_t
   ZCL_SUBTASK_ID,
   ZCL_PARSER_TASK_ID,
   ZCL_SECURITY_TASK_ID,
+  ZCL_KE_TASK_ID,
   ZCL_TASKS_SIZE
 } ZclTaskId_t;
 
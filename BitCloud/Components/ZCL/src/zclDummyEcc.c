@@ -33,6 +33,11 @@
 
 #define MAX_YIELD_LEVEL 10
 
+// Cost of a point multiplication on sect163k1 in field operations, one per key bit
+#ifndef DUMMY_ECC_POINT_MULT_FIELD_OPS
+#define DUMMY_ECC_POINT_MULT_FIELD_OPS  163ul
+#endif
+
 /******************************************************************************
                             Implementation section.
 ******************************************************************************/
@@ -400,5 +405,50 @@ int ZSE_ECQVReconstructPublicKey(unsigned char* certificate,
   // Guess we should return MCE_SUCCESS if all ok (not stated in doc)
   return MCE_SUCCESS;
 }
+
+#if ZSE_ECC_RESUMABLE == 1
+/**************************************************************************//**
+\brief Continues the started operation. Counts field operations the way a real
+       implementation would spend them: one point multiplication for the key
+       pair generation and three (public key reconstruction and ECMQV) for the
+       shared secret. The result is produced by the last slice.
+
+\param[in] ctx      Operation context.
+\param[in] fieldOps Maximum amount of field operations to be executed.
+
+\return ZSE_ECC_IN_PROGRESS if the operation is not finished,
+        result of the operation otherwise.
+******************************************************************************/
+int ZSE_ECCContinue(ZSE_EccContext_t *ctx, unsigned long fieldOps)
+{
+  unsigned long total;
+
+  if (ZSE_ECC_GENERATE_KEY_OPERATION == ctx->operation)
+    total = DUMMY_ECC_POINT_MULT_FIELD_OPS;
+  else if (ZSE_ECC_KEY_BIT_GENERATE_OPERATION == ctx->operation)
+    total = 3ul * DUMMY_ECC_POINT_MULT_FIELD_OPS;
+  else
+    return MCE_ERR_BAD_INPUT;
+
+  if (total - ctx->fieldOpsDone > fieldOps)
+  {
+    ctx->fieldOpsDone += fieldOps;
+    return ZSE_ECC_IN_PROGRESS;
+  }
+
+  ctx->fieldOpsDone = total;
+  if (ZSE_ECC_GENERATE_KEY_OPERATION == ctx->operation)
+  {
+    ctx->operation = ZSE_ECC_NO_OPERATION;
+    return ZSE_ECCGenerateKey(ctx->privateKey, ctx->output, ctx->GetRandomData, NULL, 0);
+  }
+
+  ctx->operation = ZSE_ECC_NO_OPERATION;
+  return ZSE_ECCKeyBitGenerate(ctx->privateKey, ctx->ephemeralPrivateKey, ctx->ephemeralPublicKey,
+                               ctx->remoteCertificate, ctx->remoteEphemeralPublicKey, ctx->caPublicKey,
+                               ctx->output, ctx->Hash, NULL, 0);
+}
+#endif // ZSE_ECC_RESUMABLE == 1
+
 #endif // ZCL_SUPPORT == 1
 //eof zclDummyEcc.c
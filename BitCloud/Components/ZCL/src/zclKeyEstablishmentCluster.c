@@ -30,12 +30,12 @@
 #include <appTimer.h>
 #include <sysUtils.h>
 #include <zclSecurityManager.h>
+#include <zclTaskManager.h>
 #include <sysTimer.h>
 #include <sspHash.h>
 #include <zclDbg.h>
 #include <dbg.h>
 #include <genericEcc.h>
-#include <eccAux.h>
 #include <zdoNotify.h>
 #include <aps.h>
 #include <sysEvents.h>
@@ -81,13 +81,14 @@ typedef enum
 typedef enum
 {
   ZCL_KE_CLUSTER_INITIAL_STATE                        = 0x00, //There was init
-  ZCL_KE_CLUSTER_IDLE_STATE                           = 0x01, //There was reset
+  ZCL_KE_CLUSTER_IDLE_STATE                           = 0x01, //There was reset, session is free
 
   //Discovery states
   ZCL_KE_MATCH_DESCRIPTOR_DISCOVERY_SENDING_STATE     = 0x03,
   ZCL_KE_MATCH_DESCRIPTOR_DISCOVERY_TERMINATE_STATE   = 0x04,
 
   //KE procedure states
+  ZCL_KE_CLUSTER_EPHEMERAL_KEY_GENERATING_STATE       = 0x05, // Waiting for the ECC computation slot
   ZCL_KE_CLUSTER_INITIATE_KE_COMMAND_SENDING_STATE    = 0x06,
   ZCL_KE_CLUSTER_INITIATE_KE_COMMAND_WAITING_STATE    = 0x07,
   ZCL_KE_CLUSTER_EPHEMERAL_DATA_COMMAND_SENDING_STATE = 0x08,
@@ -100,8 +101,18 @@ typedef enum
   ZCL_KE_CLUSTER_CONFIRM_KEY_COMMAND_WAITING_STATE    = 0x0d,
 
   ZCL_KE_CLUSTER_WAITING_STATE                        = 0x0e, // There was termination with NO_RESOURCES
+  ZCL_KE_CLUSTER_KEY_BITS_GENERATING_STATE            = 0x0f, // Waiting for the ECC computation slot
 } ZclKEClusterState_t;
 
+/** ECC computation step a session is waiting for. Steps of all sessions are
+    executed in slices, one slice per ZCL task in round-robin order. */
+typedef enum
+{
+  ZCL_KE_ECC_NO_STEP,
+  ZCL_KE_ECC_EPHEMERAL_KEY_STEP, // Ephemeral key pair generation
+  ZCL_KE_ECC_KEY_BITS_STEP       // ECMQV shared secret, keying data and MACs
+} ZclKeEccStep_t;
+
 typedef union
 {
   ZCL_InitiateKeyEstablishmentCommand_t   initiateKE;
@@ -121,6 +132,41 @@ typedef struct PACK _ZclKeMacBuffer_t
 } ZclKeMacBuffer_t;
 END_PACK
 
+/** State of Key Establishment with a single remote device */
+typedef struct _ZclKeSession_t
+{
+  ZclKEClusterState_t state;
+  ZclKeEccStep_t      eccStep;
+  bool                srvMode;             //!< Local device is the responder
+  bool                postponedProcessing;
+  bool                reqBusy;             //!< zclReq is being processed by ZCL
+  uint8_t             seqNum;
+  ShortAddr_t         remoteShortAddr;
+  Endpoint_t          remoteEndpoint;
+  ExtAddr_t           remoteExtAddr;
+  uint16_t            remoteEphemeralDataGenerateTime;
+  uint16_t            remoteConfirmKeyGenerateTime;
+  BcTime_t            deadline;            //!< Session timer expiration time, 0 if stopped
+  void (*timeoutHandler)(struct _ZclKeSession_t *session);
+
+  ZCL_Request_t          zclReq;
+  ZCL_KECommandPayload_t commandPayload;
+
+  //For Certicom usage
+  ZSE_EccContext_t ecc;
+  unsigned char localEphemeralPrivateKey[SECT163K1_PRIVATE_KEY_SIZE];
+  unsigned char localEphemeralPublicKey[SECT163K1_COMPRESSED_PUBLIC_KEY_SIZE];
+  unsigned char remoteCertificate[SECT163K1_CERTIFICATE_SIZE];
+  unsigned char remoteEphemeralPublicKey[SECT163K1_COMPRESSED_PUBLIC_KEY_SIZE];
+  unsigned char keyBits[SECT163K1_SHARED_SECRET_SIZE];
+
+  uint8_t digest1[AES_MMO_HASH_SIZE];
+  uint8_t digest2[AES_MMO_HASH_SIZE];
+  uint8_t macvHash[AES_MMO_HASH_SIZE];
+  uint8_t macuHash[AES_MMO_HASH_SIZE];
+  uint8_t receivedMacuHash[AES_MMO_HASH_SIZE];
+} ZclKeSession_t;
+
 /******************************************************************************
                    Static functions prototype section
 ******************************************************************************/
@@ -133,18 +179,26 @@ static ZCL_Status_t confirmKeyDataCommandIndHandler(ZCL_Addressing_t *addressing
 static ZCL_Status_t terminateKECommandIndHandler(ZCL_Addressing_t *addressing,
   uint8_t payloadLength, ZCL_TerminateKeyEstablishmentCommand_t *payload);
 
-static void keMakeMatchDescReq(void);
-static void keSendInitiateKECommand(void);
-static void keSendEphemeralDataCommand(void);
-static void keSendConfirmKeyDataCommand(void);
-static void keSendTerminateKECommand(ShortAddr_t shortAddr, Endpoint_t endpoint, ZCL_TKEStatus_t status);
-
-static void keCalculateMac1(void);
-static void keCalculateMac2(void);
-static void keGenerateKey(void);
-static void keSwitchKey(void);
-static void restartKEFired(void);
-static void keSetTimeoutInSec(uint16_t timeout, void (*callback)(void));
+static void keMakeMatchDescReq(ZclKeSession_t *session);
+static void keSendCommand(ZclKeSession_t *session, ZCL_CommandId_t reqId, ZCL_CommandId_t respId,
+  uint8_t length, void (*notify)(ZCL_Notify_t *ntfy));
+static void keSendInitiateKECommand(ZclKeSession_t *session);
+static void keSendEphemeralDataCommand(ZclKeSession_t *session);
+static void keSendConfirmKeyDataCommand(ZclKeSession_t *session);
+static void keSendTerminateKECommand(ShortAddr_t shortAddr, Endpoint_t endpoint, bool srvMode,
+  ZCL_TKEStatus_t status);
+static void keTerminateSession(ZclKeSession_t *session, ZCL_Addressing_t *addressing, bool srvMode,
+  ZCL_TKEStatus_t status);
+
+static void keScheduleEcc(ZclKeSession_t *session, ZclKeEccStep_t step);
+static void keEccFailed(ZclKeSession_t *session, ZclKeEccStep_t step);
+static void keCalculateMac1(ZclKeSession_t *session);
+static void keCalculateMac2(ZclKeSession_t *session);
+static void keGenerateKey(ZclKeSession_t *session);
+static void keSwitchKey(ZclKeSession_t *session);
+static void restartKEFired(ZclKeSession_t *session);
+static void keSetTimeoutInSec(ZclKeSession_t *session, uint16_t timeout,
+  void (*callback)(ZclKeSession_t *session));
 static void mac1Conf(void);
 static void mac2Conf(void);
 
@@ -155,24 +209,26 @@ static void keSendTerminateKECommandRespHandler(ZCL_Notify_t *zclResp);
 static void keMatchDescResp(ZDO_ZdpResp_t *zdpResp);
 
 static void keCpyReverse(uint8_t *dst, uint8_t *src, uint8_t size);
-static bool keIsRequestInProgress(void);
-static void keStopKe(ZCL_SecurityStatus_t status);
-static void keTimeoutHandler(void);
-static void keCancelTimeout(void);
+static bool keIsRequestInProgress(ZclKeSession_t *session);
+static void keStopKe(ZclKeSession_t *session, ZCL_SecurityStatus_t status);
+static void keTimeoutHandler(ZclKeSession_t *session);
+static void keCancelTimeout(ZclKeSession_t *session);
+static void keRestartTimer(void);
+static void keTimerFired(void);
 
 static int ZCL_GetAnalogRandomSequence(uint8_t *buffer, unsigned long size);
 
-static ZCL_TKEStatus_t keInitiateKeReqProcessing(ZCL_Addressing_t *addressing,
+static ZCL_TKEStatus_t keInitiateKeReqProcessing(ZclKeSession_t *session, ZCL_Addressing_t *addressing,
   ZCL_InitiateKeyEstablishmentCommand_t *payload);
-static ZCL_TKEStatus_t keInitiateKeRespProcessing(ZCL_Addressing_t *addressing,
+static ZCL_TKEStatus_t keInitiateKeRespProcessing(ZclKeSession_t *session, ZCL_Addressing_t *addressing,
   ZCL_InitiateKeyEstablishmentCommand_t *payload);
-static ZCL_TKEStatus_t keEphemeralDataReqProcessing(ZCL_Addressing_t *addressing,
+static ZCL_TKEStatus_t keEphemeralDataReqProcessing(ZclKeSession_t *session,
   ZCL_EphemeralDataCommand_t *payload);
-static ZCL_TKEStatus_t keEphemeralDataRespProcessing(ZCL_Addressing_t *addressing,
+static ZCL_TKEStatus_t keEphemeralDataRespProcessing(ZclKeSession_t *session,
   ZCL_EphemeralDataCommand_t *payload);
-static ZCL_TKEStatus_t keConfirmKeyReqProcessing(ZCL_Addressing_t *addressing,
+static ZCL_TKEStatus_t keConfirmKeyReqProcessing(ZclKeSession_t *session,
   ZCL_ConfirmKeyCommand_t *payload);
-static ZCL_TKEStatus_t keConfirmKeyRespProcessing(ZCL_Addressing_t *addressing,
+static ZCL_TKEStatus_t keConfirmKeyRespProcessing(ZclKeSession_t *session,
   ZCL_ConfirmKeyCommand_t *payload);
 
 #ifdef _ZSE_CERTIFICATION_
@@ -182,6 +238,7 @@ void delayTimerFired(void);
 /******************************************************************************
                    Global functions prototype section
 ******************************************************************************/
+void zclKeTaskHandler(void);
 #ifdef _ZSE_CERTIFICATION_
 void setKETimeouts(uint8_t ephemeralTimeout, uint8_t confirmTimeout, uint8_t ephemeralDelay, uint8_t confirmDelay);
 void setBadCertificatesProcessing(void);
@@ -207,32 +264,18 @@ static ZCL_KEClusterCommands_t keClusterClientCommands =
 };
 static ZCL_Cluster_t keClusterClient = ZCL_DEFINE_KE_CLUSTER_CLIENT(&keClusterClientAttributes, &keClusterClientCommands);
 
-
-static ZCL_Request_t                          keZclReq;
-static ZCL_KECommandPayload_t                 keCommandPayloadBuffer;
+static ZclKeSession_t                         keSessions[ZCL_KE_MAX_SESSIONS];
+static ZclKeSession_t                         *keDiscoverySession; // Initiator session doing the discovery
+static ZclKeSession_t                         *keMacSession;       // Owner of macBuf and sspKeyedHashReq
+static uint8_t                                keEccNextSession;    // Round-robin position of the ECC scheduler
 static ZCL_Request_t                          keTerminateZclReq;
 static ZCL_TerminateKeyEstablishmentCommand_t keTerminateKEPayload;
 
-static SYS_Timer_t          keApsTimer;
+static SYS_Timer_t          keApsTimer;          // Shared by all sessions, expires at the nearest deadline
 static ZDO_ZdpReq_t         zdpReq; //Needed for certain discovery
 static ZclKEClusterState_t  keState             = ZCL_KE_CLUSTER_INITIAL_STATE;
 static bool  keTerminateReqBusy = false;
 
-
-//For Certicom usage
-static unsigned char keLocalEphemeralPrivateKey[SECT163K1_PRIVATE_KEY_SIZE];
-static unsigned char keLocalEphemeralPublicKey[SECT163K1_COMPRESSED_PUBLIC_KEY_SIZE];
-static unsigned char keLocalKeyBits[SECT163K1_SHARED_SECRET_SIZE];
-
-static unsigned char keRemoteCertificate[SECT163K1_CERTIFICATE_SIZE];
-static unsigned char keRemoteEphemeralPublicKey[SECT163K1_COMPRESSED_PUBLIC_KEY_SIZE];
-
-static uint8_t digest1[AES_MMO_HASH_SIZE];
-static uint8_t digest2[AES_MMO_HASH_SIZE];
-static uint8_t macvHash[AES_MMO_HASH_SIZE];
-static uint8_t macuHash[AES_MMO_HASH_SIZE];
-static uint8_t receivedMacuHash[AES_MMO_HASH_SIZE];
-
 static ZclKeMacBuffer_t GUARDED_STRUCT(macBuf);
 
 static SSP_KeyedHashMacReq_t sspKeyedHashReq;
@@ -241,14 +284,8 @@ static SSP_KeyedHashMacReq_t sspKeyedHashReq;
 static uint32_t keIndirectPollRate = ZCL_INDIRECT_POLL_RATE_DURING_KE * 1000;
 #endif // _ENDDEVICE_
 
-static ShortAddr_t keRemoteShortAddr = ZCL_KE_INVALID_SHORT_ADDRESS;
-static Endpoint_t  keRemoteEndpoint  = ZCL_KE_INVALID_ENDPOINT;
-static uint16_t    keRemoteEphemeralDataGenerateTime;
-static uint16_t    keRemoteConfirmKeyGenerateTime;
-
+static ExtAddr_t   keStartExtAddr = ZCL_KE_INVALID_EXT_ADDRESS;
 static uint8_t buffForRandSeq[ZCL_KE_INITIATE_RANDOM_SEQ_SIZE];
-static bool postponedProcessing = false;
-static uint8_t keSeqNum;
 
 #ifdef _ZSE_CERTIFICATION_
 static uint8_t ephemeralDataGenerateTime = ZCL_KE_EPHEMERAL_DATA_GENERATE_TIME;
@@ -259,6 +296,7 @@ static HAL_AppTimer_t delayTimer = {
   .mode     = TIMER_ONE_SHOT_MODE,
   .callback = delayTimerFired
 };
+static ZclKeSession_t *delaySession;
 bool useDelay = false;
 bool sendTooLongCertificate = false;
 bool passBadCertificates = false;
@@ -270,8 +308,8 @@ int8_t certAdditionLength = 0;
                    Global variables section
 ******************************************************************************/
 Endpoint_t keLocalEndpoint = ZCL_KE_INVALID_ENDPOINT;
-bool keSrvMode = false;
 ZCL_KECertificateDescriptor_t keCertificateDescriptor;
+//Remote address of the session which runs the current ECC step
 ExtAddr_t keRemoteExtAddr = ZCL_KE_INVALID_EXT_ADDRESS;
 
 /******************************************************************************
@@ -280,19 +318,108 @@ ExtAddr_t keRemoteExtAddr = ZCL_KE_INVALID_EXT_ADDRESS;
 /*************************************************************************************//**
   \brief Validates incoming command.
 
+  \param session - session the command belongs to
   \param addressing - command's source address information
 
   \return true - if command is valid, false - otherwise.
 ******************************************************************************************/
-static inline bool keIncomingCmdIsValid(ZCL_Addressing_t *addressing)
+static inline bool keIncomingCmdIsValid(ZclKeSession_t *session, ZCL_Addressing_t *addressing)
 {
-  if (!keSrvMode)
-    if (addressing->sequenceNumber != keSeqNum)
+  if (!session->srvMode)
+    if (addressing->sequenceNumber != session->seqNum)
       return false;
 
-  return ((keRemoteShortAddr == addressing->addr.shortAddress) &&
-    ((APS_EXT_ADDRESS != addressing->addrMode) || (keRemoteExtAddr == addressing->addr.extAddress)) &&
-    (keRemoteEndpoint == addressing->endpointId));
+  return true;
+}
+
+/*************************************************************************************//**
+  \brief Detects whether the session is in use.
+
+  \param session - session to be checked
+
+  \return true if the session is in use, false if it is free.
+******************************************************************************************/
+static inline bool keSessionIsActive(ZclKeSession_t *session)
+{
+  return ZCL_KE_CLUSTER_IDLE_STATE < session->state;
+}
+
+/*************************************************************************************//**
+  \brief Finds an active session with the device the command is received from.
+
+  \param addressing - command's source address information
+  \param srvMode - true if the local device is the responder
+
+  \return pointer to the session if found, NULL otherwise.
+******************************************************************************************/
+static ZclKeSession_t *keFindSession(ZCL_Addressing_t *addressing, bool srvMode)
+{
+  for (uint8_t i = 0; i < ZCL_KE_MAX_SESSIONS; i++)
+  {
+    ZclKeSession_t *session = &keSessions[i];
+
+    if (keSessionIsActive(session) &&
+        (srvMode == session->srvMode) &&
+        (session->remoteShortAddr == addressing->addr.shortAddress) &&
+        ((APS_EXT_ADDRESS != addressing->addrMode) || (session->remoteExtAddr == addressing->addr.extAddress)) &&
+        (session->remoteEndpoint == addressing->endpointId))
+      return session;
+  }
+  return NULL;
+}
+
+/*************************************************************************************//**
+  \brief Allocates a free session. A session is free if it is idle, has no ZCL request
+    in progress and does not own the MAC calculation.
+
+  \return pointer to the session if any is free, NULL otherwise.
+******************************************************************************************/
+static ZclKeSession_t *keAllocSession(void)
+{
+  for (uint8_t i = 0; i < ZCL_KE_MAX_SESSIONS; i++)
+  {
+    ZclKeSession_t *session = &keSessions[i];
+
+    if (!keSessionIsActive(session) && !session->reqBusy &&
+        (keMacSession != session))
+    {
+      session->eccStep             = ZCL_KE_ECC_NO_STEP;
+      session->ecc.operation       = ZSE_ECC_NO_OPERATION;
+      session->postponedProcessing = false;
+      session->deadline            = 0;
+      return session;
+    }
+  }
+  return NULL;
+}
+
+/*************************************************************************************//**
+  \brief Detects whether there is an active initiator session.
+
+  \return pointer to the initiator session, NULL if there is no such one.
+******************************************************************************************/
+static ZclKeSession_t *keGetInitiatorSession(void)
+{
+  for (uint8_t i = 0; i < ZCL_KE_MAX_SESSIONS; i++)
+  {
+    if (keSessionIsActive(&keSessions[i]) && !keSessions[i].srvMode)
+      return &keSessions[i];
+  }
+  return NULL;
+}
+
+/*************************************************************************************//**
+  \brief Gets the session the ZCL request notification belongs to.
+
+  \param zclResp - ZCL request notification
+
+  \return pointer to the session.
+******************************************************************************************/
+static inline ZclKeSession_t *keGetSessionByNotify(ZCL_Notify_t *zclResp)
+{
+  ZCL_Request_t *req = GET_PARENT_BY_FIELD(ZCL_Request_t, notify, zclResp);
+
+  return GET_PARENT_BY_FIELD(ZclKeSession_t, zclReq, req);
 }
 
 /*************************************************************************************//**
@@ -300,10 +427,17 @@ static inline bool keIncomingCmdIsValid(ZCL_Addressing_t *addressing)
 ******************************************************************************************/
 void keReset(void)
 {
+  for (uint8_t i = 0; i < ZCL_KE_MAX_SESSIONS; i++)
+  {
+    keSessions[i].state    = ZCL_KE_CLUSTER_IDLE_STATE;
+    keSessions[i].eccStep  = ZCL_KE_ECC_NO_STEP;
+    keSessions[i].deadline = 0;
+  }
+  SYS_StopTimer(&keApsTimer);
+  keState = ZCL_KE_CLUSTER_INITIAL_STATE;
+
+  keStartExtAddr    = ZCL_KE_INVALID_EXT_ADDRESS;
   keRemoteExtAddr   = ZCL_KE_INVALID_EXT_ADDRESS;
-  keRemoteShortAddr = ZCL_KE_INVALID_SHORT_ADDRESS;
-  keRemoteEndpoint  = ZCL_KE_INVALID_ENDPOINT;
-  keSrvMode         = false;
 
   keLocalEndpoint   = ZCL_KE_INVALID_ENDPOINT;
   memset(&keCertificateDescriptor, 0, sizeof(keCertificateDescriptor));
@@ -317,10 +451,10 @@ void keReset(void)
 bool keInitCluster(ExtAddr_t *remoteAddress)
 {
   sysAssert(remoteAddress, KE_INIT_CLUSTER_0);
-  COPY_EXT_ADDR(keRemoteExtAddr, *remoteAddress);
+  COPY_EXT_ADDR(keStartExtAddr, *remoteAddress);
 
   //Check the initial settings
-  if ((ZCL_KE_INVALID_EXT_ADDRESS == keRemoteExtAddr) ||
+  if ((ZCL_KE_INVALID_EXT_ADDRESS == keStartExtAddr) ||
       (ZCL_KE_INVALID_ENDPOINT == keLocalEndpoint))
     return false;
 
@@ -335,6 +469,9 @@ bool keInitCluster(ExtAddr_t *remoteAddress)
 /**************************************************************************//**
   \brief This function copies size bytes of random data into buffer.
 
+  The sequence is renewed after each use, so ephemeral keys of concurrent
+  sessions never share the random data.
+
   \param: buffer - This is an unsigned char array of size at least sz to hold
    the random data.
   \param: size - The number of bytes of random data to compute and store.
@@ -344,31 +481,39 @@ bool keInitCluster(ExtAddr_t *remoteAddress)
 static int ZCL_GetAnalogRandomSequence(uint8_t *buffer, unsigned long size)
 {
   memcpy(buffer, buffForRandSeq, size);
-  if (MAC_IsOwnExtAddr(&keRemoteExtAddr))
-    SYS_GetRandomSequence(buffForRandSeq, ZCL_KE_INITIATE_RANDOM_SEQ_SIZE);
+  SYS_GetRandomSequence(buffForRandSeq, ZCL_KE_INITIATE_RANDOM_SEQ_SIZE);
   return 0;
 }
 
 /*************************************************************************************//**
-  \brief Starts KE management module.
+  \brief Starts KE management module. If the remote address passed to keInitCluster()
+    is not own address, starts Key Establishment with that device as the initiator.
+    Otherwise the device serves incoming Key Establishment requests only.
 
   \return true if success, false otherwise.
 ******************************************************************************************/
 bool keStartKE(void)
 {
+  ZclKeSession_t *session;
+
   if (ZCL_KE_CLUSTER_IDLE_STATE != keState)
     return false;
 
-  if (!MAC_IsOwnExtAddr(&keRemoteExtAddr))
+  if (!MAC_IsOwnExtAddr(&keStartExtAddr))
   {
-    const ShortAddr_t *shortAddr = NWK_GetShortByExtAddress(&keRemoteExtAddr);
+    const ShortAddr_t *shortAddr = NWK_GetShortByExtAddress(&keStartExtAddr);
+
+    if (keGetInitiatorSession() || (NULL == (session = keAllocSession())))
+      return false;
 
+    session->srvMode = false;
+    session->remoteExtAddr = keStartExtAddr;
     if (shortAddr)
-      keRemoteShortAddr = *shortAddr;
+      session->remoteShortAddr = *shortAddr;
     else
       // this is only an assumption. coordinator is trust center!!!
-      keRemoteShortAddr = 0;
-    keMakeMatchDescReq();
+      session->remoteShortAddr = 0;
+    keMakeMatchDescReq(session);
   }
 
   return true;
@@ -376,25 +521,28 @@ bool keStartKE(void)
 
 /*************************************************************************************//**
   \brief Performs discovery of KE Cluster on ESP device
+
+  \param session - initiator session
 ******************************************************************************************/
-static void keMakeMatchDescReq(void)
+static void keMakeMatchDescReq(ZclKeSession_t *session)
 {
   ZDO_MatchDescReq_t *zdoMatchDescReq = &zdpReq.req.reqPayload.matchDescReq;
 
-  keRemoteEndpoint = ZCL_KE_INVALID_ENDPOINT;
+  session->remoteEndpoint = ZCL_KE_INVALID_ENDPOINT;
 
   zdpReq.ZDO_ZdpResp = keMatchDescResp;
   zdpReq.reqCluster = MATCH_DESCRIPTOR_CLID;
   zdpReq.dstAddrMode = APS_SHORT_ADDRESS;
-  zdpReq.dstAddress.shortAddress = keRemoteShortAddr;
+  zdpReq.dstAddress.shortAddress = session->remoteShortAddr;
 
-  zdoMatchDescReq->nwkAddrOfInterest = keRemoteShortAddr;
+  zdoMatchDescReq->nwkAddrOfInterest = session->remoteShortAddr;
   zdoMatchDescReq->profileId = PROFILE_ID_SMART_ENERGY;
   zdoMatchDescReq->numInClusters = 1;
   zdoMatchDescReq->numOutClusters = 0;
   zdoMatchDescReq->inClusterList[0] = ZCL_KEY_ESTABLISHMENT_CLUSTER_ID;
 
-  keState = ZCL_KE_MATCH_DESCRIPTOR_DISCOVERY_SENDING_STATE;
+  session->state = ZCL_KE_MATCH_DESCRIPTOR_DISCOVERY_SENDING_STATE;
+  keDiscoverySession = session;
 
   ZDO_ZdpReq(&zdpReq);
 }
@@ -408,55 +556,204 @@ static void keMakeMatchDescReq(void)
 static void keMatchDescResp(ZDO_ZdpResp_t *zdpResp)
 {
   ZDO_MatchDescResp_t *zdoMatchResp = &zdpResp->respPayload.matchDescResp;
+  ZclKeSession_t *session = keDiscoverySession;
 
-  if (ZCL_KE_MATCH_DESCRIPTOR_DISCOVERY_SENDING_STATE == keState)
+  if (ZCL_KE_MATCH_DESCRIPTOR_DISCOVERY_SENDING_STATE == session->state)
   {
-    if (!keSrvMode)
+    if (ZDO_SUCCESS_STATUS == zdpResp->respPayload.status)
     {
-      if (ZDO_SUCCESS_STATUS == zdpResp->respPayload.status)
-      {
-        keRemoteEndpoint = zdoMatchResp->matchList[0];
-        keRemoteShortAddr = zdoMatchResp->nwkAddrOfInterest;
-      }
-      else if (ZDO_CMD_COMPLETED_STATUS == zdpResp->respPayload.status)
+      session->remoteEndpoint = zdoMatchResp->matchList[0];
+      session->remoteShortAddr = zdoMatchResp->nwkAddrOfInterest;
+    }
+    else if (ZDO_CMD_COMPLETED_STATUS == zdpResp->respPayload.status)
+    {
+      if ((ZCL_KE_INVALID_ENDPOINT != session->remoteEndpoint) &&
+          (ZCL_KE_INVALID_SHORT_ADDRESS != session->remoteShortAddr))
       {
-        if ((ZCL_KE_INVALID_ENDPOINT != keRemoteEndpoint) &&
-            (ZCL_KE_INVALID_SHORT_ADDRESS != keRemoteShortAddr))
-        {
-          keSendInitiateKECommand();
-        }
-        else
-        { // match discovery was completed but response was not received
-          keState = ZCL_KE_MATCH_DESCRIPTOR_DISCOVERY_TERMINATE_STATE;
-          keStopKe(ZCL_SECURITY_STATUS_DISCOVERY_FAIL);
-        }
+        keScheduleEcc(session, ZCL_KE_ECC_EPHEMERAL_KEY_STEP);
       }
       else
-      {
-        keStopKe(ZCL_SECURITY_STATUS_DISCOVERY_FAIL);
+      { // match discovery was completed but response was not received
+        session->state = ZCL_KE_MATCH_DESCRIPTOR_DISCOVERY_TERMINATE_STATE;
+        keStopKe(session, ZCL_SECURITY_STATUS_DISCOVERY_FAIL);
       }
     }
+    else
+    {
+      keStopKe(session, ZCL_SECURITY_STATUS_DISCOVERY_FAIL);
+    }
   }
-  else
+  else if (ZCL_KE_MATCH_DESCRIPTOR_DISCOVERY_TERMINATE_STATE == session->state)
   {
     if (ZDO_CMD_COMPLETED_STATUS == zdpResp->respPayload.status)
-      keStopKe(ZCL_SECURITY_STATUS_TERMINATED);
+      keStopKe(session, ZCL_SECURITY_STATUS_TERMINATED);
   }
 
   SYS_PostEvent(BC_EVENT_KE_CLUSTER_MATCH_DESC_RESP, (uintptr_t)zdpResp);
 }
 
 /*************************************************************************************//**
-  \brief Sends Key Establishment command (request or response - depends on keSrvMode).
+  \brief Queues ECC computation step of the session. Steps are executed in the ZCL
+    task in slices of ZCL_KE_ECC_FIELD_OPS_PER_SLICE field operations, sessions
+    are served in round-robin order.
+
+  \param session - session the step belongs to
+  \param step - ECC computation step
 ******************************************************************************************/
-static void keSendInitiateKECommand(void)
+static void keScheduleEcc(ZclKeSession_t *session, ZclKeEccStep_t step)
 {
-  ZCL_InitiateKeyEstablishmentCommand_t *buf = &keCommandPayloadBuffer.initiateKE;
+  session->eccStep = step;
+  session->ecc.operation = ZSE_ECC_NO_OPERATION;
+  session->state = (ZCL_KE_ECC_EPHEMERAL_KEY_STEP == step) ?
+    ZCL_KE_CLUSTER_EPHEMERAL_KEY_GENERATING_STATE : ZCL_KE_CLUSTER_KEY_BITS_GENERATING_STATE;
+  zclPostTask(ZCL_KE_TASK_ID);
+}
 
-#if CERTICOM_SUPPORT == 1
-  //Generating the ephemeral public and private Key Pair
-  ZSE_ECCGenerateKey(keLocalEphemeralPrivateKey, keLocalEphemeralPublicKey, ZCL_GetAnalogRandomSequence, yield, YIELD_LEVEL);
-#endif // CERTICOM_SUPPORT == 1
+/*************************************************************************************//**
+  \brief Starts ECC operation of the session's step.
+
+  \param session - session the step belongs to
+
+  \return MCE_SUCCESS if the operation is started, error code otherwise.
+******************************************************************************************/
+static int keStartEcc(ZclKeSession_t *session)
+{
+  if (ZCL_KE_ECC_EPHEMERAL_KEY_STEP == session->eccStep)
+    //Generating the ephemeral public and private Key Pair
+    return ZSE_ECCGenerateKeyStart(&session->ecc, session->localEphemeralPrivateKey,
+                                   session->localEphemeralPublicKey, ZCL_GetAnalogRandomSequence);
+
+  //Derive the shared secret using the ECMQV primitive
+  //Z = ECC_GenerateSharedSecret
+  return ZSE_ECCKeyBitGenerateStart(&session->ecc, keCertificateDescriptor.privateKey,
+                                    session->localEphemeralPrivateKey, session->localEphemeralPublicKey,
+                                    session->remoteCertificate, session->remoteEphemeralPublicKey,
+                                    keCertificateDescriptor.publicKey /*CA Public Key*/,
+                                    session->keyBits, SSP_BcbHash);
+}
+
+/*************************************************************************************//**
+  \brief Terminates the session after its ECC computation step failed. The remote side
+    is sent KE Terminate command, unless the session is the initiator that has not sent
+    anything yet.
+
+  \param session - session the step belongs to
+  \param step - failed ECC computation step
+******************************************************************************************/
+static void keEccFailed(ZclKeSession_t *session, ZclKeEccStep_t step)
+{
+  if (session->srvMode || (ZCL_KE_ECC_EPHEMERAL_KEY_STEP != step))
+  {
+    // the shared secret can not be derived from the remote certificate and ephemeral key
+    keSendTerminateKECommand(session->remoteShortAddr, session->remoteEndpoint, session->srvMode,
+      (ZCL_KE_ECC_KEY_BITS_STEP == step) ? ZCL_TKE_BAD_MESSAGE_STATUS : ZCL_TKE_NO_RESOURCES_STATUS);
+  }
+  keStopKe(session, ZCL_SECURITY_STATUS_TERMINATED);
+}
+
+/*************************************************************************************//**
+  \brief KE task handler. Executes a single slice of a queued ECC computation step.
+******************************************************************************************/
+void zclKeTaskHandler(void)
+{
+  // MAC calculation of the previous step is still in progress. The task is
+  // posted again when it is finished.
+  if (keMacSession)
+    return;
+
+  for (uint8_t i = 0; i < ZCL_KE_MAX_SESSIONS; i++)
+  {
+    ZclKeSession_t *session = &keSessions[keEccNextSession];
+    ZclKeEccStep_t step = session->eccStep;
+    int status = MCE_SUCCESS;
+
+    if (ZCL_KE_MAX_SESSIONS <= ++keEccNextSession)
+      keEccNextSession = 0;
+
+    if (ZCL_KE_ECC_NO_STEP == step)
+      continue;
+
+    keRemoteExtAddr = session->remoteExtAddr;
+    if (ZSE_ECC_NO_OPERATION == session->ecc.operation)
+      status = keStartEcc(session);
+    if (MCE_SUCCESS == status)
+      status = ZSE_ECCContinue(&session->ecc, ZCL_KE_ECC_FIELD_OPS_PER_SLICE);
+    if (ZSE_ECC_IN_PROGRESS == status)
+      break; // to be continued by the next slice
+
+    session->eccStep = ZCL_KE_ECC_NO_STEP;
+    if (MCE_SUCCESS != status)
+    {
+      keEccFailed(session, step);
+      break;
+    }
+    if (ZCL_KE_ECC_EPHEMERAL_KEY_STEP == step)
+      keSendInitiateKECommand(session);
+    else
+      keGenerateKey(session);
+    break;
+  }
+
+  for (uint8_t i = 0; i < ZCL_KE_MAX_SESSIONS; i++)
+  {
+    if (!keMacSession && (ZCL_KE_ECC_NO_STEP != keSessions[i].eccStep))
+    {
+      zclPostTask(ZCL_KE_TASK_ID);
+      break;
+    }
+  }
+}
+
+/*************************************************************************************//**
+  \brief Fills in common fields and sends session's KE command.
+
+  \param session - session the command belongs to
+  \param reqId - command identifier to be used by the initiator
+  \param respId - command identifier to be used by the responder
+  \param length - payload length
+  \param notify - confirmation callback
+******************************************************************************************/
+static void keSendCommand(ZclKeSession_t *session, ZCL_CommandId_t reqId, ZCL_CommandId_t respId,
+  uint8_t length, void (*notify)(ZCL_Notify_t *ntfy))
+{
+  ZCL_Request_t *req = &session->zclReq;
+
+  if (!session->srvMode)
+  {
+    req->id = reqId;
+    req->dstAddressing.clusterSide = ZCL_CLUSTER_SIDE_SERVER;
+    session->seqNum = ZCL_GetNextSeqNumber();
+  }
+  else
+  {
+    req->id = respId;
+    req->dstAddressing.clusterSide = ZCL_CLUSTER_SIDE_CLIENT;
+  }
+  req->dstAddressing.sequenceNumber = session->seqNum;
+  req->dstAddressing.profileId  = PROFILE_ID_SMART_ENERGY;
+  req->dstAddressing.clusterId  = ZCL_KEY_ESTABLISHMENT_CLUSTER_ID;
+  req->dstAddressing.endpointId = session->remoteEndpoint;
+  req->dstAddressing.addrMode   = APS_SHORT_ADDRESS;
+  req->dstAddressing.addr.shortAddress = session->remoteShortAddr;
+  req->endpointId = keLocalEndpoint;
+  req->requestPayload = (uint8_t *) &session->commandPayload;
+  req->requestLength  = length;
+  req->defaultResponse = 1;
+  req->ZCL_Notify = notify;
+
+  session->reqBusy = true;
+  ZCL_CommandReq(req);
+}
+
+/*************************************************************************************//**
+  \brief Sends Key Establishment command (request or response - depends on srvMode).
+
+  \param session - session the command belongs to
+******************************************************************************************/
+static void keSendInitiateKECommand(ZclKeSession_t *session)
+{
+  ZCL_InitiateKeyEstablishmentCommand_t *buf = &session->commandPayload.initiateKE;
+  uint8_t length = sizeof(ZCL_InitiateKeyEstablishmentCommand_t);
 
   //Prepare payload
   buf->keyEstablishmentSuite        = ZCL_KE_CBKE_ECMQV_KEY_ESTABLISHMENT_SUITE_ID;
@@ -470,16 +767,10 @@ static void keSendInitiateKECommand(void)
 
   memcpy(buf->identify, &keCertificateDescriptor.certificate, sizeof(ZclCertificate_t));
 
-  if (!keSrvMode)
-  {
-    //ZCL KE Cluster Initiate Key Establishment Command Request sending
-    keZclReq.id = ZCL_KE_INITIATE_KEY_ESTABLISHMENT_REQUEST_COMMAND_ID;
-    keZclReq.dstAddressing.clusterSide = ZCL_CLUSTER_SIDE_SERVER;
-    keSeqNum = ZCL_GetNextSeqNumber();
-    keZclReq.dstAddressing.sequenceNumber = keSeqNum;
-
-    // the crutch to asynchornize data request
+  // the crutch to asynchornize data request
 #ifdef _ENDDEVICE_
+  if (!session->srvMode)
+  {
     // store config server's indirect poll rate
     uint32_t oldIndirectPollRate;
     CS_ReadParameter(CS_INDIRECT_POLL_RATE_ID, &oldIndirectPollRate);
@@ -489,37 +780,20 @@ static void keSendInitiateKECommand(void)
 
     if (ZDO_StopSyncReq() == ZDO_SUCCESS_STATUS)
       ZDO_StartSyncReq();
-#endif /* _ENDDEVICE_ */
-
-  }
-  else
-  {
-    //ZCL KE Cluster Initiate Key Establishment Command Response sending
-    keZclReq.id = ZCL_KE_INITIATE_KEY_ESTABLISHMENT_RESPONSE_COMMAND_ID;
-    keZclReq.dstAddressing.clusterSide = ZCL_CLUSTER_SIDE_CLIENT;
-    keZclReq.dstAddressing.sequenceNumber = keSeqNum;
   }
+#endif /* _ENDDEVICE_ */
 
-  keZclReq.dstAddressing.profileId  = PROFILE_ID_SMART_ENERGY;
-  keZclReq.dstAddressing.clusterId  = ZCL_KEY_ESTABLISHMENT_CLUSTER_ID;
-  keZclReq.dstAddressing.endpointId = keRemoteEndpoint;
-  keZclReq.dstAddressing.addrMode   = APS_SHORT_ADDRESS;
-  keZclReq.dstAddressing.addr.shortAddress = keRemoteShortAddr;
-  keZclReq.endpointId = keLocalEndpoint;
-  keZclReq.requestPayload = (uint8_t *) buf;
-  keZclReq.requestLength  = sizeof(ZCL_InitiateKeyEstablishmentCommand_t);
 #ifdef _ZSE_CERTIFICATION_
   if (sendTooLongCertificate)
   {
-    keZclReq.requestLength += certAdditionLength;
+    length += certAdditionLength;
     sendTooLongCertificate = false;
   }
 #endif // _ZSE_CERTIFICATION_
 
-  keZclReq.defaultResponse = 1;
-  keZclReq.ZCL_Notify = keSendInitiateKECommandRespHandler;
-  keState = ZCL_KE_CLUSTER_INITIATE_KE_COMMAND_SENDING_STATE;
-  ZCL_CommandReq(&keZclReq);
+  session->state = ZCL_KE_CLUSTER_INITIATE_KE_COMMAND_SENDING_STATE;
+  keSendCommand(session, ZCL_KE_INITIATE_KEY_ESTABLISHMENT_REQUEST_COMMAND_ID,
+    ZCL_KE_INITIATE_KEY_ESTABLISHMENT_RESPONSE_COMMAND_ID, length, keSendInitiateKECommandRespHandler);
 }
 
 /*************************************************************************************//**
@@ -529,38 +803,45 @@ static void keSendInitiateKECommand(void)
 ******************************************************************************************/
 static void keSendInitiateKECommandRespHandler(ZCL_Notify_t *zclResp)
 {
-  sysAssert(ZCL_KE_CLUSTER_INITIATE_KE_COMMAND_SENDING_STATE == keState, KE_WRONG_STATE_0);
+  ZclKeSession_t *session = keGetSessionByNotify(zclResp);
+
+  session->reqBusy = false;
+  if (!keSessionIsActive(session))
+    return; // session was stopped while the command was being sent
+
+  sysAssert(ZCL_KE_CLUSTER_INITIATE_KE_COMMAND_SENDING_STATE == session->state, KE_WRONG_STATE_0);
   if (ZCL_SUCCESS_STATUS == zclResp->status)
   {
     /* If response was already received - continue Key Establishment */
-    if (postponedProcessing)
+    if (session->postponedProcessing)
     {
+      session->postponedProcessing = false;
 #ifdef _ZSE_CERTIFICATION_
       if (useDelay)
       {
+        delaySession = session;
         delayTimer.interval = (uint32_t)ephemeralDataGenerateDelay * 1000;
         HAL_StartAppTimer(&delayTimer);
       }
       else
 #endif // _ZSE_CERTIFICATION_
-        keSendEphemeralDataCommand();
-      postponedProcessing = false;
+        keSendEphemeralDataCommand(session);
       return;
     }
 
-    if (!keSrvMode)
+    if (!session->srvMode)
     {
-      keState = ZCL_KE_CLUSTER_INITIATE_KE_COMMAND_WAITING_STATE;
-      keSetTimeoutInSec(ZCL_KE_INITIATE_RESPONSE_WAITING_TIME, keTimeoutHandler);
+      session->state = ZCL_KE_CLUSTER_INITIATE_KE_COMMAND_WAITING_STATE;
+      keSetTimeoutInSec(session, ZCL_KE_INITIATE_RESPONSE_WAITING_TIME, keTimeoutHandler);
     }
     else
     {
-      keState = ZCL_KE_CLUSTER_EPHEMERAL_DATA_COMMAND_WAITING_STATE;
-      keSetTimeoutInSec(keRemoteEphemeralDataGenerateTime, keTimeoutHandler);
+      session->state = ZCL_KE_CLUSTER_EPHEMERAL_DATA_COMMAND_WAITING_STATE;
+      keSetTimeoutInSec(session, session->remoteEphemeralDataGenerateTime, keTimeoutHandler);
     }
   }
   else
-    keStopKe(ZCL_SECURITY_STATUS_SEND_COMMAND_FAIL);
+    keStopKe(session, ZCL_SECURITY_STATUS_SEND_COMMAND_FAIL);
 }
 
 /*************************************************************************************//**
@@ -577,17 +858,9 @@ static ZCL_Status_t initiateKECommandIndHandler(ZCL_Addressing_t *addressing,
 {
   ZclCertificate_t *zclCertificate = (ZclCertificate_t *) payload->identify;
   ZCL_TKEStatus_t tkeStatus = ZCL_TKE_NO_STATUS;
-
-  if (ZCL_CLUSTER_SIDE_CLIENT == addressing->clusterSide)
-    //Server (Responder)
-    keSrvMode = true;
-  else
-    //Client (Initiator)
-    keSrvMode = false;
-
-  keRemoteEphemeralDataGenerateTime = (uint16_t)payload->ephemeralDataGenerateTime + 2;
-  keRemoteConfirmKeyGenerateTime = (uint16_t)payload->confirmKeyGenerateTime + 2;
-  keCancelTimeout();
+  // Server (Responder) if the command is sent by the client, Client (Initiator) otherwise
+  bool srvMode = (ZCL_CLUSTER_SIDE_CLIENT == addressing->clusterSide);
+  ZclKeSession_t *session = keFindSession(addressing, srvMode);
 
 #ifdef _ZSE_CERTIFICATION_
   if (!passBadCertificates)
@@ -608,14 +881,13 @@ static ZCL_Status_t initiateKECommandIndHandler(ZCL_Addressing_t *addressing,
       {
         tkeStatus = ZCL_TKE_BAD_MESSAGE_STATUS;
       }
-      else if (keSrvMode)
+      else if (srvMode)
       {
-        keSeqNum = addressing->sequenceNumber;
-        tkeStatus = keInitiateKeReqProcessing(addressing, payload);
+        tkeStatus = keInitiateKeReqProcessing(session, addressing, payload);
       }
       else
       {
-        tkeStatus = keInitiateKeRespProcessing(addressing, payload);
+        tkeStatus = keInitiateKeRespProcessing(session, addressing, payload);
       }
     }
     else
@@ -624,68 +896,75 @@ static ZCL_Status_t initiateKECommandIndHandler(ZCL_Addressing_t *addressing,
 #ifdef _ZSE_CERTIFICATION_
   if (passBadCertificates)
   {
-    keSeqNum = addressing->sequenceNumber;
-    tkeStatus = keInitiateKeReqProcessing(addressing, payload);
+    tkeStatus = keInitiateKeReqProcessing(session, addressing, payload);
   }
 #endif // _ZSE_CERTIFICATION_
   if (ZCL_TKE_NO_STATUS != tkeStatus)
   {
-    keSendTerminateKECommand(addressing->addr.shortAddress, addressing->endpointId, tkeStatus);
+    keTerminateSession(session, addressing, srvMode, tkeStatus);
   }
 
-  SYS_PostEvent((keSrvMode) ? BC_EVENT_KE_CLUSTER_INITIATE_KE_REQ : BC_EVENT_KE_CLUSTER_INITIATE_KE_RESP, (uintptr_t)payload);
+  SYS_PostEvent((srvMode) ? BC_EVENT_KE_CLUSTER_INITIATE_KE_REQ : BC_EVENT_KE_CLUSTER_INITIATE_KE_RESP, (uintptr_t)payload);
 
   return ZCL_SUCCESS_STATUS;
 }
 
 /*************************************************************************************//**
-  \brief Processes Initiate Key Establishment Request command.
+  \brief Processes Initiate Key Establishment Request command. Opens a new responder
+    session for the device.
 
+  \param session - session which is already opened for the device, NULL if none
   \param addressing - command's source address information
   \param payload - command payload
 
   \return processing status
 ******************************************************************************************/
-static ZCL_TKEStatus_t keInitiateKeReqProcessing(ZCL_Addressing_t *addressing,
+static ZCL_TKEStatus_t keInitiateKeReqProcessing(ZclKeSession_t *session, ZCL_Addressing_t *addressing,
   ZCL_InitiateKeyEstablishmentCommand_t *payload)
 {
-  ExtAddr_t keRemoteExtAddrTmp;
+  ExtAddr_t remoteExtAddr = addressing->addr.extAddress;
+  ExtAddr_t remoteExtAddrTmp;
   ZclCertificate_t *zclCertificate = (ZclCertificate_t *) payload->identify;
 
   //Server (Responder)
-  if (ZCL_KE_CLUSTER_IDLE_STATE == keState)
-  {
-    //Save the client address (short and ext) and endpoint
-    keRemoteShortAddr = addressing->addr.shortAddress;
-    keRemoteEndpoint = addressing->endpointId;
-    keRemoteExtAddr = addressing->addr.extAddress;
+  if (session || (ZCL_KE_CLUSTER_IDLE_STATE != keState))
+    return ZCL_TKE_NO_RESOURCES_STATUS;
 
-    if (APS_EXT_ADDRESS != addressing->addrMode)
-    {
-      //There is no information about client in nwkAddrMapTable
-      //Let's get it from the Implicit Certificate
-      keRemoteExtAddr = zclCertificate->subject;
-    }
-    else
-    {
-      keCpyReverse((uint8_t *) &keRemoteExtAddrTmp, (uint8_t *) &keRemoteExtAddr, sizeof(ExtAddr_t));
+  if (APS_EXT_ADDRESS != addressing->addrMode)
+  {
+    //There is no information about client in nwkAddrMapTable
+    //Let's get it from the Implicit Certificate
+    remoteExtAddr = zclCertificate->subject;
+  }
+  else
+  {
+    keCpyReverse((uint8_t *) &remoteExtAddrTmp, (uint8_t *) &remoteExtAddr, sizeof(ExtAddr_t));
 #ifndef _ZSE_CERTIFICATION_
-      if (!IS_EQ_EXT_ADDR(keRemoteExtAddrTmp, zclCertificate->subject))
-        return ZCL_TKE_BAD_MESSAGE_STATUS;
+    if (!IS_EQ_EXT_ADDR(remoteExtAddrTmp, zclCertificate->subject))
+      return ZCL_TKE_BAD_MESSAGE_STATUS;
 #endif
-    }
+  }
 
-    memcpy(keRemoteCertificate, payload->identify, SECT163K1_CERTIFICATE_SIZE);
-#ifdef _ZSE_CERTIFICATION_
-    if (outOfOrder)
-      keSendEphemeralDataCommand();
-    else
-#endif // _ZSE_CERTIFICATION
-      keSendInitiateKECommand();
+  session = keAllocSession();
+  if (!session)
+    return ZCL_TKE_NO_RESOURCES_STATUS;
 
-  }
+  //Save the client address (short and ext) and endpoint
+  session->srvMode = true;
+  session->remoteShortAddr = addressing->addr.shortAddress;
+  session->remoteEndpoint = addressing->endpointId;
+  session->remoteExtAddr = remoteExtAddr;
+  session->seqNum = addressing->sequenceNumber;
+  session->remoteEphemeralDataGenerateTime = (uint16_t)payload->ephemeralDataGenerateTime + 2;
+  session->remoteConfirmKeyGenerateTime = (uint16_t)payload->confirmKeyGenerateTime + 2;
+
+  memcpy(session->remoteCertificate, payload->identify, SECT163K1_CERTIFICATE_SIZE);
+#ifdef _ZSE_CERTIFICATION_
+  if (outOfOrder)
+    keSendEphemeralDataCommand(session);
   else
-    return ZCL_TKE_NO_RESOURCES_STATUS;
+#endif // _ZSE_CERTIFICATION
+    keScheduleEcc(session, ZCL_KE_ECC_EPHEMERAL_KEY_STEP);
 
   return ZCL_TKE_NO_STATUS;
 }
@@ -693,92 +972,80 @@ static ZCL_TKEStatus_t keInitiateKeReqProcessing(ZCL_Addressing_t *addressing,
 /*************************************************************************************//**
   \brief Processes Initiate Key Establishment Response command.
 
+  \param session - initiator session, NULL if there is no session with the device
   \param addressing - command's source address information
   \param payload - command payload
 
   \return processing status
 ******************************************************************************************/
-static ZCL_TKEStatus_t keInitiateKeRespProcessing(ZCL_Addressing_t *addressing,
+static ZCL_TKEStatus_t keInitiateKeRespProcessing(ZclKeSession_t *session, ZCL_Addressing_t *addressing,
   ZCL_InitiateKeyEstablishmentCommand_t *payload)
 {
   //Client (Initiator)
-  postponedProcessing = (ZCL_KE_CLUSTER_INITIATE_KE_COMMAND_SENDING_STATE == keState);
+  if (!session)
+    return ZCL_TKE_BAD_MESSAGE_STATUS;
+
+  session->postponedProcessing = (ZCL_KE_CLUSTER_INITIATE_KE_COMMAND_SENDING_STATE == session->state);
 
-  if (ZCL_KE_CLUSTER_INITIATE_KE_COMMAND_WAITING_STATE == keState || postponedProcessing)
+  if (ZCL_KE_CLUSTER_INITIATE_KE_COMMAND_WAITING_STATE == session->state || session->postponedProcessing)
   {
-    if (keIncomingCmdIsValid(addressing))
+    if (keIncomingCmdIsValid(session, addressing))
     {
       ExtAddr_t keRemoteExtAddrTmp;
       ZclCertificate_t *zclCertificate = (ZclCertificate_t *) payload->identify;
 
-      keCpyReverse((uint8_t *) &keRemoteExtAddrTmp, (uint8_t *) &keRemoteExtAddr, sizeof(ExtAddr_t));
+      session->remoteEphemeralDataGenerateTime = (uint16_t)payload->ephemeralDataGenerateTime + 2;
+      session->remoteConfirmKeyGenerateTime = (uint16_t)payload->confirmKeyGenerateTime + 2;
+      keCancelTimeout(session);
+
+      keCpyReverse((uint8_t *) &keRemoteExtAddrTmp, (uint8_t *) &session->remoteExtAddr, sizeof(ExtAddr_t));
       if (!IS_EQ_EXT_ADDR(keRemoteExtAddrTmp, zclCertificate->subject))
         return ZCL_TKE_BAD_MESSAGE_STATUS;
 
-      memcpy(keRemoteCertificate, payload->identify, SECT163K1_CERTIFICATE_SIZE);
-      if (!postponedProcessing)
+      memcpy(session->remoteCertificate, payload->identify, SECT163K1_CERTIFICATE_SIZE);
+      if (!session->postponedProcessing)
       {
 #ifdef _ZSE_CERTIFICATION_
         if (useDelay)
         {
+          delaySession = session;
           delayTimer.interval = (uint32_t)ephemeralDataGenerateDelay * 1000;
           HAL_StartAppTimer(&delayTimer);
         }
         else
 #endif // _ZSE_CERTIFICATION_
-          keSendEphemeralDataCommand();
+          keSendEphemeralDataCommand(session);
       }
       return ZCL_TKE_NO_STATUS;
     }
   }
 
-  postponedProcessing = false;
+  session->postponedProcessing = false;
   return ZCL_TKE_BAD_MESSAGE_STATUS;
 }
 
 /*************************************************************************************//**
   \brief Sends Ephemeral Data KE Command.
+
+  \param session - session the command belongs to
 ******************************************************************************************/
-static void keSendEphemeralDataCommand(void)
+static void keSendEphemeralDataCommand(ZclKeSession_t *session)
 {
-  ZCL_EphemeralDataCommand_t *buf = &keCommandPayloadBuffer.ephemeralData;
+  ZCL_EphemeralDataCommand_t *buf = &session->commandPayload.ephemeralData;
 
   //Prepare payload
-  memcpy(buf->data, keLocalEphemeralPublicKey, SECT163K1_COMPRESSED_PUBLIC_KEY_SIZE);
-  if (!keSrvMode)
-  {
-    //ZCL KE Cluster Initiate Key Establishment Command Request sending
-    keZclReq.id = ZCL_KE_EPHEMERAL_DATA_REQUEST_COMMAND_ID;
-    keZclReq.dstAddressing.clusterSide = ZCL_CLUSTER_SIDE_SERVER;
-    keSeqNum = ZCL_GetNextSeqNumber();
-    keZclReq.dstAddressing.sequenceNumber = keSeqNum;
+  memcpy(buf->data, session->localEphemeralPublicKey, SECT163K1_COMPRESSED_PUBLIC_KEY_SIZE);
 
-    // the crutch to asynchornize data request
+  // the crutch to asynchornize data request
 #ifdef _ENDDEVICE_
+  if (!session->srvMode)
     if (ZDO_StopSyncReq() == ZDO_SUCCESS_STATUS)
       ZDO_StartSyncReq();
 #endif /* _ENDDEVICE_ */
-  }
-  else
-  {
-    //ZCL KE Cluster Initiate Key Establishment Command Response sending
-    keZclReq.id = ZCL_KE_EPHEMERAL_DATA_RESPONSE_COMMAND_ID;
-    keZclReq.dstAddressing.clusterSide = ZCL_CLUSTER_SIDE_CLIENT;
-    keZclReq.dstAddressing.sequenceNumber = keSeqNum;
-  }
-  keZclReq.dstAddressing.profileId  = PROFILE_ID_SMART_ENERGY;
-  keZclReq.dstAddressing.clusterId  = ZCL_KEY_ESTABLISHMENT_CLUSTER_ID;
-  keZclReq.dstAddressing.endpointId = keRemoteEndpoint;
-  keZclReq.dstAddressing.addrMode   = APS_SHORT_ADDRESS;
-  keZclReq.dstAddressing.addr.shortAddress = keRemoteShortAddr;
-  keZclReq.endpointId = keLocalEndpoint;
-  keZclReq.requestPayload = (uint8_t *) buf;
-  keZclReq.requestLength  = sizeof(ZCL_EphemeralDataCommand_t);
-  keZclReq.defaultResponse = 1;
-  keZclReq.ZCL_Notify = keSendEphemeralDataCommandRespHandler;
-  keState = ZCL_KE_CLUSTER_EPHEMERAL_DATA_COMMAND_SENDING_STATE;
-
-  ZCL_CommandReq(&keZclReq);
+
+  session->state = ZCL_KE_CLUSTER_EPHEMERAL_DATA_COMMAND_SENDING_STATE;
+  keSendCommand(session, ZCL_KE_EPHEMERAL_DATA_REQUEST_COMMAND_ID, ZCL_KE_EPHEMERAL_DATA_RESPONSE_COMMAND_ID,
+    sizeof(ZCL_EphemeralDataCommand_t), keSendEphemeralDataCommandRespHandler);
 }
 
 /*************************************************************************************//**
@@ -788,22 +1055,35 @@ static void keSendEphemeralDataCommand(void)
 ******************************************************************************************/
 static void keSendEphemeralDataCommandRespHandler(ZCL_Notify_t *zclResp)
 {
-  sysAssert(ZCL_KE_CLUSTER_EPHEMERAL_DATA_COMMAND_SENDING_STATE == keState, KE_WRONG_STATE_1);
+  ZclKeSession_t *session = keGetSessionByNotify(zclResp);
+
+  session->reqBusy = false;
+  if (!keSessionIsActive(session))
+    return; // session was stopped while the command was being sent
+
+  sysAssert(ZCL_KE_CLUSTER_EPHEMERAL_DATA_COMMAND_SENDING_STATE == session->state, KE_WRONG_STATE_1);
   if (ZCL_SUCCESS_STATUS == zclResp->status)
   {
-    if (!keSrvMode)
+    if (!session->srvMode)
     {
-      keState = ZCL_KE_CLUSTER_EPHEMERAL_DATA_COMMAND_WAITING_STATE;
-      keSetTimeoutInSec(keRemoteEphemeralDataGenerateTime, keTimeoutHandler);
+      /* If response was already received - continue Key Establishment */
+      if (session->postponedProcessing)
+      {
+        session->postponedProcessing = false;
+        keScheduleEcc(session, ZCL_KE_ECC_KEY_BITS_STEP);
+        return;
+      }
+      session->state = ZCL_KE_CLUSTER_EPHEMERAL_DATA_COMMAND_WAITING_STATE;
+      keSetTimeoutInSec(session, session->remoteEphemeralDataGenerateTime, keTimeoutHandler);
     }
     else
     {
-      keSetTimeoutInSec(keRemoteConfirmKeyGenerateTime, keTimeoutHandler);
-      keGenerateKey();
+      keSetTimeoutInSec(session, session->remoteConfirmKeyGenerateTime, keTimeoutHandler);
+      keScheduleEcc(session, ZCL_KE_ECC_KEY_BITS_STEP);
     }
   }
   else
-    keStopKe(ZCL_SECURITY_STATUS_SEND_COMMAND_FAIL);
+    keStopKe(session, ZCL_SECURITY_STATUS_SEND_COMMAND_FAIL);
 }
 
 /*************************************************************************************//**
@@ -819,37 +1099,33 @@ static ZCL_Status_t ephemeralDataCommandIndHandler(ZCL_Addressing_t *addressing,
   uint8_t payloadLength, ZCL_EphemeralDataCommand_t *payload)
 {
   ZCL_TKEStatus_t tkeStatus = ZCL_TKE_NO_STATUS;
-  keCancelTimeout();
+  // Server (Responder) if the command is sent by the client, Client (Initiator) otherwise
+  bool srvMode = (ZCL_CLUSTER_SIDE_CLIENT == addressing->clusterSide);
+  ZclKeSession_t *session = keFindSession(addressing, srvMode);
 
   (void) payloadLength;
 
-  if (ZCL_CLUSTER_SIDE_CLIENT == addressing->clusterSide)
-    //Server (Responder)
-    keSrvMode = true;
-  else
-    //Client (Initiator)
-    keSrvMode = false;
-
   //Some parameters checking
-  if (keIncomingCmdIsValid(addressing))
+  if (session && keIncomingCmdIsValid(session, addressing))
   {
-    if (keSrvMode)
+    keCancelTimeout(session);
+    if (srvMode)
     {
-      keSeqNum = addressing->sequenceNumber;
-      tkeStatus = keEphemeralDataReqProcessing(addressing, payload);
+      session->seqNum = addressing->sequenceNumber;
+      tkeStatus = keEphemeralDataReqProcessing(session, payload);
     }
     else
-      tkeStatus = keEphemeralDataRespProcessing(addressing, payload);
+      tkeStatus = keEphemeralDataRespProcessing(session, payload);
   }
   else
     tkeStatus = ZCL_TKE_BAD_MESSAGE_STATUS;
 
   if (ZCL_TKE_NO_STATUS != tkeStatus)
   {
-    keSendTerminateKECommand(addressing->addr.shortAddress, addressing->endpointId, tkeStatus);
+    keTerminateSession(session, addressing, srvMode, tkeStatus);
   }
 
-  SYS_PostEvent((keSrvMode) ? BC_EVENT_KE_CLUSTER_EPH_DATA_REQ : BC_EVENT_KE_CLUSTER_EPH_DATA_RESP, (uintptr_t)payload);
+  SYS_PostEvent((srvMode) ? BC_EVENT_KE_CLUSTER_EPH_DATA_REQ : BC_EVENT_KE_CLUSTER_EPH_DATA_RESP, (uintptr_t)payload);
 
   return ZCL_SUCCESS_STATUS;
 }
@@ -857,32 +1133,32 @@ static ZCL_Status_t ephemeralDataCommandIndHandler(ZCL_Addressing_t *addressing,
 /*************************************************************************************//**
   \brief Processes Ephemeral Data Request command.
 
-  \param addressing - command's source address information
+  \param session - responder session
   \param payload - command payload
 
   \return processing status
 ******************************************************************************************/
-static ZCL_TKEStatus_t keEphemeralDataReqProcessing(ZCL_Addressing_t *addressing,
+static ZCL_TKEStatus_t keEphemeralDataReqProcessing(ZclKeSession_t *session,
   ZCL_EphemeralDataCommand_t *payload)
 {
-  (void)addressing;
-  postponedProcessing = (ZCL_KE_CLUSTER_INITIATE_KE_COMMAND_SENDING_STATE == keState);
+  session->postponedProcessing = (ZCL_KE_CLUSTER_INITIATE_KE_COMMAND_SENDING_STATE == session->state);
 
-  if (ZCL_KE_CLUSTER_EPHEMERAL_DATA_COMMAND_WAITING_STATE == keState || postponedProcessing)
+  if (ZCL_KE_CLUSTER_EPHEMERAL_DATA_COMMAND_WAITING_STATE == session->state || session->postponedProcessing)
   {
     //Save the remote node Ephemeral Public Key
-    memcpy(keRemoteEphemeralPublicKey, payload->data, SECT163K1_COMPRESSED_PUBLIC_KEY_SIZE);
-    if (!postponedProcessing)
+    memcpy(session->remoteEphemeralPublicKey, payload->data, SECT163K1_COMPRESSED_PUBLIC_KEY_SIZE);
+    if (!session->postponedProcessing)
     {
 #ifdef _ZSE_CERTIFICATION_
       if (useDelay)
       {
+        delaySession = session;
         delayTimer.interval = (uint32_t)ephemeralDataGenerateDelay * 1000;
         HAL_StartAppTimer(&delayTimer);
       }
       else
 #endif // _ZSE_CERTIFICATION_
-      keSendEphemeralDataCommand();
+      keSendEphemeralDataCommand(session);
     }
     return ZCL_TKE_NO_STATUS;
   }
@@ -893,22 +1169,23 @@ static ZCL_TKEStatus_t keEphemeralDataReqProcessing(ZCL_Addressing_t *addressing
 /*************************************************************************************//**
   \brief Processes Ephemeral Data Response command.
 
-  \param addressing - command's source address information
+  \param session - initiator session
   \param payload - command payload
 
   \return processing status
 ******************************************************************************************/
-static ZCL_TKEStatus_t keEphemeralDataRespProcessing(ZCL_Addressing_t *addressing,
+static ZCL_TKEStatus_t keEphemeralDataRespProcessing(ZclKeSession_t *session,
   ZCL_EphemeralDataCommand_t *payload)
 {
-  (void)addressing;
-  postponedProcessing = (ZCL_KE_CLUSTER_EPHEMERAL_DATA_COMMAND_SENDING_STATE == keState);
+  session->postponedProcessing = (ZCL_KE_CLUSTER_EPHEMERAL_DATA_COMMAND_SENDING_STATE == session->state);
 
-  if (ZCL_KE_CLUSTER_EPHEMERAL_DATA_COMMAND_WAITING_STATE == keState || postponedProcessing)
+  if (ZCL_KE_CLUSTER_EPHEMERAL_DATA_COMMAND_WAITING_STATE == session->state || session->postponedProcessing)
   {
     //Save the remote node Ephemeral Public Key
-    memcpy(keRemoteEphemeralPublicKey, payload->data, SECT163K1_COMPRESSED_PUBLIC_KEY_SIZE);
-    keGenerateKey();
+    memcpy(session->remoteEphemeralPublicKey, payload->data, SECT163K1_COMPRESSED_PUBLIC_KEY_SIZE);
+    // if the request is still being sent the key is generated on its confirmation
+    if (!session->postponedProcessing)
+      keScheduleEcc(session, ZCL_KE_ECC_KEY_BITS_STEP);
     return ZCL_TKE_NO_STATUS;
   }
   else
@@ -917,51 +1194,30 @@ static ZCL_TKEStatus_t keEphemeralDataRespProcessing(ZCL_Addressing_t *addressin
 
 /*************************************************************************************//**
   \brief Sends Confirm Key Data KE Command
+
+  \param session - session the command belongs to
 ******************************************************************************************/
-static void keSendConfirmKeyDataCommand(void)
+static void keSendConfirmKeyDataCommand(ZclKeSession_t *session)
 {
-  ZCL_ConfirmKeyCommand_t *buf = &keCommandPayloadBuffer.confirmKey;
+  ZCL_ConfirmKeyCommand_t *buf = &session->commandPayload.confirmKey;
 
   //Prepare payload
-
-  if (!keSrvMode)
+  if (!session->srvMode)
   {
-    memcpy(buf->mac, macuHash, AES_MMO_HASH_SIZE);
-
-    //ZCL KE Cluster Initiate Key Establishment Command Request sending
-    keZclReq.id = ZCL_KE_CONFIRM_KEY_DATA_REQUEST_COMMAND_ID;
-    keZclReq.dstAddressing.clusterSide = ZCL_CLUSTER_SIDE_SERVER;
-    keSeqNum = ZCL_GetNextSeqNumber();
-    keZclReq.dstAddressing.sequenceNumber = keSeqNum;
+    memcpy(buf->mac, session->macuHash, AES_MMO_HASH_SIZE);
 
     // the crutch to asynchornize data request
 #ifdef _ENDDEVICE_
     if (ZDO_StopSyncReq() == ZDO_SUCCESS_STATUS)
       ZDO_StartSyncReq();
 #endif /* _ENDDEVICE_ */
-
   }
   else
-  {
-    memcpy(buf->mac, macvHash, AES_MMO_HASH_SIZE);
-    //ZCL KE Cluster Initiate Key Establishment Command Response sending
-    keZclReq.id = ZCL_KE_CONFIRM_KEY_DATA_RESPONSE_COMMAND_ID;
-    keZclReq.dstAddressing.clusterSide = ZCL_CLUSTER_SIDE_CLIENT;
-    keZclReq.dstAddressing.sequenceNumber = keSeqNum;
-  }
-  keZclReq.dstAddressing.profileId  = PROFILE_ID_SMART_ENERGY;
-  keZclReq.dstAddressing.clusterId  = ZCL_KEY_ESTABLISHMENT_CLUSTER_ID;
-  keZclReq.dstAddressing.endpointId = keRemoteEndpoint;
-  keZclReq.dstAddressing.addrMode   = APS_SHORT_ADDRESS;
-  keZclReq.dstAddressing.addr.shortAddress = keRemoteShortAddr;
-  keZclReq.endpointId = keLocalEndpoint;
-
-  keZclReq.requestPayload = (uint8_t *) buf;
-  keZclReq.requestLength  = sizeof(ZCL_ConfirmKeyCommand_t);
-  keZclReq.defaultResponse = 1;
-  keZclReq.ZCL_Notify = keSendConfirmKeyDataCommandRespHandler;
-  keState = ZCL_KE_CLUSTER_CONFIRM_KEY_COMMAND_SENDING_STATE;
-  ZCL_CommandReq(&keZclReq);
+    memcpy(buf->mac, session->macvHash, AES_MMO_HASH_SIZE);
+
+  session->state = ZCL_KE_CLUSTER_CONFIRM_KEY_COMMAND_SENDING_STATE;
+  keSendCommand(session, ZCL_KE_CONFIRM_KEY_DATA_REQUEST_COMMAND_ID, ZCL_KE_CONFIRM_KEY_DATA_RESPONSE_COMMAND_ID,
+    sizeof(ZCL_ConfirmKeyCommand_t), keSendConfirmKeyDataCommandRespHandler);
 }
 
 /*************************************************************************************//**
@@ -971,30 +1227,33 @@ static void keSendConfirmKeyDataCommand(void)
 ******************************************************************************************/
 static void keSendConfirmKeyDataCommandRespHandler(ZCL_Notify_t *zclResp)
 {
-  sysAssert(ZCL_KE_CLUSTER_CONFIRM_KEY_COMMAND_SENDING_STATE == keState, KE_WRONG_STATE_2);
+  ZclKeSession_t *session = keGetSessionByNotify(zclResp);
+
+  session->reqBusy = false;
+  if (!keSessionIsActive(session))
+    return; // session was stopped while the command was being sent
+
+  sysAssert(ZCL_KE_CLUSTER_CONFIRM_KEY_COMMAND_SENDING_STATE == session->state, KE_WRONG_STATE_2);
   if (ZCL_SUCCESS_STATUS == zclResp->status)
   {
-    if (!keSrvMode)
+    if (!session->srvMode)
     {
-      if (postponedProcessing)
+      if (session->postponedProcessing)
       {
-        keSwitchKey();
-        postponedProcessing = false;
+        session->postponedProcessing = false;
+        keSwitchKey(session);
       }
       else
       {
-        keState = ZCL_KE_CLUSTER_CONFIRM_KEY_COMMAND_WAITING_STATE;
-        keSetTimeoutInSec(keRemoteConfirmKeyGenerateTime, keTimeoutHandler);
+        session->state = ZCL_KE_CLUSTER_CONFIRM_KEY_COMMAND_WAITING_STATE;
+        keSetTimeoutInSec(session, session->remoteConfirmKeyGenerateTime, keTimeoutHandler);
       }
     }
     else
-    {
-      keState = ZCL_KE_CLUSTER_IDLE_STATE;
-      keSwitchKey();
-    }
+      keSwitchKey(session);
   }
   else
-    keStopKe(ZCL_SECURITY_STATUS_SEND_COMMAND_FAIL);
+    keStopKe(session, ZCL_SECURITY_STATUS_SEND_COMMAND_FAIL);
 }
 
 /*************************************************************************************//**
@@ -1010,36 +1269,32 @@ static ZCL_Status_t confirmKeyDataCommandIndHandler(ZCL_Addressing_t *addressing
   uint8_t payloadLength, ZCL_ConfirmKeyCommand_t *payload)
 {
   ZCL_TKEStatus_t tkeStatus = ZCL_TKE_NO_STATUS;
+  // Server (Responder) if the command is sent by the client, Client (Initiator) otherwise
+  bool srvMode = (ZCL_CLUSTER_SIDE_CLIENT == addressing->clusterSide);
+  ZclKeSession_t *session = keFindSession(addressing, srvMode);
 
-  if (ZCL_CLUSTER_SIDE_CLIENT == addressing->clusterSide)
-    //Server (Responder)
-    keSrvMode = true;
-  else
-    //Client (Initiator)
-    keSrvMode = false;
-
-  keCancelTimeout();
-  SYS_PostEvent((keSrvMode) ? BC_EVENT_KE_CLUSTER_CONF_KEY_REQ : BC_EVENT_KE_CLUSTER_CONF_KEY_RESP, (uintptr_t)payload);
+  SYS_PostEvent((srvMode) ? BC_EVENT_KE_CLUSTER_CONF_KEY_REQ : BC_EVENT_KE_CLUSTER_CONF_KEY_RESP, (uintptr_t)payload);
 
   (void) payloadLength;
 
   //Some parameters checking
-  if (keIncomingCmdIsValid(addressing))
+  if (session && keIncomingCmdIsValid(session, addressing))
   {
-    if (keSrvMode)
+    keCancelTimeout(session);
+    if (srvMode)
     {
-      keSeqNum = addressing->sequenceNumber;
-      tkeStatus = keConfirmKeyReqProcessing(addressing, payload);
+      session->seqNum = addressing->sequenceNumber;
+      tkeStatus = keConfirmKeyReqProcessing(session, payload);
     }
     else
-      tkeStatus = keConfirmKeyRespProcessing(addressing, payload);
+      tkeStatus = keConfirmKeyRespProcessing(session, payload);
   }
   else
     tkeStatus = ZCL_TKE_BAD_MESSAGE_STATUS;
 
   if (ZCL_TKE_NO_STATUS != tkeStatus)
   {
-    keSendTerminateKECommand(addressing->addr.shortAddress, addressing->endpointId, tkeStatus);
+    keTerminateSession(session, addressing, srvMode, tkeStatus);
   }
 
   return ZCL_SUCCESS_STATUS;
@@ -1048,35 +1303,34 @@ static ZCL_Status_t confirmKeyDataCommandIndHandler(ZCL_Addressing_t *addressing
 /*************************************************************************************//**
   \brief Processes Confirm Key Request command.
 
-  \param addressing - command's source address information
+  \param session - responder session
   \param payload - command payload
 
   \return processing status
 ******************************************************************************************/
-static ZCL_TKEStatus_t keConfirmKeyReqProcessing(ZCL_Addressing_t *addressing,
+static ZCL_TKEStatus_t keConfirmKeyReqProcessing(ZclKeSession_t *session,
   ZCL_ConfirmKeyCommand_t *payload)
 {
-  (void)addressing;
-
-  if (ZCL_KE_CLUSTER_CONFIRM_KEY_COMMAND_WAITING_STATE == keState)
+  if (ZCL_KE_CLUSTER_CONFIRM_KEY_COMMAND_WAITING_STATE == session->state)
   { // data has already calculated. we can send reply
-    if (0 == memcmp(macuHash, payload->mac, AES_MMO_HASH_SIZE))
+    if (0 == memcmp(session->macuHash, payload->mac, AES_MMO_HASH_SIZE))
     {
 #ifdef _ZSE_CERTIFICATION_
       if (useDelay)
       {
+        delaySession = session;
         delayTimer.interval = (uint32_t)ephemeralDataGenerateDelay * 1000;
         HAL_StartAppTimer(&delayTimer);
       }
       else
 #endif // _ZSE_CERTIFICATION_
-        keSendConfirmKeyDataCommand();
+        keSendConfirmKeyDataCommand(session);
     }
     else
     {
 #ifdef _ZSE_CERTIFICATION_
       if (passBadCertificates)
-        keSendConfirmKeyDataCommand();//return ZCL_TKE_NO_STATUS;
+        keSendConfirmKeyDataCommand(session);//return ZCL_TKE_NO_STATUS;
       else
 #endif // _ZSE_CERTIFICATION_
         return ZCL_TKE_BAD_KEY_CONFIRM_STATUS;
@@ -1084,8 +1338,8 @@ static ZCL_TKEStatus_t keConfirmKeyReqProcessing(ZCL_Addressing_t *addressing,
   }
   else
   { // data has not been ready. Store received hash to compare later
-    postponedProcessing = true;
-    memcpy(receivedMacuHash, payload->mac, AES_MMO_HASH_SIZE);
+    session->postponedProcessing = true;
+    memcpy(session->receivedMacuHash, payload->mac, AES_MMO_HASH_SIZE);
   }
 
   return ZCL_TKE_NO_STATUS;
@@ -1094,18 +1348,17 @@ static ZCL_TKEStatus_t keConfirmKeyReqProcessing(ZCL_Addressing_t *addressing,
 /*************************************************************************************//**
   \brief Processes Confirm Key Response command.
 
-  \param addressing - command's source address information
+  \param session - initiator session
   \param payload - command payload
 
   \return processing status
 ******************************************************************************************/
-static ZCL_TKEStatus_t keConfirmKeyRespProcessing(ZCL_Addressing_t *addressing,
+static ZCL_TKEStatus_t keConfirmKeyRespProcessing(ZclKeSession_t *session,
   ZCL_ConfirmKeyCommand_t *payload)
 {
-  (void)addressing;
-  postponedProcessing = (ZCL_KE_CLUSTER_CONFIRM_KEY_COMMAND_SENDING_STATE == keState);
+  session->postponedProcessing = (ZCL_KE_CLUSTER_CONFIRM_KEY_COMMAND_SENDING_STATE == session->state);
 
-  if (ZCL_KE_CLUSTER_CONFIRM_KEY_COMMAND_WAITING_STATE == keState || postponedProcessing)
+  if (ZCL_KE_CLUSTER_CONFIRM_KEY_COMMAND_WAITING_STATE == session->state || session->postponedProcessing)
   {
 #ifdef _ENDDEVICE_
      // restore indirect poll rate
@@ -1115,10 +1368,10 @@ static ZCL_TKEStatus_t keConfirmKeyRespProcessing(ZCL_Addressing_t *addressing,
 
      keIndirectPollRate = oldIndirectPollRate;
 #endif /* _ENDDEIVE_ */
-    if (0 == memcmp(macvHash, payload->mac, AES_MMO_HASH_SIZE))
+    if (0 == memcmp(session->macvHash, payload->mac, AES_MMO_HASH_SIZE))
     {
-      if (!postponedProcessing)
-        keSwitchKey();
+      if (!session->postponedProcessing)
+        keSwitchKey(session);
     }
     else
     {
@@ -1136,9 +1389,11 @@ static ZCL_TKEStatus_t keConfirmKeyRespProcessing(ZCL_Addressing_t *addressing,
 
   \param shortAddr - ahort destanation address of the command
   \param endpoint - command destination endpoint
+  \param srvMode - true if the local device is the responder
   \param status - statu of KE Terminate command
 ******************************************************************************************/
-static void keSendTerminateKECommand(ShortAddr_t shortAddr, Endpoint_t endpoint, ZCL_TKEStatus_t status)
+static void keSendTerminateKECommand(ShortAddr_t shortAddr, Endpoint_t endpoint, bool srvMode,
+  ZCL_TKEStatus_t status)
 {
   ZCL_TerminateKeyEstablishmentCommand_t *buf = &keTerminateKEPayload;
 
@@ -1155,12 +1410,11 @@ static void keSendTerminateKECommand(ShortAddr_t shortAddr, Endpoint_t endpoint,
     keTerminateZclReq.dstAddressing.endpointId = endpoint;
     keTerminateZclReq.dstAddressing.addrMode   = APS_SHORT_ADDRESS;
     keTerminateZclReq.dstAddressing.addr.shortAddress = shortAddr;
-    if (!keSrvMode)
+    if (!srvMode)
       keTerminateZclReq.dstAddressing.clusterSide = ZCL_CLUSTER_SIDE_SERVER;
     else
       keTerminateZclReq.dstAddressing.clusterSide = ZCL_CLUSTER_SIDE_CLIENT;
-    keSeqNum = ZCL_GetNextSeqNumber();
-    keTerminateZclReq.dstAddressing.sequenceNumber = keSeqNum;
+    keTerminateZclReq.dstAddressing.sequenceNumber = ZCL_GetNextSeqNumber();
 
     keTerminateZclReq.requestPayload = (uint8_t *) buf;
     keTerminateZclReq.requestLength  = sizeof(ZCL_TerminateKeyEstablishmentCommand_t);
@@ -1168,18 +1422,28 @@ static void keSendTerminateKECommand(ShortAddr_t shortAddr, Endpoint_t endpoint,
     keTerminateZclReq.ZCL_Notify = keSendTerminateKECommandRespHandler;
     keTerminateReqBusy = true;
 
-    if ((keRemoteShortAddr == shortAddr) &&
-        (keRemoteEndpoint == endpoint))
-    {
-      keRemoteExtAddr = ZCL_KE_INVALID_EXT_ADDRESS;
-      keRemoteShortAddr = ZCL_KE_INVALID_SHORT_ADDRESS;
-      keRemoteEndpoint  = ZCL_KE_INVALID_ENDPOINT;
-    }
-
     ZCL_CommandReq(&keTerminateZclReq);
   }
 }
 
+/*************************************************************************************//**
+  \brief Sends KE Terminate command to the command originator and stops the session
+    with it, if any.
+
+  \param session - session with the command originator, NULL if none
+  \param addressing - command's source address information
+  \param srvMode - true if the local device is the responder
+  \param status - status of KE Terminate command
+******************************************************************************************/
+static void keTerminateSession(ZclKeSession_t *session, ZCL_Addressing_t *addressing, bool srvMode,
+  ZCL_TKEStatus_t status)
+{
+  keSendTerminateKECommand(addressing->addr.shortAddress, addressing->endpointId, srvMode, status);
+
+  if (session)
+    keStopKe(session, ZCL_SECURITY_STATUS_TERMINATED);
+}
+
 /*************************************************************************************//**
   \brief Response handler for KE Terminate Command.
 
@@ -1190,12 +1454,6 @@ static void keSendTerminateKECommandRespHandler(ZCL_Notify_t *zclResp)
   (void)zclResp;
 
   sysAssert(keTerminateReqBusy, KE_WRONG_STATE_5);
-  if ((ZCL_KE_INVALID_ENDPOINT == keRemoteEndpoint) ||
-      (ZCL_KE_INVALID_SHORT_ADDRESS == keRemoteShortAddr) ||
-      (ZCL_KE_INVALID_EXT_ADDRESS == keRemoteExtAddr))
-  {
-    keStopKe(ZCL_SECURITY_STATUS_TERMINATED);
-  }
   keTerminateReqBusy = false;
 }
 
@@ -1211,28 +1469,23 @@ static void keSendTerminateKECommandRespHandler(ZCL_Notify_t *zclResp)
 static ZCL_Status_t terminateKECommandIndHandler(ZCL_Addressing_t *addressing,
   uint8_t payloadLength, ZCL_TerminateKeyEstablishmentCommand_t *payload)
 {
+  // Server (Responder) if the command is sent by the client, Client (Initiator) otherwise
+  bool srvMode = (ZCL_CLUSTER_SIDE_CLIENT == addressing->clusterSide);
+  ZclKeSession_t *session = keFindSession(addressing, srvMode);
+
   (void) payloadLength;
 
-  if ((keRemoteShortAddr == addressing->addr.shortAddress) &&
-     ((APS_EXT_ADDRESS != addressing->addrMode) || (keRemoteExtAddr == addressing->addr.extAddress)) &&
-     (keRemoteEndpoint == addressing->endpointId))
+  if (session)
   {
-    postponedProcessing = false;
-    if (keIsRequestInProgress())
+    session->postponedProcessing = false;
+    if (keIsRequestInProgress(session))
       return ZCL_SUCCESS_STATUS;
 
-    if (ZCL_CLUSTER_SIDE_CLIENT == addressing->clusterSide)
-      //Server (Responder)
-      keSrvMode = true;
-    else
-      //Client (Initiator)
-      keSrvMode = false;
-
     switch (payload->statusCode)
     {
       case ZCL_TKE_NO_RESOURCES_STATUS:
-        keState = ZCL_KE_CLUSTER_WAITING_STATE;
-        keSetTimeoutInSec(payload->waitTime, restartKEFired);
+        session->state = ZCL_KE_CLUSTER_WAITING_STATE;
+        keSetTimeoutInSec(session, payload->waitTime, restartKEFired);
         break;
       case ZCL_TKE_BAD_MESSAGE_STATUS:
       case ZCL_TKE_UNSUPPORTED_SUITE_STATUS:
@@ -1247,7 +1500,7 @@ static ZCL_Status_t terminateKECommandIndHandler(ZCL_Addressing_t *addressing,
       case ZCL_TKE_BAD_KEY_CONFIRM_STATUS:
          /* Add ext addr to black list */
       default:
-        keStopKe(ZCL_SECURITY_STATUS_TERMINATED);
+        keStopKe(session, ZCL_SECURITY_STATUS_TERMINATED);
         break;
     }
   }
@@ -1257,62 +1510,55 @@ static ZCL_Status_t terminateKECommandIndHandler(ZCL_Addressing_t *addressing,
 }
 
 /*************************************************************************************//**
-  \brief
+  \brief Derives the keying data from the shared secret of the session and starts
+    MAC calculation.
 
-  \param
-  \return
+  \param session - session the key is generated for
 ******************************************************************************************/
-static void keGenerateKey(void)
+static void keGenerateKey(ZclKeSession_t *session)
 {
   uint8_t hash1[25];
   uint8_t hash2[25];
-  uint8_t *keLocalPrivateKey = keCertificateDescriptor.privateKey;
-  uint8_t *keLocalPublicKey = keCertificateDescriptor.publicKey;
 
-  //Derive the shared secret using the ECMQV primitive
-  //Z = ECC_GenerateSharedSecret
-  ZSE_ECCKeyBitGenerate(keLocalPrivateKey , keLocalEphemeralPrivateKey, keLocalEphemeralPublicKey,
-                          keRemoteCertificate, keRemoteEphemeralPublicKey, keLocalPublicKey /*CA Public Key*/,
-                          keLocalKeyBits, SSP_BcbHash, yield, YIELD_LEVEL);
   //Derive the Keying data
   //Hash-1 = Z || 00 00 00 01 || SharedData
   //Hash-2 = Z || 00 00 00 02 || SharedData
 
   //Hash-1
   //Concatenation
-  memcpy((uint8_t *) hash1, keLocalKeyBits, SECT163K1_SHARED_SECRET_SIZE /*21*/);
+  memcpy((uint8_t *) hash1, session->keyBits, SECT163K1_SHARED_SECRET_SIZE /*21*/);
   hash1[21] = 0; hash1[22] = 0; hash1[23] = 0; hash1[24] = 1;
 
   //hash
-  SSP_BcbHash(digest1, 25, hash1);
+  SSP_BcbHash(session->digest1, 25, hash1);
 
 
   //Hash-2
   //Concatenation
-  memcpy((uint8_t *) hash2, keLocalKeyBits, SECT163K1_SHARED_SECRET_SIZE /*21*/);
+  memcpy((uint8_t *) hash2, session->keyBits, SECT163K1_SHARED_SECRET_SIZE /*21*/);
   hash2[21] = 0; hash2[22] = 0; hash2[23] = 0; hash2[24] = 2;
 
   //hash
-  SSP_BcbHash(digest2, 25, hash2);
+  SSP_BcbHash(session->digest2, 25, hash2);
 
-  keCalculateMac1();
+  keMacSession = session;
+  keCalculateMac1(session);
 }
 
 /*************************************************************************************//**
-  \brief
+  \brief Starts calculation of the MAC sent by the local device.
 
-  \param
-  \return
+  \param session - session owning the MAC calculation
 ******************************************************************************************/
-static void keCalculateMac1(void)
+static void keCalculateMac1(ZclKeSession_t *session)
 {
-  ZclCertificate_t *remoteCertificate = (ZclCertificate_t *) &keRemoteCertificate;
+  ZclCertificate_t *remoteCertificate = (ZclCertificate_t *) &session->remoteCertificate;
   CHECK_GUARDS(&macBuf, ZCL_MEMORY_CORRUPTION_1);
   uint8_t *dst = macBuf.macData;
 
-  keState = ZCL_KE_CLUSTER_MAC1_CALCULATING_STATE;
+  session->state = ZCL_KE_CLUSTER_MAC1_CALCULATING_STATE;
 
-  if (!keSrvMode)
+  if (!session->srvMode)
   {
     *dst = ZCL_KE_INITATOR_ADDITIONAL_MESSAGE_COMPONENT;
   }
@@ -1332,55 +1578,65 @@ static void keCalculateMac1(void)
     sizeof(ExtAddr_t));
   dst += sizeof(ExtAddr_t);
 
-  memcpy(dst, keLocalEphemeralPublicKey, SECT163K1_COMPRESSED_PUBLIC_KEY_SIZE);
+  memcpy(dst, session->localEphemeralPublicKey, SECT163K1_COMPRESSED_PUBLIC_KEY_SIZE);
   dst += SECT163K1_COMPRESSED_PUBLIC_KEY_SIZE;
 
-  memcpy(dst, keRemoteEphemeralPublicKey, SECT163K1_COMPRESSED_PUBLIC_KEY_SIZE);
+  memcpy(dst, session->remoteEphemeralPublicKey, SECT163K1_COMPRESSED_PUBLIC_KEY_SIZE);
 
   sspKeyedHashReq.text = macBuf.macData;
-  sspKeyedHashReq.key = digest1;
+  sspKeyedHashReq.key = session->digest1;
   sspKeyedHashReq.textSize = ZCL_KE_MAC_DATA_SIZE;
-  if (!keSrvMode)
+  if (!session->srvMode)
   {
-    sspKeyedHashReq.hash_i = macuHash;
+    sspKeyedHashReq.hash_i = session->macuHash;
   }
   else
   {
-    sspKeyedHashReq.hash_i = macvHash;
+    sspKeyedHashReq.hash_i = session->macvHash;
   }
   sspKeyedHashReq.SSP_KeyedHashMacConf = mac1Conf;
   SSP_KeyedHashMacReq(&sspKeyedHashReq);
 }
 
 /*************************************************************************************//**
-  \brief
+  \brief Releases the MAC calculation and resumes the ECC scheduler.
+******************************************************************************************/
+static void keReleaseMac(void)
+{
+  keMacSession = NULL;
+  zclPostTask(ZCL_KE_TASK_ID);
+}
 
-  \param
-  \return
+/*************************************************************************************//**
+  \brief Confirmation of the first MAC calculation.
 ******************************************************************************************/
 static void mac1Conf(void)
 {
-  if (ZCL_KE_CLUSTER_MAC1_CALCULATING_STATE == keState)
+  ZclKeSession_t *session = keMacSession;
+
+  sysAssert(session, KE_WRONG_STATE_3);
+  if (ZCL_KE_CLUSTER_MAC1_CALCULATING_STATE == session->state)
   {
-    keCalculateMac2();
+    keCalculateMac2(session);
   }
+  else
+    keReleaseMac(); // session was stopped
 }
 
 /*************************************************************************************//**
-  \brief
+  \brief Starts calculation of the MAC expected from the remote device.
 
-  \param
-  \return
+  \param session - session owning the MAC calculation
 ******************************************************************************************/
-static void keCalculateMac2(void)
+static void keCalculateMac2(ZclKeSession_t *session)
 {
-  ZclCertificate_t *remoteCertificate = (ZclCertificate_t *) &keRemoteCertificate;
+  ZclCertificate_t *remoteCertificate = (ZclCertificate_t *) &session->remoteCertificate;
   CHECK_GUARDS(&macBuf, ZCL_MEMORY_CORRUPTION_2);
   uint8_t *dst = macBuf.macData;
 
-  keState = ZCL_KE_CLUSTER_MAC2_CALCULATING_STATE;
+  session->state = ZCL_KE_CLUSTER_MAC2_CALCULATING_STATE;
 
-  if (!keSrvMode)
+  if (!session->srvMode)
   {
     *dst = ZCL_KE_RESPONDER_ADDITIONAL_MESSAGE_COMPONENT;
   }
@@ -1400,21 +1656,21 @@ static void keCalculateMac2(void)
     sizeof(ExtAddr_t));
   dst += sizeof(ExtAddr_t);
 
-  memcpy(dst, keRemoteEphemeralPublicKey, SECT163K1_COMPRESSED_PUBLIC_KEY_SIZE);
+  memcpy(dst, session->remoteEphemeralPublicKey, SECT163K1_COMPRESSED_PUBLIC_KEY_SIZE);
   dst += SECT163K1_COMPRESSED_PUBLIC_KEY_SIZE;
 
-  memcpy(dst, keLocalEphemeralPublicKey, SECT163K1_COMPRESSED_PUBLIC_KEY_SIZE);
+  memcpy(dst, session->localEphemeralPublicKey, SECT163K1_COMPRESSED_PUBLIC_KEY_SIZE);
 
   sspKeyedHashReq.text = macBuf.macData;
-  sspKeyedHashReq.key = digest1;
+  sspKeyedHashReq.key = session->digest1;
   sspKeyedHashReq.textSize = ZCL_KE_MAC_DATA_SIZE;
-  if (!keSrvMode)
+  if (!session->srvMode)
   {
-    sspKeyedHashReq.hash_i = macvHash;
+    sspKeyedHashReq.hash_i = session->macvHash;
   }
   else
   {
-    sspKeyedHashReq.hash_i = macuHash;
+    sspKeyedHashReq.hash_i = session->macuHash;
   }
 
   sspKeyedHashReq.SSP_KeyedHashMacConf = mac2Conf;
@@ -1422,134 +1678,202 @@ static void keCalculateMac2(void)
 }
 
 /*************************************************************************************//**
-  \brief
-
-  \param
-  \return
+  \brief Confirmation of the second MAC calculation. Continues Key Establishment.
 ******************************************************************************************/
 static void mac2Conf(void)
 {
+  ZclKeSession_t *session = keMacSession;
+
   CHECK_GUARDS(&macBuf, ZCL_MEMORY_CORRUPTION_3);
-  if (ZCL_KE_CLUSTER_MAC2_CALCULATING_STATE == keState)
+  sysAssert(session, KE_WRONG_STATE_3);
+  keReleaseMac();
+
+  if (ZCL_KE_CLUSTER_MAC2_CALCULATING_STATE == session->state)
   {
-    if (!keSrvMode)
+    if (!session->srvMode)
     {
-      if (!postponedProcessing)
+      if (!session->postponedProcessing)
       {
 #ifdef _ZSE_CERTIFICATION_
         if (useDelay)
         {
+          delaySession = session;
           delayTimer.interval = (uint32_t)confirmKeyGenerateDelay * 1000;
           HAL_StartAppTimer(&delayTimer);
         }
         else
 #endif // _ZSE_CERTIFICATION_
-          keSendConfirmKeyDataCommand();
+          keSendConfirmKeyDataCommand(session);
       }
     }
     else
     {
-      if (postponedProcessing)
+      if (session->postponedProcessing)
       {
-        postponedProcessing = false;
-        if (0 == memcmp(macuHash, receivedMacuHash, AES_MMO_HASH_SIZE))
-          keSendConfirmKeyDataCommand();
+        session->postponedProcessing = false;
+        if (0 == memcmp(session->macuHash, session->receivedMacuHash, AES_MMO_HASH_SIZE))
+          keSendConfirmKeyDataCommand(session);
         else
-          keSendTerminateKECommand(keRemoteShortAddr, keRemoteEndpoint, ZCL_TKE_BAD_KEY_CONFIRM_STATUS);
+        {
+          keSendTerminateKECommand(session->remoteShortAddr, session->remoteEndpoint, true,
+            ZCL_TKE_BAD_KEY_CONFIRM_STATUS);
+          keStopKe(session, ZCL_SECURITY_STATUS_TERMINATED);
+        }
       }
       else
-        keState = ZCL_KE_CLUSTER_CONFIRM_KEY_COMMAND_WAITING_STATE;
+        session->state = ZCL_KE_CLUSTER_CONFIRM_KEY_COMMAND_WAITING_STATE;
     }
   }
 }
 
 /*************************************************************************************//**
   \brief Sets new established key to APS and saves that KE procedure finished successfully.
+
+  \param session - finished session
 ******************************************************************************************/
-static void keSwitchKey(void)
+static void keSwitchKey(ZclKeSession_t *session)
 {
-  if (APS_KEY_HANDLE_IS_VALID(APS_SetLinkKey(&keRemoteExtAddr, digest2)))
+  if (APS_KEY_HANDLE_IS_VALID(APS_SetLinkKey(&session->remoteExtAddr, session->digest2)))
   {
-    APS_SetAuthorizedStatus(&keRemoteExtAddr, true);
+    APS_SetAuthorizedStatus(&session->remoteExtAddr, true);
 
-    SYS_PostEvent(BC_EVENT_UPDATE_LINK_KEY, (uintptr_t)&keRemoteExtAddr);
+    SYS_PostEvent(BC_EVENT_UPDATE_LINK_KEY, (uintptr_t)&session->remoteExtAddr);
 
-    if (!keSrvMode)
-    {
-      keStopKe(ZCL_SECURITY_STATUS_SUCCESS);
-    }
-    else
-      keSrvMode = false;
+    keStopKe(session, ZCL_SECURITY_STATUS_SUCCESS);
   }
+  else if (session->srvMode)
+    keStopKe(session, ZCL_SECURITY_STATUS_TERMINATED);
 }
 
 /*************************************************************************************//**
   \brief TimeOut Timer callback - restarts KE procedure after Terminate command with
     NO_RESOURCES status
+
+  \param session - session to be restarted
 ******************************************************************************************/
-static void restartKEFired(void)
+static void restartKEFired(ZclKeSession_t *session)
 {
-  sysAssert(ZCL_KE_CLUSTER_WAITING_STATE == keState, KE_WRONG_STATE_6);
-  keSendInitiateKECommand();
+  sysAssert(ZCL_KE_CLUSTER_WAITING_STATE == session->state, KE_WRONG_STATE_6);
+  keScheduleEcc(session, ZCL_KE_ECC_EPHEMERAL_KEY_STEP);
 }
 
 /*************************************************************************************//**
   \brief Timeout timer expired
+
+  \param session - session the timer belongs to
 ******************************************************************************************/
-static void keTimeoutHandler(void)
+static void keTimeoutHandler(ZclKeSession_t *session)
 {
-  sysAssert(!keIsRequestInProgress(), KE_WRONG_STATE_4);
-  keStopKe(ZCL_SECURITY_STATUS_TIMEOUT);
+  sysAssert(!keIsRequestInProgress(session), KE_WRONG_STATE_4);
+  keStopKe(session, ZCL_SECURITY_STATUS_TIMEOUT);
 }
 
 /*************************************************************************************//**
-  \brief Starts timeout timer
+  \brief Starts session's timeout timer
+  \param[in] session - session the timer belongs to
   \param[in] timeout - timeout in seconds
   \param[in] callback - timer callback function pointer
 ******************************************************************************************/
-static void keSetTimeoutInSec(uint16_t timeout, void (*callback)(void))
+static void keSetTimeoutInSec(ZclKeSession_t *session, uint16_t timeout,
+  void (*callback)(ZclKeSession_t *session))
 {
-  SYS_InitTimer(&keApsTimer, TIMER_ONE_SHOT_MODE, (uint32_t)timeout << 10ul, callback);
-  SYS_StartTimer(&keApsTimer);
+  session->deadline = HAL_GetSystemTime() + ((uint32_t)timeout << 10ul);
+  session->timeoutHandler = callback;
+  keRestartTimer();
 }
 
 /*************************************************************************************//**
-  \brief Stop Timeout timer
+  \brief Stops session's timeout timer. The shared timer is left running,
+    it is rescheduled on expiration.
+  \param[in] session - session the timer belongs to
 ******************************************************************************************/
-static void keCancelTimeout(void)
+static void keCancelTimeout(ZclKeSession_t *session)
 {
+  session->deadline = 0;
+}
+
+/*************************************************************************************//**
+  \brief Starts the shared timer to expire at the nearest session's deadline.
+******************************************************************************************/
+static void keRestartTimer(void)
+{
+  BcTime_t now = HAL_GetSystemTime();
+  BcTime_t nearest = 0;
+
+  for (uint8_t i = 0; i < ZCL_KE_MAX_SESSIONS; i++)
+  {
+    BcTime_t deadline = keSessions[i].deadline;
+
+    if (deadline && (!nearest || ((int32_t)(deadline - nearest) < 0)))
+      nearest = deadline;
+  }
+
   SYS_StopTimer(&keApsTimer);
+  if (nearest)
+  {
+    SYS_InitTimer(&keApsTimer, TIMER_ONE_SHOT_MODE,
+      ((int32_t)(nearest - now) > 0) ? (uint32_t)(nearest - now) : 1ul, keTimerFired);
+    SYS_StartTimer(&keApsTimer);
+  }
+}
+
+/*************************************************************************************//**
+  \brief Shared timer callback. Calls timeout handlers of the expired sessions.
+******************************************************************************************/
+static void keTimerFired(void)
+{
+  BcTime_t now = HAL_GetSystemTime();
+
+  for (uint8_t i = 0; i < ZCL_KE_MAX_SESSIONS; i++)
+  {
+    ZclKeSession_t *session = &keSessions[i];
+
+    if (session->deadline && ((int32_t)(now - session->deadline) >= 0))
+    {
+      session->deadline = 0;
+      session->timeoutHandler(session);
+    }
+  }
+
+  keRestartTimer();
 }
 
 /*************************************************************************************//**
-  \brief Stops KE
+  \brief Stops KE session
 
+  \param session - session to be stopped
   \param status - status of KE execution - to be passed to ZCL Security Manager
 ******************************************************************************************/
-static void keStopKe(ZCL_SecurityStatus_t status)
+static void keStopKe(ZclKeSession_t *session, ZCL_SecurityStatus_t status)
 {
-  if (ZCL_KE_MATCH_DESCRIPTOR_DISCOVERY_SENDING_STATE == keState)
+  if (ZCL_KE_MATCH_DESCRIPTOR_DISCOVERY_SENDING_STATE == session->state)
   {
-    keState = ZCL_KE_MATCH_DESCRIPTOR_DISCOVERY_TERMINATE_STATE;
+    session->state = ZCL_KE_MATCH_DESCRIPTOR_DISCOVERY_TERMINATE_STATE;
     return; // wait for ending of the match descriptor discovery
   }
 
-  keCancelTimeout();
-  postponedProcessing = false;
-  keState = ZCL_KE_CLUSTER_IDLE_STATE;
-  keNotification(status);
+  keCancelTimeout(session);
+  session->eccStep = ZCL_KE_ECC_NO_STEP;
+  session->ecc.operation = ZSE_ECC_NO_OPERATION;
+  session->postponedProcessing = false;
+  session->state = ZCL_KE_CLUSTER_IDLE_STATE;
+
+  // Only initiator session is started by ZCL Security Manager
+  if (!session->srvMode)
+    keNotification(status);
 }
 
 /*************************************************************************************//**
   \brief Detects wether KE is in progress or not
+  \param session - session to be checked
   \return true if KE procedure is in progress, false othewise.
 ******************************************************************************************/
-static bool keIsRequestInProgress(void)
+static bool keIsRequestInProgress(ZclKeSession_t *session)
 {
-  return keState == ZCL_KE_MATCH_DESCRIPTOR_DISCOVERY_SENDING_STATE
-      || keState == ZCL_KE_CLUSTER_INITIATE_KE_COMMAND_SENDING_STATE
-      || keState == ZCL_KE_CLUSTER_EPHEMERAL_DATA_COMMAND_SENDING_STATE
-      || keState == ZCL_KE_CLUSTER_CONFIRM_KEY_COMMAND_SENDING_STATE;
+  return session->state == ZCL_KE_MATCH_DESCRIPTOR_DISCOVERY_SENDING_STATE
+      || session->state == ZCL_KE_CLUSTER_INITIATE_KE_COMMAND_SENDING_STATE
+      || session->state == ZCL_KE_CLUSTER_EPHEMERAL_DATA_COMMAND_SENDING_STATE
+      || session->state == ZCL_KE_CLUSTER_CONFIRM_KEY_COMMAND_SENDING_STATE;
 }
 
 /*************************************************************************************//**
@@ -1576,14 +1900,19 @@ static void keCpyReverse(uint8_t *dst, uint8_t *src, uint8_t size)
 ******************************************************************************************/
 ZclCertificate_t *keGetCertificate(ExtAddr_t subject)
 {
-  uint8_t *result = NULL;
-
   SYS_Swap((uint8_t*)&subject, sizeof(ExtAddr_t));
-  if (((ZclCertificate_t *) keRemoteCertificate)->subject == subject)
-    result = keRemoteCertificate;
-  else if (keCertificateDescriptor.certificate.subject == subject)
-    result = keCertificateDescriptor.certificate.publicReconstrKey;
-  return (ZclCertificate_t *)result;
+
+  for (uint8_t i = 0; i < ZCL_KE_MAX_SESSIONS; i++)
+  {
+    ZclCertificate_t *certificate = (ZclCertificate_t *) keSessions[i].remoteCertificate;
+
+    if (keSessionIsActive(&keSessions[i]) && (certificate->subject == subject))
+      return certificate;
+  }
+
+  if (keCertificateDescriptor.certificate.subject == subject)
+    return (ZclCertificate_t *)keCertificateDescriptor.certificate.publicReconstrKey;
+  return NULL;
 }
 
 /*************************************************************************************//**
@@ -1631,14 +1960,16 @@ void setOutOfOrderResponse(void)
 *****************************************************************************/
 void delayTimerFired(void)
 {
-  if (ZCL_KE_CLUSTER_EPHEMERAL_DATA_COMMAND_WAITING_STATE == keState)
-    keSendEphemeralDataCommand();
-  if (ZCL_KE_CLUSTER_INITIATE_KE_COMMAND_WAITING_STATE == keState)
-    keSendEphemeralDataCommand();
-  if (ZCL_KE_CLUSTER_MAC2_CALCULATING_STATE == keState)
-    keSendConfirmKeyDataCommand();
-  if (ZCL_KE_CLUSTER_CONFIRM_KEY_COMMAND_WAITING_STATE == keState)
-    keSendConfirmKeyDataCommand();
+  ZclKeSession_t *session = delaySession;
+
+  if (ZCL_KE_CLUSTER_EPHEMERAL_DATA_COMMAND_WAITING_STATE == session->state)
+    keSendEphemeralDataCommand(session);
+  if (ZCL_KE_CLUSTER_INITIATE_KE_COMMAND_WAITING_STATE == session->state)
+    keSendEphemeralDataCommand(session);
+  if (ZCL_KE_CLUSTER_MAC2_CALCULATING_STATE == session->state)
+    keSendConfirmKeyDataCommand(session);
+  if (ZCL_KE_CLUSTER_CONFIRM_KEY_COMMAND_WAITING_STATE == session->state)
+    keSendConfirmKeyDataCommand(session);
 }
 
 void ZCL_KeSendTooLongCertificate(int8_t addLen)
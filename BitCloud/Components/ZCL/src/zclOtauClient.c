@@ -38,6 +38,7 @@ extern uint8_t otauInternalAddrStatus;
 extern uint32_t otauInternalLength;
 extern uint32_t otauFlashWriteOffset;
 extern uint32_t otauImageRemainder;
+extern OtauCheckpoint_t otauCheckpoint;
 #endif // APP_SUPPORT_OTAU_RECOVERY == 1
 
 extern ZCL_Status_t otauUpgradeEndStatus;
@@ -97,6 +98,11 @@ uint16_t otauPdsWriteFreqInBytes;
                         Static variables section
 *******************************************************************************/
 static uint8_t ofdWriteRetry;
+#if APP_SUPPORT_OTAU_RECOVERY == 1
+// end of the last completed flash page and the running checksum up to it
+static uint32_t verifiedLength;
+static uint8_t verifiedChecksum;
+#endif
 
 /******************************************************************************
                    Implementation section
@@ -233,13 +239,11 @@ void otauOpenOfdCallback(OFD_Status_t status)
 
 #if APP_SUPPORT_OTAU_RECOVERY == 1
   if (PDS_IsAbleToRestore(OTAU_IMGFILES_MEMORY_MEM_ID) &&
-      PDS_IsAbleToRestore(OTAU_AUXFILES_MEMORY_MEM_ID) &&
-      PDS_IsAbleToRestore(OTAU_OFFSETFILES_MEMORY_MEM_ID))
+      PDS_IsAbleToRestore(OTAU_OFFSETFILES_MEMORY_MEM_ID) &&
+      PDS_Restore(OTAU_IMGFILES_MEMORY_MEM_ID) &&
+      PDS_Restore(OTAU_OFFSETFILES_MEMORY_MEM_ID) &&
+      otauRestoreCheckpoint())
   {
-    PDS_Restore(OTAU_IMGFILES_MEMORY_MEM_ID);
-    PDS_Restore(OTAU_AUXFILES_MEMORY_MEM_ID);
-    PDS_Restore(OTAU_OFFSETFILES_MEMORY_MEM_ID);
-
     if (isExtAddrValid(otauServerExtAddr))
     {
       COPY_EXT_ADDR(serverExtAddr, otauServerExtAddr);
@@ -311,8 +315,7 @@ void otauSwitchCallback(OFD_Status_t status)
       // send upgrade end request with SUCCESS
 #if APP_SUPPORT_OTAU_RECOVERY == 1
       PDS_Store(OTAU_IMGFILES_MEMORY_MEM_ID);
-      PDS_Store(OTAU_AUXFILES_MEMORY_MEM_ID);
-      PDS_Store(OTAU_OFFSETFILES_MEMORY_MEM_ID);
+      otauSaveCheckpoint();
 #endif
       retryCount = otauMaxRetryCount;
       otauUpgradeEndStatus = ZCL_SUCCESS_STATUS;
@@ -397,24 +400,11 @@ void otauProcessSuccessfullWritingToFlash(void)
       OTAU_CHECK_STATE(stateMachine, OTAU_GET_IMAGE_PAGES_STATE) || \
       OTAU_CHECK_STATE(stateMachine, OTAU_GET_MISSED_BLOCKS_STATE))
   {
-#if APP_SUPPORT_OTAU_RECOVERY == 1
-    otauRunningChecksum = otauCalcCrc(otauRunningChecksum, tmpMemParam->data, tmpMemParam->length);
-#endif
-
     tmpMemParam->offset += tmpMemParam->length;
 
 #if APP_SUPPORT_OTAU_RECOVERY == 1
     otauFlashWriteOffset = tmpMemParam->offset;
-    
-    if (otauNextOffset >= otauNextPdsWriteOffset)
-    {
-      PDS_Store(OTAU_OFFSETFILES_MEMORY_MEM_ID);
-      otauNextPdsWriteOffset = otauNextOffset + otauPdsWriteFreqInBytes;
-      if (otauNextPdsWriteOffset > (otauImageSize-1))
-      {
-        otauNextPdsWriteOffset = (otauImageSize-1);
-      }
-    }
+    otauTrackCheckpoint(tmpMemParam);
 #endif
 
     if (0 == tmpAuxParam->imageInternalLength)
@@ -521,21 +511,149 @@ void otauClearPdsParams(void)
 {
   ExtAddr_t zeroAddr = ZERO_SERVER_EXT_ADDRESS;
 
-  otauRunningChecksum     = 0xFF;
-  otauNextOffset          = 0;
   otauImageVersion        = 0;
   otauImageSize           = 0;
-  otauInternalAddrStatus  = 0;
-  otauInternalLength      = 0;
-  otauFlashWriteOffset    = 0;
   otauImageRemainder      = 0;
+  otauResetCheckpoint();
   COPY_EXT_ADDR(otauServerExtAddr, zeroAddr);
 
   PDS_Store(OTAU_IMGFILES_MEMORY_MEM_ID);
-  PDS_Store(OTAU_AUXFILES_MEMORY_MEM_ID);
+  otauSaveCheckpoint();
+}
+
+/***************************************************************************//**
+\brief Resets the download state to the beginning of the image. The image
+  remainder is set up separately, as it depends on the image size.
+******************************************************************************/
+void otauResetCheckpoint(void)
+{
+  otauRunningChecksum     = 0xFF;
+  otauNextOffset          = 0;
+  otauInternalAddrStatus  = 0;
+  otauInternalLength      = 0;
+  otauFlashWriteOffset    = 0;
+  verifiedLength          = 0;
+  verifiedChecksum        = 0xFF;
+}
+
+/***************************************************************************//**
+\brief Stores the current download state as recovery checkpoint
+******************************************************************************/
+void otauSaveCheckpoint(void)
+{
+  otauCheckpoint.nextOffset         = otauNextOffset;
+  otauCheckpoint.internalLength     = otauInternalLength;
+  otauCheckpoint.flashWriteOffset   = otauFlashWriteOffset;
+  otauCheckpoint.imageRemainder     = otauImageRemainder;
+  otauCheckpoint.verifiedLength     = verifiedLength;
+  // the auxiliary structure of the next sub-element is not received yet
+  otauCheckpoint.internalAddrStatus = otauInternalLength ? otauInternalAddrStatus : 0;
+  otauCheckpoint.runningChecksum    = otauRunningChecksum;
+  otauCheckpoint.verifiedChecksum   = verifiedChecksum;
+  otauCheckpoint.crc = otauCalcCrc(0xFF, (uint8_t *)&otauCheckpoint, offsetof(OtauCheckpoint_t, crc));
+
   PDS_Store(OTAU_OFFSETFILES_MEMORY_MEM_ID);
 }
 
+/***************************************************************************//**
+\brief Takes the download state from the restored recovery checkpoint
+
+\return 'true' if the checkpoint is intact, otherwise 'false' and the download
+  state is reset to the beginning of the image
+******************************************************************************/
+bool otauRestoreCheckpoint(void)
+{
+  bool intact = (otauCheckpoint.crc ==
+    otauCalcCrc(0xFF, (uint8_t *)&otauCheckpoint, offsetof(OtauCheckpoint_t, crc)));
+
+  if (!intact)
+  {
+    memset(&otauCheckpoint, 0, sizeof(OtauCheckpoint_t));
+    otauCheckpoint.runningChecksum = 0xFF;
+    otauCheckpoint.verifiedChecksum = 0xFF;
+  }
+
+  otauNextOffset         = otauCheckpoint.nextOffset;
+  otauInternalLength     = otauCheckpoint.internalLength;
+  otauFlashWriteOffset   = otauCheckpoint.flashWriteOffset;
+  otauImageRemainder     = otauCheckpoint.imageRemainder;
+  otauInternalAddrStatus = otauCheckpoint.internalAddrStatus;
+  otauRunningChecksum    = otauCheckpoint.runningChecksum;
+  verifiedLength         = otauCheckpoint.verifiedLength;
+  verifiedChecksum       = otauCheckpoint.verifiedChecksum;
+
+  return intact;
+}
+
+/***************************************************************************//**
+\brief Updates the running checksum with the data written to the flash and
+  stores the download state as recovery checkpoint once the configured amount
+  of bytes has been downloaded since the previous one. The checkpoint is taken
+  after a completed write, so it holds the exact parser state. Besides, the end
+  of the last completed flash page is remembered, so a resumed download can
+  verify the flushed pages with OFD_CalCrc(). Shall be called after the write
+  offset is advanced.
+
+\param[in] memParam - parameters of the completed write
+******************************************************************************/
+void otauTrackCheckpoint(const OFD_MemoryAccessParam_t *memParam)
+{
+  uint32_t writeStart = memParam->offset - memParam->length;
+  uint32_t pageEnd = memParam->offset & ~(OTAU_CHECKPOINT_PAGE_SIZE - 1ul);
+
+  if (pageEnd > writeStart)
+  {
+    verifiedLength   = pageEnd;
+    verifiedChecksum = otauCalcCrc(otauRunningChecksum, memParam->data, (uint8_t)(pageEnd - writeStart));
+  }
+
+  otauRunningChecksum = otauCalcCrc(otauRunningChecksum, memParam->data, memParam->length);
+
+  if (otauNextOffset >= otauNextPdsWriteOffset)
+  {
+    otauSaveCheckpoint();
+
+    otauNextPdsWriteOffset = otauNextOffset + otauPdsWriteFreqInBytes;
+    if (otauNextPdsWriteOffset > (otauImageSize-1))
+    {
+      otauNextPdsWriteOffset = (otauImageSize-1);
+    }
+  }
+}
+
+/***************************************************************************//**
+\brief Continues the download from the restored recovery checkpoint
+******************************************************************************/
+void otauResumeDownload(void)
+{
+  ZCL_OtauClientMem_t *clientMem = zclGetOtauClientMem();
+  OtauImageAuxVar_t *tmpAuxParam = &clientMem->imageAuxParam;
+
+  otauConfigureNextPdsWriteOffset();
+
+  if (tmpAuxParam->imageInternalLength)
+  { // inside of sub-element data
+    otauCountActuallyDataSize();
+  }
+  else if (IMAGE_CRC_SIZE == tmpAuxParam->imageRemainder)
+  { // all the sub-elements are written, only the flush is left
+    OTAU_SET_STATE(stateMachine, OTAU_WAIT_TO_UPGRADE_STATE);
+    otauNextPdsWriteOffset = clientMem->otauParam.imageSize;
+    otauStartGenericTimer(REPOST_OFD_ACTION, otauStartFlush);
+    return;
+  }
+  else
+  { // the auxiliary structure of the next sub-element is expected
+    tmpAuxParam->internalAddressStatus = 0;
+    tmpAuxParam->currentDataSize = AUXILIARY_STRUCTURE_IS_FULL;
+#if APP_SUPPORT_OTAU_PAGE_REQUEST == 1
+    clientMem->blockRequest = OTAU_BLOCK_REQUEST_USAGE;
+#endif
+  }
+
+  otauStartDownload();
+}
+
 /***************************************************************************//**
 \brief Configures the next write offset for PDS/NVM
 ******************************************************************************/
@@ -597,16 +715,15 @@ void otauEraseCallback(OFD_Status_t status)
 #endif
 
 #if APP_SUPPORT_OTAU_RECOVERY == 1
-        otauRunningChecksum     = 0xFF;
-        otauNextOffset          = 0;
-        otauInternalAddrStatus  = 0;
-        otauInternalLength      = 0;
-        otauFlashWriteOffset    = 0;
+        otauResetCheckpoint();
+        otauImageRemainder = clientMem->imageAuxParam.imageRemainder;
         otauImageSize = clientMem->otauParam.imageSize;
         otauImageVersion = clientMem->newFirmwareVersion.memAlloc;
         COPY_EXT_ADDR(otauServerExtAddr, serverExtAddr);
 
         PDS_Store(OTAU_IMGFILES_MEMORY_MEM_ID);
+        // the previous checkpoint describes the erased image
+        otauSaveCheckpoint();
         otauConfigureNextPdsWriteOffset();
 #endif
 
@@ -631,9 +748,9 @@ void otauEraseCallback(OFD_Status_t status)
 
 #if APP_SUPPORT_OTAU_RECOVERY == 1
 /***************************************************************************//**
-\brief Get the CRC of the image stored in external memory at given position
-
-\param[in] position - image position in external memory
+\brief Verifies the flash pages completed before the restored recovery
+  checkpoint. The data of the partially written page is skipped, it is
+  checked together with the whole image by the flush.
 ******************************************************************************/
 void otauGetCrc(void)
 {
@@ -646,8 +763,14 @@ void otauGetCrc(void)
     return;
   }
 
-  OFD_CalCrc(OFD_POSITION_1, clientMem->otauParam.imageBlockData, otauNextOffset,
-             otauRunningChecksum, otauGetCrcCallback);
+  if (0 == verifiedLength)
+  { // no page is completed, nothing to verify
+    otauResumeDownload();
+    return;
+  }
+
+  OFD_CalCrc(OFD_POSITION_1, clientMem->otauParam.imageBlockData, verifiedLength,
+             verifiedChecksum, otauGetCrcCallback);
 }
 
 /***************************************************************************//**
@@ -658,10 +781,6 @@ void otauGetCrc(void)
 ******************************************************************************/
 void otauGetCrcCallback(OFD_Status_t status, OFD_ImageInfo_t *imageInfo)
 {
-  ZCL_OtauClientMem_t *clientMem = zclGetOtauClientMem();
-  OtauImageAuxVar_t *tmpAuxParam = &clientMem->imageAuxParam;
-  ZclOtauClientImageBuffer_t *tmpParam = &clientMem->otauParam;
-
   if ((!OTAU_CHECK_STATE(stateMachine, OTAU_GET_IMAGE_BLOCKS_STATE)) && \
       (!OTAU_CHECK_STATE(stateMachine, OTAU_GET_IMAGE_PAGES_STATE)))
   {
@@ -672,24 +791,12 @@ void otauGetCrcCallback(OFD_Status_t status, OFD_ImageInfo_t *imageInfo)
   switch(status)
   {
     case OFD_STATUS_SUCCESS:
-      if (otauRunningChecksum == imageInfo->crc)
-      {
-        tmpAuxParam->currentFileOffset		 = otauNextOffset;
-        tmpAuxParam->imageInternalLength	 = otauInternalLength;
-        tmpAuxParam->internalAddressStatus	 = otauInternalAddrStatus;
-        tmpAuxParam->imageRemainder 		 = otauImageSize - otauInternalLength;
-#if APP_SUPPORT_OTAU_PAGE_REQUEST == 1
-        CS_ReadParameter(CS_ZCL_OTAU_IMAGE_PAGE_REQUEST_PAGE_SIZE_ID, &tmpAuxParam->lastPageSize);
-        tmpAuxParam->imagePageOffset		 = otauNextOffset;
-#endif
-        COPY_EXT_ADDR(clientMem->otauServer, serverExtAddr);
-        tmpParam->imageSize = otauImageSize;
-        clientMem->newFirmwareVersion.memAlloc = otauImageVersion;
-
-        otauStartDownload();
+      if (verifiedChecksum == imageInfo->crc)
+      { // flushed pages are intact, continue from the checkpoint
+        otauResumeDownload();
       }
       else
-      {
+      { // start over
         otauStartErase();
       }
       break;
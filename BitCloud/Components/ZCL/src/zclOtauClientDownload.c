@@ -260,8 +260,8 @@ ZCL_Status_t otauFillAuxiliaryStructure(ZCL_OtauImageBlockResp_t *payload)
       otauCountActuallyDataSize();
       tmpAuxParam->imageRemainder -= (tmpAuxParam->imageInternalLength + AUXILIARY_STRUCTURE_IS_FULL);
 #if APP_SUPPORT_OTAU_RECOVERY == 1
+      // stored with the next checkpoint
       otauImageRemainder = tmpAuxParam->imageRemainder;
-      PDS_Store(OTAU_AUXFILES_MEMORY_MEM_ID);
 #endif
     }
   }
@@ -41,6 +41,7 @@ uint8_t otauInternalAddrStatus  = 0u;
 uint8_t otauRunningChecksum     = 0xFFu;
 uint32_t otauImageRemainder     = 0ul;
 uint32_t otauFlashWriteOffset   = 0ul;
+OtauCheckpoint_t otauCheckpoint;
 
 /*******************************************************************************
                 OTAU client persistent data table definition
@@ -49,12 +50,7 @@ uint32_t otauFlashWriteOffset   = 0ul;
 PDS_DECLARE_FILE(OTAU_SERVER_EXT_ADDR_MEM_ID,  sizeof(ExtAddr_t), &otauServerExtAddr,      NO_FILE_MARKS);
 PDS_DECLARE_FILE(OTAU_IMAGE_VERSION_MEM_ID,    sizeof(uint32_t),  &otauImageVersion,       NO_FILE_MARKS);
 PDS_DECLARE_FILE(OTAU_IMAGE_SIZE_MEM_ID,       sizeof(uint32_t),  &otauImageSize,          NO_FILE_MARKS);
-PDS_DECLARE_FILE(OTAU_NEXT_OFFSET_MEM_ID,      sizeof(uint32_t),  &otauNextOffset,         NO_FILE_MARKS);
-PDS_DECLARE_FILE(OTAU_RUNNING_CHECKSUM_MEM_ID, sizeof(uint8_t),   &otauRunningChecksum,    NO_FILE_MARKS);
-PDS_DECLARE_FILE(OTAU_INTERNAL_LENGTH_MEM_ID,  sizeof(uint32_t),  &otauInternalLength,     NO_FILE_MARKS);
-PDS_DECLARE_FILE(OTAU_IMAGE_REMAINDER_MEM_ID,  sizeof(uint32_t),  &otauImageRemainder,     NO_FILE_MARKS);
-PDS_DECLARE_FILE(OTAU_ADDRESS_STATUS_MEM_ID,   sizeof(uint8_t),   &otauInternalAddrStatus, NO_FILE_MARKS);
-PDS_DECLARE_FILE(OTAU_IMAGE_WRITE_OFFSET_ID,   sizeof(uint32_t),  &otauFlashWriteOffset,   NO_FILE_MARKS);
+PDS_DECLARE_FILE(OTAU_CHECKPOINT_MEM_ID,       sizeof(OtauCheckpoint_t), &otauCheckpoint, NO_FILE_MARKS);
 
 // ZCL OTA Upgrade Client data file identifiers list.
 // Shall be placed in PDS_FF segment
@@ -65,18 +61,9 @@ PROGMEM_DECLARE(PDS_MemId_t otauImgFilesMemoryIdsTable[]) =
   OTAU_IMAGE_SIZE_MEM_ID,
 };
 
-PROGMEM_DECLARE(PDS_MemId_t otauAuxFilesMemoryIdsTable[]) =
-{
-  OTAU_IMAGE_REMAINDER_MEM_ID,
-  OTAU_ADDRESS_STATUS_MEM_ID,
-};
-
 PROGMEM_DECLARE(PDS_MemId_t otauOffsetFilesMemoryIdsTable[]) =
 {
-  OTAU_NEXT_OFFSET_MEM_ID,
-  OTAU_RUNNING_CHECKSUM_MEM_ID,
-  OTAU_INTERNAL_LENGTH_MEM_ID,
-  OTAU_IMAGE_WRITE_OFFSET_ID,
+  OTAU_CHECKPOINT_MEM_ID,
 };
 
 // ZCL OTA Upgrade Client data directory descriptor.
@@ -88,13 +75,6 @@ PDS_DECLARE_DIR(PDS_DirDescr_t otauImgFilesMemoryDirDescr) =
   .memoryId   = OTAU_IMGFILES_MEMORY_MEM_ID
 };
 
-PDS_DECLARE_DIR(PDS_DirDescr_t otauAuxFilesMemoryDirDescr) =
-{
-  .list       = otauAuxFilesMemoryIdsTable,
-  .filesCount = ARRAY_SIZE(otauAuxFilesMemoryIdsTable),
-  .memoryId   = OTAU_AUXFILES_MEMORY_MEM_ID
-};
-
 PDS_DECLARE_DIR(PDS_DirDescr_t otauOffsetFilesMemoryDirDescr) =
 {
   .list       = otauOffsetFilesMemoryIdsTable,
@@ -206,12 +206,14 @@ ZCL_Status_t queryNextImageRespInd(ZCL_Addressing_t *addressing, uint8_t payload
       {
 #if APP_SUPPORT_OTAU_RECOVERY == 1
         if (PDS_IsAbleToRestore(OTAU_IMGFILES_MEMORY_MEM_ID) &&
-            PDS_IsAbleToRestore(OTAU_AUXFILES_MEMORY_MEM_ID) &&
             PDS_IsAbleToRestore(OTAU_OFFSETFILES_MEMORY_MEM_ID))
         {
-          PDS_Restore(OTAU_IMGFILES_MEMORY_MEM_ID);
-          PDS_Restore(OTAU_AUXFILES_MEMORY_MEM_ID);
-          PDS_Restore(OTAU_OFFSETFILES_MEMORY_MEM_ID);
+          if (!PDS_Restore(OTAU_IMGFILES_MEMORY_MEM_ID) ||
+              !PDS_Restore(OTAU_OFFSETFILES_MEMORY_MEM_ID) ||
+              !otauRestoreCheckpoint())
+          { // don't resume from a broken checkpoint
+            otauClearPdsParams();
+          }
         }
 #endif
         otauStartImageLoading(payload);
@@ -265,18 +267,13 @@ void otauStartImageLoading(ZCL_OtauQueryNextImageResp_t *payload)
 
 #if APP_SUPPORT_OTAU_RECOVERY == 1
     COPY_EXT_ADDR(otauServerExtAddr, zeroAddr);
-    otauNextOffset          = 0;
-    otauInternalAddrStatus  = 0;
-    otauInternalLength      = 0;
     otauImageSize           = 0;
     otauImageRemainder      = 0;
     otauImageVersion        = 0;
-    otauFlashWriteOffset    = 0;
-    otauRunningChecksum     = 0xFF;
+    otauResetCheckpoint();
 
     PDS_Store(OTAU_IMGFILES_MEMORY_MEM_ID);
-    PDS_Store(OTAU_AUXFILES_MEMORY_MEM_ID);
-    PDS_Store(OTAU_OFFSETFILES_MEMORY_MEM_ID);
+    otauSaveCheckpoint();
 #endif
     (void)zeroAddr;
     
@@ -306,9 +303,8 @@ void otauStartImageLoading(ZCL_OtauQueryNextImageResp_t *payload)
       clientMem->newFirmwareVersion.memAlloc = payload->currentFirmwareVersion.memAlloc;
       tmpParam->imageSize = payload->imageSize;
 
-      otauConfigureNextPdsWriteOffset();
-      otauCountActuallyDataSize();
-      otauStartDownload();
+      // don't trust the checkpoint blindly, verify the flushed pages first
+      otauGetCrc();
     }
     else // OTAU_CONTINUE_CLIENT_WORK
     { // Same server rediscovered
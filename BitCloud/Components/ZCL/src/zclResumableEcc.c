@@ -0,0 +1,145 @@
+/**************************************************************************//**
+  \file zclResumableEcc.c
+
+  \brief Resumable ECC operations. Stores operation parameters in the context
+         and, if the ECC backend can not execute operations in slices,
+         executes the whole operation within the first slice.
+
+  \author
+    Atmel Corporation: http://www.atmel.com \n
+    Support email: avr@atmel.com
+
+  Copyright (c) 2008-2015, Atmel Corporation. All rights reserved.
+  Licensed under Atmel's Limited License Agreement (BitCloudTM).
+
+  \internal
+    History:
+      19/10/26 - Created
+******************************************************************************/
+#if ZCL_SUPPORT == 1
+/******************************************************************************
+                            Includes section.
+******************************************************************************/
+#include <stddef.h>
+#include <string.h>
+#include <genericEcc.h>
+#include <eccAux.h>
+
+/******************************************************************************
+                            Implementation section.
+******************************************************************************/
+/**************************************************************************//**
+\brief Starts resumable generation of an ephemeral key pair. See
+       ZSE_ECCGenerateKey() for parameters.
+
+\param[in] ctx Operation context.
+
+\return MCE_SUCCESS if the operation is started, error code of
+        ZSE_ECCGenerateKey() otherwise.
+******************************************************************************/
+int ZSE_ECCGenerateKeyStart(ZSE_EccContext_t *ctx,
+                            unsigned char *privateKey,
+                            unsigned char *publicKey,
+                            GetRandomDataFunc *GetRandomData)
+{
+  if (!privateKey || !publicKey)
+    return MCE_ERR_NULL_OUTPUT_BUF;
+
+  if (!GetRandomData)
+    return MCE_ERR_NULL_FUNC_PTR;
+
+  memset(ctx, 0, sizeof(ZSE_EccContext_t));
+  ctx->operation     = ZSE_ECC_GENERATE_KEY_OPERATION;
+  ctx->privateKey    = privateKey;
+  ctx->output        = publicKey;
+  ctx->GetRandomData = GetRandomData;
+
+  return MCE_SUCCESS;
+}
+
+/**************************************************************************//**
+\brief Starts resumable derivation of a shared secret using the ECMQV
+       algorithm. See ZSE_ECCKeyBitGenerate() for parameters.
+
+\param[in] ctx Operation context.
+
+\return MCE_SUCCESS if the operation is started, error code of
+        ZSE_ECCKeyBitGenerate() otherwise.
+******************************************************************************/
+int ZSE_ECCKeyBitGenerateStart(ZSE_EccContext_t *ctx,
+                               unsigned char *privateKey,
+                               unsigned char *ephemeralPrivateKey,
+                               unsigned char *ephemeralPublicKey,
+                               unsigned char *remoteCertificate,
+                               unsigned char *remoteEphemeralPublicKey,
+                               unsigned char *caPublicKey,
+                               unsigned char *keyBits,
+                               HashFunc *Hash)
+{
+  if (!privateKey)
+    return MCE_ERR_NULL_PRIVATE_KEY;
+
+  if (!ephemeralPrivateKey)
+    return MCE_ERR_NULL_EPHEM_PRI_KEY;
+
+  if (!ephemeralPublicKey || !remoteEphemeralPublicKey)
+    return MCE_ERR_NULL_EPHEM_PUB_KEY;
+
+  if (!remoteCertificate)
+    return MCE_ERR_NULL_INPUT_BUF;
+
+  if (!caPublicKey)
+    return MCE_ERR_NULL_PUBLIC_KEY;
+
+  if (!keyBits)
+    return MCE_ERR_NULL_OUTPUT_BUF;
+
+  if (!Hash)
+    return MCE_ERR_NULL_FUNC_PTR;
+
+  memset(ctx, 0, sizeof(ZSE_EccContext_t));
+  ctx->operation                = ZSE_ECC_KEY_BIT_GENERATE_OPERATION;
+  ctx->privateKey               = privateKey;
+  ctx->ephemeralPrivateKey      = ephemeralPrivateKey;
+  ctx->ephemeralPublicKey       = ephemeralPublicKey;
+  ctx->remoteCertificate        = remoteCertificate;
+  ctx->remoteEphemeralPublicKey = remoteEphemeralPublicKey;
+  ctx->caPublicKey              = caPublicKey;
+  ctx->output                   = keyBits;
+  ctx->Hash                     = Hash;
+
+  return MCE_SUCCESS;
+}
+
+#if ZSE_ECC_RESUMABLE != 1
+/**************************************************************************//**
+\brief Continues the started operation. The backend can not be interrupted,
+       so the whole operation is executed regardless of fieldOps.
+
+\param[in] ctx      Operation context.
+\param[in] fieldOps Maximum amount of field operations to be executed.
+
+\return Result of the operation.
+******************************************************************************/
+int ZSE_ECCContinue(ZSE_EccContext_t *ctx, unsigned long fieldOps)
+{
+  unsigned char operation = ctx->operation;
+
+  (void)fieldOps;
+  ctx->operation = ZSE_ECC_NO_OPERATION;
+
+  if (ZSE_ECC_GENERATE_KEY_OPERATION == operation)
+    return ZSE_ECCGenerateKey(ctx->privateKey, ctx->output, ctx->GetRandomData,
+                              yield, YIELD_LEVEL);
+
+  if (ZSE_ECC_KEY_BIT_GENERATE_OPERATION == operation)
+    return ZSE_ECCKeyBitGenerate(ctx->privateKey, ctx->ephemeralPrivateKey, ctx->ephemeralPublicKey,
+                                 ctx->remoteCertificate, ctx->remoteEphemeralPublicKey, ctx->caPublicKey,
+                                 ctx->output, ctx->Hash, yield, YIELD_LEVEL);
+
+  return MCE_ERR_BAD_INPUT;
+}
+#endif // ZSE_ECC_RESUMABLE != 1
+
+#endif // ZCL_SUPPORT == 1
+//eof zclResumableEcc.c
@@ -35,37 +35,8 @@
 #include <clusters.h>
 #include <zdo.h>
 
-#define ZCL_SM_INVALID_SHORT_ADDRESS       0xffff
-#define ZCL_SM_INVALID_EXT_ADDRESS         0xffffffffffffffffLL
 #define ZCL_SM_KE_INIT_TIMEOUT             5000
 
-#if CERTICOM_SUPPORT == 1
-  #ifndef ZCL_SM_PERMISSION_TABLE_SIZE
-    #define ZCL_SM_PERMISSION_TABLE_SIZE          0x05
-  #endif
-#endif // CERTICOM_SUPPORT == 1
-
-
-#if CERTICOM_SUPPORT == 1
-typedef enum
-{
-  ZCL_SM_TC_NOT_AUTHENTICATED_STATUS    = 0x00,
-  ZCL_SM_TC_AUTHENTICATION_STARTED      = 0x01,
-  ZCL_SM_TC_AUTHENTICATION_FAILED       = 0x02,
-  ZCL_SM_TC_AUTHENTICATED_STATUS        = 0x03,
-  ZCL_SM_TC_LINK_KEY_UPDATE_REQUIRED    = 0x04,
-} ZclSmTcAuthenticateStatus_t;
-
-typedef struct
-{
-  ShortAddr_t                   shortAddr;
-  ExtAddr_t                     extAddr;
-  Endpoint_t                    keEndpoint;
-  ZclSmTcAuthenticateStatus_t   authenticateStatus;
-  uint16_t                      linkKeyTimeout;     //in minutes (45 days as maximum)
-} ZclSmPTEntry_t;
-#endif // CERTICOM_SUPPORT == 1
-
 #if CERTICOM_SUPPORT == 1
 extern Endpoint_t   keLocalEndpoint;
 extern ZCL_KECertificateDescriptor_t keCertificateDescriptor;
@@ -311,223 +282,6 @@ void ZCL_Get(ZCL_Get_t *req)
   }
 }
 
-#if 0
-
-#if CERTICOM_SUPPORT == 1
-static void smMatchDescResp(ZDO_ZdpResp_t *zdpResp)
-{
-  ZDO_MatchDescResp_t *zdoMatchResp = &zdpResp->respPayload.matchDescResp;
-  APS_BindReq_t apsBindReq;
-
-  if (ZDO_SUCCESS_STATUS == zdpResp->respPayload.status)
-  {
-      srvKEEndpoint = zdoMatchResp->matchList[0];
-      srvShortAddr = zdoMatchResp->nwkAddrOfInterest;
-  }
-  else if (ZDO_CMD_COMPLETED_STATUS == zdpResp->respPayload.status)
-  {
-    if ((APS_ZDO_ENDPOINT != srvKEEndpoint) &&
-        (ZCL_SM_INVALID_SHORT_ADDRESS != srvShortAddr))
-    {
-      smMakeStartConf(ZCL_SECURITY_STATUS_DISCOVERY_FAIL);
-    }
-    else
-    {
-/*
-typedef struct
-{
-  //Standard fields
-  ExtAddr_t srcAddr;
-  Endpoint_t srcEndpoint;
-  ClusterId_t clusterId;
-  APS_AddrMode_t dstAddrMode;
-  APS_Address_t dstAddr;
-  Endpoint_t dstEndpoint;
-  //Confirm
-  APS_BindConf_t confirm;
-} APS_BindReq_t;
-*/
-      apsBindReq.srcAddr = *MAC_GetExtAddr();
-      apsBindReq.srcEndpoint = clKEEndpoint;
-      apsBindReq.clusterId = ZCL_KEY_ESTABLISHMENT_CLUSTER_ID;
-      apsBindReq.dstAddrMode = APS_EXT_ADDRESS;
-      COPY_EXT_ADDR(apsBindReq.dstAddr.extAddress, *APS_GetTrustCenterAddress());
-      apsBindReq.dstEndpoint = srvKEEndpoint;
-      APS_BindReq(&apsBindReq);
-      if (APS_SUCCESS_STATUS != apsBindReq.confirm.status)
-      {
-        smMakeStartConf(ZCL_SECURITY_STATUS_APS_BINDING_FAIL);
-      }
-      else
-      {
-        keInitiateKE(0x00, apsBindReq.dstAddr.extAddress, srvKEEndpoint);
-      }
-    }
-  }
-}
-
-
-static void smMakeKEWithTrustCenter(void)
-{
-  //It's supposed that TrustCenter is in the coordinator which has
-  //short address equal to 0x0000
-  //TBD: For other cases the complex service discovery needed
-
-  smMakeMatchDescReq();
-}
-
-
-//Function make discovery for KE Cluster at the TrustCenter
-//It's assumed that TrustCenter is located at Coordinator
-static smMakeMatchDescReq(void)
-{
-  ZDO_MatchDescReq_t *zdoMatchDescReq = &zdpReq.req.reqPayload.matchDescReq;
-
-  zdpReq.ZDO_ZdpResp = smMatchDescResp;
-  zdpReq.reqCluster = MATCH_DESCRIPTOR_CLID;
-  zdoMatchDescReq->nwkAddrOfInterest = 0x0000;
-  zdoMatchDescReq->profileId = PROFILE_ID_SMART_ENERGY;
-  zdoMatchDescReq->numInClusters = 1;
-  zdoMatchDescReq->numOutClusters = 0;
-  zdoMatchDescReq->inClusterList[0] = ZCL_KEY_ESTABLISHMENT_CLUSTER_ID;
-  ZDO_ZdpReq(&zdpReq);
-}
-
-
-static void smZdoIeeeAddrResp(ZDO_ZdpResp_t *zdpResp)
-{
-  ZDO_IeeeAddrResp_t    *ieeeAddrResp = (ZDO_IeeeAddrResp_t *) &zdpResp->respPayload.ieeeAddrResp;
-  APS_BindReq_t         apsReq;
-  ZCL_SecurityStatus_t  status = ZCL_SUCCESS_STATUS;
-
-  if (ZDO_SUCCESS_STATUS == zdpResp->respPayload.status)
-  {
-    srvExtAddr = ieeeAddrResp->ieeeAddrRemote;
-    COPY_EXT_ADDR(apsReq.srcAddr, *MAC_GetExtAddr());
-    apsReq.srcEndpoint = clKEEndpoint;
-    apsReq.clusterId = ZCL_KEY_ESTABLISHMENT_CLUSTER_ID;
-    apsReq.dstAddrMode = APS_EXT_ADDRESS;
-    apsReq.dstAddr.extAddress = ieeeAddrResp->ieeeAddrRemote;
-    apsReq.dstEndpoint = clKEEndpoint;
-    APS_BindReq(&apsReq);
-
-    keSendInitiateKECommand();
-  }
-  else
-  {
-    status = ZCL_SECURITY_STATUS_DISCOVERY_FAIL;
-  }
-  smMakeStartConf(status);
-}
-
-
-static void smMakeIeeeAddrReq(ShortAddr_t shortAddr)
-{
-  ZDO_IeeeAddrReq_t *zdoIeeeAddrReq = &zdpReq.req.reqPayload.ieeeAddrReq;
-
-  zdpReq.ZDO_ZdpResp = smZdoIeeeAddrResp;
-  zdpReq.reqCluster = IEEE_ADDR_CLID;
-
-  zdoIeeeAddrReq->nwkAddrOfInterest = shortAddr;
-
-  zdoIeeeAddrReq->reqType = 0;
-  zdoIeeeAddrReq->startIndex = 0;
-
-  ZDO_ZdpReq(&zdpReq);
-}
-#endif // CERTICOM_SUPPORT == 1
-
-
-
-void smTimoutHandler(void)
-{
-  smMakeStartConf(ZCL_SECURITY_STATUS_TIMEOUT);
-}
-
-void smSetTimeout(uint32_t timeout)
-{
-  apsInitAppTimer(&smApsTimer, TIMER_ONE_SHOT_MODE, timeout, smTimoutHandler);
-  apsStartTimer(&smApsTimer);
-}
-
-
-static void smMakeKE(ZclSmPTEntry_t *permissionTableEntry)
-{
-  if (NULL == currentPermissionTableEntry)
-  {
-    currentPermissionTableEntry = permissionTableEntry;
-  }
-
-}
-
-
-
-
-
-
-
-/***
-CS_GetMemory(CS_TC_PERMISSION_TABLE_ID, (void*)&permissionDeviceTable);
-CS_ReadParameter(CS_MAX_TC_ALLOWED_DEVICES_AMOUNT_ID, &maxAllowedDeviceAmount);
-***/
-
-static ZclSmPTEntry_t *smGetFromPermissionTable(ShortAddr_t *shortAddr, ExtAddr_t *extAddr)
-{
-  uint8_t i;
-  uint8_t j = 0;
-  uint8_t k;
-  ShortAddr_t shortAddr_;
-  ExtAddr_t   extAddr_;
-
-  if (NULL != shortAddr)
-  {
-    j |= (1 << 0);
-    shortAddr_ = *shortAddr;
-  }
-  if (NULL != extAddr)
-  {
-    j |= (1 << 1);
-    COPY_EXT_ADDR(extAddr_, *extAddr);
-  }
-
-  if (0 != j)
-  {
-    for (i = 0; i < ZCL_SM_PERMISSION_TABLE_SIZE; i++)
-    {
-      k = 0;
-      if (0 != (j & (1 << 0)))
-      {
-        if (smTcPermissionTable[i].shortAddr == shortAddr_)
-          k |= (1 << 0);
-        if (IS_EQ_EXT_ADDR(smTcPermissionTable[i].extAddr, extAddr_))
-          k |= (1 << 1);
-      }
-      if (k == j)
-        return &smTcPermissionTable[i];
-    }
-  }
-  return NULL;
-}
-
-/*
-ZclSmPermissionTableEntry_t *smAddToPermissionTable(ShortAddr_t shortAdddr, ExtAddr_t extAddr)
-{
-  ZclSmPermissionTableEntry_t *result = NULL;
-
-  result = smGetFromPermissionTable(shortAddr, extAddr);
-  if (NULL == result)
-    result = smGetFromPermissionTable(ZCL_SM_INVALID_SHORT_ADDRESS, ZCL_SM_INVALID_EXT_ADDRESS);
-  if (NULL != result)
-  {
-    result->shortAddr = shortAddr;
-    result->extAddr = extAddr;
-  }
-  return result;
-}
-*/
-
-#endif //#if 0
-
 #else // (defined _LINK_SECURITY_) && (!defined _LIGHT_LINK_PROFILE_)
 void zclSecurityTaskHandler(void)
 {}
@@ -43,6 +43,9 @@ typedef  void (* ZclTask_t)(void);
 extern void zclTaskHandler(void);
 extern void zclParserTaskHandler(void);
 extern void zclSecurityTaskHandler(void);
+#if (defined _LINK_SECURITY_) && (!defined _LIGHT_LINK_PROFILE_) && (CERTICOM_SUPPORT == 1)
+extern void zclKeTaskHandler(void);
+#endif
 
 /******************************************************************************
                              Constants section
@@ -53,6 +56,9 @@ static PROGMEM_DECLARE(ZclTask_t zclHandlers[ZCL_TASKS_SIZE]) =
   [ZCL_SUBTASK_ID]          = zclTaskHandler,
   [ZCL_PARSER_TASK_ID]      = zclParserTaskHandler,
   [ZCL_SECURITY_TASK_ID]    = zclSecurityTaskHandler,
+#if (defined _LINK_SECURITY_) && (!defined _LIGHT_LINK_PROFILE_) && (CERTICOM_SUPPORT == 1)
+  [ZCL_KE_TASK_ID]          = zclKeTaskHandler,
+#endif
 };
 
 /******************************************************************************
@@ -162,6 +162,10 @@ typedef struct N_FSM_StateMachine_Log_t
         #fsmVariable \
     }
 
+/** The logging version always scans the transition table linearly, see N_Fsm.h. */
+#define N_FSM_DECLARE_INDEXED(fsmVariable, transitionTable, transitionTableSize, entryExitTable, entryExitTableSize, actionFunction, checkFunction, stateCount) \
+    N_FSM_DECLARE(fsmVariable, transitionTable, transitionTableSize, entryExitTable, entryExitTableSize, actionFunction, checkFunction)
+
 #define N_FSM_STATE(state) \
     { (N_FSM_STATE_BIT + (uint8_t)state), 0u, 0u, 0u, #state }
 
@@ -106,6 +106,36 @@ typedef N_UTIL_ROM struct N_FSM_Transition_NoLog_t
 
 } N_FSM_Transition_NoLog_t;
 
+/** Compiled form of a transition table, declared by N_FSM_DECLARE_INDEXED(). Built once, on the first
+    use of the state machine. Transitions are grouped per state and sorted on event, so an event is
+    dispatched with a binary search on the transitions of the current state only.
+*/
+typedef struct N_FSM_Index_t
+{
+    /** Per-state offset table (stateCount + 1 entries). The transitions of state s are
+        pOrder[pStateOffset[s]] up to (not including) pOrder[pStateOffset[s + 1]].
+    */
+    uint8_t*                       pStateOffset;
+
+    /** Transition table indices, sorted on (state, event). Transitions for the same state and event
+        keep the order of the transition table.
+    */
+    uint8_t*                       pOrder;
+
+    /** Number of states, i.e. the highest state value + 1. */
+    uint8_t                        stateCount;
+
+    /** One of the N_FSM_INDEX_... values. */
+    uint8_t                        status;
+
+    /** Number of events processed. */
+    uint16_t                       eventCount;
+
+    /** Number of events that resulted in a transition. */
+    uint16_t                       transitionCount;
+
+} N_FSM_Index_t;
+
 /** Groups the tables and functions defining the finite state machine.
 */
 typedef struct N_FSM_StateMachine_NoLog_t
@@ -116,9 +146,18 @@ typedef struct N_FSM_StateMachine_NoLog_t
     uint8_t                        entryExitTableSize;
     N_FSM_ActionFunc_t             pAction;
     N_FSM_ConditionFunc_t          pCondition;
+    N_FSM_Index_t*                 pIndex;    // NULL, or compiled form of pTable
 
 } N_FSM_StateMachine_NoLog_t;
 
+/** Type of the trace hook, called for every event processed by any state machine.
+    \param pFsm The state machine that processed the event
+    \param fromState The state the event was received in
+    \param event The event
+    \param toState The next state, N_FSM_SAME_STATE, or N_FSM_NONE if the event was ignored
+*/
+typedef void (*N_FSM_TraceHook_t)(const struct N_FSM_StateMachine_NoLog_t* pFsm, N_FSM_State_t fromState, N_FSM_Event_t event, N_FSM_State_t toState);
+
 /***************************************************************************************************
 * EXPORTED MACROS AND CONSTANTS
 ***************************************************************************************************/
@@ -141,6 +180,11 @@ typedef struct N_FSM_StateMachine_NoLog_t
 /** Event placeholder to specify a default case ('all other events'). */
 #define N_FSM_OTHER_EVENT (0x7Fu)
 
+/** Values of N_FSM_Index_t.status. */
+#define N_FSM_INDEX_NOT_BUILT   (0u)
+#define N_FSM_INDEX_BUILT       (1u)
+#define N_FSM_INDEX_LINEAR      (2u)
+
 #define N_FSM_Transition_t N_FSM_Transition_NoLog_t
 
 #define N_FSM_StateMachine_t N_FSM_StateMachine_NoLog_t
@@ -158,7 +202,35 @@ typedef struct N_FSM_StateMachine_NoLog_t
         entryExitTable, \
         entryExitTableSize, \
         actionFunction, \
-        checkFunction \
+        checkFunction, \
+        NULL \
+    }
+
+/** Same as N_FSM_DECLARE(), but dispatches events through a compiled form of the transition table,
+    at the cost of (transitionTableSize + stateCount + 1) bytes of RAM. stateCount is the highest
+    state value + 1. Tables that use N_FSM_ANY_STATE or N_FSM_OTHER_EVENT are scanned linearly.
+*/
+#define N_FSM_DECLARE_INDEXED(fsmVariable, transitionTable, transitionTableSize, entryExitTable, entryExitTableSize, actionFunction, checkFunction, stateCount) \
+    static uint8_t fsmVariable##_stateOffset[(stateCount) + 1u]; \
+    static uint8_t fsmVariable##_order[transitionTableSize]; \
+    static N_FSM_Index_t fsmVariable##_index = \
+    { \
+        fsmVariable##_stateOffset, \
+        fsmVariable##_order, \
+        (uint8_t)(stateCount), \
+        N_FSM_INDEX_NOT_BUILT, \
+        0u, \
+        0u \
+    }; \
+    static const N_FSM_StateMachine_t fsmVariable = \
+    { \
+        transitionTable, \
+        transitionTableSize, \
+        entryExitTable, \
+        entryExitTableSize, \
+        actionFunction, \
+        checkFunction, \
+        &fsmVariable##_index \
     }
 
 #define N_FSM_STATE(state) \
@@ -226,6 +298,12 @@ bool N_FSM_ProcessEvent1arg(N_FSM_StateMachine_t const* pFsm, N_FSM_State_t* pAc
 */
 bool N_FSM_ProcessEvent2args(N_FSM_StateMachine_t const* pFsm, N_FSM_State_t* pActualState, N_FSM_Event_t event, int32_t arg1, int32_t arg2);
 
+/** Set the trace hook that is called for every processed event.
+    \note Not available when N_FSM_ENABLE_LOGGING is defined; the log already traces all events.
+    \param hook The hook, or NULL to disable tracing
+*/
+void N_FSM_SetTraceHook(N_FSM_TraceHook_t hook);
+
 /***************************************************************************************************
 * END OF C++ DECLARATION WRAPPER
 ***************************************************************************************************/
@@ -39,10 +39,162 @@ $Id: N_Fsm.c 28213 2015-07-22 09:43:04Z agasthian.s $
 // This bit is used to check whether the Fsm is being illegally used recursively.
 #define RECURSIVE_STATE_CHECK   N_FSM_STATE_BIT
 
+/***************************************************************************************************
+* LOCAL VARIABLES
+***************************************************************************************************/
+
+#ifndef N_FSM_ENABLE_LOGGING
+static N_FSM_TraceHook_t s_traceHook = NULL;
+#endif
+
 /***************************************************************************************************
 * LOCAL FUNCTIONS
 ***************************************************************************************************/
 
+#ifndef N_FSM_ENABLE_LOGGING
+/** Build the compiled form of the transition table. Falls back to the linear scan when the table
+    cannot be indexed without changing the order in which transitions are evaluated.
+*/
+static void BuildIndex(N_FSM_StateMachine_t const* pFsm)
+{
+    N_FSM_Index_t* pIndex = pFsm->pIndex;
+    uint8_t* pOffset = pIndex->pStateOffset;
+    uint8_t state = N_FSM_ANY_STATE;
+
+    pIndex->status = N_FSM_INDEX_LINEAR;
+    for (uint8_t s = 0u; s <= pIndex->stateCount; s++)
+    {
+        pOffset[s] = 0u;
+    }
+
+    // count the transitions per state
+    for (uint8_t i = 0u; i < pFsm->tableSize; i++)
+    {
+        uint8_t event = pFsm->pTable[i].event;
+        if ( (event & N_FSM_STATE_BIT) != 0u )
+        {
+            state = event ^ N_FSM_STATE_BIT;
+            if ( state >= pIndex->stateCount )
+            {
+                return; // also covers N_FSM_ANY_STATE
+            }
+        }
+        else if ( (state == N_FSM_ANY_STATE) || (event == N_FSM_OTHER_EVENT) )
+        {
+            return;
+        }
+        else
+        {
+            pOffset[state + 1u]++;
+        }
+    }
+
+    // turn the counts into offsets
+    for (uint8_t s = 0u; s < pIndex->stateCount; s++)
+    {
+        pOffset[s + 1u] += pOffset[s];
+    }
+
+    // distribute the transitions over the states, keeping the table order. pOffset[s] is used as fill
+    // pointer for state s, so afterwards it holds the offset of state s + 1.
+    for (uint8_t i = 0u; i < pFsm->tableSize; i++)
+    {
+        uint8_t event = pFsm->pTable[i].event;
+        if ( (event & N_FSM_STATE_BIT) != 0u )
+        {
+            state = event ^ N_FSM_STATE_BIT;
+        }
+        else
+        {
+            pIndex->pOrder[pOffset[state]] = i;
+            pOffset[state]++;
+        }
+    }
+    for (uint8_t s = pIndex->stateCount; s > 0u; s--)
+    {
+        pOffset[s] = pOffset[s - 1u];
+    }
+    pOffset[0] = 0u;
+
+    // sort the transitions of each state on event (stable insertion sort; a state has a few transitions only)
+    for (uint8_t s = 0u; s < pIndex->stateCount; s++)
+    {
+        for (uint8_t k = pOffset[s] + 1u; k < pOffset[s + 1u]; k++)
+        {
+            uint8_t txIndex = pIndex->pOrder[k];
+            uint8_t event = pFsm->pTable[txIndex].event;
+            uint8_t j = k;
+            while ( (j > pOffset[s]) && (pFsm->pTable[pIndex->pOrder[j - 1u]].event > event) )
+            {
+                pIndex->pOrder[j] = pIndex->pOrder[j - 1u];
+                j--;
+            }
+            pIndex->pOrder[j] = txIndex;
+        }
+    }
+
+    pIndex->status = N_FSM_INDEX_BUILT;
+}
+
+/** Find the transition to take using the compiled form of the transition table.
+    \return The transition, or NULL if the event is ignored in the actual state
+*/
+static const N_FSM_Transition_t N_UTIL_ROM* FindIndexedTransition(N_FSM_StateMachine_t const* pFsm, N_FSM_State_t* pActualState, N_FSM_Event_t event, int32_t arg1, int32_t arg2)
+{
+    const N_FSM_Index_t* pIndex = pFsm->pIndex;
+    uint8_t lo;
+    uint8_t hi;
+
+    if ( *pActualState >= pIndex->stateCount )
+    {
+        return NULL;
+    }
+
+    // find the first transition for this event
+    lo = pIndex->pStateOffset[*pActualState];
+    hi = pIndex->pStateOffset[*pActualState + 1u];
+    while ( lo < hi )
+    {
+        uint8_t mid = (uint8_t)((lo + hi) / 2u);
+        if ( pFsm->pTable[pIndex->pOrder[mid]].event < event )
+        {
+            lo = mid + 1u;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    // evaluate the candidates in table order
+    hi = pIndex->pStateOffset[*pActualState + 1u];
+    for (; lo < hi; lo++)
+    {
+        const N_FSM_Transition_t N_UTIL_ROM* pTx = &(pFsm->pTable[pIndex->pOrder[lo]]);
+        bool found;
+
+        if ( pTx->event != event )
+        {
+            break;
+        }
+
+        found = TRUE;
+        if ( pTx->ConditionalFunction != N_FSM_NONE )
+        {
+            *pActualState |= RECURSIVE_STATE_CHECK;
+            found = pFsm->pCondition(pTx->ConditionalFunction, arg1, arg2);
+            *pActualState &= ~RECURSIVE_STATE_CHECK;
+        }
+        if ( found )
+        {
+            return pTx;
+        }
+    }
+
+    return NULL;
+}
+#endif
+
 
 /***************************************************************************************************
 * EXPORTED FUNCTIONS
@@ -54,6 +206,13 @@ void N_FSM_Initialize_Log(N_FSM_StateMachine_Log_t const* pFsm, N_FSM_State_t* p
 void N_FSM_Initialize(N_FSM_StateMachine_t const* pFsm, N_FSM_State_t* pActualState, N_FSM_State_t initialState)
 #endif
 {
+#ifndef N_FSM_ENABLE_LOGGING
+    if ( (pFsm->pIndex != NULL) && (pFsm->pIndex->status == N_FSM_INDEX_NOT_BUILT) )
+    {
+        BuildIndex(pFsm);
+    }
+#endif
+
     *pActualState = initialState;
     for (uint8_t i = 0u; i < pFsm->entryExitTableSize; i++)
     {
@@ -88,6 +247,20 @@ bool N_FSM_ProcessEvent2args(N_FSM_StateMachine_t const* pFsm, N_FSM_State_t* pA
         N_ERRH_FATAL();
     }
 
+#ifndef N_FSM_ENABLE_LOGGING
+    if ( (pFsm->pIndex != NULL) && (pFsm->pIndex->status == N_FSM_INDEX_NOT_BUILT) )
+    {
+        BuildIndex(pFsm);
+    }
+
+    if ( (pFsm->pIndex != NULL) && (pFsm->pIndex->status == N_FSM_INDEX_BUILT) )
+    {
+        pTx = FindIndexedTransition(pFsm, pActualState, event, arg1, arg2);
+        found = (pTx != NULL);
+        tableIndex = pFsm->tableSize; // skip the linear scan
+    }
+#endif
+
     // find matching transition
     while ((!found) && (tableIndex < pFsm->tableSize))
     {
@@ -148,6 +321,19 @@ bool N_FSM_ProcessEvent2args(N_FSM_StateMachine_t const* pFsm, N_FSM_State_t* pA
 
         N_LOG_COMPID(compId, N_Log_Level_State, pFsm->fsmName, ("%s: event=%u (^%s)", fromStateName, (int16_t)event, eventName));
     }
+#else
+    if ( pFsm->pIndex != NULL )
+    {
+        pFsm->pIndex->eventCount++;
+        if ( found )
+        {
+            pFsm->pIndex->transitionCount++;
+        }
+    }
+    if ( s_traceHook != NULL )
+    {
+        s_traceHook(pFsm, *pActualState, event, found ? pTx->nextState : N_FSM_NONE);
+    }
 #endif
 
     if (found)
@@ -150,6 +150,20 @@ void D_Nv_EraseSector(uint8_t sector)
   }
 }
 
+/** Erases one page of a sector of the internal NV.
+   \param sector The sector to use (0..D_NV_SECTOR_COUNT)
+   \param offset The offset of the page within the sector, must be page aligned
+*/
+void D_Nv_ErasePage(uint8_t sector, uint16_t offset)
+{
+  uint32_t address = D_NV_MEMORY_START + (uint32_t)(sector - D_NV_FIRST_SECTOR) * D_NV_SECTOR_SIZE + offset;
+
+  N_ERRH_ASSERT_FATAL(address <= D_NV_MEMORY_END);
+  N_ERRH_ASSERT_FATAL((offset % D_NV_PAGE_SIZE) == 0U);
+
+  HAL_EraseFlashPage(address);
+}
+
 /** Compare bytes with contents of the internal NV.
     \param sector The sector to use (0..D_NV_SECTOR_COUNT)
     \param offset The offset to start comparing with
@@ -0,0 +1,177 @@
+/**
+  \file D_NvSim.h
+
+  \brief Host simulator of the internal (D_Nv) and external (D_XNv) NV.
+
+  The simulator implements the D_Nv_Stub_xxx and D_XNv_Stub_xxx functions
+  the S_Nv and S_XNv components are bound to when built with TESTHARNESS.
+  Each device is backed by a memory-mapped file, so its contents and wear
+  survive restarts of the host process.
+
+  The simulator behaves like NOR flash:
+  - programming can only change bits from 1 to 0, bits which would have to
+    change from 0 to 1 keep their value and are counted as violations,
+  - erasing is done per erase unit only (a page of D_Nv, a sector of D_XNv),
+  - erase counters are kept per page and stored in the backing file,
+  - program and erase operations advance a simulated clock according to
+    the configured timing,
+  - power can be cut deterministically after a given number of bytes,
+    pages or calls.
+
+  The file consists of the NV contents followed by the erase counters
+  (one uint32_t per page, host byte order).
+
+  \author
+    Atmel Corporation: http://www.atmel.com \n
+    Support email: avr@atmel.com
+
+  Copyright (c) 2008-2015, Atmel Corporation. All rights reserved.
+  Licensed under Atmel's Limited License Agreement (BitCloudTM).
+
+  \internal
+    History:
+    19.10.26 - created
+*/
+
+#ifndef D_NVSIM_H
+#define D_NVSIM_H
+
+#include <N_Types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Simulated devices */
+typedef enum D_NvSim_Device_t
+{
+  D_NVSIM_NV  = 0u,   //!< Internal NV, see D_Nv.h
+  D_NVSIM_XNV = 1u,   //!< External NV, see D_XNv.h
+} D_NvSim_Device_t;
+
+/** Granularity of the power cut countdown */
+typedef enum D_NvSim_CutLevel_t
+{
+  /** Every programmed byte and every erased erase unit is counted. The interrupted
+      byte only gets its upper nibble programmed. */
+  D_NVSIM_CUT_BYTE = 0u,
+  /** Every programmed page and every erased erase unit is counted. The interrupted
+      page only gets the first half of its data programmed. */
+  D_NVSIM_CUT_PAGE = 1u,
+  /** Every program or erase call is counted. The interrupted call has no effect. */
+  D_NVSIM_CUT_CALL = 2u,
+} D_NvSim_CutLevel_t;
+
+/** Timing of a device, microseconds */
+typedef struct D_NvSim_Timing_t
+{
+  uint32_t readByteUs;      //!< Time to read one byte
+  uint32_t programPageUs;   //!< Fixed time to program a (part of a) page
+  uint32_t programByteUs;   //!< Additional time per programmed byte
+  uint32_t eraseUs;         //!< Time to erase one erase unit
+} D_NvSim_Timing_t;
+
+/** Operation statistics of a device */
+typedef struct D_NvSim_Statistics_t
+{
+  uint64_t bytesRead;
+  uint64_t bytesProgrammed;
+  uint32_t programCalls;
+  uint32_t programViolations;   //!< Bytes which were requested to change a bit from 0 to 1
+  uint32_t pageErases;          //!< Erased pages, including the ones erased as part of a sector
+  uint32_t sectorErases;
+  uint32_t powerCuts;
+  uint64_t busyTimeUs;          //!< Simulated time spent on reading, programming and erasing
+} D_NvSim_Statistics_t;
+
+/** Wear distribution of a device */
+typedef struct D_NvSim_Wear_t
+{
+  uint16_t pageCount;
+  uint32_t minEraseCount;
+  uint32_t maxEraseCount;
+  uint64_t totalEraseCount;
+} D_NvSim_Wear_t;
+
+/** Callback invoked when a scheduled power cut occurs. It may longjmp() out of
+    the driver to simulate a reset; if it returns, program and erase requests
+    are ignored until D_NvSim_PowerOn() is called. */
+typedef void (*D_NvSim_PowerCutCallback_t)(D_NvSim_Device_t device);
+
+/** Opens the backing file of a device. A new or empty file is created in the
+    erased state with all erase counters zero.
+    \param device The device to open
+    \param pFileName The backing file, or NULL to use anonymous memory
+    \returns TRUE on success, FALSE if the file can not be mapped or has an unexpected size
+*/
+bool D_NvSim_Open(D_NvSim_Device_t device, const char *pFileName);
+
+/** Flushes and closes the backing file of a device.
+    \param device The device to close
+*/
+void D_NvSim_Close(D_NvSim_Device_t device);
+
+/** Sets the timing of a device. Defaults to typical values of the SAMR21 NVM
+    controller and of a SPI flash.
+    \param device The device to configure
+    \param[in] pTiming The new timing
+*/
+void D_NvSim_SetTiming(D_NvSim_Device_t device, const D_NvSim_Timing_t *pTiming);
+
+/** Schedules a power cut.
+    \param device The device to cut the power of
+    \param level The granularity of the countdown
+    \param count The number of units to be completed before the cut, 0 cancels the scheduled cut
+    \param pfCut Function to be called when the cut occurs. Can be NULL.
+*/
+void D_NvSim_SchedulePowerCut(D_NvSim_Device_t device, D_NvSim_CutLevel_t level, uint32_t count,
+                              D_NvSim_PowerCutCallback_t pfCut);
+
+/** Restores the power of a device after a cut.
+    \param device The device to power on
+*/
+void D_NvSim_PowerOn(D_NvSim_Device_t device);
+
+/** Checks if the power of a device has been cut.
+    \param device The device to check
+    \returns TRUE if the power is cut, FALSE otherwise
+*/
+bool D_NvSim_IsPoweredOff(D_NvSim_Device_t device);
+
+/** Returns the simulated time. The clock advances with every read, program
+    and erase, and with D_NvSim_AdvanceTime().
+    \returns Simulated time, microseconds
+*/
+uint64_t D_NvSim_GetTime(void);
+
+/** Advances the simulated clock and completes the asynchronous operations which
+    have finished meanwhile.
+    \param us The time to advance the clock by, microseconds
+*/
+void D_NvSim_AdvanceTime(uint32_t us);
+
+/** Reads the operation statistics of a device.
+    \param device The device to read the statistics of
+    \param[out] pStatistics The buffer to store the statistics to
+    \param reset TRUE to clear the statistics after reading
+*/
+void D_NvSim_GetStatistics(D_NvSim_Device_t device, D_NvSim_Statistics_t *pStatistics, bool reset);
+
+/** Calculates the wear distribution of a device over all of its pages.
+    \param device The device to examine
+    \param[out] pWear The buffer to store the wear distribution to
+*/
+void D_NvSim_GetWear(D_NvSim_Device_t device, D_NvSim_Wear_t *pWear);
+
+/** Returns the erase counter of a page.
+    \param device The device to examine
+    \param page The index of the page, counted from the start of the first sector
+    \returns The number of times the page has been erased
+*/
+uint32_t D_NvSim_GetPageEraseCount(D_NvSim_Device_t device, uint16_t page);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // D_NVSIM_H
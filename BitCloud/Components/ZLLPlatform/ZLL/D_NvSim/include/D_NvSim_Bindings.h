@@ -0,0 +1,17 @@
+// implemented interface(s)
+#define D_Nv_Read D_Nv_Stub_Read
+#define D_Nv_Write D_Nv_Stub_Write
+#define D_Nv_EraseSector D_Nv_Stub_EraseSector
+#define D_Nv_ErasePage D_Nv_Stub_ErasePage
+#define D_Nv_IsEmpty D_Nv_Stub_IsEmpty
+#define D_Nv_IsEqual D_Nv_Stub_IsEqual
+
+#define D_XNv_Read D_XNv_Stub_Read
+#define D_XNv_Write D_XNv_Stub_Write
+#define D_XNv_EraseSector D_XNv_Stub_EraseSector
+#define D_XNv_IsEmpty D_XNv_Stub_IsEmpty
+#define D_XNv_IsEqual D_XNv_Stub_IsEqual
+#define D_XNv_IsBusy D_XNv_Stub_IsBusy
+#define D_XNv_EraseSectorAsync D_XNv_Stub_EraseSectorAsync
+
+// no used interfaces
@@ -0,0 +1,727 @@
+/**
+  \file D_NvSim.c
+
+  \brief Host simulator of the internal (D_Nv) and external (D_XNv) NV.
+
+  \author
+    Atmel Corporation: http://www.atmel.com \n
+    Support email: avr@atmel.com
+
+  Copyright (c) 2008-2015, Atmel Corporation. All rights reserved.
+  Licensed under Atmel's Limited License Agreement (BitCloudTM).
+
+  \internal
+    History:
+    19.10.26 - created
+*/
+
+#if defined(TESTHARNESS)
+/******************************************************************************
+                   Includes section
+******************************************************************************/
+#include <D_NvSim_Bindings.h>
+#include <D_NvSim.h>
+#include <D_Nv.h>
+#include <D_XNv.h>
+#include <N_ErrH.h>
+#include <N_Types.h>
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/******************************************************************************
+                   Definitions section
+******************************************************************************/
+#define COMPID "D_NvSim"
+
+#define DEVICE_COUNT  2u
+
+// Geometry of the external NV, see D_XNv.h
+#define XNV_SECTOR_COUNT  8u
+#define XNV_PAGE_SIZE     256u
+
+// Event masks passed to CountEvent()
+#define CUT_EVENT_BYTE   (1u << D_NVSIM_CUT_BYTE)
+#define CUT_EVENT_PAGE   (1u << D_NVSIM_CUT_PAGE)
+#define CUT_EVENT_CALL   (1u << D_NVSIM_CUT_CALL)
+#define CUT_EVENT_ERASE  (CUT_EVENT_BYTE | CUT_EVENT_PAGE)
+
+/******************************************************************************
+                   Types section
+******************************************************************************/
+typedef struct Device_t
+{
+  // geometry
+  uint8_t firstSector;
+  uint8_t sectorCount;
+  uint32_t sectorSize;
+  uint32_t pageSize;
+  uint32_t eraseUnitSize;
+
+  // backing storage: contents followed by one erase counter per page
+  uint8_t *pMemory;
+  uint32_t *pEraseCount;
+  size_t mappedSize;
+  int fd;
+
+  D_NvSim_Timing_t timing;
+  D_NvSim_Statistics_t statistics;
+
+  // power cut
+  D_NvSim_CutLevel_t cutLevel;
+  uint32_t cutCountdown;
+  D_NvSim_PowerCutCallback_t pfCut;
+  bool poweredOff;
+
+  // pending asynchronous operation
+  bool busy;
+  uint64_t busyUntil;
+  D_XNv_Callback_t pfDone;
+} Device_t;
+
+/******************************************************************************
+                   Static variables section
+******************************************************************************/
+static Device_t s_devices[DEVICE_COUNT] =
+{
+  [D_NVSIM_NV] =
+  {
+    .firstSector = D_NV_FIRST_SECTOR,
+    .sectorCount = D_NV_SECTOR_COUNT,
+    .sectorSize = D_NV_SECTOR_SIZE,
+    .pageSize = D_NV_PAGE_SIZE,
+    .eraseUnitSize = D_NV_PAGE_SIZE,
+    .fd = -1,
+    // SAMR21 NVM controller: page write 2.5 ms, row erase 6 ms
+    .timing = { .readByteUs = 0u, .programPageUs = 2500u, .programByteUs = 0u, .eraseUs = 6000u },
+  },
+  [D_NVSIM_XNV] =
+  {
+    .firstSector = 0u,
+    .sectorCount = XNV_SECTOR_COUNT,
+    .sectorSize = D_XNV_SECTOR_SIZE,
+    .pageSize = XNV_PAGE_SIZE,
+    .eraseUnitSize = D_XNV_SECTOR_SIZE,
+    .fd = -1,
+    // SPI flash at 4 MHz: 2 us per transferred byte, page program 0.7 ms, 4 KB sector erase 60 ms
+    .timing = { .readByteUs = 2u, .programPageUs = 700u, .programByteUs = 2u, .eraseUs = 60000u },
+  },
+};
+
+/** The simulated clock, microseconds */
+static uint64_t s_time = 0u;
+
+/***************************************************************************************************
+* LOCAL FUNCTION DECLARATIONS
+***************************************************************************************************/
+static Device_t* GetDevice(D_NvSim_Device_t device);
+static uint32_t GetAddress(Device_t *pDevice, uint8_t sector, uint32_t offset, uint32_t numberOfBytes);
+static bool CountEvent(Device_t *pDevice, uint8_t eventMask);
+static void CutPower(Device_t *pDevice, D_NvSim_Device_t device);
+static void CompleteOperation(Device_t *pDevice);
+static void WaitReady(Device_t *pDevice);
+static void Read(D_NvSim_Device_t device, uint8_t sector, uint16_t offset, uint8_t *pBuffer, uint32_t numberOfBytes);
+static uint32_t Program(D_NvSim_Device_t device, uint8_t sector, uint16_t offset, const uint8_t *pBuffer,
+                        uint32_t numberOfBytes);
+static uint32_t Erase(D_NvSim_Device_t device, uint8_t sector, uint32_t offset, uint32_t numberOfBytes);
+static bool Compare(D_NvSim_Device_t device, uint8_t sector, uint16_t offset, const uint8_t *pBuffer,
+                    uint32_t numberOfBytes);
+
+/******************************************************************************
+                   Implementations section
+******************************************************************************/
+/** Returns the state of a device, which must have been opened.
+*/
+static Device_t* GetDevice(D_NvSim_Device_t device)
+{
+  N_ERRH_ASSERT_FATAL(device < DEVICE_COUNT);
+  N_ERRH_ASSERT_FATAL(s_devices[device].pMemory != NULL);
+  return &s_devices[device];
+}
+
+/** Translates a sector and offset to an offset within the backing storage and checks the range.
+*/
+static uint32_t GetAddress(Device_t *pDevice, uint8_t sector, uint32_t offset, uint32_t numberOfBytes)
+{
+  N_ERRH_ASSERT_FATAL((sector >= pDevice->firstSector) && (sector < (pDevice->firstSector + pDevice->sectorCount)));
+  N_ERRH_ASSERT_FATAL((offset + numberOfBytes) <= pDevice->sectorSize);
+
+  return (uint32_t)(sector - pDevice->firstSector) * pDevice->sectorSize + offset;
+}
+
+/** Advances the power cut countdown if the event matches its level.
+    \returns TRUE if the power has to be cut now, FALSE otherwise
+*/
+static bool CountEvent(Device_t *pDevice, uint8_t eventMask)
+{
+  if ( (pDevice->cutCountdown == 0u) || ((eventMask & (1u << pDevice->cutLevel)) == 0u) )
+  {
+    return FALSE;
+  }
+
+  pDevice->cutCountdown--;
+  return (pDevice->cutCountdown == 0u);
+}
+
+/** Cuts the power of a device. The pending asynchronous operation is lost.
+*/
+static void CutPower(Device_t *pDevice, D_NvSim_Device_t device)
+{
+  pDevice->poweredOff = TRUE;
+  pDevice->busy = FALSE;
+  pDevice->pfDone = NULL;
+  pDevice->statistics.powerCuts++;
+
+  if ( pDevice->pfCut != NULL )
+  {
+    pDevice->pfCut(device);
+  }
+}
+
+/** Finishes the pending asynchronous operation.
+*/
+static void CompleteOperation(Device_t *pDevice)
+{
+  D_XNv_Callback_t pfDone = pDevice->pfDone;
+
+  pDevice->busy = FALSE;
+  pDevice->pfDone = NULL;
+
+  if ( pfDone != NULL )
+  {
+    pfDone();
+  }
+}
+
+/** Waits for the pending asynchronous operation to finish, like the real
+    drivers do for synchronous requests.
+*/
+static void WaitReady(Device_t *pDevice)
+{
+  if ( pDevice->busy )
+  {
+    if ( s_time < pDevice->busyUntil )
+    {
+      s_time = pDevice->busyUntil;
+    }
+    CompleteOperation(pDevice);
+  }
+}
+
+static void Read(D_NvSim_Device_t device, uint8_t sector, uint16_t offset, uint8_t *pBuffer, uint32_t numberOfBytes)
+{
+  Device_t *pDevice = GetDevice(device);
+  uint32_t address = GetAddress(pDevice, sector, offset, numberOfBytes);
+  uint32_t duration = numberOfBytes * pDevice->timing.readByteUs;
+
+  WaitReady(pDevice);
+  memcpy(pBuffer, &pDevice->pMemory[address], numberOfBytes);
+
+  pDevice->statistics.bytesRead += numberOfBytes;
+  pDevice->statistics.busyTimeUs += duration;
+  s_time += duration;
+}
+
+/** Programs bytes with NOR semantics, page by page.
+    \returns The time needed for programming, microseconds
+*/
+static uint32_t Program(D_NvSim_Device_t device, uint8_t sector, uint16_t offset, const uint8_t *pBuffer,
+                        uint32_t numberOfBytes)
+{
+  Device_t *pDevice = GetDevice(device);
+  uint32_t address = GetAddress(pDevice, sector, offset, numberOfBytes);
+  uint32_t duration = 0u;
+
+  if ( pDevice->poweredOff )
+  {
+    return 0u;
+  }
+  if ( CountEvent(pDevice, CUT_EVENT_CALL) )
+  {
+    CutPower(pDevice, device);
+    return 0u;
+  }
+
+  pDevice->statistics.programCalls++;
+
+  while ( numberOfBytes > 0u )
+  {
+    uint32_t count = pDevice->pageSize - (address % pDevice->pageSize);
+    uint32_t limit;
+
+    if ( count > numberOfBytes )
+    {
+      count = numberOfBytes;
+    }
+    limit = count;
+    if ( CountEvent(pDevice, CUT_EVENT_PAGE) )
+    {
+      limit = count / 2u;
+    }
+
+    for ( uint32_t i = 0u; i < limit; i++ )
+    {
+      uint8_t data = pBuffer[i];
+
+      if ( CountEvent(pDevice, CUT_EVENT_BYTE) )
+      {
+        pDevice->pMemory[address + i] &= (uint8_t)(data | 0x0Fu);
+        pDevice->statistics.bytesProgrammed += i;
+        CutPower(pDevice, device);
+        return duration;
+      }
+      if ( (data & (uint8_t)~pDevice->pMemory[address + i]) != 0u )
+      {
+        pDevice->statistics.programViolations++;
+      }
+      pDevice->pMemory[address + i] &= data;
+    }
+
+    duration += pDevice->timing.programPageUs + limit * pDevice->timing.programByteUs;
+    pDevice->statistics.bytesProgrammed += limit;
+    pDevice->statistics.busyTimeUs += pDevice->timing.programPageUs + limit * pDevice->timing.programByteUs;
+
+    if ( limit < count )
+    {
+      CutPower(pDevice, device);
+      return duration;
+    }
+
+    numberOfBytes -= count;
+    address += count;
+    pBuffer += count;
+  }
+
+  return duration;
+}
+
+/** Erases whole erase units and updates the erase counters of their pages.
+    \returns The time needed for erasing, microseconds
+*/
+static uint32_t Erase(D_NvSim_Device_t device, uint8_t sector, uint32_t offset, uint32_t numberOfBytes)
+{
+  Device_t *pDevice = GetDevice(device);
+  uint32_t address = GetAddress(pDevice, sector, offset, numberOfBytes);
+  uint32_t duration = 0u;
+
+  N_ERRH_ASSERT_FATAL((address % pDevice->eraseUnitSize) == 0u);
+  N_ERRH_ASSERT_FATAL((numberOfBytes % pDevice->eraseUnitSize) == 0u);
+
+  if ( pDevice->poweredOff )
+  {
+    return 0u;
+  }
+  if ( CountEvent(pDevice, CUT_EVENT_CALL) )
+  {
+    CutPower(pDevice, device);
+    return 0u;
+  }
+
+  for ( ; numberOfBytes > 0u; numberOfBytes -= pDevice->eraseUnitSize, address += pDevice->eraseUnitSize )
+  {
+    if ( CountEvent(pDevice, CUT_EVENT_ERASE) )
+    {
+      memset(&pDevice->pMemory[address], 0xFF, pDevice->eraseUnitSize / 2u);
+      CutPower(pDevice, device);
+      return duration;
+    }
+
+    memset(&pDevice->pMemory[address], 0xFF, pDevice->eraseUnitSize);
+    for ( uint32_t page = address / pDevice->pageSize;
+          page < ((address + pDevice->eraseUnitSize) / pDevice->pageSize); page++ )
+    {
+      pDevice->pEraseCount[page]++;
+      pDevice->statistics.pageErases++;
+    }
+
+    duration += pDevice->timing.eraseUs;
+    pDevice->statistics.busyTimeUs += pDevice->timing.eraseUs;
+  }
+
+  return duration;
+}
+
+/** Compares bytes with the contents of a device.
+    \param[in] pBuffer The data to compare with, or NULL to compare with 0xFF
+*/
+static bool Compare(D_NvSim_Device_t device, uint8_t sector, uint16_t offset, const uint8_t *pBuffer,
+                    uint32_t numberOfBytes)
+{
+  Device_t *pDevice = GetDevice(device);
+  uint32_t address = GetAddress(pDevice, sector, offset, numberOfBytes);
+  uint32_t duration = numberOfBytes * pDevice->timing.readByteUs;
+
+  WaitReady(pDevice);
+
+  pDevice->statistics.bytesRead += numberOfBytes;
+  pDevice->statistics.busyTimeUs += duration;
+  s_time += duration;
+
+  for ( uint32_t i = 0u; i < numberOfBytes; i++ )
+  {
+    if ( pDevice->pMemory[address + i] != ((pBuffer != NULL) ? pBuffer[i] : 0xFFu) )
+    {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/** Opens the backing file of a device.
+    \param device The device to open
+    \param pFileName The backing file, or NULL to use anonymous memory
+    \returns TRUE on success, FALSE if the file can not be mapped or has an unexpected size
+*/
+bool D_NvSim_Open(D_NvSim_Device_t device, const char *pFileName)
+{
+  Device_t *pDevice;
+  uint32_t memorySize;
+  size_t fileSize;
+  bool initialize = TRUE;
+  void *pMapping;
+
+  N_ERRH_ASSERT_FATAL(device < DEVICE_COUNT);
+  pDevice = &s_devices[device];
+  N_ERRH_ASSERT_FATAL(pDevice->pMemory == NULL);
+
+  memorySize = pDevice->sectorCount * pDevice->sectorSize;
+  fileSize = memorySize + (memorySize / pDevice->pageSize) * sizeof(uint32_t);
+
+  if ( pFileName == NULL )
+  {
+    pMapping = mmap(NULL, fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  }
+  else
+  {
+    struct stat fileStatus;
+
+    pDevice->fd = open(pFileName, O_RDWR | O_CREAT, 0644);
+    if ( pDevice->fd < 0 )
+    {
+      return FALSE;
+    }
+    if ( fstat(pDevice->fd, &fileStatus) != 0 )
+    {
+      D_NvSim_Close(device);
+      return FALSE;
+    }
+    if ( fileStatus.st_size != 0 )
+    {
+      initialize = FALSE;
+      if ( (size_t) fileStatus.st_size != fileSize )
+      {
+        D_NvSim_Close(device);
+        return FALSE;
+      }
+    }
+    else if ( ftruncate(pDevice->fd, (off_t) fileSize) != 0 )
+    {
+      D_NvSim_Close(device);
+      return FALSE;
+    }
+
+    pMapping = mmap(NULL, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, pDevice->fd, 0);
+  }
+
+  if ( pMapping == MAP_FAILED )
+  {
+    D_NvSim_Close(device);
+    return FALSE;
+  }
+
+  pDevice->pMemory = (uint8_t*) pMapping;
+  pDevice->pEraseCount = (uint32_t*) (pDevice->pMemory + memorySize);
+  pDevice->mappedSize = fileSize;
+  if ( initialize )
+  {
+    memset(pDevice->pMemory, 0xFF, memorySize);
+    memset(pDevice->pEraseCount, 0x00, fileSize - memorySize);
+  }
+
+  memset(&pDevice->statistics, 0x00, sizeof(pDevice->statistics));
+  pDevice->cutCountdown = 0u;
+  pDevice->poweredOff = FALSE;
+  pDevice->busy = FALSE;
+  pDevice->pfDone = NULL;
+
+  return TRUE;
+}
+
+/** Flushes and closes the backing file of a device.
+    \param device The device to close
+*/
+void D_NvSim_Close(D_NvSim_Device_t device)
+{
+  Device_t *pDevice;
+
+  N_ERRH_ASSERT_FATAL(device < DEVICE_COUNT);
+  pDevice = &s_devices[device];
+
+  if ( pDevice->pMemory != NULL )
+  {
+    if ( pDevice->fd >= 0 )
+    {
+      (void) msync(pDevice->pMemory, pDevice->mappedSize, MS_SYNC);
+    }
+    (void) munmap(pDevice->pMemory, pDevice->mappedSize);
+    pDevice->pMemory = NULL;
+    pDevice->pEraseCount = NULL;
+  }
+  if ( pDevice->fd >= 0 )
+  {
+    (void) close(pDevice->fd);
+    pDevice->fd = -1;
+  }
+}
+
+/** Sets the timing of a device.
+    \param device The device to configure
+    \param[in] pTiming The new timing
+*/
+void D_NvSim_SetTiming(D_NvSim_Device_t device, const D_NvSim_Timing_t *pTiming)
+{
+  N_ERRH_ASSERT_FATAL(device < DEVICE_COUNT);
+  s_devices[device].timing = *pTiming;
+}
+
+/** Schedules a power cut.
+    \param device The device to cut the power of
+    \param level The granularity of the countdown
+    \param count The number of units to be completed before the cut, 0 cancels the scheduled cut
+    \param pfCut Function to be called when the cut occurs. Can be NULL.
+*/
+void D_NvSim_SchedulePowerCut(D_NvSim_Device_t device, D_NvSim_CutLevel_t level, uint32_t count,
+                              D_NvSim_PowerCutCallback_t pfCut)
+{
+  Device_t *pDevice;
+
+  N_ERRH_ASSERT_FATAL(device < DEVICE_COUNT);
+  N_ERRH_ASSERT_FATAL(level <= D_NVSIM_CUT_CALL);
+  pDevice = &s_devices[device];
+
+  pDevice->cutLevel = level;
+  // the countdown reaches zero on the unit being interrupted
+  pDevice->cutCountdown = (count != 0u) ? (count + 1u) : 0u;
+  pDevice->pfCut = pfCut;
+}
+
+/** Restores the power of a device after a cut.
+    \param device The device to power on
+*/
+void D_NvSim_PowerOn(D_NvSim_Device_t device)
+{
+  N_ERRH_ASSERT_FATAL(device < DEVICE_COUNT);
+  s_devices[device].poweredOff = FALSE;
+}
+
+/** Checks if the power of a device has been cut.
+    \param device The device to check
+    \returns TRUE if the power is cut, FALSE otherwise
+*/
+bool D_NvSim_IsPoweredOff(D_NvSim_Device_t device)
+{
+  N_ERRH_ASSERT_FATAL(device < DEVICE_COUNT);
+  return s_devices[device].poweredOff;
+}
+
+/** Returns the simulated time.
+    \returns Simulated time, microseconds
+*/
+uint64_t D_NvSim_GetTime(void)
+{
+  return s_time;
+}
+
+/** Advances the simulated clock and completes the asynchronous operations which
+    have finished meanwhile.
+    \param us The time to advance the clock by, microseconds
+*/
+void D_NvSim_AdvanceTime(uint32_t us)
+{
+  s_time += us;
+
+  for ( uint8_t i = 0u; i < DEVICE_COUNT; i++ )
+  {
+    if ( s_devices[i].busy && (s_time >= s_devices[i].busyUntil) )
+    {
+      CompleteOperation(&s_devices[i]);
+    }
+  }
+}
+
+/** Reads the operation statistics of a device.
+    \param device The device to read the statistics of
+    \param[out] pStatistics The buffer to store the statistics to
+    \param reset TRUE to clear the statistics after reading
+*/
+void D_NvSim_GetStatistics(D_NvSim_Device_t device, D_NvSim_Statistics_t *pStatistics, bool reset)
+{
+  N_ERRH_ASSERT_FATAL(device < DEVICE_COUNT);
+
+  *pStatistics = s_devices[device].statistics;
+  if ( reset )
+  {
+    memset(&s_devices[device].statistics, 0x00, sizeof(s_devices[device].statistics));
+  }
+}
+
+/** Calculates the wear distribution of a device over all of its pages.
+    \param device The device to examine
+    \param[out] pWear The buffer to store the wear distribution to
+*/
+void D_NvSim_GetWear(D_NvSim_Device_t device, D_NvSim_Wear_t *pWear)
+{
+  Device_t *pDevice = GetDevice(device);
+
+  pWear->pageCount = (uint16_t) ((pDevice->sectorCount * pDevice->sectorSize) / pDevice->pageSize);
+  pWear->minEraseCount = UINT32_MAX;
+  pWear->maxEraseCount = 0u;
+  pWear->totalEraseCount = 0u;
+
+  for ( uint16_t page = 0u; page < pWear->pageCount; page++ )
+  {
+    uint32_t eraseCount = pDevice->pEraseCount[page];
+
+    if ( eraseCount < pWear->minEraseCount )
+    {
+      pWear->minEraseCount = eraseCount;
+    }
+    if ( eraseCount > pWear->maxEraseCount )
+    {
+      pWear->maxEraseCount = eraseCount;
+    }
+    pWear->totalEraseCount += eraseCount;
+  }
+}
+
+/** Returns the erase counter of a page.
+    \param device The device to examine
+    \param page The index of the page, counted from the start of the first sector
+    \returns The number of times the page has been erased
+*/
+uint32_t D_NvSim_GetPageEraseCount(D_NvSim_Device_t device, uint16_t page)
+{
+  Device_t *pDevice = GetDevice(device);
+
+  N_ERRH_ASSERT_FATAL(page < ((pDevice->sectorCount * pDevice->sectorSize) / pDevice->pageSize));
+  return pDevice->pEraseCount[page];
+}
+
+/***************************************************************************************************
+* D_Nv INTERFACE
+***************************************************************************************************/
+
+void D_Nv_Read(uint8_t sector, uint16_t offset, uint8_t *pBuffer, D_Nv_Size_t numberOfBytes)
+{
+  Read(D_NVSIM_NV, sector, offset, pBuffer, numberOfBytes);
+}
+
+void D_Nv_Write(uint8_t sector, uint16_t offset, uint8_t *pBuffer, D_Nv_Size_t numberOfBytes)
+{
+  N_ERRH_ASSERT_FATAL(numberOfBytes);
+  s_time += Program(D_NVSIM_NV, sector, offset, pBuffer, numberOfBytes);
+}
+
+void D_Nv_EraseSector(uint8_t sector)
+{
+  uint32_t duration = Erase(D_NVSIM_NV, sector, 0u, D_NV_SECTOR_SIZE);
+
+  if ( !s_devices[D_NVSIM_NV].poweredOff )
+  {
+    s_devices[D_NVSIM_NV].statistics.sectorErases++;
+  }
+  s_time += duration;
+}
+
+void D_Nv_ErasePage(uint8_t sector, uint16_t offset)
+{
+  s_time += Erase(D_NVSIM_NV, sector, offset, D_NV_PAGE_SIZE);
+}
+
+bool D_Nv_IsEmpty(uint8_t sector, uint16_t offset, D_Nv_Size_t numberOfBytes)
+{
+  N_ERRH_ASSERT_FATAL(numberOfBytes);
+  return Compare(D_NVSIM_NV, sector, offset, NULL, numberOfBytes);
+}
+
+bool D_Nv_IsEqual(uint8_t sector, uint16_t offset, uint8_t *pBuffer, D_Nv_Size_t numberOfBytes)
+{
+  N_ERRH_ASSERT_FATAL(numberOfBytes);
+  return Compare(D_NVSIM_NV, sector, offset, pBuffer, numberOfBytes);
+}
+
+/***************************************************************************************************
+* D_XNv INTERFACE
+***************************************************************************************************/
+
+void D_XNv_Read(uint8_t sector, uint16_t offset, uint8_t *pBuffer, D_XNv_Size_t numberOfBytes)
+{
+  Read(D_NVSIM_XNV, sector, offset, pBuffer, numberOfBytes);
+}
+
+void D_XNv_Write(uint8_t sector, uint16_t offset, const uint8_t *pBuffer, D_XNv_Size_t numberOfBytes)
+{
+  WaitReady(GetDevice(D_NVSIM_XNV));
+  s_time += Program(D_NVSIM_XNV, sector, offset, pBuffer, numberOfBytes);
+}
+
+void D_XNv_EraseSector(uint8_t sector)
+{
+  uint32_t duration;
+
+  WaitReady(GetDevice(D_NVSIM_XNV));
+  duration = Erase(D_NVSIM_XNV, sector, 0u, D_XNV_SECTOR_SIZE);
+  if ( !s_devices[D_NVSIM_XNV].poweredOff )
+  {
+    s_devices[D_NVSIM_XNV].statistics.sectorErases++;
+  }
+  s_time += duration;
+}
+
+bool D_XNv_IsEmpty(uint8_t sector, uint16_t offset, D_XNv_Size_t numberOfBytes)
+{
+  return Compare(D_NVSIM_XNV, sector, offset, NULL, numberOfBytes);
+}
+
+bool D_XNv_IsEqual(uint8_t sector, uint16_t offset, uint8_t *pBuffer, D_XNv_Size_t numberOfBytes)
+{
+  return Compare(D_NVSIM_XNV, sector, offset, pBuffer, numberOfBytes);
+}
+
+/** The contents change when the asynchronous operation is started, the device
+    stays busy until the simulated clock has passed its duration.
+*/
+bool D_XNv_IsBusy(void)
+{
+  Device_t *pDevice = GetDevice(D_NVSIM_XNV);
+
+  if ( pDevice->busy && (s_time >= pDevice->busyUntil) )
+  {
+    CompleteOperation(pDevice);
+  }
+
+  return pDevice->busy;
+}
+
+void D_XNv_EraseSectorAsync(uint8_t sector, D_XNv_Callback_t pfDone)
+{
+  Device_t *pDevice = GetDevice(D_NVSIM_XNV);
+  uint32_t duration;
+
+  WaitReady(pDevice);
+  duration = Erase(D_NVSIM_XNV, sector, 0u, D_XNV_SECTOR_SIZE);
+  if ( !pDevice->poweredOff )
+  {
+    pDevice->statistics.sectorErases++;
+    pDevice->busy = TRUE;
+    pDevice->busyUntil = s_time + duration;
+    pDevice->pfDone = pfDone;
+  }
+}
+
+#endif // TESTHARNESS
+// eof D_NvSim.c
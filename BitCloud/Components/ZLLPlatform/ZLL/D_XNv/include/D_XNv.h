@@ -43,6 +43,9 @@ typedef uint8_t D_XNv_Size_t;
 typedef uint16_t D_XNv_Size_t;
 #endif
 
+/** Completion callback of the asynchronous D_XNv operations. */
+typedef void (*D_XNv_Callback_t)(void);
+
 /***************************************************************************************************
 * EXPORTED MACROS AND CONSTANTS
 ***************************************************************************************************/
@@ -101,6 +104,22 @@ bool D_XNv_IsEmpty(uint8_t sector, uint16_t offset, D_XNv_Size_t numberOfBytes);
 */
 bool D_XNv_IsEqual(uint8_t sector, uint16_t offset, uint8_t *pBuffer, D_XNv_Size_t numberOfBytes);
 
+#if !defined BOOTLOADER
+/** Checks if a program or erase operation is in progress. Does not wait for the operation to finish.
+    \returns TRUE if an asynchronous operation is pending or the external NV is busy, FALSE otherwise.
+*/
+bool D_XNv_IsBusy(void);
+
+/** Starts erasing a sector of the external NV. The end of the erase is detected by polling the
+    status of the external NV on a timer.
+    \param sector The sector to erase (0..7)
+    \param pfDone Function to be called when the erase has finished. Can be NULL.
+    \note Only one asynchronous operation can be pending at a time.
+    \note Synchronous requests issued meanwhile will wait until the erase has finished.
+*/
+void D_XNv_EraseSectorAsync(uint8_t sector, D_XNv_Callback_t pfDone);
+#endif
+
 /***************************************************************************************************
 * END OF C++ DECLARATION WRAPPER
 ***************************************************************************************************/
@@ -4,5 +4,7 @@
 #define D_XNv_EraseSector D_XNv_EraseSector_Impl
 #define D_XNv_IsEmpty D_XNv_IsEmpty_Impl
 #define D_XNv_IsEqual D_XNv_IsEqual_Impl
+#define D_XNv_IsBusy D_XNv_IsBusy_Impl
+#define D_XNv_EraseSectorAsync D_XNv_EraseSectorAsync_Impl
 
 // no used interfaces
@@ -40,6 +40,7 @@ $Id: D_XNv-ATmega.c 24615 2013-02-27 05:14:24Z mahendranp $
 #include "D_XNv.h"
 #include "N_Types.h"
 #include <appTimer.h>
+#include "N_ErrH.h"
 
 /***************************************************************************************************
 * EXTERNAL INCLUDE FILES
@@ -96,6 +97,13 @@ $Id: D_XNv-ATmega.c 24615 2013-02-27 05:14:24Z mahendranp $
 
 #define D_XVN_CS_VALUE  (uint8_t)(1u << (D_XNV_PIN_CS & 0x07u))
 
+#define D_XNV_PAGE_SIZE         0x100u
+
+/** Interval of polling the external NV status while a sector is erased asynchronously. */
+#ifndef D_XNV_ERASE_POLL_INTERVAL_MS
+#define D_XNV_ERASE_POLL_INTERVAL_MS 20u
+#endif
+
 /***************************************************************************************************
 * LOCAL VARIABLES
 ***************************************************************************************************/
@@ -103,6 +111,23 @@ $Id: D_XNv-ATmega.c 24615 2013-02-27 05:14:24Z mahendranp $
 //to handle sys integrity checks
 static D_XNv_SystemCheckCallback_t s_pfSystemCheckCallback = NULL;
 
+#if !defined BOOTLOADER
+static void BusyPollTimerFired(void);
+
+/** Pending asynchronous operation. */
+static struct
+{
+    bool pending;
+    D_XNv_Callback_t pfDone;
+} s_asyncOperation;
+
+static HAL_AppTimer_t s_busyPollTimer =
+{
+    .mode     = TIMER_ONE_SHOT_MODE,
+    .callback = BusyPollTimerFired
+};
+#endif
+
 /***************************************************************************************************
 * LOCAL FUNCTIONS
 ***************************************************************************************************/
@@ -164,20 +189,102 @@ static inline uint8_t SpiRxByte(void)
     return SPDR;
 }
 
+/** Checks if a previous write or sector erase is still in progress. */
+static bool IsWriteInProgress(void)
+{
+    uint8_t status;
+
+    SelectFlash();
+    SpiTxByteAndWait(D_XNV_READ_STATUS_CMD);
+    SpiTxByteAndWait(0u);
+    status = SpiRxByte();
+    DeselectFlash();
+
+    return ((status & D_XNV_STATUS_WIP) != 0u);
+}
+
 /** Wait unit a previous write or sector erase has finished. This can take really long! */
 static void WaitUntilWriteFinished(void)
 {
-	uint8_t status;
-	do
-	{
-		SelectFlash();
-		SpiTxByteAndWait(D_XNV_READ_STATUS_CMD);
-		SpiTxByteAndWait(0u);
-		status = SpiRxByte();
-		DeselectFlash();
-	}
-	while ( status & D_XNV_STATUS_WIP );
+    while ( IsWriteInProgress() )
+    {
+        // no action
+    }
+}
+
+static void WriteEnable(void)
+{
+    SelectFlash();
+    SpiTxByteAndWait(D_XNV_WRITE_ENABLE_CMD);
+    DeselectFlash();
+}
+
+/** Starts programming of bytes up to the end of the page. Does not wait for programming to finish.
+    \returns The number of bytes being programmed
+*/
+static uint16_t ProgramPage(uint8_t sector, uint16_t offset, const uint8_t *pBuffer, D_XNv_Size_t numberOfBytes)
+{
+    uint16_t count = D_XNV_PAGE_SIZE - (offset & (D_XNV_PAGE_SIZE - 1u));
+
+    if ( count > numberOfBytes )
+    {
+        count = numberOfBytes;
+    }
+
+    WriteEnable();
+
+    SelectFlash();
+    SpiTxByteAndWait(D_XNV_PAGE_PROGRAM_CMD);
+    SpiTxByteAndWait(sector);
+    SpiTxByteAndWait((uint8_t)(offset >> 8));
+    SpiTxByteAndWait((uint8_t)offset);
+    for ( uint16_t i = 0u; i < count; i++ )
+    {
+        SpiTxByteAndWait(pBuffer[i]);
+    }
+    DeselectFlash();
+
+    return count;
+}
+
+static void StartEraseSector(uint8_t sector)
+{
+#if defined(ENABLE_NV_USAGE_SIMULATION)
+    N_LOG_ALWAYS(("EraseSector,%hu", sector));
+#endif
+    WriteEnable();
+
+    SelectFlash();
+    SpiTxByteAndWait(D_XNV_SECTOR_ERASE_CMD);
+    SpiTxByteAndWait(sector);
+    SpiTxByteAndWait(0x00u);
+    SpiTxByteAndWait(0x00u);
+    DeselectFlash();
+}
+
+#if !defined BOOTLOADER
+/** Busy poll timer callback. Completes the pending asynchronous operation.
+*/
+static void BusyPollTimerFired(void)
+{
+    D_XNv_Callback_t pfDone;
+
+    if ( IsWriteInProgress() )
+    {
+        HAL_StartAppTimer(&s_busyPollTimer);
+        return;
+    }
+
+    pfDone = s_asyncOperation.pfDone;
+    s_asyncOperation.pending = FALSE;
+    s_asyncOperation.pfDone = NULL;
+
+    if ( pfDone != NULL )
+    {
+        pfDone();
+    }
 }
+#endif
 
 static inline uint8_t ReadSingleByte(void)
 {
@@ -237,48 +344,22 @@ void D_XNv_Read_Impl(uint8_t sector, uint16_t offset, uint8_t *pBuffer, D_XNv_Si
 
 void D_XNv_Write_Impl(uint8_t sector, uint16_t offset, const uint8_t *pBuffer, D_XNv_Size_t numberOfBytes)
 {
+    uint16_t count;
+
     while (numberOfBytes != 0u)
     {
         WaitUntilWriteFinished();
-
-        SelectFlash();
-        SpiTxByteAndWait(D_XNV_WRITE_ENABLE_CMD);
-        DeselectFlash();
-
-        SelectFlash();
-        SpiTxByteAndWait(D_XNV_PAGE_PROGRAM_CMD);
-        SpiTxByteAndWait(sector);
-        SpiTxByteAndWait((uint8_t)(offset >> 8));
-        SpiTxByteAndWait((uint8_t)offset);
-        do
-        {
-            SpiTxByteAndWait(*pBuffer);
-            pBuffer++;
-            numberOfBytes--;
-            offset++;
-        }
-        while ( ( numberOfBytes != 0u ) && ( (offset & 0x00FFu) != 0x0000u ) );
-        DeselectFlash();
+        count = ProgramPage(sector, offset, pBuffer, numberOfBytes);
+        pBuffer += count;
+        offset += count;
+        numberOfBytes -= count;
     }
 }
 
 void D_XNv_EraseSector_Impl(uint8_t sector)
 {
-#if defined(ENABLE_NV_USAGE_SIMULATION)
-    N_LOG_ALWAYS(("EraseSector,%hu", sector));
-#endif
     WaitUntilWriteFinished();
-
-    SelectFlash();
-    SpiTxByteAndWait(D_XNV_WRITE_ENABLE_CMD);
-    DeselectFlash();
-
-    SelectFlash();
-    SpiTxByteAndWait(D_XNV_SECTOR_ERASE_CMD);
-    SpiTxByteAndWait(sector);
-    SpiTxByteAndWait(0x00u);
-    SpiTxByteAndWait(0x00u);
-    DeselectFlash();
+    StartEraseSector(sector);
 }
 
 bool D_XNv_IsEmpty_Impl(uint8_t sector, uint16_t offset, D_XNv_Size_t numberOfBytes)
@@ -328,3 +409,24 @@ bool D_XNv_IsEqual_Impl(uint8_t sector, uint16_t offset, uint8_t *pBuffer, D_XNv
 
     return isEqual;
 }
+
+#if !defined BOOTLOADER
+bool D_XNv_IsBusy_Impl(void)
+{
+    return s_asyncOperation.pending || IsWriteInProgress();
+}
+
+void D_XNv_EraseSectorAsync_Impl(uint8_t sector, D_XNv_Callback_t pfDone)
+{
+    N_ERRH_ASSERT_FATAL(!s_asyncOperation.pending);
+
+    WaitUntilWriteFinished();
+    StartEraseSector(sector);
+
+    s_asyncOperation.pending = TRUE;
+    s_asyncOperation.pfDone = pfDone;
+
+    s_busyPollTimer.interval = D_XNV_ERASE_POLL_INTERVAL_MS;
+    HAL_StartAppTimer(&s_busyPollTimer);
+}
+#endif
@@ -44,6 +44,8 @@ $Id: D_XNv-SamR21.c 24615 2013-02-27 05:14:24Z mahendranp $
 #include <atsamr21.h>
 #include <atomic.h>
 #include <spi.h>
+#include <string.h>
+#include "N_ErrH.h"
 
 /***************************************************************************************************
 * EXTERNAL INCLUDE FILES
@@ -82,6 +84,7 @@ $Id: D_XNv-SamR21.c 24615 2013-02-27 05:14:24Z mahendranp $
 #define SC_SPI_DATA        SC5_SPI_DATA
 #define SC_SPI_INTFLAG     SC5_SPI_INTFLAG
 #define SC_SPI_INTFLAG_RXC SC5_SPI_INTFLAG_RXC
+#define SC_SPI_INTFLAG_DRE SC5_SPI_INTFLAG_DRE
 
 #else
 
@@ -101,9 +104,20 @@ $Id: D_XNv-SamR21.c 24615 2013-02-27 05:14:24Z mahendranp $
 #define SC_SPI_DATA        SC2_SPI_DATA
 #define SC_SPI_INTFLAG     SC2_SPI_INTFLAG
 #define SC_SPI_INTFLAG_RXC SC2_SPI_INTFLAG_RXC
+#define SC_SPI_INTFLAG_DRE SC2_SPI_INTFLAG_DRE
 
 #endif
 
+#define D_XNV_PAGE_SIZE         0x100u
+
+/** Size of the buffer used to check the contents of the external NV. */
+#define D_XNV_CHECK_BUFFER_SIZE 16u
+
+/** Interval of polling the external NV status while a sector is erased asynchronously. */
+#ifndef D_XNV_ERASE_POLL_INTERVAL_MS
+#define D_XNV_ERASE_POLL_INTERVAL_MS 20u
+#endif
+
 /***************************************************************************************************
 * LOCAL VARIABLES
 ***************************************************************************************************/
@@ -111,6 +125,23 @@ $Id: D_XNv-SamR21.c 24615 2013-02-27 05:14:24Z mahendranp $
 //to handle sys integrity checks
 static D_XNv_SystemCheckCallback_t s_pfSystemCheckCallback = NULL;
 
+#if !defined BOOTLOADER
+static void BusyPollTimerFired(void);
+
+/** Pending asynchronous operation. */
+static struct
+{
+    bool pending;
+    D_XNv_Callback_t pfDone;
+} s_asyncOperation;
+
+static HAL_AppTimer_t s_busyPollTimer =
+{
+    .mode     = TIMER_ONE_SHOT_MODE,
+    .callback = BusyPollTimerFired
+};
+#endif
+
 /***************************************************************************************************
 * LOCAL FUNCTIONS
 ***************************************************************************************************/
@@ -190,27 +221,144 @@ static inline void SpiTxByteWaitAndDummyReadByte(uint8_t value)
     SpiRxByte();
 }
 
+/** Transfers a block of bytes over SPI. The next byte is put to the transmit buffer while the
+    previous one is being shifted, so the SPI clock runs without gaps.
+    \param[in] pTxBuffer Bytes to transmit, or NULL to transmit dummy bytes
+    \param[out] pRxBuffer Buffer for the received bytes, or NULL to drop them
+    \param length The number of bytes to transfer
+*/
+static void SpiTransferBlock(const uint8_t *pTxBuffer, uint8_t *pRxBuffer, uint16_t length)
+{
+    uint16_t txIndex = 0u;
+    uint16_t rxIndex = 0u;
+    uint8_t value;
+
+    if ( length == 0u )
+    {
+        return;
+    }
+
+    SpiTxByte((pTxBuffer != NULL) ? pTxBuffer[txIndex] : 0u);
+    txIndex++;
+
+    // At most two bytes are in flight, so the double buffered receiver can not overflow
+    // even if the loop is interrupted.
+    while ( rxIndex < length )
+    {
+        if ( txIndex < length )
+        {
+            while ( !(SC_SPI_INTFLAG & SC_SPI_INTFLAG_DRE) )
+            {
+                // no action
+            }
+            SpiTxByte((pTxBuffer != NULL) ? pTxBuffer[txIndex] : 0u);
+            txIndex++;
+        }
+
+        SpiTxWaitReady();
+        value = SpiRxByte();
+        if ( pRxBuffer != NULL )
+        {
+            pRxBuffer[rxIndex] = value;
+        }
+        rxIndex++;
+    }
+}
+
+/** Checks if a previous write or sector erase is still in progress. */
+static bool IsWriteInProgress(void)
+{
+    uint8_t status;
+
+    SelectFlash();
+    SpiTxByteWaitAndDummyReadByte(D_XNV_READ_STATUS_CMD);
+    SpiTxByteAndWait(0u);
+    status = SpiRxByte();
+    DeselectFlash();
+
+    return ((status & D_XNV_STATUS_WIP) != 0u);
+}
+
 /** Wait unit a previous write or sector erase has finished. This can take really long! */
 static void WaitUntilWriteFinished(void)
 {
-	uint8_t status;
-	do
-	{
-		SelectFlash();
-		SpiTxByteWaitAndDummyReadByte(D_XNV_READ_STATUS_CMD);
-		SpiTxByteAndWait(0u);
-		status = SpiRxByte();
-		DeselectFlash();
-	}
-	while ( status & D_XNV_STATUS_WIP );
+    while ( IsWriteInProgress() )
+    {
+        // no action
+    }
 }
 
-static inline uint8_t ReadSingleByte(void)
+/** Selects the flash and sends a command followed by the address. */
+static void StartCommand(uint8_t command, uint8_t sector, uint16_t offset)
 {
-    SpiTxByteAndWait(0u);
-    return SpiRxByte();
+    SelectFlash();
+    SpiTxByteWaitAndDummyReadByte(command);
+    SpiTxByteWaitAndDummyReadByte(sector);
+    SpiTxByteWaitAndDummyReadByte((uint8_t)(offset >> 8));
+    SpiTxByteWaitAndDummyReadByte((uint8_t)offset);
 }
 
+static void WriteEnable(void)
+{
+    SelectFlash();
+    SpiTxByteWaitAndDummyReadByte(D_XNV_WRITE_ENABLE_CMD);
+    DeselectFlash();
+}
+
+/** Starts programming of bytes up to the end of the page. Does not wait for programming to finish.
+    \returns The number of bytes being programmed
+*/
+static uint16_t ProgramPage(uint8_t sector, uint16_t offset, const uint8_t *pBuffer, D_XNv_Size_t numberOfBytes)
+{
+    uint16_t count = D_XNV_PAGE_SIZE - (offset & (D_XNV_PAGE_SIZE - 1u));
+
+    if ( count > numberOfBytes )
+    {
+        count = numberOfBytes;
+    }
+
+    WriteEnable();
+    StartCommand(D_XNV_PAGE_PROGRAM_CMD, sector, offset);
+    SpiTransferBlock(pBuffer, NULL, count);
+    DeselectFlash();
+
+    return count;
+}
+
+static void StartEraseSector(uint8_t sector)
+{
+#if defined(ENABLE_NV_USAGE_SIMULATION)
+    N_LOG_ALWAYS(("EraseSector,%hu", sector));
+#endif
+    WriteEnable();
+    StartCommand(D_XNV_SECTOR_ERASE_CMD, sector, 0x0000u);
+    DeselectFlash();
+}
+
+#if !defined BOOTLOADER
+/** Busy poll timer callback. Completes the pending asynchronous operation.
+*/
+static void BusyPollTimerFired(void)
+{
+    D_XNv_Callback_t pfDone;
+
+    if ( IsWriteInProgress() )
+    {
+        HAL_StartAppTimer(&s_busyPollTimer);
+        return;
+    }
+
+    pfDone = s_asyncOperation.pfDone;
+    s_asyncOperation.pending = FALSE;
+    s_asyncOperation.pfDone = NULL;
+
+    if ( pfDone != NULL )
+    {
+        pfDone();
+    }
+}
+#endif
+
 /***************************************************************************************************
 * EXPORTED FUNCTIONS
 ***************************************************************************************************/
@@ -325,109 +473,99 @@ void D_XNv_Read_Impl(uint8_t sector, uint16_t offset, uint8_t *pBuffer, D_XNv_Si
 {
     WaitUntilWriteFinished();
 
-    SelectFlash();
-    SpiTxByteWaitAndDummyReadByte(D_XNV_READ_CMD);
-    SpiTxByteWaitAndDummyReadByte(sector);
-    SpiTxByteWaitAndDummyReadByte((uint8_t)(offset >> 8));
-    SpiTxByteWaitAndDummyReadByte((uint8_t)offset);
-
-    while ( numberOfBytes != 0u )
-    {
-        *pBuffer = ReadSingleByte();
-        pBuffer++;
-        numberOfBytes--;
-    }
-
+    StartCommand(D_XNV_READ_CMD, sector, offset);
+    SpiTransferBlock(NULL, pBuffer, numberOfBytes);
     DeselectFlash();
 }
 
 void D_XNv_Write_Impl(uint8_t sector, uint16_t offset, const uint8_t *pBuffer, D_XNv_Size_t numberOfBytes)
 {
+    uint16_t count;
+
     while (numberOfBytes != 0u)
     {
         WaitUntilWriteFinished();
-        SelectFlash();
-        SpiTxByteWaitAndDummyReadByte(D_XNV_WRITE_ENABLE_CMD);
-        DeselectFlash();
-
-        SelectFlash();
-        SpiTxByteWaitAndDummyReadByte(D_XNV_PAGE_PROGRAM_CMD);
-        SpiTxByteWaitAndDummyReadByte(sector);
-        SpiTxByteWaitAndDummyReadByte((uint8_t)(offset >> 8));
-        SpiTxByteWaitAndDummyReadByte((uint8_t)offset);
-        do
-        {
-            SpiTxByteWaitAndDummyReadByte(*pBuffer);
-            pBuffer++;
-            numberOfBytes--;
-            offset++;
-        }
-        while ( ( numberOfBytes != 0u ) && ( (offset & 0x00FFu) != 0x0000u ) );
-        DeselectFlash();
+        count = ProgramPage(sector, offset, pBuffer, numberOfBytes);
+        pBuffer += count;
+        offset += count;
+        numberOfBytes -= count;
     }
 }
 
 void D_XNv_EraseSector_Impl(uint8_t sector)
 {
-#if defined(ENABLE_NV_USAGE_SIMULATION)
-    N_LOG_ALWAYS(("EraseSector,%hu", sector));
-#endif
     WaitUntilWriteFinished();
-    SelectFlash();
-    SpiTxByteWaitAndDummyReadByte(D_XNV_WRITE_ENABLE_CMD);
-    DeselectFlash();
-
-    SelectFlash();
-    SpiTxByteWaitAndDummyReadByte(D_XNV_SECTOR_ERASE_CMD);
-    SpiTxByteWaitAndDummyReadByte(sector);
-    SpiTxByteWaitAndDummyReadByte(0x00u);
-    SpiTxByteWaitAndDummyReadByte(0x00u);
-    DeselectFlash();
+    StartEraseSector(sector);
 }
 
 bool D_XNv_IsEmpty_Impl(uint8_t sector, uint16_t offset, D_XNv_Size_t numberOfBytes)
 {
+    uint8_t buffer[D_XNV_CHECK_BUFFER_SIZE];
+    uint8_t andedContent = 0xFFu;
+    // numberOfBytes equal to 0 requests to check the whole range of D_XNv_Size_t
+    uint32_t remaining = (numberOfBytes != 0u) ? numberOfBytes : ((uint32_t)(D_XNv_Size_t)~0u + 1uL);
+    uint16_t count;
+
     WaitUntilWriteFinished();
 
-    SelectFlash();
-    SpiTxByteWaitAndDummyReadByte(D_XNV_READ_CMD);
-    SpiTxByteWaitAndDummyReadByte(sector);
-    SpiTxByteWaitAndDummyReadByte((uint8_t)(offset >> 8));
-    SpiTxByteWaitAndDummyReadByte((uint8_t)offset);
+    StartCommand(D_XNV_READ_CMD, sector, offset);
 
-    uint8_t andedContent = 0xFFu;
-    do
+    while ((andedContent == 0xFFu) && (remaining != 0u))
     {
-        andedContent &= ReadSingleByte();
-        numberOfBytes--; // will wrap from 0 to 0xFFFF when numberOfBytes equals 0 on entry
+        count = (remaining < sizeof(buffer)) ? (uint16_t)remaining : (uint16_t)sizeof(buffer);
+        SpiTransferBlock(NULL, buffer, count);
+        for ( uint16_t i = 0u; i < count; i++ )
+        {
+            andedContent &= buffer[i];
+        }
+        remaining -= count;
     }
-    while ((andedContent == 0xFFu) && (numberOfBytes != 0u));
 
     DeselectFlash();
-   return (andedContent == 0xFFu);
+    return (andedContent == 0xFFu);
 }
 
 bool D_XNv_IsEqual_Impl(uint8_t sector, uint16_t offset, uint8_t *pBuffer, D_XNv_Size_t numberOfBytes)
 {
+    uint8_t buffer[D_XNV_CHECK_BUFFER_SIZE];
     bool isEqual = TRUE;
+    uint16_t count;
 
     WaitUntilWriteFinished();
 
-    SelectFlash();
-    SpiTxByteWaitAndDummyReadByte(D_XNV_READ_CMD);
-    SpiTxByteWaitAndDummyReadByte(sector);
-    SpiTxByteWaitAndDummyReadByte((uint8_t)(offset >> 8));
-    SpiTxByteWaitAndDummyReadByte((uint8_t)offset);
+    StartCommand(D_XNV_READ_CMD, sector, offset);
 
     while ((isEqual) && (numberOfBytes != 0u))
     {
-        isEqual = (*pBuffer == ReadSingleByte());
-        pBuffer++;
-
-        numberOfBytes--;
+        count = (numberOfBytes < sizeof(buffer)) ? numberOfBytes : (uint16_t)sizeof(buffer);
+        SpiTransferBlock(NULL, buffer, count);
+        isEqual = (memcmp(pBuffer, buffer, count) == 0);
+        pBuffer += count;
+        numberOfBytes -= count;
     }
 
     DeselectFlash();
 
     return isEqual;
 }
+
+#if !defined BOOTLOADER
+bool D_XNv_IsBusy_Impl(void)
+{
+    return s_asyncOperation.pending || IsWriteInProgress();
+}
+
+void D_XNv_EraseSectorAsync_Impl(uint8_t sector, D_XNv_Callback_t pfDone)
+{
+    N_ERRH_ASSERT_FATAL(!s_asyncOperation.pending);
+
+    WaitUntilWriteFinished();
+    StartEraseSector(sector);
+
+    s_asyncOperation.pending = TRUE;
+    s_asyncOperation.pfDone = pfDone;
+
+    s_busyPollTimer.interval = D_XNV_ERASE_POLL_INTERVAL_MS;
+    HAL_StartAppTimer(&s_busyPollTimer);
+}
+#endif
@@ -38,6 +38,7 @@ $Id: N_AddressManager.c 24615 2013-02-27 05:14:24Z arazinkov $
 #include "N_Types.h"
 
 #include <sysEvents.h>
+#include <appTimer.h>
 #include <macAddr.h>
 #include <nwkCommon.h>
 
@@ -58,6 +59,24 @@ $Id: N_AddressManager.c 24615 2013-02-27 05:14:24Z arazinkov $
 #define VALID_GROUP_MAX                 0xFEFFu
 #define VALID_GROUP_COUNT               ((VALID_GROUP_MAX - VALID_GROUP_MIN) + 1u)
 
+/** Amount of randomly allocated addresses and group ranges that are remembered
+    to avoid handing them out again */
+#ifndef N_ADDRESSMANAGER_RECENT_ADDRESSES
+#  define N_ADDRESSMANAGER_RECENT_ADDRESSES    16u
+#endif
+#ifndef N_ADDRESSMANAGER_RECENT_GROUPS
+#  define N_ADDRESSMANAGER_RECENT_GROUPS       8u
+#endif
+
+/** Delay before recently allocated values are written to flash, so that a burst
+    of allocations (e.g. during touchlink) results in a single write */
+#ifndef N_ADDRESSMANAGER_RECENT_WRITE_DELAY_MS
+#  define N_ADDRESSMANAGER_RECENT_WRITE_DELAY_MS    2000u
+#endif
+
+/** Amount of intervals the random address and group spaces consist of */
+#define RANDOM_SPACE_INTERVALS          2u
+
 /***************************************************************************************************
 * LOCAL TYPES
 ***************************************************************************************************/
@@ -76,11 +95,29 @@ typedef struct N_AddressManager_GroupValidRanges_t
     uint16_t groupAddrEnd;
 } N_AddressManager_GroupValidRanges_t;
 
+typedef struct N_AddressManager_Interval_t
+{
+    uint16_t first;
+    uint16_t last;
+} N_AddressManager_Interval_t;
+
+/** Randomly allocated values, kept in flash. An all-zero entry is empty,
+    as zero is never a valid random address or group identifier. */
+typedef struct N_AddressManager_Recent_t
+{
+    uint16_t address[N_ADDRESSMANAGER_RECENT_ADDRESSES];
+    uint16_t groupFirst[N_ADDRESSMANAGER_RECENT_GROUPS];
+    uint8_t groupCount[N_ADDRESSMANAGER_RECENT_GROUPS];
+    uint8_t addressNext;
+    uint8_t groupNext;
+} N_AddressManager_Recent_t;
+
 /***************************************************************************************************
 * FUNCTIONS PROTOTYPES
 ***************************************************************************************************/
 static void nAddressManagerObserver(SYS_EventId_t eventId, SYS_EventData_t data);
 static void nAddressManagerAllocNwkAddrForAssociatingDevice(ShortAddr_t *const address);
+static void recentWriteTimerFired(void);
 
 /***************************************************************************************************
 * LOCAL VARIABLES
@@ -102,6 +139,43 @@ static N_AddressManager_GroupValidRanges_t s_groupValidRanges =
 /* BitCloud events receiver */
 static SYS_EventReceiver_t bcEventReceiver = { .func = nAddressManagerObserver};
 
+static N_AddressManager_Recent_t s_recent;
+static bool s_recentWritePending = FALSE;
+
+static HAL_AppTimer_t s_recentWriteTimer =
+{
+  .mode = TIMER_ONE_SHOT_MODE,
+  .interval = N_ADDRESSMANAGER_RECENT_WRITE_DELAY_MS,
+  .callback = recentWriteTimerFired
+};
+
+/** Valid random addresses.
+    0x0000 is not valid because it is the ZigBee Coordinator address.
+    0x0001..0x000F are not valid because they are the first addresses
+    allocated from the pool of the first address assignment capable device.
+    0x7FFC..0x800F are not valid because they are the first addresses
+    allocated from the pool of the second address assignment capable device.
+    0xFFF8..0xFFFF are not valid because they are ZigBee Broadcast addresses */
+static const N_AddressManager_Interval_t s_randomAddressSpace[RANDOM_SPACE_INTERVALS] =
+{
+    { 0x0010u, 0x7FFBu },
+    { 0x8010u, 0xFFF7u },
+};
+
+/** Valid random groups.
+    0x0000 is not valid because it is not a valid ZigBee group id
+    0x0001..0x000F are not valid because they are the first groups
+    allocated from the pool of the first address assignment capable device.
+    0x7F80..0x7F8F are not valid because they are the first groups
+    allocated from the pool of the second address assignment capable device.
+    0xFF00..0xFFFF are not valid because they are reserved by for future
+    specification enhancements. */
+static const N_AddressManager_Interval_t s_randomGroupSpace[RANDOM_SPACE_INTERVALS] =
+{
+    { 0x0010u, 0x7F7Fu },
+    { 0x7F90u, 0xFEFFu },
+};
+
 /***************************************************************************************************
 * LOCAL FUNCTIONS
 ***************************************************************************************************/
@@ -113,78 +187,174 @@ static void WriteFreeRanges(void)
   N_ERRH_ASSERT_FATAL(ret == S_Nv_ReturnValue_Ok);
 }
 
-static bool IsValidRandomAddress(uint16_t address)
+static void WriteRecent(void)
 {
-    // 0x0000 is not valid because it is the ZigBee Coordinator address.
-    // 0x0001..0x000F are not valid because they are the first addresses
-    // allocated from the pool of the first address assignment capable device.
-    if ( (address <= 0x000Fu) )
-    {
-        return FALSE;
-    }
-    // 0x7FFC..0x800F are not valid because they are the first addresses
-    // allocated from the pool of the second address assignment capable device.
-    if ( (address >= 0x7FFCu) && (address <= 0x800Fu) )
+  // flash access
+  S_Nv_ReturnValue_t ret = S_Nv_Write(RECENT_ASSIGNMENTS_STORAGE_ID, 0u, sizeof(s_recent), &s_recent);
+  N_ERRH_ASSERT_FATAL(ret == S_Nv_ReturnValue_Ok);
+}
+
+/** Schedules a deferred write of the recently allocated values. Losing the last
+    allocations on a reset only weakens the collision avoidance. */
+static void ScheduleWriteRecent(void)
+{
+  if ( !s_recentWritePending )
+  {
+    s_recentWritePending = TRUE;
+    HAL_StartAppTimer(&s_recentWriteTimer);
+  }
+}
+
+static void recentWriteTimerFired(void)
+{
+  s_recentWritePending = FALSE;
+  WriteRecent();
+}
+
+/** Returns the amount of first values of blocks of blockSize consecutive values
+    which fit completely into one of the intervals
+*/
+static uint32_t GetRandomSpaceSize(const N_AddressManager_Interval_t* pSpace, uint8_t blockSize)
+{
+    uint32_t size = 0uL;
+
+    for ( uint8_t i = 0u; i < RANDOM_SPACE_INTERVALS; i++ )
     {
-        return FALSE;
+        uint32_t intervalSize = ((uint32_t) pSpace[i].last - (uint32_t) pSpace[i].first) + 1uL;
+
+        if ( intervalSize >= blockSize )
+        {
+            size += (intervalSize - blockSize) + 1uL;
+        }
     }
-    // 0xFFF8..0xFFFF are not valid because they are ZigBee Broadcast addresses
-    if ( (address >= 0xFFF8u) )
+
+    return size;
+}
+
+/** Maps a uniformly drawn index to the first value of a block in the random space
+*/
+static uint16_t GetRandomSpaceValue(const N_AddressManager_Interval_t* pSpace, uint8_t blockSize, uint32_t index)
+{
+    for ( uint8_t i = 0u; i < RANDOM_SPACE_INTERVALS; i++ )
     {
-        return FALSE;
+        uint32_t intervalSize = ((uint32_t) pSpace[i].last - (uint32_t) pSpace[i].first) + 1uL;
+
+        if ( intervalSize >= blockSize )
+        {
+            intervalSize = (intervalSize - blockSize) + 1uL;
+            if ( index < intervalSize )
+            {
+                return (uint16_t) (pSpace[i].first + index);
+            }
+            index -= intervalSize;
+        }
     }
 
-    return TRUE;
+    return pSpace[0].first;
 }
 
-static bool IsValidRandomGroup(uint16_t groupFirst, uint8_t numGroups)
+/** Returns the first valid block start which is not less than value, wrapping around
+*/
+static uint16_t GetNextRandomSpaceValue(const N_AddressManager_Interval_t* pSpace, uint8_t blockSize, uint32_t value)
 {
-    for ( uint8_t i = 0u; i < numGroups; i++ )
+    for ( uint8_t i = 0u; i < RANDOM_SPACE_INTERVALS; i++ )
     {
-        uint16_t group = groupFirst + i;
+        uint32_t lastStart = ((uint32_t) pSpace[i].last + 1uL) - blockSize;
 
-        // 0x0000 is not valid because it is not a valid ZigBee group id
-        // 0x0001..0x000F are not valid because they are the first groups
-        // allocated from the pool of the first address assignment capable device.
-        if ( (group <= 0x000Fu) )
+        if ( value < pSpace[i].first )
         {
-            return FALSE;
+            value = pSpace[i].first;
         }
-        // 0x7F80..0x7F8F are not valid because they are the first groups
-        // allocated from the pool of the second address assignment capable device.
-        if ( (group >= 0x7F80u) && (group <= 0x7F8Fu) )
+        if ( value <= lastStart )
         {
-            return FALSE;
+            return (uint16_t) value;
         }
-        // 0xFF00..0xFFFF are not valid because they are reserved by for future
-        // specification enhancements.
-        if ( (group >= 0xFF00u) )
+    }
+
+    return pSpace[0].first;
+}
+
+/** Draws the first value of a block uniformly from the random space in constant time
+*/
+static uint16_t DrawRandomSpaceValue(const N_AddressManager_Interval_t* pSpace, uint8_t blockSize)
+{
+    uint32_t index = ((uint32_t) N_Util_Random() * GetRandomSpaceSize(pSpace, blockSize)) >> 16;
+
+    return GetRandomSpaceValue(pSpace, blockSize, index);
+}
+
+static bool IsRecentAddress(uint16_t address)
+{
+    for ( uint8_t i = 0u; i < N_ADDRESSMANAGER_RECENT_ADDRESSES; i++ )
+    {
+        if ( s_recent.address[i] == address )
         {
-            return FALSE;
+            return TRUE;
         }
     }
 
-    return TRUE;
+    return FALSE;
+}
+
+/** Returns the index of a recently allocated group range overlapping with the given one,
+    or N_ADDRESSMANAGER_RECENT_GROUPS if there is none
+*/
+static uint8_t FindRecentGroups(uint16_t groupFirst, uint8_t numGroups)
+{
+    uint8_t i;
+
+    for ( i = 0u; i < N_ADDRESSMANAGER_RECENT_GROUPS; i++ )
+    {
+        if ( (s_recent.groupCount[i] != 0u) &&
+             ((uint32_t) groupFirst < ((uint32_t) s_recent.groupFirst[i] + s_recent.groupCount[i])) &&
+             ((uint32_t) s_recent.groupFirst[i] < ((uint32_t) groupFirst + numGroups)) )
+        {
+            break;
+        }
+    }
+
+    return i;
 }
 
 static void AllocateRandomAddress(uint16_t* pAddress)
 {
-    do
+    uint16_t address = DrawRandomSpaceValue(s_randomAddressSpace, 1u);
+
+    // Each recent address occupies one value, so one of the next
+    // N_ADDRESSMANAGER_RECENT_ADDRESSES + 1 candidates is free.
+    for ( uint8_t i = 0u; (i < N_ADDRESSMANAGER_RECENT_ADDRESSES) && IsRecentAddress(address); i++ )
     {
-        *pAddress = N_Util_Random();
+        address = GetNextRandomSpaceValue(s_randomAddressSpace, 1u, (uint32_t) address + 1uL);
     }
-    while ( !IsValidRandomAddress(*pAddress) );
+
+    s_recent.address[s_recent.addressNext] = address;
+    s_recent.addressNext = (uint8_t) ((s_recent.addressNext + 1u) % N_ADDRESSMANAGER_RECENT_ADDRESSES);
+    ScheduleWriteRecent();
+
+    *pAddress = address;
 }
 
 static void AllocateRandomGroups(uint8_t numGroups, uint16_t* pGroupIdFirst)
 {
     if ( numGroups > 0u )
     {
-        do
+        uint16_t groupFirst = DrawRandomSpaceValue(s_randomGroupSpace, numGroups);
+        uint8_t overlap = FindRecentGroups(groupFirst, numGroups);
+
+        // Skip past each overlapping recent range, at most once per remembered range.
+        for ( uint8_t i = 0u; (i < N_ADDRESSMANAGER_RECENT_GROUPS) && (overlap < N_ADDRESSMANAGER_RECENT_GROUPS); i++ )
         {
-            *pGroupIdFirst = N_Util_Random();
+            groupFirst = GetNextRandomSpaceValue(s_randomGroupSpace, numGroups,
+                (uint32_t) s_recent.groupFirst[overlap] + s_recent.groupCount[overlap]);
+            overlap = FindRecentGroups(groupFirst, numGroups);
         }
-        while ( !IsValidRandomGroup(*pGroupIdFirst, numGroups) );
+
+        s_recent.groupFirst[s_recent.groupNext] = groupFirst;
+        s_recent.groupCount[s_recent.groupNext] = numGroups;
+        s_recent.groupNext = (uint8_t) ((s_recent.groupNext + 1u) % N_ADDRESSMANAGER_RECENT_GROUPS);
+        ScheduleWriteRecent();
+
+        *pGroupIdFirst = groupFirst;
     }
 }
 
@@ -356,6 +526,18 @@ void N_AddressManager_Init(void)
     // flash access
     ret = S_Nv_ItemInit(FREE_RANGES_STORAGE_ID, sizeof(s_freeRanges), &s_freeRanges);
     N_ERRH_ASSERT_FATAL( (ret == S_Nv_ReturnValue_DidNotExist) || (ret == S_Nv_ReturnValue_Ok) );
+    ret = S_Nv_ItemInit(RECENT_ASSIGNMENTS_STORAGE_ID, sizeof(s_recent), &s_recent);
+    N_ERRH_ASSERT_FATAL( (ret == S_Nv_ReturnValue_DidNotExist) || (ret == S_Nv_ReturnValue_Ok) );
+
+    if ( (s_recent.addressNext >= N_ADDRESSMANAGER_RECENT_ADDRESSES) ||
+         (s_recent.groupNext >= N_ADDRESSMANAGER_RECENT_GROUPS) )
+    {
+        // invalid values, forget the recent assignments
+        N_LOG_NONFATAL();
+
+        memset(&s_recent, 0, sizeof(s_recent));
+        WriteRecent();
+    }
 
     if ((s_freeRanges.addressFirst == 0u) && (s_freeRanges.addressCount == 0u) &&
         (s_freeRanges.groupFirst == 0u) && (s_freeRanges.groupCount == 0u))
@@ -53,6 +53,48 @@ typedef enum N_Cmi_Result_t
     N_Cmi_Result_Invalid_Request,
 } N_Cmi_Result_t;
 
+/** Configuration of the adaptive poll rate controller */
+typedef struct N_Cmi_AdaptivePollConfig_t
+{
+    /** Poll interval used when downlink traffic is observed or a response is expected, ms */
+    uint32_t minPollIntervalMs;
+    /** Longest poll interval, ms. Has priority over the energy budget */
+    uint32_t maxPollIntervalMs;
+    /** Amount of polls allowed during energyPeriodMs, 0 - not limited */
+    uint16_t maxPollsPerPeriod;
+    /** Length of the energy budget period, ms */
+    uint32_t energyPeriodMs;
+    /** Amount of consecutive empty polls after which the poll interval is doubled */
+    uint8_t emptyPollsToBackOff;
+    /** Clock returning time in ms. If NULL, system time is used */
+    uint32_t (*GetTime)(void);
+} N_Cmi_AdaptivePollConfig_t;
+
+/** Weights of the criteria used by the default beacon scoring function */
+typedef struct N_Cmi_BeaconScoreWeights_t
+{
+    /** Weight of the link quality. LQI above N_CMI_LQI_RANDOM_BEACON_SELECTION_THRESHOLD is limited to it */
+    uint8_t lqi;
+    /** Penalty per depth level of the potential parent */
+    uint8_t depth;
+    /** Bonus for the capacity to accept a device of the own type */
+    uint8_t capacity;
+    /** Bonus for a network update id not older than the own one */
+    uint8_t updateId;
+    /** Penalty per recent join failure with the potential parent */
+    uint8_t failure;
+    /** Bonus for the current parent */
+    uint8_t stickiness;
+} N_Cmi_BeaconScoreWeights_t;
+
+/** Beacon scoring function.
+    \param pBeacon The beacon to score
+    \param failures Amount of recent join failures with the beacon originator
+    \param isCurrentParent true if the beacon originator is the current parent
+    \returns beacon score, the higher - the better
+*/
+typedef int16_t (*N_Cmi_BeaconScore_t)(const N_Beacon_t* pBeacon, uint8_t failures, bool isCurrentParent);
+
 typedef struct N_Cmi_Callback_t
 {
     /** The end-device has detected that it has lost its parent.
@@ -175,12 +217,42 @@ void N_Cmi_NetworkDiscovery(uint32_t channelMask,
                             N_Cmi_BeaconIndication_t pfBeaconReceivedCallback,
                             N_Cmi_NetworkDiscoveryDone_t pfDoneCallback);
 
-/** Perform a ZigBee network join (MAC association).
+/** Perform a ZigBee network join (MAC association). If the beacon is taken from
+    the scored candidates list, the next candidates are tried in order on failure and
+    the beacon is updated to the one of the joined parent.
     \param pSelectedBeacon The beacon from a device to join to.
     \param pfDoneCallback Pointer to the function that should be called after the join is done
 */
 void N_Cmi_Join(N_Beacon_t* pSelectedBeacon, N_Cmi_JoinDone_t pfDoneCallback);
 
+/** Sets weights of the default beacon scoring function or a custom scoring function.
+    Beacons accepted during association and reconnection discoveries are scored and
+    the best of them are kept in the candidates list.
+    \param pWeights Weights of the scoring criteria. NULL - keep current weights.
+    \param pfScore Custom scoring function. NULL - use the default one.
+*/
+void N_Cmi_SetBeaconScoring(const N_Cmi_BeaconScoreWeights_t* pWeights, N_Cmi_BeaconScore_t pfScore);
+
+/** Gets a beacon from the scored candidates list of the last network discovery.
+    \param index Position in the list, 0 - the best candidate
+    \param pBeacon Pointer to memory the beacon is copied to
+    \returns true - if the candidate exists; false - otherwise
+*/
+bool N_Cmi_GetBeaconCandidate(uint8_t index, N_Beacon_t* pBeacon);
+
+/** Clears the scored candidates list. Must be called before a discovery consisting of
+    several association network discoveries (e.g. channel by channel) is started;
+    other network discoveries clear the list themselves.
+*/
+void N_Cmi_ClearBeaconCandidates(void);
+
+/** Updates join failures history of a parent. Failures lower the score of the parent
+    beacons during next discoveries, success clears the history of the parent.
+    \param pBeacon Beacon of the parent joined or rejoined to
+    \param success true - if the join was successful; false - otherwise
+*/
+void N_Cmi_ReportParentResult(const N_Beacon_t* pBeacon, bool success);
+
 /** Perform a ZigBee network rejoin to find a new parent (end-device only).
     \param pSelectedBeacon The beacon from a device to rejoin to.
     \param secure Whether to do a secure rejoin (TRUE) or an unsecure rejoin (FALSE, only possible with central trustcenter)
@@ -297,6 +369,24 @@ void N_Cmi_ZdpRequest(ZDO_ZdpReq_t *zdpReq);
 */
 void N_Cmi_SetPollRateForTimePeriod(uint32_t rate, uint32_t time);
 
+/** Starts adaptive polling. The poll interval is set to the minimum when data is received
+    from the parent or the stack waits for a response, and is doubled after a number of
+    empty polls, staying within the configured bounds and the energy budget.
+    The poll rate set by N_Connection_SetPollRate is restored when adaptive polling is stopped;
+    setting it to 0 suspends polling.
+    \param[in] pConfig - controller configuration, copied by the component
+*/
+void N_Cmi_StartAdaptivePolling(const N_Cmi_AdaptivePollConfig_t* pConfig);
+
+/** Stops adaptive polling and restores the poll rate set by the application.
+*/
+void N_Cmi_StopAdaptivePolling(void);
+
+/** Returns the poll interval chosen by the adaptive controller.
+    \return poll interval in ms or 0 if adaptive polling is not active
+*/
+uint32_t N_Cmi_GetAdaptivePollInterval(void);
+
 /** Sets the type of groupcast to be used - NWK multicast or APS Groupcast.
     \param[in] multicast - if true NWK multicast will be used.
 */
@@ -39,6 +39,10 @@
 #  define N_Cmi_NetworkDiscovery N_Cmi_Stub_NetworkDiscovery
 #  define N_Cmi_SendLinkStatus N_Cmi_Stub_SendLinkStatus
 #  define N_Cmi_Join N_Cmi_Stub_Join
+#  define N_Cmi_SetBeaconScoring N_Cmi_Stub_SetBeaconScoring
+#  define N_Cmi_GetBeaconCandidate N_Cmi_Stub_GetBeaconCandidate
+#  define N_Cmi_ClearBeaconCandidates N_Cmi_Stub_ClearBeaconCandidates
+#  define N_Cmi_ReportParentResult N_Cmi_Stub_ReportParentResult
 #  define N_Cmi_ResetNetworkSettings N_Cmi_Stub_ResetNetworkSettings
 #  define N_Cmi_GetNetworkParams N_Cmi_Stub_GetNetworkParams
 #  define N_Cmi_GetParentInfo N_Cmi_Stub_GetParentInfo
@@ -48,6 +52,9 @@
 #  define N_Cmi_SendLeaveIndication N_Cmi_Stub_SendLeaveIndication
 #  define N_Cmi_ProcessLeaveIndication N_Cmi_Stub_ProcessLeaveIndication
 #  define N_Cmi_SendUpdateDevice N_Cmi_Stub_SendUpdateDevice
+#  define N_Cmi_StartAdaptivePolling N_Cmi_Stub_StartAdaptivePolling
+#  define N_Cmi_StopAdaptivePolling N_Cmi_Stub_StopAdaptivePolling
+#  define N_Cmi_GetAdaptivePollInterval N_Cmi_Stub_GetAdaptivePollInterval
 
 // N_DeviceInfo
 #  define N_DeviceInfo_IsFactoryNew N_DeviceInfo_Stub_IsFactoryNew
@@ -69,6 +76,8 @@
 #  define N_DeviceInfo_SetParentNetworkAddress N_DeviceInfo_Stub_SetParentNetworkAddress
 #  define N_DeviceInfo_SetFactoryNew N_DeviceInfo_Stub_SetFactoryNew
 #  define N_DeviceInfo_GetTrustCenterMode N_DeviceInfo_Stub_GetTrustCenterMode
+#  define N_DeviceInfo_GetNetworkPanId N_DeviceInfo_Stub_GetNetworkPanId
+#  define N_DeviceInfo_GetParentNetworkAddress N_DeviceInfo_Stub_GetParentNetworkAddress
 
 // N_Security
 #  define N_Security_GetRandomData N_Security_Stub_GetRandomData
@@ -101,6 +110,10 @@
 #  define N_Cmi_NetworkDiscovery N_Cmi_NetworkDiscovery_Impl
 #  define N_Cmi_SendLinkStatus N_Cmi_SendLinkStatus_Impl
 #  define N_Cmi_Join N_Cmi_Join_Impl
+#  define N_Cmi_SetBeaconScoring N_Cmi_SetBeaconScoring_Impl
+#  define N_Cmi_GetBeaconCandidate N_Cmi_GetBeaconCandidate_Impl
+#  define N_Cmi_ClearBeaconCandidates N_Cmi_ClearBeaconCandidates_Impl
+#  define N_Cmi_ReportParentResult N_Cmi_ReportParentResult_Impl
 #  define N_Cmi_ResetNetworkSettings N_Cmi_ResetNetworkSettings_Impl
 #  define N_Cmi_GetNetworkParams N_Cmi_GetNetworkParams_Impl
 #  define N_Cmi_GetParentInfo N_Cmi_GetParentInfo_Impl
@@ -115,6 +128,9 @@
 #  define N_Cmi_UseNwkMulticast N_Cmi_UseNwkMulticast_Impl
 #  define N_Cmi_InitMacLayer N_Cmi_InitMacLayer_Impl
 #  define N_Cmi_SetPollRateForTimePeriod N_Cmi_SetPollRateForTimePeriod_Impl
+#  define N_Cmi_StartAdaptivePolling N_Cmi_StartAdaptivePolling_Impl
+#  define N_Cmi_StopAdaptivePolling N_Cmi_StopAdaptivePolling_Impl
+#  define N_Cmi_GetAdaptivePollInterval N_Cmi_GetAdaptivePollInterval_Impl
 
 // N_DeviceInfo
 #  define N_DeviceInfo_IsFactoryNew N_DeviceInfo_IsFactoryNew_Impl
@@ -136,6 +152,8 @@
 #  define N_DeviceInfo_SetParentNetworkAddress N_DeviceInfo_SetParentNetworkAddress_Impl
 #  define N_DeviceInfo_SetFactoryNew N_DeviceInfo_SetFactoryNew_Impl
 #  define N_DeviceInfo_GetTrustCenterMode N_DeviceInfo_GetTrustCenterMode_Impl
+#  define N_DeviceInfo_GetNetworkPanId N_DeviceInfo_GetNetworkPanId_Impl
+#  define N_DeviceInfo_GetParentNetworkAddress N_DeviceInfo_GetParentNetworkAddress_Impl
 #  define N_DeviceInfo_IsEndDevice N_DeviceInfo_IsEndDevice_Impl
 
 // N_Security
@@ -61,6 +61,43 @@
 #define N_CMI_LQI_RANDOM_BEACON_SELECTION_THRESHOLD 44u
 #endif
 
+/* Amount of the best scored beacons kept to be tried in order */
+#ifndef N_CMI_BEACON_CANDIDATES_AMOUNT
+#define N_CMI_BEACON_CANDIDATES_AMOUNT 4u
+#endif
+
+/* Amount of potential parents which join failures are remembered */
+#ifndef N_CMI_PARENT_HISTORY_SIZE
+#define N_CMI_PARENT_HISTORY_SIZE 4u
+#endif
+
+/* Default weights of the beacon scoring criteria */
+#ifndef N_CMI_BEACON_SCORE_WEIGHT_LQI
+#define N_CMI_BEACON_SCORE_WEIGHT_LQI 1u
+#endif
+
+#ifndef N_CMI_BEACON_SCORE_WEIGHT_DEPTH
+#define N_CMI_BEACON_SCORE_WEIGHT_DEPTH 2u
+#endif
+
+#ifndef N_CMI_BEACON_SCORE_WEIGHT_CAPACITY
+#define N_CMI_BEACON_SCORE_WEIGHT_CAPACITY 8u
+#endif
+
+#ifndef N_CMI_BEACON_SCORE_WEIGHT_UPDATE_ID
+#define N_CMI_BEACON_SCORE_WEIGHT_UPDATE_ID 16u
+#endif
+
+#ifndef N_CMI_BEACON_SCORE_WEIGHT_FAILURE
+#define N_CMI_BEACON_SCORE_WEIGHT_FAILURE 12u
+#endif
+
+#ifndef N_CMI_BEACON_SCORE_WEIGHT_STICKINESS
+#define N_CMI_BEACON_SCORE_WEIGHT_STICKINESS 10u
+#endif
+
+#define N_CMI_NO_CANDIDATE N_CMI_BEACON_CANDIDATES_AMOUNT
+
 /* Macro for setting MAC attributes. */
 #define SET_MAC_ATTR(id, name, value) \
   nCmiMacInit.mac.set.attrId.macPibId = (id); \
@@ -114,6 +151,21 @@ typedef struct _N_Cmi_NwkDiscovery_t
   N_Cmi_BeaconFilter_t isBestBeacon;
 } N_Cmi_NwkDiscovery_t;
 
+/* Beacon from the last network discovery with its score */
+typedef struct _N_Cmi_BeaconCandidate_t
+{
+  N_Beacon_t beacon;
+  int16_t score;
+} N_Cmi_BeaconCandidate_t;
+
+/* Join failures with a potential parent */
+typedef struct _N_Cmi_ParentHistory_t
+{
+  uint16_t panId;
+  uint16_t sourceAddress;
+  uint8_t failures;
+} N_Cmi_ParentHistory_t;
+
 /******************************************************************************
                     Prototypes section
 ******************************************************************************/
@@ -126,7 +178,16 @@ static void nCmiObserver(SYS_EventId_t eventId, SYS_EventData_t data);
 static void NWK_NetworkDiscoveryConf(NWK_NetworkDiscoveryConf_t *conf);
 static bool nCmiBeaconIsAccepted(const MAC_BeaconNotifyInd_t *const beaconNtfy);
 static bool nCmiIsBestBeacon(const MAC_BeaconNotifyInd_t *const beaconNtfy);
+static bool nCmiCollectBeacon(const MAC_BeaconNotifyInd_t *const beaconNtfy);
 static void nCmiPickBeacon(const MAC_BeaconNotifyInd_t *const beaconNtfy);
+static void nCmiBeaconFromNotify(const MAC_BeaconNotifyInd_t *const beaconNtfy, N_Beacon_t *beacon);
+static uint8_t nCmiAddBeaconCandidate(const MAC_BeaconNotifyInd_t *const beaconNtfy);
+static int16_t nCmiDefaultBeaconScore(const N_Beacon_t* pBeacon, uint8_t failures, bool isCurrentParent);
+static N_Cmi_ParentHistory_t* nCmiFindParentHistory(const N_Beacon_t* pBeacon);
+static bool nCmiIsSameParent(const N_Beacon_t* pFirst, const N_Beacon_t* pSecond);
+static void nCmiStartAssociation(void);
+static void nCmiJoinRetryTimerFired(void);
+static bool nCmiNextJoinCandidate(void);
 static void setDistributedTcLinkKey(void);
 static void setLinkKeyAsPrimary(void);
 static void N_Cmi_SetBeaconFilter(N_Cmi_BeaconFilteringCriterion_t criterion);
@@ -170,6 +231,38 @@ static N_Cmi_NwkDiscovery_t nwkDiscovery =
 
 static N_Cmi_JoinDone_t associationDoneCallback;
 
+/* Scored beacons of the last network discovery, the best one first */
+static N_Cmi_BeaconCandidate_t beaconCandidates[N_CMI_BEACON_CANDIDATES_AMOUNT];
+static uint8_t beaconCandidatesAmount;
+
+static N_Cmi_ParentHistory_t parentHistory[N_CMI_PARENT_HISTORY_SIZE];
+
+static N_Cmi_BeaconScoreWeights_t beaconScoreWeights =
+{
+  .lqi        = N_CMI_BEACON_SCORE_WEIGHT_LQI,
+  .depth      = N_CMI_BEACON_SCORE_WEIGHT_DEPTH,
+  .capacity   = N_CMI_BEACON_SCORE_WEIGHT_CAPACITY,
+  .updateId   = N_CMI_BEACON_SCORE_WEIGHT_UPDATE_ID,
+  .failure    = N_CMI_BEACON_SCORE_WEIGHT_FAILURE,
+  .stickiness = N_CMI_BEACON_SCORE_WEIGHT_STICKINESS,
+};
+
+static N_Cmi_BeaconScore_t pfBeaconScore = nCmiDefaultBeaconScore;
+
+/* Beacon of the parent being joined and its position in the candidates list */
+static N_Beacon_t* joinBeacon;
+static uint8_t joinCandidateIdx;
+/* Network selected by the caller, failover is restricted to its parents */
+static N_Address_ExtendedPanId_t joinExtendedPanId;
+
+/* Timer to join the next candidate out of the confirm context */
+static HAL_AppTimer_t joinRetryTimer =
+{
+  .mode     = TIMER_ONE_SHOT_MODE,
+  .interval = 10,
+  .callback = nCmiJoinRetryTimerFired
+};
+
 static N_Cmi_SetZllLinkKeyAsPrimaryDone_t setLinkKeyAsPrimaryDoneCallback;
 
 /* BitCloud events receiver */
@@ -583,6 +676,11 @@ void N_Cmi_NetworkDiscovery_Impl(uint32_t channelMask,
 
   N_Cmi_SetBeaconFilter(filteringMode);
 
+  /* Association discovery is done channel by channel, its user clears the candidates
+     by N_Cmi_ClearBeaconCandidates() before the first channel */
+  if (BEACON_FILTERING_CRITERION_ASSOCIATION != filteringMode)
+    beaconCandidatesAmount = 0U;
+
   nwkDiscovery.request.scanDuration = durationPerChannel;
   nwkDiscovery.request.scanChannels = channelMask;
   nwkDiscovery.extendedPanId = extendedPanId;
@@ -614,7 +712,7 @@ static void N_Cmi_SetBeaconFilter(N_Cmi_BeaconFilteringCriterion_t criterion)
 #else
     case BEACON_FILTERING_CRITERION_RECONNECT:
       nwkDiscovery.isBeaconAccepted = nCmiReconnectIsBeaconAccepted;
-      nwkDiscovery.isBestBeacon = NULL;
+      nwkDiscovery.isBestBeacon = nCmiCollectBeacon;
     break;
 #endif /* ZIGBEE_END_DEVICE */
     case BEACON_FILTERING_CRITERION_ASSOCIATION:
@@ -788,34 +886,136 @@ static bool nCmiBeaconIsAccepted(const MAC_BeaconNotifyInd_t *const beaconNtfy)
   return true;
 }
 
-/** Checks, if new beacon is better then the existent one
+/** Checks, if new beacon is better then the existent one. The beacon is added to
+    the scored candidates list and is the best one if it heads the list.
 
     \param beaconNtfy Beacon notification data
     \returns true - if new beacon is better; false - otherwise
 */
 static bool nCmiIsBestBeacon(const MAC_BeaconNotifyInd_t *const beaconNtfy)
 {
-  /* Pick the very first beacon */
-  if (0 == memcmp((uint8_t*)&(uint64_t){0ULL}, (uint8_t*)nwkDiscovery.pBeacon->extendedPanId,
-        sizeof(ExtPanId_t)))
+  if (0U == nCmiAddBeaconCandidate(beaconNtfy))
     return true;
 
-  /* Pick beacon with highest LQI if this value is below the threshold */
-  if (beaconNtfy->panDescr.quality < N_CMI_LQI_RANDOM_BEACON_SELECTION_THRESHOLD)
+  /* The best parent could be moved down by its own worse beacon */
+  if (beaconCandidatesAmount)
+    *nwkDiscovery.pBeacon = beaconCandidates[0].beacon;
+
+  return false;
+}
+
+/** Adds a beacon to the scored candidates list. Every beacon is passed
+    further to the beacon indication callback.
+
+    \param beaconNtfy Beacon notification data
+    \returns true
+*/
+static bool nCmiCollectBeacon(const MAC_BeaconNotifyInd_t *const beaconNtfy)
+{
+  nCmiAddBeaconCandidate(beaconNtfy);
+  return true;
+}
+
+/** Scores a beacon and inserts it to the candidates list keeping the list sorted.
+    Beacons with equal score are ordered randomly to spread joining devices over parents.
+
+    \param beaconNtfy Beacon notification data
+    \returns position of the beacon in the list or N_CMI_NO_CANDIDATE if the beacon is worse
+              than all the kept ones
+*/
+static uint8_t nCmiAddBeaconCandidate(const MAC_BeaconNotifyInd_t *const beaconNtfy)
+{
+  N_Beacon_t beacon;
+  N_Cmi_ParentHistory_t *history;
+  bool isCurrentParent;
+  int16_t score;
+  uint8_t position;
+  uint8_t i;
+
+  nCmiBeaconFromNotify(beaconNtfy, &beacon);
+
+  /* Beacon from a known parent replaces its previous beacon */
+  for (i = 0U; i < beaconCandidatesAmount; i++)
   {
-    if (nwkDiscovery.pBeacon->lqi < beaconNtfy->panDescr.quality)
-      return true;
+    if (nCmiIsSameParent(&beaconCandidates[i].beacon, &beacon))
+    {
+      beaconCandidatesAmount--;
+      memmove(&beaconCandidates[i], &beaconCandidates[i + 1U],
+              (beaconCandidatesAmount - i) * sizeof(N_Cmi_BeaconCandidate_t));
+      break;
+    }
   }
-  /* Pick beacon randomly if LQI is above the threshold */
-  else
+
+  history = nCmiFindParentHistory(&beacon);
+  isCurrentParent = !N_DeviceInfo_IsFactoryNew() &&
+                    (beacon.panId == N_DeviceInfo_GetNetworkPanId()) &&
+                    (beacon.sourceAddress == N_DeviceInfo_GetParentNetworkAddress());
+  score = pfBeaconScore(&beacon, history ? history->failures : 0U, isCurrentParent);
+
+  for (position = 0U; position < beaconCandidatesAmount; position++)
   {
-    uint8_t seed;
+    if (score > beaconCandidates[position].score)
+      break;
 
-    N_Security_GetRandomData(&seed, sizeof(seed));
-    return seed & 0x01;
+    if (score == beaconCandidates[position].score)
+    {
+      uint8_t seed;
+
+      N_Security_GetRandomData(&seed, sizeof(seed));
+      if (seed & 0x01)
+        break;
+    }
   }
 
-  return false;
+  if (N_CMI_BEACON_CANDIDATES_AMOUNT <= position)
+    return N_CMI_NO_CANDIDATE;
+
+  if (beaconCandidatesAmount < N_CMI_BEACON_CANDIDATES_AMOUNT)
+    beaconCandidatesAmount++;
+
+  memmove(&beaconCandidates[position + 1U], &beaconCandidates[position],
+          (beaconCandidatesAmount - 1U - position) * sizeof(N_Cmi_BeaconCandidate_t));
+  beaconCandidates[position].beacon = beacon;
+  beaconCandidates[position].score = score;
+
+  return position;
+}
+
+/** Default beacon scoring function. Combines link quality, depth, capacity,
+    network update id, join failures with the parent and stickiness to the current parent.
+
+    \param pBeacon The beacon to score
+    \param failures Amount of recent join failures with the beacon originator
+    \param isCurrentParent true if the beacon originator is the current parent
+    \returns beacon score, the higher - the better
+*/
+static int16_t nCmiDefaultBeaconScore(const N_Beacon_t* pBeacon, uint8_t failures, bool isCurrentParent)
+{
+  int16_t score;
+
+  /* Links above the threshold are considered equally good */
+  score = (int16_t)beaconScoreWeights.lqi * MIN(pBeacon->lqi, N_CMI_LQI_RANDOM_BEACON_SELECTION_THRESHOLD);
+  score -= (int16_t)beaconScoreWeights.depth * pBeacon->depth;
+
+#if defined(ZIGBEE_END_DEVICE)
+  if (pBeacon->hasDeviceCapacity)
+#else
+  if (pBeacon->hasRouterCapacity)
+#endif /* ZIGBEE_END_DEVICE */
+    score += beaconScoreWeights.capacity;
+
+  /* Parent with outdated network settings is likely to change channel soon */
+  if ((pBeacon->updateId == N_DeviceInfo_GetNetworkUpdateId()) ||
+      COMPARE_WITH_THRESHOLD(pBeacon->updateId, N_DeviceInfo_GetNetworkUpdateId(),
+                             UPDATE_ID_OVERFLOW_LIMIT))
+    score += beaconScoreWeights.updateId;
+
+  score -= (int16_t)beaconScoreWeights.failure * failures;
+
+  if (isCurrentParent)
+    score += beaconScoreWeights.stickiness;
+
+  return score;
 }
 
 /** Picks a beacon as a best one. The best beacon will be finaly returned as a result of
@@ -824,9 +1024,18 @@ static bool nCmiIsBestBeacon(const MAC_BeaconNotifyInd_t *const beaconNtfy)
     \param beaconNtfy Beacon notification data
 */
 static void nCmiPickBeacon(const MAC_BeaconNotifyInd_t *const beaconNtfy)
+{
+  nCmiBeaconFromNotify(beaconNtfy, nwkDiscovery.pBeacon);
+}
+
+/** Fills ZLL Platform beacon from the beacon notification.
+
+    \param beaconNtfy Beacon notification data
+    \param beacon Beacon to be filled
+*/
+static void nCmiBeaconFromNotify(const MAC_BeaconNotifyInd_t *const beaconNtfy, N_Beacon_t *beacon)
 {
   const NwkBeaconPayload_t *const beaconPayload = (NwkBeaconPayload_t*)beaconNtfy->msdu;
-  N_Beacon_t *const beacon = nwkDiscovery.pBeacon;
   ExtPanId_t extPanId = beaconPayload->nwkExtendedPanid;
 
   beacon->depth = beaconPayload->field.deviceDepth;
@@ -843,6 +1052,102 @@ static void nCmiPickBeacon(const MAC_BeaconNotifyInd_t *const beaconNtfy)
   beacon->updateId = beaconPayload->updateId;
 }
 
+/** Checks, if two beacons are sent by the same device.
+
+    \returns true - if beacons are sent by the same device; false - otherwise
+*/
+static bool nCmiIsSameParent(const N_Beacon_t* pFirst, const N_Beacon_t* pSecond)
+{
+  return (pFirst->sourceAddress == pSecond->sourceAddress) &&
+         (pFirst->panId == pSecond->panId) &&
+         (pFirst->logicalChannel == pSecond->logicalChannel);
+}
+
+/** Looks for join failures history of a potential parent.
+
+    \param pBeacon Beacon of the potential parent
+    \returns pointer to the history entry or NULL if there were no failures
+*/
+static N_Cmi_ParentHistory_t* nCmiFindParentHistory(const N_Beacon_t* pBeacon)
+{
+  for (uint8_t i = 0U; i < N_CMI_PARENT_HISTORY_SIZE; i++)
+  {
+    if (parentHistory[i].failures &&
+        (parentHistory[i].panId == pBeacon->panId) &&
+        (parentHistory[i].sourceAddress == pBeacon->sourceAddress))
+      return &parentHistory[i];
+  }
+
+  return NULL;
+}
+
+/** Sets weights of the default beacon scoring function or a custom scoring function.
+    \param pWeights Weights of the scoring criteria. NULL - keep current weights.
+    \param pfScore Custom scoring function. NULL - use the default one.
+*/
+void N_Cmi_SetBeaconScoring_Impl(const N_Cmi_BeaconScoreWeights_t* pWeights, N_Cmi_BeaconScore_t pfScore)
+{
+  if (pWeights)
+    beaconScoreWeights = *pWeights;
+
+  pfBeaconScore = pfScore ? pfScore : nCmiDefaultBeaconScore;
+}
+
+/** Clears the scored candidates list.
+*/
+void N_Cmi_ClearBeaconCandidates_Impl(void)
+{
+  beaconCandidatesAmount = 0U;
+}
+
+/** Gets a beacon from the scored candidates list of the last network discovery.
+    \param index Position in the list, 0 - the best candidate
+    \param pBeacon Pointer to memory the beacon is copied to
+    \returns true - if the candidate exists; false - otherwise
+*/
+bool N_Cmi_GetBeaconCandidate_Impl(uint8_t index, N_Beacon_t* pBeacon)
+{
+  if (index >= beaconCandidatesAmount)
+    return false;
+
+  *pBeacon = beaconCandidates[index].beacon;
+  return true;
+}
+
+/** Updates join failures history of a parent. Failures lower the score of the parent
+    beacons during next discoveries, success clears the history of the parent.
+    \param pBeacon Beacon of the parent joined or rejoined to
+    \param success true - if the join was successful; false - otherwise
+*/
+void N_Cmi_ReportParentResult_Impl(const N_Beacon_t* pBeacon, bool success)
+{
+  N_Cmi_ParentHistory_t *history = nCmiFindParentHistory(pBeacon);
+
+  if (success)
+  {
+    if (history)
+      history->failures = 0U;
+    return;
+  }
+
+  /* Replace the parent with the least amount of failures */
+  if (!history)
+  {
+    history = &parentHistory[0];
+    for (uint8_t i = 1U; i < N_CMI_PARENT_HISTORY_SIZE; i++)
+    {
+      if (parentHistory[i].failures < history->failures)
+        history = &parentHistory[i];
+    }
+    history->panId = pBeacon->panId;
+    history->sourceAddress = pBeacon->sourceAddress;
+    history->failures = 0U;
+  }
+
+  if (history->failures < UINT8_MAX)
+    history->failures++;
+}
+
 /** Network Discovery completion callback.
 
     \param conf NWK Discovery results
@@ -862,11 +1167,34 @@ static void NWK_NetworkDiscoveryConf(NWK_NetworkDiscoveryConf_t *conf)
   callback();
 }
 
-/** Perform a ZigBee network join (MAC association).
+/** Perform a ZigBee network join (MAC association). If the beacon is taken from
+    the scored candidates list, the next candidates are tried in order on failure and
+    the beacon is updated to the one of the joined parent.
     \param pSelectedBeacon The beacon from a device to join to.
     \param pfDoneCallback Pointer to the function that should be called after the join is done
 */
 void N_Cmi_Join_Impl(N_Beacon_t* pSelectedBeacon, N_Cmi_JoinDone_t pfDoneCallback)
+{
+  N_ERRH_ASSERT_FATAL(NULL == associationDoneCallback); /* Unexpected function call */
+
+  associationDoneCallback = pfDoneCallback;
+  joinBeacon = pSelectedBeacon;
+  memcpy(joinExtendedPanId, pSelectedBeacon->extendedPanId, sizeof(joinExtendedPanId));
+
+  for (joinCandidateIdx = 0U; joinCandidateIdx < beaconCandidatesAmount; joinCandidateIdx++)
+  {
+    if (nCmiIsSameParent(&beaconCandidates[joinCandidateIdx].beacon, pSelectedBeacon))
+      break;
+  }
+  if (joinCandidateIdx >= beaconCandidatesAmount)
+    joinCandidateIdx = N_CMI_NO_CANDIDATE;
+
+  nCmiStartAssociation();
+}
+
+/** Starts association with the parent of the join beacon.
+*/
+static void nCmiStartAssociation(void)
 {
   ExtAddr_t extAddr = 0ULL;
   NWK_JoinControl_t joinControl =
@@ -876,25 +1204,47 @@ void N_Cmi_Join_Impl(N_Beacon_t* pSelectedBeacon, N_Cmi_JoinDone_t pfDoneCallbac
     .discoverNetworks = false,
     .secured = true,
   };
-  NwkNeighbor_t *neighbor = NWK_AddKnownNeighbor(pSelectedBeacon->sourceAddress, &extAddr, true);
+  NwkNeighbor_t *neighbor = NWK_AddKnownNeighbor(joinBeacon->sourceAddress, &extAddr, true);
 
-  N_ERRH_ASSERT_FATAL(NULL == associationDoneCallback); /* Unexpected function call */
   N_ERRH_ASSERT_FATAL(neighbor); /* Neighbor table full */
 
-  associationDoneCallback = pfDoneCallback;
-
-  neighbor->logicalChannel = pSelectedBeacon->logicalChannel;
-  neighbor->depth = pSelectedBeacon->depth;
-  neighbor->panId = pSelectedBeacon->panId;
-  memcpy((uint8_t*)&neighbor->extPanId, pSelectedBeacon->extendedPanId, sizeof(uint64_t));
-  neighbor->updateId = pSelectedBeacon->updateId;
-  neighbor->permitJoining = pSelectedBeacon->permitJoining;
+  neighbor->logicalChannel = joinBeacon->logicalChannel;
+  neighbor->depth = joinBeacon->depth;
+  neighbor->panId = joinBeacon->panId;
+  memcpy((uint8_t*)&neighbor->extPanId, joinBeacon->extendedPanId, sizeof(uint64_t));
+  neighbor->updateId = joinBeacon->updateId;
+  neighbor->permitJoining = joinBeacon->permitJoining;
 
   startNetworkReq.ZDO_StartNetworkConf = nCmiAssociationConf;
   CS_WriteParameter(CS_JOIN_CONTROL_ID, &joinControl);
   ZDO_StartNetworkReq(&startNetworkReq);
 }
 
+/** Moves to the next candidate in the list having the extended PAN id of the
+    network selected for the join.
+    \returns true - if such a candidate exists; false - otherwise
+*/
+static bool nCmiNextJoinCandidate(void)
+{
+  if (N_CMI_NO_CANDIDATE == joinCandidateIdx)
+    return false;
+
+  while (++joinCandidateIdx < beaconCandidatesAmount)
+  {
+    if (0 == memcmp(beaconCandidates[joinCandidateIdx].beacon.extendedPanId, joinExtendedPanId,
+                    sizeof(joinExtendedPanId)))
+      return true;
+  }
+  return false;
+}
+
+/** Join retry timer fired - associate with the next candidate.
+*/
+static void nCmiJoinRetryTimerFired(void)
+{
+  nCmiStartAssociation();
+}
+
 static void nCmiAssociationConf(ZDO_StartNetworkConf_t* conf)
 {
   N_Cmi_Result_t result = N_Cmi_Result_Failure;
@@ -909,6 +1259,25 @@ static void nCmiAssociationConf(ZDO_StartNetworkConf_t* conf)
   else if (ZDO_INVALID_REQUEST_STATUS == conf->status)
     result = N_Cmi_Result_Invalid_Request;
 
+  N_Cmi_ReportParentResult_Impl(joinBeacon, N_Cmi_Result_Success == result);
+
+  /* Parent refused or didn't respond - drop its neighbor entry added for the association */
+  if (N_Cmi_Result_Failure == result)
+  {
+    NwkNeighbor_t *neighbor = NWK_FindNeighborByShortAddr(joinBeacon->sourceAddress);
+
+    if (neighbor)
+      NWK_RemoveNeighbor(neighbor, true);
+  }
+
+  /* Try the next candidate of the same network */
+  if (N_Cmi_Result_Failure == result && nCmiNextJoinCandidate())
+  {
+    *joinBeacon = beaconCandidates[joinCandidateIdx].beacon;
+    HAL_StartAppTimer(&joinRetryTimer);
+    return;
+  }
+
   associationDoneCallback(result);
 
   CS_ReadParameter(CS_JOIN_CONTROL_ID, &joinControl);
@@ -0,0 +1,264 @@
+/**************************************************************************//**
+  \file N_Cmi_AdaptivePoll.c
+
+  \brief Adaptive poll rate controller of CMI component. Adjusts the indirect
+         poll interval of an end device to the observed downlink traffic.
+
+  \author
+    Atmel Corporation: http://www.atmel.com \n
+    Support email: avr@atmel.com
+
+  Copyright (c) 2008-2015, Atmel Corporation. All rights reserved.
+  Licensed under Atmel's Limited License Agreement (BitCloudTM).
+
+  \internal
+    History:
+    19.10.26 - created
+******************************************************************************/
+
+/******************************************************************************
+                    Includes section
+******************************************************************************/
+#include <configServer.h>
+#include <appTimer.h>
+#include <sysEvents.h>
+#include <sysUtils.h>
+#include <zdo.h>
+
+#include <N_Cmi_Bindings.h>
+#include <N_Cmi.h>
+#include <N_ErrH.h>
+
+#ifdef ZIGBEE_END_DEVICE
+/******************************************************************************
+                    Defines section
+******************************************************************************/
+#define COMPID "N_Cmi_AdaptivePoll"
+
+/******************************************************************************
+                    Prototypes section
+******************************************************************************/
+static void nCmiAdaptivePollTimerFired(void);
+static void nCmiAdaptivePollObserver(SYS_EventId_t eventId, SYS_EventData_t data);
+static uint32_t nCmiAdaptivePollNextInterval(uint32_t now);
+static void nCmiAdaptivePollApply(uint32_t interval);
+static uint32_t nCmiAdaptivePollGetTime(void);
+
+/******************************************************************************
+                    Static variables section
+******************************************************************************/
+static N_Cmi_AdaptivePollConfig_t adaptivePollConfig;
+static bool adaptivePollActive = false;
+/* Poll interval currently used, ms */
+static uint32_t currentInterval;
+/* Consecutive polls without downlink traffic */
+static uint8_t emptyPolls;
+/* Data frames received since the last poll */
+static uint16_t downlinkHits;
+/* Start of the current energy budget period and polls done during it */
+static uint32_t periodStart;
+static uint16_t pollsInPeriod;
+
+static HAL_AppTimer_t adaptivePollTimer =
+{
+  .mode     = TIMER_ONE_SHOT_MODE,
+  .callback = nCmiAdaptivePollTimerFired
+};
+
+static SYS_EventReceiver_t adaptivePollEventReceiver = { .func = nCmiAdaptivePollObserver};
+
+extern uint32_t pollRate;
+
+extern bool isSetPollRateAllowed;
+
+/***********************************************************************************
+                    Implementation section
+***********************************************************************************/
+/** Starts adaptive polling. The poll interval is kept between configured bounds:
+    it is set to the minimum when downlink traffic is observed or a response is expected
+    and doubled after a number of empty polls.
+    \param[in] pConfig - controller configuration, copied by the component
+*/
+void N_Cmi_StartAdaptivePolling_Impl(const N_Cmi_AdaptivePollConfig_t* pConfig)
+{
+  N_ERRH_ASSERT_FATAL(pConfig && pConfig->minPollIntervalMs &&
+                      (pConfig->minPollIntervalMs <= pConfig->maxPollIntervalMs)); /* Invalid configuration */
+
+  adaptivePollConfig = *pConfig;
+  if (!adaptivePollConfig.emptyPollsToBackOff)
+    adaptivePollConfig.emptyPollsToBackOff = 1U;
+
+  currentInterval = adaptivePollConfig.minPollIntervalMs;
+  emptyPolls = 0U;
+  downlinkHits = 0U;
+  pollsInPeriod = 0U;
+  periodStart = nCmiAdaptivePollGetTime();
+
+  if (!adaptivePollActive)
+    SYS_SubscribeToEvent(BC_EVENT_APS_DATA_INDICATION, &adaptivePollEventReceiver);
+  adaptivePollActive = true;
+
+  nCmiAdaptivePollApply(currentInterval);
+
+  HAL_StopAppTimer(&adaptivePollTimer);
+  adaptivePollTimer.interval = currentInterval;
+  HAL_StartAppTimer(&adaptivePollTimer);
+}
+
+/** Stops adaptive polling and restores the poll rate set by the application.
+*/
+void N_Cmi_StopAdaptivePolling_Impl(void)
+{
+  if (!adaptivePollActive)
+    return;
+
+  adaptivePollActive = false;
+  HAL_StopAppTimer(&adaptivePollTimer);
+  SYS_UnsubscribeFromEvent(BC_EVENT_APS_DATA_INDICATION, &adaptivePollEventReceiver);
+
+  if (isSetPollRateAllowed && pollRate)
+  {
+    CS_WriteParameter(CS_INDIRECT_POLL_RATE_ID, &pollRate);
+    ZDO_StopSyncReq();
+    ZDO_StartSyncReq();
+  }
+}
+
+/** Returns the poll interval chosen by the adaptive controller.
+    \return poll interval in ms or 0 if adaptive polling is not active
+*/
+uint32_t N_Cmi_GetAdaptivePollInterval_Impl(void)
+{
+  return adaptivePollActive ? currentInterval : 0U;
+}
+
+/** Adaptive poll timer has fired. One timer period corresponds to one poll.
+*/
+static void nCmiAdaptivePollTimerFired(void)
+{
+  uint32_t now = nCmiAdaptivePollGetTime();
+
+  if (adaptivePollConfig.energyPeriodMs && ((now - periodStart) >= adaptivePollConfig.energyPeriodMs))
+  {
+    periodStart = now;
+    pollsInPeriod = 0U;
+  }
+  if (pollsInPeriod < UINT16_MAX)
+    pollsInPeriod++;
+
+  currentInterval = nCmiAdaptivePollNextInterval(now);
+  downlinkHits = 0U;
+
+  /* Reapplied every time as a temporary poll rate could be restored meanwhile */
+  nCmiAdaptivePollApply(currentInterval);
+
+  adaptivePollTimer.interval = currentInterval;
+  HAL_StartAppTimer(&adaptivePollTimer);
+}
+
+/** Calculates the next poll interval from the observed traffic and the energy budget.
+    \param[in] now - current time, ms
+    \return poll interval, ms
+*/
+static uint32_t nCmiAdaptivePollNextInterval(uint32_t now)
+{
+  uint32_t interval = currentInterval;
+  bool idle = true;
+
+  /* Layers waiting for an APS acknowledgement or a ZCL response report being busy */
+  SYS_PostEvent(BC_EVENT_BUSY_REQUEST, (SYS_EventData_t)&idle);
+
+  if (downlinkHits || !idle)
+  {
+    emptyPolls = 0U;
+    interval = adaptivePollConfig.minPollIntervalMs;
+  }
+  else if (++emptyPolls >= adaptivePollConfig.emptyPollsToBackOff)
+  {
+    emptyPolls = 0U;
+    interval = (interval > (UINT32_MAX / 2U)) ? UINT32_MAX : (interval * 2U);
+  }
+
+  /* Spread the rest of the poll budget over the rest of the period */
+  if (adaptivePollConfig.maxPollsPerPeriod && adaptivePollConfig.energyPeriodMs)
+  {
+    uint32_t elapsed = now - periodStart;
+    uint32_t remainingTime = (elapsed < adaptivePollConfig.energyPeriodMs) ?
+                             (adaptivePollConfig.energyPeriodMs - elapsed) : 0U;
+    uint32_t remainingPolls = (pollsInPeriod < adaptivePollConfig.maxPollsPerPeriod) ?
+                              (uint32_t)(adaptivePollConfig.maxPollsPerPeriod - pollsInPeriod) : 0U;
+
+    if (remainingPolls)
+      interval = MAX(interval, remainingTime / remainingPolls);
+    else
+      interval = MAX(interval, remainingTime);
+  }
+
+  /* The maximum bound has priority over the energy budget to keep the parent link alive */
+  interval = MAX(interval, adaptivePollConfig.minPollIntervalMs);
+  interval = MIN(interval, adaptivePollConfig.maxPollIntervalMs);
+
+  return interval;
+}
+
+/** Passes poll interval to the stack.
+    \param[in] interval - poll interval, ms
+*/
+static void nCmiAdaptivePollApply(uint32_t interval)
+{
+  uint32_t csPollRate;
+
+  /* Temporary poll rate set by N_Cmi_SetPollRateForTimePeriod() or polling
+     disabled by the application have priority */
+  if (!isSetPollRateAllowed || !pollRate)
+    return;
+
+  CS_ReadParameter(CS_INDIRECT_POLL_RATE_ID, &csPollRate);
+  if (csPollRate == interval)
+    return;
+
+  CS_WriteParameter(CS_INDIRECT_POLL_RATE_ID, &interval);
+  ZDO_StopSyncReq();
+  ZDO_StartSyncReq();
+}
+
+/** BitCloud events observer.
+    \param[in] eventId - id of raised event
+    \param[in] data - event's data
+*/
+static void nCmiAdaptivePollObserver(SYS_EventId_t eventId, SYS_EventData_t data)
+{
+  if ((BC_EVENT_APS_DATA_INDICATION == eventId) && (downlinkHits < UINT16_MAX))
+    downlinkHits++;
+
+  (void)data;
+}
+
+/** Returns current time from the configured clock.
+    \return time, ms
+*/
+static uint32_t nCmiAdaptivePollGetTime(void)
+{
+  if (adaptivePollConfig.GetTime)
+    return adaptivePollConfig.GetTime();
+
+  return (uint32_t)HAL_GetSystemTime();
+}
+
+#else /* ZIGBEE_END_DEVICE */
+
+void N_Cmi_StartAdaptivePolling_Impl(const N_Cmi_AdaptivePollConfig_t* pConfig)
+{
+  (void)pConfig;
+}
+
+void N_Cmi_StopAdaptivePolling_Impl(void)
+{}
+
+uint32_t N_Cmi_GetAdaptivePollInterval_Impl(void)
+{
+  return 0U;
+}
+
+#endif /* ZIGBEE_END_DEVICE */
+// eof N_Cmi_AdaptivePoll.c
@@ -47,6 +47,10 @@
 #  define N_Cmi_NetworkDiscovery N_Cmi_Stub_NetworkDiscovery
 #  define N_Cmi_SendLinkStatus N_Cmi_Stub_SendLinkStatus
 #  define N_Cmi_Join N_Cmi_Stub_Join
+#  define N_Cmi_SetBeaconScoring N_Cmi_Stub_SetBeaconScoring
+#  define N_Cmi_GetBeaconCandidate N_Cmi_Stub_GetBeaconCandidate
+#  define N_Cmi_ClearBeaconCandidates N_Cmi_Stub_ClearBeaconCandidates
+#  define N_Cmi_ReportParentResult N_Cmi_Stub_ReportParentResult
 #  define N_Cmi_ResetNetworkSettings N_Cmi_Stub_ResetNetworkSettings
 #  define N_Cmi_GetNetworkParams N_Cmi_Stub_GetNetworkParams
 #  define N_Cmi_GetParentInfo N_Cmi_Stub_GetParentInfo
@@ -56,6 +60,9 @@
 #  define N_Cmi_SendLeaveIndication N_Cmi_Stub_SendLeaveIndication
 #  define N_Cmi_ProcessLeaveIndication N_Cmi_Stub_ProcessLeaveIndication
 #  define N_Cmi_SendUpdateDevice N_Cmi_Stub_SendUpdateDevice
+#  define N_Cmi_StartAdaptivePolling N_Cmi_Stub_StartAdaptivePolling
+#  define N_Cmi_StopAdaptivePolling N_Cmi_Stub_StopAdaptivePolling
+#  define N_Cmi_GetAdaptivePollInterval N_Cmi_Stub_GetAdaptivePollInterval
 #  define N_Cmi_UseNwkMulticast N_Cmi_UseNwkMulticast_Impl
 #  define N_Cmi_InitMacLayer N_Cmi_InitMacLayer_Impl
 
@@ -111,6 +118,10 @@
 #  define N_Cmi_NetworkDiscovery N_Cmi_NetworkDiscovery_Impl
 #  define N_Cmi_SendLinkStatus N_Cmi_SendLinkStatus_Impl
 #  define N_Cmi_Join N_Cmi_Join_Impl
+#  define N_Cmi_SetBeaconScoring N_Cmi_SetBeaconScoring_Impl
+#  define N_Cmi_GetBeaconCandidate N_Cmi_GetBeaconCandidate_Impl
+#  define N_Cmi_ClearBeaconCandidates N_Cmi_ClearBeaconCandidates_Impl
+#  define N_Cmi_ReportParentResult N_Cmi_ReportParentResult_Impl
 #  define N_Cmi_ResetNetworkSettings N_Cmi_ResetNetworkSettings_Impl
 #  define N_Cmi_GetNetworkParams N_Cmi_GetNetworkParams_Impl
 #  define N_Cmi_GetParentInfo N_Cmi_GetParentInfo_Impl
@@ -121,6 +132,9 @@
 #  define N_Cmi_ProcessLeaveIndication N_Cmi_ProcessLeaveIndication_Impl
 #  define N_Cmi_SendUpdateDevice N_Cmi_SendUpdateDevice_Impl
 #  define N_Cmi_SetPollRateForTimePeriod N_Cmi_SetPollRateForTimePeriod_Impl
+#  define N_Cmi_StartAdaptivePolling N_Cmi_StartAdaptivePolling_Impl
+#  define N_Cmi_StopAdaptivePolling N_Cmi_StopAdaptivePolling_Impl
+#  define N_Cmi_GetAdaptivePollInterval N_Cmi_GetAdaptivePollInterval_Impl
 #  define N_Cmi_SetZllLinkKeyAsPrimary N_Cmi_SetZllLinkKeyAsPrimary_Impl
 #  define N_Cmi_UseNwkMulticast N_Cmi_UseNwkMulticast_Impl
 #  define N_Cmi_InitMacLayer N_Cmi_InitMacLayer_Impl
@@ -43,6 +43,10 @@
 #  define N_Cmi_NetworkDiscovery N_Cmi_Stub_NetworkDiscovery
 #  define N_Cmi_SendLinkStatus N_Cmi_Stub_SendLinkStatus
 #  define N_Cmi_Join N_Cmi_Stub_Join
+#  define N_Cmi_SetBeaconScoring N_Cmi_Stub_SetBeaconScoring
+#  define N_Cmi_GetBeaconCandidate N_Cmi_Stub_GetBeaconCandidate
+#  define N_Cmi_ClearBeaconCandidates N_Cmi_Stub_ClearBeaconCandidates
+#  define N_Cmi_ReportParentResult N_Cmi_Stub_ReportParentResult
 #  define N_Cmi_ResetNetworkSettings N_Cmi_Stub_ResetNetworkSettings
 #  define N_Cmi_GetNetworkParams N_Cmi_Stub_GetNetworkParams
 #  define N_Cmi_GetParentInfo N_Cmi_Stub_GetParentInfo
@@ -107,6 +111,10 @@
 #  define N_Cmi_NetworkDiscovery N_Cmi_NetworkDiscovery_Impl
 #  define N_Cmi_SendLinkStatus N_Cmi_SendLinkStatus_Impl
 #  define N_Cmi_Join N_Cmi_Join_Impl
+#  define N_Cmi_SetBeaconScoring N_Cmi_SetBeaconScoring_Impl
+#  define N_Cmi_GetBeaconCandidate N_Cmi_GetBeaconCandidate_Impl
+#  define N_Cmi_ClearBeaconCandidates N_Cmi_ClearBeaconCandidates_Impl
+#  define N_Cmi_ReportParentResult N_Cmi_ReportParentResult_Impl
 #  define N_Cmi_ResetNetworkSettings N_Cmi_ResetNetworkSettings_Impl
 #  define N_Cmi_GetNetworkParams N_Cmi_GetNetworkParams_Impl
 #  define N_Cmi_GetParentInfo N_Cmi_GetParentInfo_Impl
@@ -137,8 +137,9 @@ void N_Connection_AssociateDiscovery_Impl(N_Beacon_t* pBeacon, N_Connection_Asso
   discoveryContext.channelIdx = 0;
   discoveryContext.aborted = false;
 
-  /* Clean the beacon buffer */
+  /* Clean the beacon buffer and the parent candidates of previous discoveries */
   memset(pBeacon, 0x00, sizeof(N_Beacon_t));
+  N_Cmi_ClearBeaconCandidates();
 
   /* Obtain mask of next channel to scan */
   channelMask = getMaskForNextChannel();
@@ -39,14 +39,240 @@
   #define N_GROUP_MAX_SUBSCRIBERS   1u
 #endif
 
+/** Number of distinct groups kept in the membership cache */
+#if (!defined(N_GROUPS_CACHE_SIZE))
+  #define N_GROUPS_CACHE_SIZE   CS_GROUP_TABLE_SIZE
+#endif
+
+/** Number of distinct endpoints the membership cache can represent */
+#define N_GROUPS_CACHE_MAX_ENDPOINTS  7u
+
+/** Endpoint mask bit of groups added for APS_BROADCAST_ENDPOINT */
+#define N_GROUPS_CACHE_ALL_ENDPOINTS  0x80u
+
+/******************************************************************************
+                    Types section
+******************************************************************************/
+typedef enum
+{
+  N_GROUPS_CACHE_INVALID,  //< Cache is rebuilt from the NWK group table on next use
+  N_GROUPS_CACHE_VALID,    //< Cache mirrors the NWK group table
+  N_GROUPS_CACHE_OVERFLOW  //< NWK group table does not fit, NWK is used until groups are removed or the table changes
+} N_Groups_CacheState_t;
+
+/** Membership cache entry. Entries are sorted on groupId. */
+typedef struct
+{
+  uint16_t groupId;
+  uint8_t  endpoints;  //< Bit i is set if s_cacheEndpoint[i] is member of the group, see also N_GROUPS_CACHE_ALL_ENDPOINTS
+} N_Groups_CacheEntry_t;
+
+/******************************************************************************
+                    Static variables section
+******************************************************************************/
 N_UTIL_CALLBACK_DECLARE(N_Groups_Subscriber_t, s_subscribers, N_GROUP_MAX_SUBSCRIBERS);
 
 static void N_Groups_RemovedFromAllGroups(SYS_EventId_t eventId, SYS_EventData_t data);
+static void N_Groups_GroupTableChanged(SYS_EventId_t eventId, SYS_EventData_t data);
 
 static SYS_EventReceiver_t eventReceiver = {
   .func = N_Groups_RemovedFromAllGroups
 };
 
+static SYS_EventReceiver_t cacheEventReceiver = {
+  .func = N_Groups_GroupTableChanged
+};
+
+static N_Groups_CacheEntry_t s_cache[N_GROUPS_CACHE_SIZE];
+static uint8_t s_cacheCount = 0u;
+static uint8_t s_cacheEndpoint[N_GROUPS_CACHE_MAX_ENDPOINTS];
+static uint8_t s_cacheEndpointCount = 0u;
+static N_Groups_CacheState_t s_cacheState = N_GROUPS_CACHE_INVALID;
+static bool s_cacheSubscribed = false;
+/* Set while this component changes the NWK group table itself */
+static bool s_cacheUpdating = false;
+
+/* Position of the last group returned by N_Groups_GetGroup(), to continue an iteration from */
+static bool s_cursorValid = false;
+static uint8_t s_cursorEndpoint;
+static uint8_t s_cursorIndex;
+static uint8_t s_cursorPosition;
+
+/******************************************************************************
+                    Static functions section
+******************************************************************************/
+/** Gets the endpoint mask of the cache entries.
+    \param endpoint The endpoint, or APS_BROADCAST_ENDPOINT
+    \param allocate Whether to allocate a bit for an endpoint that is not known yet
+    \returns The mask, or 0 when the endpoint is not known and can not be allocated
+*/
+static uint8_t cacheEndpointMask(uint8_t endpoint, bool allocate)
+{
+  uint8_t i;
+
+  if (APS_BROADCAST_ENDPOINT == endpoint)
+    return N_GROUPS_CACHE_ALL_ENDPOINTS;
+
+  for (i = 0u; i < s_cacheEndpointCount; i++)
+    if (s_cacheEndpoint[i] == endpoint)
+      return (uint8_t)(1u << i);
+
+  if (!allocate || (N_GROUPS_CACHE_MAX_ENDPOINTS == s_cacheEndpointCount))
+    return 0u;
+
+  s_cacheEndpoint[s_cacheEndpointCount] = endpoint;
+  return (uint8_t)(1u << s_cacheEndpointCount++);
+}
+
+/** Finds the group in the cache using binary search.
+    \param groupId The group to find
+    \param pPosition The position of the group, or where it should be inserted
+    \returns true if the group is in the cache, otherwise false.
+*/
+static bool cacheFind(uint16_t groupId, uint8_t *pPosition)
+{
+  uint8_t lo = 0u;
+  uint8_t hi = s_cacheCount;
+
+  while (lo < hi)
+  {
+    uint8_t mid = (uint8_t)((lo + hi) / 2u);
+
+    if (s_cache[mid].groupId < groupId)
+      lo = mid + 1u;
+    else
+      hi = mid;
+  }
+
+  *pPosition = lo;
+  return (lo < s_cacheCount) && (s_cache[lo].groupId == groupId);
+}
+
+/** Adds the endpoint to the group in the cache. Moves the cache to the overflow state
+    when there is no room for the group or the endpoint.
+*/
+static void cacheAdd(uint16_t groupId, uint8_t endpoint)
+{
+  uint8_t mask = cacheEndpointMask(endpoint, true);
+  uint8_t position;
+
+  if (0u == mask)
+  {
+    s_cacheState = N_GROUPS_CACHE_OVERFLOW;
+    return;
+  }
+
+  if (!cacheFind(groupId, &position))
+  {
+    if (N_GROUPS_CACHE_SIZE == s_cacheCount)
+    {
+      s_cacheState = N_GROUPS_CACHE_OVERFLOW;
+      return;
+    }
+    memmove(&s_cache[position + 1u], &s_cache[position], (s_cacheCount - position) * sizeof(N_Groups_CacheEntry_t));
+    s_cache[position].groupId = groupId;
+    s_cache[position].endpoints = 0u;
+    s_cacheCount++;
+  }
+
+  s_cache[position].endpoints |= mask;
+  s_cursorValid = false;
+}
+
+/** Removes the endpoint from the group in the cache. */
+static void cacheRemove(uint16_t groupId, uint8_t endpoint)
+{
+  uint8_t position;
+
+  if (!cacheFind(groupId, &position))
+    return;
+
+  s_cache[position].endpoints &= (uint8_t)~cacheEndpointMask(endpoint, false);
+  if (0u == s_cache[position].endpoints)
+  {
+    s_cacheCount--;
+    memmove(&s_cache[position], &s_cache[position + 1u], (s_cacheCount - position) * sizeof(N_Groups_CacheEntry_t));
+  }
+  s_cursorValid = false;
+}
+
+/** Removes the endpoint from all groups in the cache. */
+static void cacheRemoveAll(uint8_t endpoint)
+{
+  uint8_t mask = cacheEndpointMask(endpoint, false);
+  uint8_t count = 0u;
+
+  for (uint8_t i = 0u; i < s_cacheCount; i++)
+  {
+    s_cache[i].endpoints &= (uint8_t)~mask;
+    if (0u != s_cache[i].endpoints)
+      s_cache[count++] = s_cache[i];
+  }
+  s_cacheCount = count;
+  s_cursorValid = false;
+}
+
+/** Updates the cache after an endpoint has been removed from a group. An overflowed cache is
+    rebuilt on next use, as the NWK group table may fit now. So is the cache after a removal
+    for APS_BROADCAST_ENDPOINT, as NWK treats it as any endpoint.
+*/
+static void cacheRemoved(uint16_t groupId, uint8_t endpoint)
+{
+  if ((N_GROUPS_CACHE_VALID == s_cacheState) && (APS_BROADCAST_ENDPOINT != endpoint))
+    cacheRemove(groupId, endpoint);
+  else if (N_GROUPS_CACHE_INVALID != s_cacheState)
+    s_cacheState = N_GROUPS_CACHE_INVALID;
+}
+
+/** Checks whether the cache can be used, rebuilding it from the NWK group table when needed.
+    \returns true if the cache mirrors the NWK group table, otherwise false.
+*/
+static bool cacheReady(void)
+{
+  NWK_GroupTableEntry_t *groupEntry = NULL;
+
+  if (N_GROUPS_CACHE_INVALID != s_cacheState)
+    return N_GROUPS_CACHE_VALID == s_cacheState;
+
+  if (!s_cacheSubscribed)
+  {
+    SYS_SubscribeToEvent(BC_EVENT_GROUP_TABLE_UPDATED, &cacheEventReceiver);
+    SYS_SubscribeToEvent(BC_EVENT_GROUPS_REMOVED, &cacheEventReceiver);
+    SYS_SubscribeToEvent(BC_EVENT_NETWORK_LEFT, &cacheEventReceiver);
+    SYS_SubscribeToEvent(BC_EVENT_NETWORK_STARTED, &cacheEventReceiver);
+    s_cacheSubscribed = true;
+  }
+
+  s_cacheCount = 0u;
+  s_cacheEndpointCount = 0u;
+  s_cursorValid = false;
+  s_cacheState = N_GROUPS_CACHE_VALID;
+
+  while ((N_GROUPS_CACHE_VALID == s_cacheState) && (NULL != (groupEntry = NWK_NextGroup(groupEntry))))
+    cacheAdd(groupEntry->addr, groupEntry->data);
+
+  return N_GROUPS_CACHE_VALID == s_cacheState;
+}
+
+/** Checks membership of an endpoint to a group. APS_BROADCAST_ENDPOINT is member when any
+    endpoint is, like for NWK_IsGroupMember().
+*/
+static bool isMemberOfGroup(uint8_t endpoint, uint16_t groupId)
+{
+  uint8_t position;
+
+  if (!cacheReady())
+    return NWK_IsGroupMember(groupId, endpoint);
+
+  if (!cacheFind(groupId, &position))
+    return false;
+
+  if (APS_BROADCAST_ENDPOINT == endpoint)
+    return true;
+
+  return 0u != (s_cache[position].endpoints & cacheEndpointMask(endpoint, false));
+}
+
 /******************************************************************************
                     Implementation section
 ******************************************************************************/
@@ -59,11 +285,17 @@ N_Groups_Status_t N_Groups_AddToGroup_Impl(uint8_t endpoint, uint16_t groupId)
 {
   N_ERRH_ASSERT_FATAL(IS_VALID_ENDPOINT(endpoint));
 
-  if (NWK_IsGroupMember(groupId, endpoint))
+  if (isMemberOfGroup(endpoint, groupId))
     return N_Groups_Status_AlreadyMember;
 
-  if (NWK_AddGroup(groupId, endpoint))
+  s_cacheUpdating = true;
+  bool added = NWK_AddGroup(groupId, endpoint);
+  s_cacheUpdating = false;
+
+  if (added)
   {
+    if (N_GROUPS_CACHE_VALID == s_cacheState)
+      cacheAdd(groupId, endpoint);
     N_UTIL_CALLBACK(N_Groups_Subscriber_t, s_subscribers, AddedToGroup, (endpoint, groupId));
     return N_Groups_Status_Ok;
   }
@@ -80,8 +312,13 @@ N_Groups_Status_t N_Groups_RemoveFromGroup_Impl(uint8_t endpoint, uint16_t group
 {
   N_ERRH_ASSERT_FATAL(IS_VALID_ENDPOINT(endpoint));
 
-  if(NWK_RemoveGroup(groupId, endpoint))
+  s_cacheUpdating = true;
+  bool removed = NWK_RemoveGroup(groupId, endpoint);
+  s_cacheUpdating = false;
+
+  if (removed)
   {
+    cacheRemoved(groupId, endpoint);
     N_UTIL_CALLBACK(N_Groups_Subscriber_t, s_subscribers, RemovedFromGroup, (endpoint, groupId));
     return N_Groups_Status_Ok;
   }
@@ -95,7 +332,14 @@ N_Groups_Status_t N_Groups_RemoveFromGroup_Impl(uint8_t endpoint, uint16_t group
 void N_Groups_RemoveFromAllGroups_Impl(uint8_t endpoint)
 {
   N_ERRH_ASSERT_FATAL(IS_VALID_ENDPOINT(endpoint));
+  s_cacheUpdating = true;
   NWK_RemoveAllGroups(endpoint);
+  s_cacheUpdating = false;
+
+  if ((N_GROUPS_CACHE_VALID == s_cacheState) && (APS_BROADCAST_ENDPOINT != endpoint))
+    cacheRemoveAll(endpoint);
+  else if (N_GROUPS_CACHE_INVALID != s_cacheState)
+    s_cacheState = N_GROUPS_CACHE_INVALID;
 }
 
 /** Checks membership of an endpoint to a group.
@@ -107,7 +351,7 @@ bool N_Groups_IsMemberOfGroup_Impl(uint8_t endpoint, uint16_t groupId)
 {
   N_ERRH_ASSERT_FATAL(IS_VALID_ENDPOINT(endpoint));
 
-  return NWK_IsGroupMember(groupId, endpoint);
+  return isMemberOfGroup(endpoint, groupId);
 }
 
 /** Gets the total group list capacity
@@ -135,11 +379,46 @@ uint8_t N_Groups_GetRemainingCapacity_Impl(void)
     \param index The index within the group list
     \param pGroup The place to store the groupId retrieved from the list
     \returns N_Groups_Status_Ok when pGroup is valid, otherwise N_Groups_Status_Failed.
+    \note Iterating over the indices in increasing order takes O(n) in total.
 */
 N_Groups_Status_t N_Groups_GetGroup_Impl(uint8_t endpoint, uint8_t index, uint16_t* pGroup)
 {
   NWK_GroupTableEntry_t *groupEntry = NULL;
 
+  if (cacheReady())
+  {
+    uint8_t mask = cacheEndpointMask(endpoint, false);
+    uint8_t position = 0u;
+    uint8_t count = 0u;
+
+    if (0u == mask)
+      return N_Groups_Status_Failed;
+
+    // continue from the last returned group when iterating
+    if (s_cursorValid && (s_cursorEndpoint == endpoint) && (s_cursorIndex <= index))
+    {
+      position = s_cursorPosition;
+      count = s_cursorIndex;
+    }
+
+    for (; position < s_cacheCount; position++)
+      if (0u != (s_cache[position].endpoints & mask))
+      {
+        if (count == index)
+        {
+          s_cursorValid = true;
+          s_cursorEndpoint = endpoint;
+          s_cursorIndex = index;
+          s_cursorPosition = position;
+          *pGroup = s_cache[position].groupId;
+          return N_Groups_Status_Ok;
+        }
+        count++;
+      }
+
+    return N_Groups_Status_Failed;
+  }
+
   while (NULL != (groupEntry = NWK_NextGroup(groupEntry)))
     if (groupEntry->data == endpoint && !index--)
     {
@@ -166,4 +445,17 @@ static void N_Groups_RemovedFromAllGroups(SYS_EventId_t eventId, SYS_EventData_t
                   (groupEntry->data, groupEntry->addr));
 }
 
+/** Keeps the membership cache coherent with changes of the NWK group table. */
+static void N_Groups_GroupTableChanged(SYS_EventId_t eventId, SYS_EventData_t data)
+{
+  if (BC_EVENT_GROUPS_REMOVED == eventId)
+  {
+    NWK_GroupTableEntry_t *groupEntry = (NWK_GroupTableEntry_t *)data;
+
+    cacheRemoved(groupEntry->addr, groupEntry->data);
+  }
+  else if (!s_cacheUpdating)
+    s_cacheState = N_GROUPS_CACHE_INVALID;
+}
+
 /* eof N_Groups.c */
@@ -45,6 +45,9 @@ extern "C" {
 
 #define NETWORK_KEY_LENGTH 16u
 
+/** Command id reported for manufacturer specific commands. */
+#define N_INTERPAN_COMMAND_ID_UNKNOWN 0xFFu
+
 /** The maximum number of device info records in a device info response. */
 #define N_INTERPAN_DEVICE_INFO_RECORD_MAX 5u
 
@@ -305,10 +308,58 @@ typedef struct N_InterPan_Callback_t
     int8_t endOfList;
 } N_InterPan_Callback_t;
 
+/** Reasons for the rejection of a received command, see \ref N_InterPan_GetRxRejectCount. */
+typedef enum N_InterPan_RxReject_t
+{
+    N_InterPan_RxReject_UnknownCommand = 0,  //< The command id is not known
+    N_InterPan_RxReject_Length = 1,          //< The length is not valid for the command
+    N_InterPan_RxReject_Direction = 2,       //< The direction in the frame control field is not valid for the command
+    N_InterPan_RxReject_Unexpected = 3,      //< A response was received without having sent the request
+    N_InterPan_RxReject_Count = 4,
+} N_InterPan_RxReject_t;
+
+/** Transmit status. */
+typedef enum N_InterPan_TxStatus_t
+{
+    N_InterPan_TxStatus_Ok = 0,       //< The frame has been sent
+    N_InterPan_TxStatus_Failed = 1,   //< The frame has been passed to the MAC, but sending failed
+    N_InterPan_TxStatus_Dropped = 2,  //< The frame has not been sent, because no buffer became available in time, or the channel changed while it waited
+} N_InterPan_TxStatus_t;
+
+/** Transmit status callback structure. */
+typedef struct N_InterPan_TxCallback_t
+{
+    /** A frame passed to one of the send functions has been handled.
+        \param commandId The command id of the frame, or N_INTERPAN_COMMAND_ID_UNKNOWN
+        \param status The result
+        \note When no InterPan buffer is free, frames are queued. A queued ScanRequest is replaced by a
+               newer one, and a queued ScanResponse by a newer one to the same destination. When the queue
+               is full, the oldest frame with the lowest priority is dropped.
+        \note Is called after the transmit queue has been updated, so another frame may be sent from
+               this callback.
+    */
+    void (*TxDone)(uint8_t commandId, N_InterPan_TxStatus_t status);
+
+    /** Guard to ensure the initialiser contains all functions. */
+    int8_t endOfList;
+} N_InterPan_TxCallback_t;
+
 /***************************************************************************************************
 * EXPORTED FUNCTIONS
 ***************************************************************************************************/
 
+/** Get the number of received commands that were dropped for a reason.
+    \param reason The reason
+    \returns The number of dropped commands, saturated at 0xFFFF
+    \note Manufacturer specific commands are never rejected, they are only passed to ReceivedInterPanCommand.
+*/
+uint16_t N_InterPan_GetRxRejectCount(N_InterPan_RxReject_t reason);
+
+/** Subscribe for transmit status callbacks from this component.
+    \param pCallback Pointer to filled callback structure
+*/
+void N_InterPan_SubscribeTx(const N_InterPan_TxCallback_t* pCallback);
+
 /** Subscribe for callbacks from this component.
     \param pCallback Pointer to filled callback structure
 */
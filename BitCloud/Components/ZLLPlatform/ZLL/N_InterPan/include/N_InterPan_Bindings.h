@@ -1,5 +1,7 @@
 // implemented interface
 #define N_InterPan_Subscribe N_InterPan_Subscribe_Impl
+#define N_InterPan_SubscribeTx N_InterPan_SubscribeTx_Impl
+#define N_InterPan_GetRxRejectCount N_InterPan_GetRxRejectCount_Impl
 #define N_InterPan_BroadcastScanRequest N_InterPan_BroadcastScanRequest_Impl
 #define N_InterPan_UnicastScanRequest N_InterPan_UnicastScanRequest_Impl
 #define N_InterPan_SendScanResponse N_InterPan_SendScanResponse_Impl
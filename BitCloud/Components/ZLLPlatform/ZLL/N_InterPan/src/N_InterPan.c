@@ -35,6 +35,7 @@ $Id: N_InterPan.c 24662 2013-03-04 08:37:46Z arazinkov $
 #include "N_Types.h"
 #include "N_Util.h"
 #include <intrpData.h>
+#include <configServer.h>
 #include <clusters.h>
 #include <N_InterPanBuffers.h>
 
@@ -49,6 +50,21 @@ $Id: N_InterPan.c 24662 2013-03-04 08:37:46Z arazinkov $
   #define N_INTERPAN_MAX_SUBSCRIBERS      4u
 #endif
 
+/** Maximum number of subscribers to the transmit status of this component. */
+#ifndef N_INTERPAN_MAX_TX_SUBSCRIBERS
+  #define N_INTERPAN_MAX_TX_SUBSCRIBERS   1u
+#endif
+
+/** Number of frames that can wait for a free InterPan buffer. */
+#ifndef N_INTERPAN_TX_QUEUE_SIZE
+  #define N_INTERPAN_TX_QUEUE_SIZE        3u
+#endif
+
+/** Transmit priorities. When the queue is full, the oldest frame with the lowest priority is dropped. */
+#define TX_PRIORITY_LOW                 0u
+#define TX_PRIORITY_NORMAL              1u
+#define TX_PRIORITY_HIGH                2u
+
 #define SCAN_REQUEST_COMMAND_ID                             0x00u
 #define SCAN_RESPONSE_COMMAND_ID                            0x01u
 #define DEVICE_INFO_REQUEST_COMMAND_ID                      0x02u
@@ -83,25 +99,63 @@ $Id: N_InterPan.c 24662 2013-03-04 08:37:46Z arazinkov $
 #define CLIENT_SERVER_DIR               0x00u
 #define SERVER_CLIENT_DIR               0x01u
 
+/** Marks a command descriptor of a request, which is always accepted. */
+#define NO_RESPONSE_SLOT                0xFFu
+
 /***************************************************************************************************
 * LOCAL TYPES
 ***************************************************************************************************/
 
 typedef void (*CommandHandler_t)(INTRP_DataInd_t *ind);
 
+/** Responses are only accepted after the corresponding request has been sent. */
+typedef enum ResponseSlot_t
+{
+    ResponseSlot_ScanResponse,
+    ResponseSlot_DeviceInfoResponse,
+    ResponseSlot_NetworkStartResponse,
+    ResponseSlot_NetworkJoinRouterResponse,
+    ResponseSlot_NetworkJoinEndDeviceResponse,
+    ResponseSlot_Count
+} ResponseSlot_t;
+
+/** Describes how a received command is validated and dispatched. */
+typedef struct CommandDescriptor_t
+{
+    uint8_t commandId;
+    uint8_t direction;
+    uint8_t minLength;
+    uint8_t maxLength;
+    /** Index into s_responseHandlers, or NO_RESPONSE_SLOT if handler is to be used. */
+    uint8_t responseSlot;
+    CommandHandler_t handler;
+} CommandDescriptor_t;
+
+/** Frame waiting for a free InterPan buffer. */
+typedef struct TxQueueEntry_t
+{
+    uint8_t commandId;
+    uint8_t priority;
+    bool broadcast;
+    /** The channel the frame was requested on. The frame is dropped if the radio has left it. */
+    uint8_t channel;
+    uint8_t dataLength;
+    N_Address_Extended_t destinationAddress;
+    uint8_t data[APS_MAX_INTERPAN_ASDU_SIZE];
+} TxQueueEntry_t;
+
 /***************************************************************************************************
 * LOCAL VARIABLES
 ***************************************************************************************************/
 
-/** Used for all responses until their corresponding commands have been sent. */
-static void DummyCommandHandler(INTRP_DataInd_t *ind)
-{
-  // nop
-  (void)ind;
-}
-
 N_UTIL_CALLBACK_DECLARE(N_InterPan_Callback_t, s_subscribers, N_INTERPAN_MAX_SUBSCRIBERS);
 
+N_UTIL_CALLBACK_DECLARE(N_InterPan_TxCallback_t, s_txSubscribers, N_INTERPAN_MAX_TX_SUBSCRIBERS);
+
+/** Frames waiting for a free InterPan buffer, oldest first. */
+static TxQueueEntry_t s_txQueue[N_INTERPAN_TX_QUEUE_SIZE];
+static uint8_t s_txQueueCount = 0u;
+
 /** Sequence number used for Inter-PAN transaction sequence number and the AF sequence number. */
 static uint8_t s_sequenceNumber = 0u;
 
@@ -109,12 +163,13 @@ static uint8_t s_sequenceNumber = 0u;
 static const N_Address_Extended_t s_invalidExtendedAddress = { 0xFFu, 0xFFu, 0xFFu, 0xFFu, 0xFFu, 0xFFu, 0xFFu, 0xFFu };
 static const N_Address_Extended_t s_zeroExtendedAddress = { 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u };
 
-/** To save code size, the response handlers are only installed when the corresponding command is sent. */
-static CommandHandler_t s_ProcessReceivedScanResponse = DummyCommandHandler;
-static CommandHandler_t s_ProcessReceivedDeviceInfoResponse = DummyCommandHandler;
-static CommandHandler_t s_ProcessReceivedNetworkStartResponse = DummyCommandHandler;
-static CommandHandler_t s_ProcessReceivedNetworkJoinRouterResponse = DummyCommandHandler;
-static CommandHandler_t s_ProcessReceivedNetworkJoinEndDeviceResponse = DummyCommandHandler;
+/** To save code size, the response handlers are only installed when the corresponding command is sent.
+    Until then, the response is rejected as unexpected.
+*/
+static CommandHandler_t s_responseHandlers[ResponseSlot_Count];
+
+/** Number of received commands rejected by the dispatcher, per reason. */
+static uint16_t s_rxRejectCount[N_InterPan_RxReject_Count];
 
 static bool s_initialised = FALSE;
 
@@ -122,28 +177,121 @@ static bool s_initialised = FALSE;
                     Prototypes section
 ******************************************************************************/
 static void INTRP_DataConf(INTRP_DataConf_t *conf);
+static void ProcessReceivedScanRequest(INTRP_DataInd_t *ind);
+static void ProcessReceivedScanResponse(INTRP_DataInd_t *ind);
+static void ProcessReceivedDeviceInfoRequest(INTRP_DataInd_t *ind);
+static void ProcessReceivedDeviceInfoResponse(INTRP_DataInd_t *ind);
+static void ProcessReceivedIdentifyRequest(INTRP_DataInd_t *ind);
+static void ProcessReceivedResetToFactoryNewRequest(INTRP_DataInd_t *ind);
+static void ProcessReceivedNetworkStartRequest(INTRP_DataInd_t *ind);
+static void ProcessReceivedNetworkStartResponse(INTRP_DataInd_t *ind);
+static void ProcessReceivedNetworkJoinRouterRequest(INTRP_DataInd_t *ind);
+static void ProcessReceivedNetworkJoinRouterResponse(INTRP_DataInd_t *ind);
+static void ProcessReceivedNetworkJoinEndDeviceRequest(INTRP_DataInd_t *ind);
+static void ProcessReceivedNetworkJoinEndDeviceResponse(INTRP_DataInd_t *ind);
+static void ProcessReceivedNetworkUpdateRequest(INTRP_DataInd_t *ind);
+
+/***************************************************************************************************
+* LOCAL CONSTANTS
+***************************************************************************************************/
+
+/** Received commands, sorted on command id. The lengths are checked before the handler is called;
+    commands with optional or variable length fields are checked further by their handler.
+*/
+static const CommandDescriptor_t s_commandDescriptors[] =
+{
+    { SCAN_REQUEST_COMMAND_ID, CLIENT_SERVER_DIR,
+      sizeof(N_InterPan_ScanRequest_t), sizeof(N_InterPan_ScanRequest_t),
+      NO_RESPONSE_SLOT, ProcessReceivedScanRequest },
+    { SCAN_RESPONSE_COMMAND_ID, SERVER_CLIENT_DIR,
+      offsetof(N_InterPan_ScanResponse_t, endPoint), sizeof(N_InterPan_ScanResponse_t),
+      ResponseSlot_ScanResponse, NULL },
+    { DEVICE_INFO_REQUEST_COMMAND_ID, CLIENT_SERVER_DIR,
+      sizeof(N_InterPan_DeviceInfoRequest_t), sizeof(N_InterPan_DeviceInfoRequest_t),
+      NO_RESPONSE_SLOT, ProcessReceivedDeviceInfoRequest },
+    { DEVICE_INFO_RESPONSE_COMMAND_ID, SERVER_CLIENT_DIR,
+      offsetof(N_InterPan_DeviceInfoResponse_t, deviceInfo), sizeof(N_InterPan_DeviceInfoResponse_t),
+      ResponseSlot_DeviceInfoResponse, NULL },
+    { IDENTIFY_REQUEST_COMMAND_ID, CLIENT_SERVER_DIR,
+      sizeof(N_InterPan_IdentifyRequest_t), sizeof(N_InterPan_IdentifyRequest_t),
+      NO_RESPONSE_SLOT, ProcessReceivedIdentifyRequest },
+    { RESET_TO_FACTORY_NEW_REQUEST_COMMAND_ID, CLIENT_SERVER_DIR,
+      sizeof(N_InterPan_ResetToFactoryNewRequest_t), sizeof(N_InterPan_ResetToFactoryNewRequest_t),
+      NO_RESPONSE_SLOT, ProcessReceivedResetToFactoryNewRequest },
+    { NETWORK_START_REQUEST_COMMAND_ID, CLIENT_SERVER_DIR,
+      sizeof(N_InterPan_NetworkStartRequest_t), sizeof(N_InterPan_NetworkStartRequest_t),
+      NO_RESPONSE_SLOT, ProcessReceivedNetworkStartRequest },
+    { NETWORK_START_RESPONSE_COMMAND_ID, SERVER_CLIENT_DIR,
+      sizeof(N_InterPan_NetworkStartResponse_t), sizeof(N_InterPan_NetworkStartResponse_t),
+      ResponseSlot_NetworkStartResponse, NULL },
+    { NETWORK_JOIN_ROUTER_REQUEST_COMMAND_ID, CLIENT_SERVER_DIR,
+      sizeof(N_InterPan_NetworkJoinRequest_t), sizeof(N_InterPan_NetworkJoinRequest_t),
+      NO_RESPONSE_SLOT, ProcessReceivedNetworkJoinRouterRequest },
+    { NETWORK_JOIN_ROUTER_RESPONSE_COMMAND_ID, SERVER_CLIENT_DIR,
+      sizeof(N_InterPan_NetworkJoinResponse_t), sizeof(N_InterPan_NetworkJoinResponse_t),
+      ResponseSlot_NetworkJoinRouterResponse, NULL },
+    { NETWORK_JOIN_END_DEVICE_REQUEST_COMMAND_ID, CLIENT_SERVER_DIR,
+      sizeof(N_InterPan_NetworkJoinRequest_t), sizeof(N_InterPan_NetworkJoinRequest_t),
+      NO_RESPONSE_SLOT, ProcessReceivedNetworkJoinEndDeviceRequest },
+    { NETWORK_JOIN_END_DEVICE_RESPONSE_COMMAND_ID, SERVER_CLIENT_DIR,
+      sizeof(N_InterPan_NetworkJoinResponse_t), sizeof(N_InterPan_NetworkJoinResponse_t),
+      ResponseSlot_NetworkJoinEndDeviceResponse, NULL },
+    { NETWORK_UPDATE_REQUEST_COMMAND_ID, CLIENT_SERVER_DIR,
+      sizeof(N_InterPan_NetworkUpdateRequest_t), sizeof(N_InterPan_NetworkUpdateRequest_t),
+      NO_RESPONSE_SLOT, ProcessReceivedNetworkUpdateRequest },
+};
 
 /***************************************************************************************************
 * LOCAL FUNCTIONS
 ***************************************************************************************************/
-/**************************************************************************//**
-\brief Confirmation of interPan data sending
+/** Returns the command id of a frame, or N_INTERPAN_COMMAND_ID_UNKNOWN for a manufacturer specific frame. */
+static uint8_t GetCommandId(const uint8_t* pData)
+{
+  const N_InterPan_FrameHeader_t* pHeader = (const N_InterPan_FrameHeader_t*)pData;
 
-\param[in] conf - pointer to confirmation structure
-******************************************************************************/
-static void INTRP_DataConf(INTRP_DataConf_t *conf)
+  return pHeader->frameControl.manufacturerSpecific ? N_INTERPAN_COMMAND_ID_UNKNOWN : pHeader->commandId;
+}
+
+/** Returns the transmit priority of a command. Scan and identify frames are repeated by the
+    touchlink procedure anyway, network commands are not.
+*/
+static uint8_t GetTxPriority(uint8_t commandId)
 {
-  INTRP_DataReq_t *req = GET_PARENT_BY_FIELD(INTRP_DataReq_t, confirm, conf);
-  freeInterPanBuffer(req);
+  switch (commandId)
+  {
+    case SCAN_REQUEST_COMMAND_ID:
+    case SCAN_RESPONSE_COMMAND_ID:
+    case IDENTIFY_REQUEST_COMMAND_ID:
+      return TX_PRIORITY_LOW;
+
+    case N_INTERPAN_COMMAND_ID_UNKNOWN:
+    case DEVICE_INFO_REQUEST_COMMAND_ID:
+    case DEVICE_INFO_RESPONSE_COMMAND_ID:
+      return TX_PRIORITY_NORMAL;
+
+    default:
+      return TX_PRIORITY_HIGH;
+  }
 }
 
-static void DataRequest(uint16_t dataLength, uint8_t* pData, N_Address_Extended_t* pDestinationAddress, uint8_t* pSequenceNumber)
+/** Notifies the transmit subscribers. Shall only be called when the queue is consistent, as a subscriber
+    may send another frame from the callback.
+*/
+static void TxDone(uint8_t commandId, N_InterPan_TxStatus_t status)
+{
+  N_UTIL_CALLBACK(N_InterPan_TxCallback_t, s_txSubscribers, TxDone, (commandId, status));
+}
+
+/** Hands a frame to the stack.
+    \returns FALSE if no InterPan buffer is free, otherwise TRUE
+*/
+static bool SendFrame(uint16_t dataLength, const uint8_t* pData, const N_Address_Extended_t* pDestinationAddress)
 {
   INTRP_DataReq_t *req = getFreeInterPanBuffer();
   uint8_t *asdu;
 
   if (!req)
-    N_ERRH_FATAL();
+    return FALSE;
 
   asdu = getDataBuffer(req);
 
@@ -167,7 +315,145 @@ static void DataRequest(uint16_t dataLength, uint8_t* pData, N_Address_Extended_
   req->INTRP_DataConf = INTRP_DataConf;
 
   INTRP_DataReq(req);
-  (void)pSequenceNumber;
+  return TRUE;
+}
+
+/** Returns the channel the radio is on. */
+static uint8_t GetCurrentChannel(void)
+{
+  uint8_t channel;
+
+  CS_ReadParameter(CS_RF_CURRENT_CHANNEL_ID, &channel);
+  return channel;
+}
+
+/** Sends queued frames while InterPan buffers are free. Frames requested on another channel than the
+    current one are dropped, as the InterPan mode or channel has changed since.
+*/
+static void SendQueuedFrames(void)
+{
+  uint8_t channel = GetCurrentChannel();
+
+  while (s_txQueueCount > 0u)
+  {
+    TxQueueEntry_t* pEntry = &s_txQueue[0];
+    uint8_t commandId = pEntry->commandId;
+    bool stale = (pEntry->channel != channel);
+
+    if (!stale && !SendFrame(pEntry->dataLength, pEntry->data, pEntry->broadcast ? NULL : &pEntry->destinationAddress))
+      return;
+
+    s_txQueueCount--;
+    memmove(&s_txQueue[0], &s_txQueue[1], s_txQueueCount * sizeof(TxQueueEntry_t));
+
+    if (stale)
+      TxDone(commandId, N_InterPan_TxStatus_Dropped);
+  }
+}
+
+/** Finds the queue entry to store a frame in. A queued scan request is replaced by a newer one, and a
+    queued scan response by a newer one to the same destination. When the queue is full, the oldest
+    frame with the lowest priority is dropped to make room, unless the new frame has an even lower
+    priority. The subscribers are not notified of a dropped frame here, as the queue is not consistent
+    until the new frame is stored.
+    \param pDropped Set to TRUE if a queued frame has been dropped, otherwise FALSE
+    \param pDroppedCommandId The command id of the dropped frame
+    \returns The index of the entry, or N_INTERPAN_TX_QUEUE_SIZE if the new frame is to be dropped
+*/
+static uint8_t GetTxQueueEntry(uint8_t commandId, const N_Address_Extended_t* pDestinationAddress,
+                               bool* pDropped, uint8_t* pDroppedCommandId)
+{
+  uint8_t priority = GetTxPriority(commandId);
+  uint8_t victim = N_INTERPAN_TX_QUEUE_SIZE;
+
+  *pDropped = FALSE;
+
+  for (uint8_t i = 0u; i < s_txQueueCount; i++)
+  {
+    TxQueueEntry_t* pEntry = &s_txQueue[i];
+
+    if ((commandId == pEntry->commandId) &&
+        ((SCAN_REQUEST_COMMAND_ID == commandId) ||
+         ((SCAN_RESPONSE_COMMAND_ID == commandId) && (pDestinationAddress != NULL) && !pEntry->broadcast &&
+          (memcmp(pEntry->destinationAddress, pDestinationAddress, sizeof(N_Address_Extended_t)) == 0))))
+    {
+      *pDropped = TRUE;
+      *pDroppedCommandId = pEntry->commandId;
+      return i;
+    }
+  }
+
+  if (s_txQueueCount < N_INTERPAN_TX_QUEUE_SIZE)
+    return s_txQueueCount++;
+
+  for (uint8_t i = 0u; i < s_txQueueCount; i++)
+  {
+    if ((s_txQueue[i].priority <= priority) &&
+        ((N_INTERPAN_TX_QUEUE_SIZE == victim) || (s_txQueue[i].priority < s_txQueue[victim].priority)))
+      victim = i;
+  }
+
+  if (N_INTERPAN_TX_QUEUE_SIZE != victim)
+  {
+    // drop the victim and append the new frame, to keep the queue in order
+    *pDropped = TRUE;
+    *pDroppedCommandId = s_txQueue[victim].commandId;
+    memmove(&s_txQueue[victim], &s_txQueue[victim + 1u], (s_txQueueCount - victim - 1u) * sizeof(TxQueueEntry_t));
+    victim = s_txQueueCount - 1u;
+  }
+  return victim;
+}
+
+/**************************************************************************//**
+\brief Confirmation of interPan data sending
+
+\param[in] conf - pointer to confirmation structure
+******************************************************************************/
+static void INTRP_DataConf(INTRP_DataConf_t *conf)
+{
+  INTRP_DataReq_t *req = GET_PARENT_BY_FIELD(INTRP_DataReq_t, confirm, conf);
+  uint8_t commandId = GetCommandId(req->asdu);
+  N_InterPan_TxStatus_t status = (MAC_SUCCESS_STATUS == conf->status) ? N_InterPan_TxStatus_Ok : N_InterPan_TxStatus_Failed;
+
+  freeInterPanBuffer(req);
+  // queued frames are sent at the rate the stack confirms the previous ones
+  SendQueuedFrames();
+  TxDone(commandId, status);
+}
+
+/** Sends a frame, or queues it when no InterPan buffer is free. Frames are sent in order, so a frame
+    is queued as well when other frames are still waiting.
+*/
+static void DataRequest(uint16_t dataLength, uint8_t* pData, N_Address_Extended_t* pDestinationAddress)
+{
+  uint8_t commandId = GetCommandId(pData);
+  uint8_t index;
+  bool dropped;
+  uint8_t droppedCommandId;
+
+  N_ERRH_ASSERT_FATAL(dataLength <= APS_MAX_INTERPAN_ASDU_SIZE);
+
+  if ((0u == s_txQueueCount) && SendFrame(dataLength, pData, pDestinationAddress))
+    return;
+
+  index = GetTxQueueEntry(commandId, pDestinationAddress, &dropped, &droppedCommandId);
+  if (N_INTERPAN_TX_QUEUE_SIZE == index)
+  {
+    TxDone(commandId, N_InterPan_TxStatus_Dropped);
+    return;
+  }
+
+  s_txQueue[index].commandId = commandId;
+  s_txQueue[index].priority = GetTxPriority(commandId);
+  s_txQueue[index].broadcast = (pDestinationAddress == NULL);
+  s_txQueue[index].channel = GetCurrentChannel();
+  s_txQueue[index].dataLength = (uint8_t)dataLength;
+  if (pDestinationAddress)
+    memcpy(s_txQueue[index].destinationAddress, pDestinationAddress, sizeof(N_Address_Extended_t));
+  memcpy(s_txQueue[index].data, pData, dataLength);
+
+  if (dropped)
+    TxDone(droppedCommandId, N_InterPan_TxStatus_Dropped);
 }
 
 static void Send(uint8_t commandId, bool isResponse, uint16_t dataLength, uint8_t* data, N_Address_Extended_t* pDestinationAddress)
@@ -182,7 +468,7 @@ static void Send(uint8_t commandId, bool isResponse, uint16_t dataLength, uint8_
     header->transactionSequenceNumber = isResponse ? header->transactionSequenceNumber : s_sequenceNumber;
     header->commandId = commandId;
 
-    DataRequest(dataLength, data, pDestinationAddress, isResponse ? &header->transactionSequenceNumber : &s_sequenceNumber);
+    DataRequest(dataLength, data, pDestinationAddress);
 }
 
 static void ProcessReceivedScanRequest(INTRP_DataInd_t *ind)
@@ -432,6 +718,78 @@ static void ProcessReceivedNetworkUpdateRequest(INTRP_DataInd_t *ind)
         (pPayload, &(ind->srcAddress.raw)));
 }
 
+/** Finds the descriptor of a command with a binary search on the command id.
+    \returns The descriptor, or NULL if the command is unknown
+*/
+static const CommandDescriptor_t* FindCommandDescriptor(uint8_t commandId)
+{
+    uint8_t low = 0u;
+    uint8_t high = (uint8_t)N_UTIL_ARRAY_SIZE(s_commandDescriptors);
+
+    while ( low < high )
+    {
+        uint8_t middle = (uint8_t)((low + high) / 2u);
+
+        if ( s_commandDescriptors[middle].commandId == commandId )
+        {
+            return &s_commandDescriptors[middle];
+        }
+        if ( s_commandDescriptors[middle].commandId < commandId )
+        {
+            low = middle + 1u;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return NULL;
+}
+
+static void RejectCommand(N_InterPan_RxReject_t reason)
+{
+    if ( s_rxRejectCount[reason] < 0xFFFFu )
+    {
+        s_rxRejectCount[reason]++;
+    }
+}
+
+/** Validates a received non-manufacturer specific command against its descriptor, and calls its
+    handler. Invalid or unexpected commands are dropped here, before any handler is called.
+*/
+static void DispatchCommand(INTRP_DataInd_t *ind)
+{
+    N_InterPan_FrameHeader_t* pHeader = (N_InterPan_FrameHeader_t*)(ind->asdu);
+    const CommandDescriptor_t* pDescriptor = FindCommandDescriptor(pHeader->commandId);
+    CommandHandler_t handler;
+
+    if ( pDescriptor == NULL )
+    {
+        RejectCommand(N_InterPan_RxReject_UnknownCommand);
+        return;
+    }
+    if ( (ind->asduLength < pDescriptor->minLength) || (ind->asduLength > pDescriptor->maxLength) )
+    {
+        RejectCommand(N_InterPan_RxReject_Length);
+        return;
+    }
+    if ( pHeader->frameControl.direction != pDescriptor->direction )
+    {
+        RejectCommand(N_InterPan_RxReject_Direction);
+        return;
+    }
+
+    handler = (pDescriptor->responseSlot == NO_RESPONSE_SLOT) ?
+        pDescriptor->handler : s_responseHandlers[pDescriptor->responseSlot];
+    if ( handler == NULL )
+    {
+        RejectCommand(N_InterPan_RxReject_Unexpected);
+        return;
+    }
+
+    handler(ind);
+}
+
 /**************************************************************************//**
 \brief INTRP-DATA indication primitive's prototype
 
@@ -455,99 +813,7 @@ void INTRP_DataInd(INTRP_DataInd_t *ind)
         // Only handle non-manufacturer specific commands (skip otherwise)
         if (!pHeader->frameControl.manufacturerSpecific)
         {
-            switch (pHeader->commandId)
-            {
-            case SCAN_REQUEST_COMMAND_ID:
-                if (ind->asduLength == sizeof(N_InterPan_ScanRequest_t))
-                {
-                    ProcessReceivedScanRequest(ind);
-                }
-                break;
-
-            case SCAN_RESPONSE_COMMAND_ID:
-                // size is checked in ProcessReceivedScanResponse
-                s_ProcessReceivedScanResponse(ind);
-                break;
-
-            case DEVICE_INFO_REQUEST_COMMAND_ID:
-                if (ind->asduLength == sizeof(N_InterPan_DeviceInfoRequest_t))
-                {
-                    ProcessReceivedDeviceInfoRequest(ind);
-                }
-                break;
-
-            case DEVICE_INFO_RESPONSE_COMMAND_ID:
-                // size is checked in ProcessReceivedDeviceInfoResponse
-                s_ProcessReceivedDeviceInfoResponse(ind);
-                break;
-
-            case IDENTIFY_REQUEST_COMMAND_ID:
-                if (ind->asduLength == sizeof(N_InterPan_IdentifyRequest_t))
-                {
-                    ProcessReceivedIdentifyRequest(ind);
-                }
-                break;
-
-            case RESET_TO_FACTORY_NEW_REQUEST_COMMAND_ID:
-                if (ind->asduLength == sizeof(N_InterPan_ResetToFactoryNewRequest_t))
-                {
-                    ProcessReceivedResetToFactoryNewRequest(ind);
-                }
-                break;
-
-            case NETWORK_START_REQUEST_COMMAND_ID:
-                if (ind->asduLength == sizeof(N_InterPan_NetworkStartRequest_t))
-                {
-                    ProcessReceivedNetworkStartRequest(ind);
-                }
-                break;
-
-            case NETWORK_START_RESPONSE_COMMAND_ID:
-                if (ind->asduLength == sizeof(N_InterPan_NetworkStartResponse_t))
-                {
-                    s_ProcessReceivedNetworkStartResponse(ind);
-                }
-                break;
-
-            case NETWORK_JOIN_ROUTER_REQUEST_COMMAND_ID:
-                if (ind->asduLength == sizeof(N_InterPan_NetworkJoinRequest_t))
-                {
-                    ProcessReceivedNetworkJoinRouterRequest(ind);
-                }
-                break;
-
-            case NETWORK_JOIN_ROUTER_RESPONSE_COMMAND_ID:
-                if (ind->asduLength == sizeof(N_InterPan_NetworkJoinResponse_t))
-                {
-                    s_ProcessReceivedNetworkJoinRouterResponse(ind);
-                }
-                break;
-
-            case NETWORK_JOIN_END_DEVICE_REQUEST_COMMAND_ID:
-                if (ind->asduLength == sizeof(N_InterPan_NetworkJoinRequest_t))
-                {
-                    ProcessReceivedNetworkJoinEndDeviceRequest(ind);
-                }
-                break;
-
-            case NETWORK_JOIN_END_DEVICE_RESPONSE_COMMAND_ID:
-                if (ind->asduLength == sizeof(N_InterPan_NetworkJoinResponse_t))
-                {
-                    s_ProcessReceivedNetworkJoinEndDeviceResponse(ind);
-                }
-                break;
-
-            case NETWORK_UPDATE_REQUEST_COMMAND_ID:
-                if (ind->asduLength == sizeof(N_InterPan_NetworkUpdateRequest_t))
-                {
-                    ProcessReceivedNetworkUpdateRequest(ind);
-                }
-                break;
-
-            default:
-                // unknown Inter-PAN message. ignore
-                break;
-            }
+            DispatchCommand(ind);
         }
     }
 
@@ -577,14 +843,14 @@ void N_InterPan_Subscribe(const N_InterPan_Callback_t* pCallback)
 /** Interface function, see \ref N_InterPan_BroadcastScanRequest. */
 void N_InterPan_BroadcastScanRequest(N_InterPan_ScanRequest_t* pPayload)
 {
-    s_ProcessReceivedScanResponse = ProcessReceivedScanResponse;
+    s_responseHandlers[ResponseSlot_ScanResponse] = ProcessReceivedScanResponse;
     Send(SCAN_REQUEST_COMMAND_ID, FALSE, sizeof(N_InterPan_ScanRequest_t), (uint8_t*) pPayload, NULL);
 }
 
 /** Interface function, see \ref N_InterPan_UnicastScanRequest. */
 void N_InterPan_UnicastScanRequest(N_InterPan_ScanRequest_t* pPayload, N_Address_Extended_t* pDestinationAddress)
 {
-    s_ProcessReceivedScanResponse = ProcessReceivedScanResponse;
+    s_responseHandlers[ResponseSlot_ScanResponse] = ProcessReceivedScanResponse;
     Send(SCAN_REQUEST_COMMAND_ID, FALSE, sizeof(N_InterPan_ScanRequest_t), (uint8_t*) pPayload, pDestinationAddress);
 }
 
@@ -602,7 +868,7 @@ void N_InterPan_SendScanResponse(N_InterPan_ScanResponse_t* pPayload, N_Address_
 /** Interface function, see \ref N_InterPan_SendDeviceInfoRequest. */
 void N_InterPan_SendDeviceInfoRequest(N_InterPan_DeviceInfoRequest_t* pPayload, N_Address_Extended_t* pDestinationAddress)
 {
-    s_ProcessReceivedDeviceInfoResponse = ProcessReceivedDeviceInfoResponse;
+    s_responseHandlers[ResponseSlot_DeviceInfoResponse] = ProcessReceivedDeviceInfoResponse;
     Send(DEVICE_INFO_REQUEST_COMMAND_ID, FALSE, sizeof(N_InterPan_DeviceInfoRequest_t), (uint8_t*) pPayload, pDestinationAddress);
 }
 
@@ -632,7 +898,7 @@ void N_InterPan_SendResetToFactoryNewRequest(N_InterPan_ResetToFactoryNewRequest
 /** Interface function, see \ref N_InterPan_SendNetworkStartRequest. */
 void N_InterPan_SendNetworkStartRequest(N_InterPan_NetworkStartRequest_t* pPayload, N_Address_Extended_t* pDestinationAddress)
 {
-    s_ProcessReceivedNetworkStartResponse = ProcessReceivedNetworkStartResponse;
+    s_responseHandlers[ResponseSlot_NetworkStartResponse] = ProcessReceivedNetworkStartResponse;
     Send(NETWORK_START_REQUEST_COMMAND_ID, FALSE, sizeof(N_InterPan_NetworkStartRequest_t), (uint8_t*) pPayload, pDestinationAddress);
 }
 
@@ -645,7 +911,7 @@ void N_InterPan_SendNetworkStartResponse(N_InterPan_NetworkStartResponse_t* pPay
 /** Interface function, see \ref N_InterPan_SendNetworkJoinRouterRequest. */
 void N_InterPan_SendNetworkJoinRouterRequest(N_InterPan_NetworkJoinRequest_t* pPayload, N_Address_Extended_t* pDestinationAddress)
 {
-    s_ProcessReceivedNetworkJoinRouterResponse = ProcessReceivedNetworkJoinRouterResponse;
+    s_responseHandlers[ResponseSlot_NetworkJoinRouterResponse] = ProcessReceivedNetworkJoinRouterResponse;
     Send(NETWORK_JOIN_ROUTER_REQUEST_COMMAND_ID, FALSE, sizeof(N_InterPan_NetworkJoinRequest_t), (uint8_t*) pPayload, pDestinationAddress);
 }
 
@@ -658,7 +924,7 @@ void N_InterPan_SendNetworkJoinRouterResponse(N_InterPan_NetworkJoinResponse_t*
 /** Interface function, see \ref N_InterPan_SendNetworkJoinEndDeviceRequest. */
 void N_InterPan_SendNetworkJoinEndDeviceRequest(N_InterPan_NetworkJoinRequest_t* pPayload, N_Address_Extended_t* pDestinationAddress)
 {
-    s_ProcessReceivedNetworkJoinEndDeviceResponse = ProcessReceivedNetworkJoinEndDeviceResponse;
+    s_responseHandlers[ResponseSlot_NetworkJoinEndDeviceResponse] = ProcessReceivedNetworkJoinEndDeviceResponse;
     Send(NETWORK_JOIN_END_DEVICE_REQUEST_COMMAND_ID, FALSE, sizeof(N_InterPan_NetworkJoinRequest_t), (uint8_t*) pPayload, pDestinationAddress);
 }
 
@@ -677,5 +943,18 @@ void N_InterPan_SendNetworkUpdateRequest(N_InterPan_NetworkUpdateRequest_t* pPay
 /** Interface function, see \ref N_InterPan_SendInterPanCommand. */
 void N_InterPan_SendInterPanCommand(uint8_t payloadLength, uint8_t* pPayload, N_Address_Extended_t* pDestinationAddress)
 {
-    DataRequest((uint16_t)payloadLength, pPayload, pDestinationAddress, &s_sequenceNumber);
+    DataRequest((uint16_t)payloadLength, pPayload, pDestinationAddress);
+}
+
+/** Interface function, see \ref N_InterPan_GetRxRejectCount. */
+uint16_t N_InterPan_GetRxRejectCount(N_InterPan_RxReject_t reason)
+{
+    N_ERRH_ASSERT_FATAL(reason < N_InterPan_RxReject_Count);
+    return s_rxRejectCount[reason];
+}
+
+/** Interface function, see \ref N_InterPan_SubscribeTx. */
+void N_InterPan_SubscribeTx(const N_InterPan_TxCallback_t* pCallback)
+{
+    N_UTIL_CALLBACK_SUBSCRIBE(N_InterPan_TxCallback_t, s_txSubscribers, pCallback);
 }
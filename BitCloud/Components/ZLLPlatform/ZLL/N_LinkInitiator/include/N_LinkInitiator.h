@@ -165,6 +165,7 @@ typedef void (*N_LinkInitiator_ResetDeviceToFactoryNewDone_t)(N_LinkInitiator_St
 #define N_LinkInitiator_ScanType_Touchlink                  0x02u
 #define N_LinkInitiator_ScanType_OwnPanOnly                 0x04u
 #define N_LinkInitiator_ScanType_IncludeSecondaryChannels   0x08u
+#define N_LinkInitiator_ScanType_Adaptive                   0x10u
 typedef uint8_t N_LinkInitiator_ScanType_t;
 
 typedef struct N_LinkInitiator_EndpointInfo_t
@@ -224,6 +225,13 @@ void N_LinkInitiator_Subscribe(const N_LinkInitiator_Callback_t* pCb);
     by one InterPan ScanRequest command on each of the channels of the secondary channel mask. All of
     these ScanRequest commands are separated by 250 milliseconds.
 
+    The \ref N_LinkInitiator_ScanType_Adaptive option shortens the scan sequence. The channel on which
+    the best device was found during the previous adaptive scan takes the place of the first channel.
+    The wait after each ScanRequest is adapted to the observed response times, and ends as soon as
+    the devices found on that channel during the previous scan have answered. If
+    N_LINK_INITIATOR_ADAPTIVE_SCAN_STOP_COUNT is set to a non-zero value, the scan ends when that number
+    of devices has been found. By default it is 0, and all channels are scanned.
+
     Any type of scan sequence can be stopped by calling \ref N_LinkInitiator_StopScan.
 */
 void N_LinkInitiator_Scan(N_LinkInitiator_ScanType_t scanType, N_LinkInitiator_Device_t dev[], uint8_t devArraySize, N_LinkInitiator_ScanDone_t pfDoneCallback);
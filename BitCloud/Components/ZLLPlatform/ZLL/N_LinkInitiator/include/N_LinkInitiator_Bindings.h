@@ -74,6 +74,8 @@
 # define N_Security_FindSharedKeyIndex N_Security_FindSharedKeyIndex_Impl
 
 # define N_Timer_Start16 N_Timer_Start16_Impl
+# define N_Timer_IsRunning N_Timer_IsRunning_Impl
+# define N_Timer_GetSystemTime N_Timer_GetSystemTime_Impl
 
 # define N_Zdp_ClientSubscribe N_Zdp_Stub_ClientSubscribe
 # define N_Zdp_SendNwkAddrReq N_Zdp_Stub_SendNwkAddrReq
@@ -174,6 +176,8 @@
 # define N_Util_Random N_Util_Random_Impl
 
 # define N_Timer_Stop N_Timer_Stop_Impl
+# define N_Timer_IsRunning N_Timer_IsRunning_Impl
+# define N_Timer_GetSystemTime N_Timer_GetSystemTime_Impl
 
 #endif
 
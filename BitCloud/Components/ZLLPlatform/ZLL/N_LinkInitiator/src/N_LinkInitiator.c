@@ -77,6 +77,16 @@ $Id: N_LinkInitiator.c 24615 2013-02-27 05:14:24Z arazinkov $
 /** Time to wait after sending a scan request (in milliseconds). */
 #define SCAN_REQUEST_WAIT_TIME_MS       250u
 
+/** Shortest time to wait after sending a scan request during an adaptive scan (in milliseconds). */
+#if (!defined(N_LINK_INITIATOR_ADAPTIVE_SCAN_MIN_WAIT_TIME_MS))
+#   define N_LINK_INITIATOR_ADAPTIVE_SCAN_MIN_WAIT_TIME_MS   60u
+#endif
+
+/** Number of valid scan responses after which an adaptive scan is ended, or 0 to always scan all channels. */
+#if (!defined(N_LINK_INITIATOR_ADAPTIVE_SCAN_STOP_COUNT))
+#   define N_LINK_INITIATOR_ADAPTIVE_SCAN_STOP_COUNT        0u
+#endif
+
 /** Time to wait between sending a ZigBee message and changing channels/network. */
 #define CHANGE_TIMEOUT_MS               100u
 
@@ -192,6 +202,24 @@ static uint8_t s_scanRequestCount = 0u;
 /** The type of scan. */
 static N_LinkInitiator_ScanType_t s_scanType;
 
+/** The channel the current scan request is sent on. */
+static uint8_t s_scanChannel = 0u;
+
+/** The number of scan responses stored in the device array for the current scan request. */
+static uint8_t s_scanRequestResponseCount = 0u;
+
+/** The system time at which the current scan request was sent. */
+static uint32_t s_scanRequestSentTime = 0uL;
+
+/** The channel of the best device found during the last adaptive scan, or 0 if none was found. */
+static uint8_t s_preferredScanChannel = 0u;
+
+/** The number of devices found on \ref s_preferredScanChannel during the last adaptive scan. */
+static uint8_t s_expectedScanResponders = 0u;
+
+/** Estimate of the time between sending a scan request and receiving a response (in milliseconds). */
+static uint16_t s_scanResponseTimeMs = SCAN_REQUEST_WAIT_TIME_MS / 2u;
+
 /** The identifyTime to send in the identify request. */
 static uint16_t s_identifyTimeoutInSec = 0u;
 
@@ -286,6 +314,7 @@ enum N_LinkInitiator_states // states
     sResetToFactoryNewWaitForInterPanModeOnTargetChannel,
     sResetToFactoryNewRequestSending,
     sResetToFactoryNewWaitForInterPanModeOff,
+    sNumberOfStates // not a state; used to size the indexed transition table
 };
 
 enum N_LinkInitiator_events // events
@@ -513,13 +542,14 @@ N_FSM( eSetInterPanModeDone,                N_FSM_NONE,
 
 };
 
-N_FSM_DECLARE(s_fsm,
-              s_transitionTable,
-              N_FSM_TABLE_SIZE(s_transitionTable),
-              NULL,
-              0u,
-              PerformAction,
-              CheckCondition);
+N_FSM_DECLARE_INDEXED(s_fsm,
+                      s_transitionTable,
+                      N_FSM_TABLE_SIZE(s_transitionTable),
+                      NULL,
+                      0u,
+                      PerformAction,
+                      CheckCondition,
+                      sNumberOfStates);
 
 /* @Fsm2PlantUml:end  */
 
@@ -567,47 +597,161 @@ static inline uint8_t* extractKeyFromBuffer(void)
 * STATE MACHINE ACTION FUNCTIONS
 ***************************************************************************************************/
 
-static inline void SetInterPanModeOnFirstChannel(void)
+static inline bool IsAdaptiveScan(void)
 {
-    s_scanRequestCount = 0u;
-    N_Connection_SetInitiatorInterPanModeOn(N_DeviceInfo_GetChannelForIndex(0u, N_DeviceInfo_GetPrimaryChannelMask()), SetInterPanModeDone);
+    return N_UTIL_BOOL((s_scanType & N_LinkInitiator_ScanType_Adaptive) != 0u);
 }
 
-static inline void SetInterPanModeOnTargetChannel(void)
+static uint8_t GetNrChannelsInChannelMask(uint32_t channelMask)
 {
-    N_Connection_SetInitiatorInterPanModeOn(s_deviceArray->scanResponse.channel, SetInterPanModeDone);
+    return (channelMask == 0uL) ? 0u : N_DeviceInfo_GetNrChannelsInChannelMask(channelMask);
 }
 
-static inline void SetInterPanModeOnNextChannel(void)
+/** Get the channel to send a scan request on. The first NUMBER_OF_SCAN_REQUESTS_ON_FIRST_CHANNEL requests
+    are sent on the first primary channel, or during an adaptive scan on the channel where a device was
+    found during the last scan. The other channels follow in order, primary channels first.
+    \param requestIndex The number of scan requests sent so far
+*/
+static uint8_t GetScanChannel(uint8_t requestIndex)
 {
-    uint8_t channelIndex;
-    uint8_t channel;
+    uint32_t primaryMask = N_DeviceInfo_GetPrimaryChannelMask();
+    uint32_t secondaryMask = N_DeviceInfo_GetSecondaryChannelMask();
+    uint8_t firstChannel = N_DeviceInfo_GetChannelForIndex(0u, primaryMask);
+    uint8_t index;
+
+    if ( (s_scanType & N_LinkInitiator_ScanType_IncludeSecondaryChannels) == 0u )
+    {
+        secondaryMask = 0uL;
+    }
+    if ( IsAdaptiveScan() && (s_preferredScanChannel != 0u) &&
+         (((primaryMask | secondaryMask) & (1uL << s_preferredScanChannel)) != 0uL) )
+    {
+        firstChannel = s_preferredScanChannel;
+    }
+
+    if ( requestIndex < NUMBER_OF_SCAN_REQUESTS_ON_FIRST_CHANNEL )
+    {
+        return firstChannel;
+    }
 
-    uint8_t primaryChannelCount = N_DeviceInfo_GetNrChannelsInChannelMask(N_DeviceInfo_GetPrimaryChannelMask());
-    if ( s_scanRequestCount < (primaryChannelCount + (NUMBER_OF_SCAN_REQUESTS_ON_FIRST_CHANNEL - 1u)) )
+    primaryMask &= ~(1uL << firstChannel);
+    secondaryMask &= ~(1uL << firstChannel);
+    index = requestIndex - NUMBER_OF_SCAN_REQUESTS_ON_FIRST_CHANNEL;
+    if ( index < GetNrChannelsInChannelMask(primaryMask) )
     {
-        // get the next primary channel...
+        return N_DeviceInfo_GetChannelForIndex(index, primaryMask);
+    }
+    return N_DeviceInfo_GetChannelForIndex(index - GetNrChannelsInChannelMask(primaryMask), secondaryMask);
+}
+
+/** Get the time to wait for scan responses after sending a scan request. During an adaptive scan this is
+    twice the estimated response time, instead of the fixed SCAN_REQUEST_WAIT_TIME_MS.
+*/
+static uint16_t GetScanRequestWaitTime(void)
+{
+    uint16_t waitTime = SCAN_REQUEST_WAIT_TIME_MS;
 
-        if ( s_scanRequestCount < NUMBER_OF_SCAN_REQUESTS_ON_FIRST_CHANNEL )
+    if ( IsAdaptiveScan() )
+    {
+        waitTime = 2u * s_scanResponseTimeMs;
+        if ( waitTime < N_LINK_INITIATOR_ADAPTIVE_SCAN_MIN_WAIT_TIME_MS )
         {
-            // use the first primary channel
-            channelIndex = 0u;
+            waitTime = N_LINK_INITIATOR_ADAPTIVE_SCAN_MIN_WAIT_TIME_MS;
         }
-        else
+        if ( waitTime > SCAN_REQUEST_WAIT_TIME_MS )
         {
-            // use one of the other primary channels
-            channelIndex = s_scanRequestCount - (NUMBER_OF_SCAN_REQUESTS_ON_FIRST_CHANNEL - 1u);
+            waitTime = SCAN_REQUEST_WAIT_TIME_MS;
         }
-        channel = N_DeviceInfo_GetChannelForIndex(channelIndex, N_DeviceInfo_GetPrimaryChannelMask());
+    }
+    return waitTime;
+}
+
+/** Update the response time estimate with the response time of a scan response. The estimate follows
+    slower responses immediately and faster responses gradually.
+*/
+static void UpdateScanResponseTime(void)
+{
+    uint32_t responseTime = N_Timer_GetSystemTime() - s_scanRequestSentTime;
+
+    if ( responseTime > SCAN_REQUEST_WAIT_TIME_MS )
+    {
+        responseTime = SCAN_REQUEST_WAIT_TIME_MS;
+    }
+    if ( responseTime >= s_scanResponseTimeMs )
+    {
+        s_scanResponseTimeMs = (uint16_t)responseTime;
     }
     else
     {
-        // use one of the secondary channels
-        channelIndex = (s_scanRequestCount - (NUMBER_OF_SCAN_REQUESTS_ON_FIRST_CHANNEL - 1u)) - primaryChannelCount;
-        channel = N_DeviceInfo_GetChannelForIndex(channelIndex, N_DeviceInfo_GetSecondaryChannelMask());
+        s_scanResponseTimeMs -= (uint16_t)((s_scanResponseTimeMs - responseTime) / 8u);
     }
+}
 
-    N_Connection_SetInitiatorInterPanModeOn(channel, SetInterPanModeDone);
+/** Remember the channel of the best device found, to scan it first during the next adaptive scan. */
+static void UpdatePreferredScanChannel(void)
+{
+    s_preferredScanChannel = 0u;
+    s_expectedScanResponders = 0u;
+    if ( s_scanResponseCount > 0u )
+    {
+        s_preferredScanChannel = s_deviceArray[0].scanResponse.channel;
+        for ( uint8_t i = 0u; i < s_scanResponseCount; i++ )
+        {
+            if ( s_deviceArray[i].scanResponse.channel == s_preferredScanChannel )
+            {
+                s_expectedScanResponders++;
+            }
+        }
+    }
+}
+
+/** End the wait for scan responses when all devices that are expected on this channel have answered, or
+    when enough devices have been found. Does nothing when no wait is running, e.g. when a late response
+    arrives while the next channel is being set.
+*/
+static void CheckScanRequestWaitDone(void)
+{
+    bool done = FALSE;
+
+    if ( !N_Timer_IsRunning(&s_timer) )
+    {
+        return;
+    }
+
+    if ( (s_scanChannel == s_preferredScanChannel) && (s_expectedScanResponders != 0u) &&
+         (s_scanRequestResponseCount >= s_expectedScanResponders) )
+    {
+        done = TRUE;
+    }
+    if ( (N_LINK_INITIATOR_ADAPTIVE_SCAN_STOP_COUNT != 0u) &&
+         (s_scanResponseCount >= N_LINK_INITIATOR_ADAPTIVE_SCAN_STOP_COUNT) )
+    {
+        done = TRUE;
+    }
+
+    if ( done )
+    {
+        N_Timer_Stop(&s_timer);
+        N_Task_SetEvent(s_taskId, EVENT_TIMER);
+    }
+}
+
+static inline void SetInterPanModeOnFirstChannel(void)
+{
+    s_scanRequestCount = 0u;
+    s_scanChannel = GetScanChannel(0u);
+    N_Connection_SetInitiatorInterPanModeOn(s_scanChannel, SetInterPanModeDone);
+}
+
+static inline void SetInterPanModeOnTargetChannel(void)
+{
+    N_Connection_SetInitiatorInterPanModeOn(s_deviceArray->scanResponse.channel, SetInterPanModeDone);
+}
+
+static inline void SetInterPanModeOnNextChannel(void)
+{
+    s_scanChannel = GetScanChannel(s_scanRequestCount);
+    N_Connection_SetInitiatorInterPanModeOn(s_scanChannel, SetInterPanModeDone);
 }
 
 static inline void SetInterPanModeOff(void)
@@ -618,6 +762,10 @@ static inline void SetInterPanModeOff(void)
 static inline void ScanFinishedSuccess(void)
 {
     N_ERRH_ASSERT_FATAL(s_scanDoneCallback != NULL);
+    if ( IsAdaptiveScan() )
+    {
+        UpdatePreferredScanChannel();
+    }
     s_scanDoneCallback(N_LinkInitiator_Status_Ok, s_scanResponseCount);
     s_scanDoneCallback = NULL;
 }
@@ -670,7 +818,9 @@ static void continueBroadcastScanRequest(void)
 
   N_InterPan_BroadcastScanRequest(&scanRequest);
 
-  N_Timer_Start16(SCAN_REQUEST_WAIT_TIME_MS, &s_timer);
+  s_scanRequestSentTime = N_Timer_GetSystemTime();
+  s_scanRequestResponseCount = 0u;
+  N_Timer_Start16(GetScanRequestWaitTime(), &s_timer);
 
   s_scanRequestCount++;
 }
@@ -678,6 +828,7 @@ static void continueBroadcastScanRequest(void)
 static inline void StoreScanResponse(void)
 {
     uint8_t target = 0u;
+    bool stored = FALSE;
 
     N_ERRH_ASSERT_FATAL(s_receivedMessageType == ReceivedMessageType_ScanResponse);
   
@@ -714,11 +865,22 @@ static inline void StoreScanResponse(void)
         {
             s_scanResponseCount++;
         }
+        stored = TRUE;
     }
     else
     {
         // ignore scan response
     }
+
+    if ( IsAdaptiveScan() )
+    {
+        UpdateScanResponseTime();
+        if ( stored )
+        {
+            s_scanRequestResponseCount++;
+            CheckScanRequestWaitDone();
+        }
+    }
 }
 
 static inline void SendIdentifyRequest(void)
@@ -1390,6 +1552,11 @@ static inline bool IsScanDone(int32_t arg1, int32_t arg2)
     {
         totalScanRequestCount += N_DeviceInfo_GetNrChannelsInChannelMask(mask);
     }
+    if ( IsAdaptiveScan() && (N_LINK_INITIATOR_ADAPTIVE_SCAN_STOP_COUNT != 0u) &&
+         (s_scanResponseCount >= N_LINK_INITIATOR_ADAPTIVE_SCAN_STOP_COUNT) )
+    {
+        return TRUE;
+    }
     (void)arg1;
     (void)arg2;
     return N_UTIL_BOOL(s_scanRequestCount == totalScanRequestCount);
@@ -227,6 +227,7 @@ enum N_LinkTarget_states // states
     sJoiningWaitForInterPanModeOff,
     sFindingFreePan,
     sWaitForStartOrJoinResponseToBeSent,
+    sNumberOfStates // not a state; used to size the indexed transition table
 };
 
 enum N_LinkTarget_events // events
@@ -343,13 +344,14 @@ static const N_FSM_StateEntryExit_t s_entryExit[] =
     N_FSM_ENTRYEXIT( sEnabled, NULL, EnabledExit ),
 };
 
-N_FSM_DECLARE(s_fsm,
-              s_transitionTable,
-              N_FSM_TABLE_SIZE(s_transitionTable),
-              s_entryExit,
-              N_FSM_TABLE_SIZE(s_entryExit),
-              PerformAction,
-              CheckCondition);
+N_FSM_DECLARE_INDEXED(s_fsm,
+                      s_transitionTable,
+                      N_FSM_TABLE_SIZE(s_transitionTable),
+                      s_entryExit,
+                      N_FSM_TABLE_SIZE(s_entryExit),
+                      PerformAction,
+                      CheckCondition,
+                      sNumberOfStates);
 
 /* @Fsm2PlantUml:end  */
 
@@ -5,6 +5,10 @@
 #if defined(TESTHARNESS)
 // ...bind to stubs...
 
+// N_Cmi
+#define N_Cmi_GetBeaconCandidate N_Cmi_Stub_GetBeaconCandidate
+#define N_Cmi_ReportParentResult N_Cmi_Stub_ReportParentResult
+
 // N_Connection
 #define N_Connection_ReconnectHandler_Subscribe N_Connection_Stub_ReconnectHandler_Subscribe
 #define N_Connection_ReconnectHandler_NetworkDiscovery N_Connection_Stub_ReconnectHandler_NetworkDiscovery
@@ -23,6 +27,10 @@
 #else
 // ...bind to implementation...
 
+// N_Cmi
+#define N_Cmi_GetBeaconCandidate N_Cmi_GetBeaconCandidate_Impl
+#define N_Cmi_ReportParentResult N_Cmi_ReportParentResult_Impl
+
 // N_Connection
 #define N_Connection_ReconnectHandler_Subscribe N_Connection_ReconnectHandler_Subscribe_Impl
 #define N_Connection_ReconnectHandler_NetworkDiscovery N_Connection_ReconnectHandler_NetworkDiscovery_Impl
@@ -24,6 +24,9 @@ is done, of 240ms per channel.
 
 \par
 If one of the discoveries finds the network, a Rejoin is done of 440ms.
+Parents are tried in the order of the beacon scores given by N_Cmi; if rejoin
+to the best scored parent fails, the next scored parents with device capacity
+are tried before falling back to unsecure rejoin.
 
 \par
 With a channel mask of 4 channels, the longest possible time to find back a parent is:
@@ -44,6 +47,7 @@ N_EndDeviceRobustness stores messages.
 * EXTERNAL INCLUDE FILES
 ***************************************************************************************************/
 
+#include "N_Cmi.h"
 #include "N_Connection.h"
 #include "N_Connection_ReconnectHandler.h"
 #include "N_DeviceInfo.h"
@@ -80,6 +84,9 @@ static N_Task_Id_t s_taskId = N_TASK_ID_NONE;
 static uint8_t s_retryCounter;
 
 static N_Beacon_t s_selectedBeacon = { 0u };
+static uint8_t s_candidateIndex;
+/* Highest network update id seen during the last discovery, only parents with it are candidates */
+static uint8_t s_highestUpdateId;
 
 static bool isBusy;
 
@@ -90,6 +97,8 @@ static bool isBusy;
 static void ReconnectHandler_NetworkDiscoveryDone(void);
 static void ReconnectHandler_JoinDone(N_Connection_Result_t result);
 static void ReconnectHandler_BeaconReceivedCallback(N_Beacon_t* pBeacon);
+static bool SelectFirstCandidate(void);
+static bool IsCandidate(const N_Beacon_t* pBeacon);
 
 /***************************************************************************************************
 * STATE MACHINE
@@ -122,7 +131,8 @@ enum N_ReconnectHandler_actions // actions
     aSetRetryCounter_DiscoveryOnNetworkChannel,
     aDecrementRetryCounter_DiscoveryOnNetworkChannel,
     aRejoin,
-    aUnsecureRejoin,
+    aReportFailure_RejoinNextCandidate,
+    aReportFailure_UnsecureRejoin,
     aReconnectionSucceeded_SetNotBusy_ProcessPotponedInterPanMode,
     aReconnectionFailed_SetNotBusy_ProcessPotponedInterPanMode,
 };
@@ -130,6 +140,7 @@ enum N_ReconnectHandler_actions // actions
 enum N_ReconnectHandler_conditions // conditions
 {
     cAnotherTryOnNetworkChannel,
+    cAnotherCandidate,
     cHasTrustCenter,
 };
 
@@ -153,7 +164,8 @@ N_FSM( eNetworkNotFound,        N_FSM_NONE,                 aReconnectionFailed_
 
 N_FSM_STATE( sRejoining ),
 N_FSM( eRejoinSuccess,          N_FSM_NONE,                 aReconnectionSucceeded_SetNotBusy_ProcessPotponedInterPanMode, sIdle ),
-N_FSM( eRejoinFailure,          cHasTrustCenter,            aUnsecureRejoin,                                               sUnsecureRejoining ),
+N_FSM( eRejoinFailure,          cAnotherCandidate,          aReportFailure_RejoinNextCandidate,                            N_FSM_SAME_STATE ),
+N_FSM( eRejoinFailure,          cHasTrustCenter,            aReportFailure_UnsecureRejoin,                                 sUnsecureRejoining ),
 N_FSM( eRejoinFailure,          N_FSM_ELSE,                 aReconnectionFailed_SetNotBusy_ProcessPotponedInterPanMode,    sIdle ),
 
 N_FSM_STATE( sUnsecureRejoining ),
@@ -189,6 +201,20 @@ static inline bool AnotherTryOnNetworkChannel(void)
     return N_UTIL_BOOL(s_retryCounter > 0u);
 }
 
+static bool AnotherCandidate(void)
+{
+    N_Beacon_t beacon;
+
+    for (uint8_t i = s_candidateIndex + 1u; N_Cmi_GetBeaconCandidate(i, &beacon); i++)
+    {
+        if ( IsCandidate(&beacon) )
+        {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
 static inline bool HasTrustCenter(void)
 {
     return N_UTIL_BOOL(N_DeviceInfo_GetTrustCenterMode() == N_DeviceInfo_TrustCenterMode_Central);
@@ -202,6 +228,8 @@ static bool CheckCondition(N_FSM_Condition_t condition, int32_t arg1, int32_t ar
     {
     case cAnotherTryOnNetworkChannel:
         return AnotherTryOnNetworkChannel();
+    case cAnotherCandidate:
+        return AnotherCandidate();
     case cHasTrustCenter:
         return HasTrustCenter();
     default:
@@ -264,8 +292,26 @@ static inline void Rejoin(void)
     N_Connection_ReconnectHandler_Rejoin(&s_selectedBeacon, ReconnectHandler_JoinDone);
 }
 
+static inline void ReportFailure(void)
+{
+    N_Cmi_ReportParentResult(&s_selectedBeacon, FALSE);
+}
+
+static void RejoinNextCandidate(void)
+{
+    do
+    {
+        s_candidateIndex++;
+        (void)N_Cmi_GetBeaconCandidate(s_candidateIndex, &s_selectedBeacon);
+    } while ( !IsCandidate(&s_selectedBeacon) );
+
+    Rejoin();
+}
+
 static inline void UnsecureRejoin(void)
 {
+    // fall back to the best scored parent
+    (void)SelectFirstCandidate();
     N_Connection_ReconnectHandler_UnsecureRejoin(&s_selectedBeacon, ReconnectHandler_JoinDone);
 }
 
@@ -297,7 +343,12 @@ static void PerformAction(N_FSM_Action_t action, int32_t arg1, int32_t arg2)
     case aRejoin:
         Rejoin();
         break;
-    case aUnsecureRejoin:
+    case aReportFailure_RejoinNextCandidate:
+        ReportFailure();
+        RejoinNextCandidate();
+        break;
+    case aReportFailure_UnsecureRejoin:
+        ReportFailure();
         UnsecureRejoin();
         break;
     case aReconnectionSucceeded_SetNotBusy_ProcessPotponedInterPanMode:
@@ -341,8 +392,38 @@ static void ReconnectHandler_BeaconReceivedCallback(N_Beacon_t* pBeacon)
     }
 }
 
+/** A scored parent is only a candidate if it can accept a child and has the
+    network settings of the highest network update id. The score is not allowed
+    to prefer a parent with stale settings (channel, PAN id). */
+static bool IsCandidate(const N_Beacon_t* pBeacon)
+{
+    return N_UTIL_BOOL(pBeacon->hasDeviceCapacity && (pBeacon->updateId == s_highestUpdateId));
+}
+
+static bool SelectFirstCandidate(void)
+{
+    N_Beacon_t beacon;
+
+    for (s_candidateIndex = 0u; N_Cmi_GetBeaconCandidate(s_candidateIndex, &beacon); s_candidateIndex++)
+    {
+        if ( IsCandidate(&beacon) )
+        {
+            memcpy(&s_selectedBeacon, &beacon, sizeof(s_selectedBeacon));
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
 static void ReconnectHandler_NetworkDiscoveryDone(void)
 {
+    // prefer the best scored parent with the highest update id, otherwise keep the received beacon
+    s_highestUpdateId = s_selectedBeacon.updateId;
+    if ( !SelectFirstCandidate() )
+    {
+        s_candidateIndex = 0u;
+    }
+
     if ( s_selectedBeacon.logicalChannel != 0u )    // was at least one valid beacon received?
     {
         N_Task_SetEvent(s_taskId, EVENT_NETWORK_DISCOVERY_SUCCEEDED);
@@ -357,6 +438,7 @@ static void ReconnectHandler_JoinDone(N_Connection_Result_t result)
 {
     if ( result == N_Connection_Result_Success )
     {
+        N_Cmi_ReportParentResult(&s_selectedBeacon, TRUE);
         N_Task_SetEvent(s_taskId, EVENT_JOIN_SUCCEEDED);
     }
     else
@@ -69,6 +69,23 @@ typedef enum S_Nv_ReturnValue_t
 */
 typedef bool (*S_Nv_PowerSupplyCheckingFunction_t)(void);
 
+#if defined(S_NV_CACHE_STATISTICS)
+/** Statistics of the item cache lookups. */
+typedef struct S_Nv_CacheStatistics_t
+{
+    /** Number of lookups of an item. */
+    uint32_t lookups;
+    /** Number of lookups of an item that does not exist. */
+    uint32_t misses;
+    /** Total number of item ids compared during the lookups. */
+    uint32_t comparisons;
+    /** Largest number of item ids compared during a single lookup. */
+    uint8_t maxComparisons;
+    /** Number of cached items. */
+    uint8_t itemCount;
+} S_Nv_CacheStatistics_t;
+#endif
+
 /***************************************************************************************************
 * EXPORTED MACROS AND CONSTANTS
 ***************************************************************************************************/
@@ -186,6 +203,15 @@ bool S_Nv_IsItemAvailable(S_Nv_ItemId_t id);
 */
 void S_Nv_SetPowerSupplyCheckingFunction(S_Nv_PowerSupplyCheckingFunction_t pf);
 
+#if defined(S_NV_CACHE_STATISTICS)
+/** Reads the statistics of the item cache lookups. Only available on SAMR21 platforms.
+
+    \param[out] pStatistics Buffer for the statistics.
+    \param reset TRUE to restart collecting the statistics.
+*/
+void S_Nv_GetCacheStatistics(S_Nv_CacheStatistics_t* pStatistics, bool reset);
+#endif
+
 /***************************************************************************************************
 * END OF C++ DECLARATION WRAPPER
 ***************************************************************************************************/
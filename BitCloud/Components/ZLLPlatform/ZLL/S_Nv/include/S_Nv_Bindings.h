@@ -8,6 +8,7 @@
 #define S_Nv_Delete S_Nv_Delete_Impl
 #define S_Nv_SetPowerSupplyCheckingFunction S_Nv_SetPowerSupplyCheckingFunction_Impl
 #define S_Nv_IsItemAvailable S_Nv_IsItemAvailable_Impl
+#define S_Nv_GetCacheStatistics S_Nv_GetCacheStatistics_Impl
 
 // used interfaces
 #if defined(TESTHARNESS)
@@ -15,6 +16,7 @@
 #define D_Nv_Write D_Nv_Stub_Write
 #define D_Nv_Read D_Nv_Stub_Read
 #define D_Nv_EraseSector D_Nv_Stub_EraseSector
+#define D_Nv_ErasePage D_Nv_Stub_ErasePage
 #define D_Nv_IsEmpty D_Nv_Stub_IsEmpty
 #define D_Nv_IsEqual D_Nv_Stub_IsEqual
 
@@ -28,6 +30,7 @@
 #define D_Nv_Write D_Nv_Write_Impl
 #define D_Nv_Read D_Nv_Read_Impl
 #define D_Nv_EraseSector D_Nv_EraseSector_Impl
+#define D_Nv_ErasePage D_Nv_ErasePage_Impl
 #define D_Nv_IsEmpty D_Nv_IsEmpty_Impl
 #define D_Nv_IsEqual D_Nv_IsEqual_Impl
 
@@ -34,9 +34,12 @@ $Id: S_Nv_Stack_Ids.h 24615 2013-02-27 05:14:24Z arazinkov $
     This file defines the flash storage ids used by the ZLLPlatform.
     NOTE: Future additions to the ZLLPlatform should use IDs from the range
     S_NV_STACK_RANGE_MIN..S_NV_STACK_RANGE_MAX, defined in \ref wlPdsMemIds.h.
-    The two items defined here are legacy and should not be changed.
+    They are taken from S_NV_STACK_RANGE_MAX downwards, clear of the BitCloud
+    items which are numbered upwards from S_NV_STACK_RANGE_MIN.
+    The two S_NV_PLATFORM_RANGE1 items defined here are legacy and should not be changed.
 */
 #define FREE_RANGES_STORAGE_ID                      (S_NV_PLATFORM_RANGE1_MIN + 1u) // addressManager
 #define FACTORY_NEW_STORAGE_ID                      (S_NV_PLATFORM_RANGE1_MIN + 2u) // device info
+#define RECENT_ASSIGNMENTS_STORAGE_ID               (S_NV_STACK_RANGE_MAX)          // addressManager
 
 #endif //S_NV_STACK_IDS_H
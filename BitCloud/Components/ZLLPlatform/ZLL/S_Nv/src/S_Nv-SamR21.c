@@ -76,16 +76,63 @@
 /** Delay before performing a compact item operation. */
 #define COMPACT_ITEM_DELAY_MS 3000u
 
+/** Delay between two steps of a compact sector operation. Other tasks run in between. */
+#if !defined(S_NV_COMPACT_STEP_INTERVAL_MS)
+#define S_NV_COMPACT_STEP_INTERVAL_MS 10u
+#endif
+
+/** Number of rows copied by one step of a compact sector operation. */
+#if !defined(S_NV_COMPACT_ROWS_PER_STEP)
+#define S_NV_COMPACT_ROWS_PER_STEP 1u
+#endif
+
+/** Number of pages erased by one step of a compact sector or erase sector operation. */
+#if !defined(S_NV_ERASE_PAGES_PER_STEP)
+#define S_NV_ERASE_PAGES_PER_STEP 1u
+#endif
+
+/** Delay between two steps of an erase sector operation. */
+#define ERASE_SECTOR_STEP_INTERVAL_MS S_NV_COMPACT_STEP_INTERVAL_MS
+
 /** Perform a compact item operation if the number of partial writes is larger than this. */
 #define COMPACT_ITEM_THRESHOLD 100u
 
 /** Perform a compact sector operation with a delay if the sector has less free space than this. */
 #define PREEMPTIVE_COMPACT_SECTOR_THRESHOLD  (MAX_ITEM_LENGTH + BLOCK_HEADER_SIZE)
 
+/** Keep rarely written items in a separate cold sector, so that a compact sector operation does
+    not copy them each time. Needs a free sector besides the active and the cold sector. */
+#if !defined(S_NV_COLD_SECTOR)
+#if D_NV_SECTOR_COUNT >= 3
+#define S_NV_COLD_SECTOR 1
+#else
+#define S_NV_COLD_SECTOR 0
+#endif
+#endif
+
+/** An item that has not been written during this number of compact sector operations is cold. */
+#if !defined(S_NV_COLD_ITEM_AGE)
+#define S_NV_COLD_ITEM_AGE 3u
+#endif
+
+/** Rewrite the cold sector if cold items of at least this size are in the active sector. */
+#if !defined(S_NV_COLD_MIGRATE_THRESHOLD)
+#define S_NV_COLD_MIGRATE_THRESHOLD (SECTOR_SIZE / 8u)
+#endif
+
+/** Move the cold sector if it has been erased this number of times less than the free sector it would move to. */
+#if !defined(S_NV_COLD_WEAR_DELTA)
+#define S_NV_COLD_WEAR_DELTA 16u
+#endif
+
 #define SECTOR_SIZE   D_NV_SECTOR_SIZE
 #define FIRST_SECTOR  D_NV_FIRST_SECTOR
 #define SECTOR_COUNT  D_NV_SECTOR_COUNT
 
+#if SECTOR_COUNT > 32
+#error "S_Nv supports up to 32 sectors"
+#endif
+
 /* address of the page from where items are stores i.e 2nd row address in the sector */
 #define ITEMS_AREA_START_ADDRESS  D_NV_PAGE_SIZE
 
@@ -96,9 +143,23 @@
 /** The size of the block header. same for Snv rev1 */
 #define BLOCK_HEADER_SIZE ((uint16_t) sizeof(BlockHeader_t))
 
+/** Location of the wear record in the first row of a sector. It is in another flash page than
+    the sector header, so that both can be programmed separately. */
+#define SECTOR_WEAR_OFFSET 64u
+#define SECTOR_WEAR_SIZE ((uint16_t) sizeof(SectorWear_t))
+
 /** The sequence number to use for the initial sector. */
 #define INITIAL_SECTOR_SEQUENCE_NUMBER 0xFFFFFFFEuL
 
+/** Item flag: the sector being compacted to contains a copy of the item, which may be outdated. */
+#define ITEM_IN_DESTINATION 0x01u
+/** Item flag: the last written block of the item is in the cold sector. */
+#define ITEM_IN_COLD_SECTOR 0x02u
+/** Item flag: the cold sector contains a copy of the item, which may be outdated. */
+#define ITEM_HAS_COLD_COPY  0x04u
+/** Item flag: the item is moved to the cold sector by the compact sector operation in progress. */
+#define ITEM_MIGRATE        0x08u
+
 /***************************************************************************************************
 * LOCAL TYPES
 ***************************************************************************************************/
@@ -160,6 +221,16 @@ typedef struct SectorHeader_t
 
 } SectorHeader_t;
 
+/** Wear record located at SECTOR_WEAR_OFFSET. Written after the first row of the sector is erased,
+    before the sector is used. Missing in sectors erased by older versions. */
+typedef struct SectorWear_t
+{
+    /** Number of times the sector has been erased. */
+    uint32_t eraseCount;
+    /** Parity bits for the eraseCount field = eraseCount ^ 0xFFFFFFFFuL. */
+    uint32_t eraseCountParity;
+} SectorWear_t;
+
 typedef struct BlockHeader_t
 {
     /** CRC of the data. */
@@ -187,15 +258,33 @@ typedef struct Item_t
     uint16_t id;
     /** Pointer to the last written block for this item. */
     uint16_t lastBlock;
+    /** Pointer to the up to date copy of the item in the sector being compacted to.
+        0x0000 if the item still has to be copied. */
+    uint16_t compactedBlock;
+    /** ITEM_xxx flags. */
+    uint8_t flags;
+    /** Number of compact sector operations since the item was last written. */
+    uint8_t age;
 } Item_t;
 
 /** Enumerations for Snv revisions. */
 typedef enum
 {
+  SNV_REV_INVALID = 0,
   SNV_REV_1 = 1,
-  SNV_REV_2,  
+  SNV_REV_2,
+  /** Rev 2 layout holding cold items, signature "ATSNvC". */
+  SNV_REV_2_COLD
 } SnvRevisioin_t;
 
+/** States of the compact sector operation. */
+typedef enum
+{
+  COMPACT_IDLE,
+  COMPACT_ERASE,
+  COMPACT_COPY
+} CompactState_t;
+
 /** Enumerations for Snv Item alignments. */
 typedef enum
 {
@@ -213,6 +302,35 @@ typedef enum
 #pragma pack()
 #endif
 
+/** Progress of a compact sector operation. The source sector stays the active sector
+    until all items are copied and the header of the destination sector is written. */
+typedef struct CompactOperation_t
+{
+    CompactState_t state;
+    /** Finish the operation without giving control to other tasks. */
+    bool blocking;
+    /** The cold sector is rewritten first. The active sector is compacted afterwards. */
+    bool cold;
+    uint8_t sector;
+    /** Sectors that failed to erase, bit 0 is FIRST_SECTOR. */
+    uint32_t excludedSectors;
+    /** Offset of the next page of the destination sector to erase. */
+    uint16_t eraseOffset;
+    /** Destination offset of the row being filled and the number of bytes in it. */
+    uint16_t rowStart;
+    uint16_t rowLength;
+    /** Item being copied, 0 if none. */
+    uint16_t itemId;
+    /** Source and destination blocks of the item being copied. */
+    uint8_t itemSourceSector;
+    uint16_t itemSourceBlock;
+    uint16_t itemBlock;
+    /** Number of bytes of the block of the item being copied that are already in the row. */
+    uint16_t itemOffset;
+    BlockHeader_t itemHeader;
+    uint8_t row[ROW_SIZE];
+} CompactOperation_t;
+
 /***************************************************************************************************
 * LOCAL VARIABLES
 ***************************************************************************************************/
@@ -224,9 +342,23 @@ static uint8_t s_sector;
 /** Location of the first unprogrammed byte in the active sector. */
 static uint16_t s_sectorHead;
 
-/** The number of read, and thus cached, items */
+/** The sector holding cold items, 0xFF if there is none. It is only written by a compact sector operation. */
+static uint8_t s_coldSector = 0xFFu;
+/** An item with a copy in the cold sector has been deleted. The cold sector has to be rewritten
+    before a compact sector operation drops the delete record from the active sector. */
+static bool s_coldDeletePending = FALSE;
+
+/** Erase counters of the sectors, read from the wear records. */
+static uint32_t s_eraseCount[SECTOR_COUNT];
+/** The lowest sequence number of the valid sectors. */
+static uint32_t s_sequenceNumber;
+
+/** The number of read, and thus cached, items. The cache is sorted by item id. */
 static uint8_t s_itemCount = 0u;
 static Item_t s_itemCache[MAX_ITEM_COUNT];
+#if defined(S_NV_CACHE_STATISTICS)
+static S_Nv_CacheStatistics_t s_cacheStatistics;
+#endif
 static uint8_t dataBlock[ROW_SIZE];
 
 /** The sector to erase in the EVENT_ERASE_SECTOR handler. */
@@ -236,8 +368,11 @@ static uint8_t s_sectorToErase = 0xFFu;
 static uint16_t s_compactItemId = 0x0000u;
 static uint16_t s_compactItemLength = 0x0000u;
 
-static uint16_t compactBlockOffset = 0u;
-static uint16_t currentCompactLength = 0u;
+/** Progress of the compact sector operation. */
+static CompactOperation_t s_compaction;
+
+/** Offset of the next page to erase in s_sectorToErase. */
+static uint16_t s_eraseOffset = 0u;
 
 /** Callback function called before changing flash contents. */
 static S_Nv_PowerSupplyCheckingFunction_t s_powerSupplyCheckingFunction = NULL;
@@ -257,8 +392,14 @@ static void compactSectorTimerFired(void);
 static void compactItemTimerFired(void);
 static bool PowerSupplyTooLow(void);
 static bool CompactSector(void);
-static S_Nv_ReturnValue_t CompactItem(void);
+static void StartCompaction(void);
+static bool CompactSectorStep(void);
+static void RestartCompaction(void);
+static void SelectDestinationSector(void);
+static bool PlanColdSector(void);
+static S_Nv_ReturnValue_t CompactItem(uint16_t id, uint16_t newLength);
 static bool GatherData(uint8_t sourceSector, uint16_t lastBlockPointer, uint16_t offset, uint16_t length, void* pData);
+static void EraseHeaderPage(uint8_t sector);
 /***************************************************************************************************
 * LOCAL FUNCTIONS
 ***************************************************************************************************/
@@ -266,24 +407,80 @@ static bool GatherData(uint8_t sourceSector, uint16_t lastBlockPointer, uint16_t
 */
 static void eraseSectorTimerFired(void)
 {
-    if (!PowerSupplyTooLow())
-        D_Nv_EraseSector(s_sectorToErase);
+    if ( PowerSupplyTooLow() || (s_sectorToErase == 0xFFu) )
+        return;
+
+    // the first page holds the sector header, so the sector is invalid after the first step
+    for ( uint8_t i = 0u; (i < S_NV_ERASE_PAGES_PER_STEP) && (s_eraseOffset < SECTOR_SIZE); i++ )
+    {
+        if ( s_eraseOffset == 0u )
+        {
+            EraseHeaderPage(s_sectorToErase);
+        }
+        else
+        {
+            D_Nv_ErasePage(s_sectorToErase, s_eraseOffset);
+        }
+        s_eraseOffset += D_NV_PAGE_SIZE;
+    }
+
+    if ( s_eraseOffset < SECTOR_SIZE )
+    {
+        eraseSectorTimer.interval = ERASE_SECTOR_STEP_INTERVAL_MS;
+        HAL_StartAppTimer(&eraseSectorTimer);
+    }
+    else
+    {
+        s_sectorToErase = 0xFFu;
+    }
+}
+
+/** Starts a one-shot system timer.
+*/
+static void StartTimer(SYS_Timer_t* pTimer, uint32_t interval, void (*handler)(void))
+{
+    SYS_InitTimer(pTimer, TIMER_ONE_SHOT_MODE, interval, handler);
+    SYS_StartTimer(pTimer);
 }
 
-/** Compact sector timer callback.
+/** Compact sector timer callback. Performs one step of the compact sector operation.
 */
 static void compactSectorTimerFired(void)
 {
-    if (!PowerSupplyTooLow())
-        if (!CompactSector())
+    SYS_StopTimer(&compactSectorTimer);
+
+    if ( PowerSupplyTooLow() )
+    {
+        // an operation in progress is continued later, a new one is started when needed
+        if ( s_compaction.state != COMPACT_IDLE )
+            StartTimer(&compactSectorTimer, COMPACT_SECTOR_DELAY_MS, compactSectorTimerFired);
+        return;
+    }
+
+    if ( s_compaction.state == COMPACT_IDLE )
+        StartCompaction();
+
+    if ( s_compaction.blocking )
+    {
+        if ( !CompactSector() )
+            N_ERRH_FATAL();
+    }
+    else
+    {
+        if ( !CompactSectorStep() )
             N_ERRH_FATAL();
+    }
+
+    if ( s_compaction.state != COMPACT_IDLE )
+        StartTimer(&compactSectorTimer, S_NV_COMPACT_STEP_INTERVAL_MS, compactSectorTimerFired);
 }
 
 /** Compact item timer callback.
 */
 static void compactItemTimerFired(void)
 {
-    (void)CompactItem();
+    SYS_StopTimer(&compactItemTimer);
+    (void)CompactItem(s_compactItemId, s_compactItemLength);
 }
 
 /** Check the power supply.
@@ -354,49 +551,155 @@ static void UpdateSectorHead(uint16_t increment, ItemAlignment_t itemAlignment )
     }
 }
 
+/** Return the position of the item in the cache.
+    \param id The id to find
+    \returns The position of the item, or the position to insert it at if it is not cached
+*/
+static uint8_t FindItemCachePosition(uint16_t id)
+{
+    uint8_t low = 0u;
+    uint8_t high = s_itemCount;
+#if defined(S_NV_CACHE_STATISTICS)
+    uint8_t comparisons = 0u;
+#endif
+
+    while ( low < high )
+    {
+        uint8_t middle = (uint8_t) ((low + high) / 2u);
+#if defined(S_NV_CACHE_STATISTICS)
+        comparisons++;
+#endif
+        if ( s_itemCache[middle].id < id )
+        {
+            low = middle + 1u;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+#if defined(S_NV_CACHE_STATISTICS)
+    s_cacheStatistics.comparisons += comparisons;
+    if ( comparisons > s_cacheStatistics.maxComparisons )
+    {
+        s_cacheStatistics.maxComparisons = comparisons;
+    }
+#endif
+
+    return low;
+}
+
 /** Return a pointer to the cache for the item.
     \param id The id to find
     \returns A pointer to the cache for the ID, or NULL if it was not found
 */
 static Item_t *FindItemCache(uint16_t id)
 {
-    for ( uint8_t cacheIndex = 0u; cacheIndex < s_itemCount; cacheIndex++ )
+    uint8_t position = FindItemCachePosition(id);
+
+#if defined(S_NV_CACHE_STATISTICS)
+    s_cacheStatistics.lookups++;
+#endif
+
+    if ( (position < s_itemCount) && (s_itemCache[position].id == id) )
     {
-        Item_t *cache = &s_itemCache[cacheIndex];
-        if ( cache->id == id )
-        {
-            N_ERRH_ASSERT_FATAL(cache->lastBlock != 0x0000);
-            return cache;
-        }
+        Item_t *cache = &s_itemCache[position];
+        N_ERRH_ASSERT_FATAL(cache->lastBlock != 0x0000);
+        return cache;
     }
+
+#if defined(S_NV_CACHE_STATISTICS)
+    s_cacheStatistics.misses++;
+#endif
     return NULL;
 }
 
 /** Return a pointer to a cache for a new item.
     \param id The id to create cache for
     \returns A pointer to the cache for the ID
+    \note Pointers to the cache of other items are not valid any more
 */
 static Item_t *CreateItemCache(uint16_t id)
 {
-    N_ERRH_ASSERT_FATAL(FindItemCache(id) == NULL);
+    uint8_t position = FindItemCachePosition(id);
+
+    N_ERRH_ASSERT_FATAL((position == s_itemCount) || (s_itemCache[position].id != id));
     N_ERRH_ASSERT_FATAL(s_itemCount < MAX_ITEM_COUNT);
 
-    Item_t *cache = &s_itemCache[s_itemCount++];
+    // keep the cache sorted
+    memmove(&s_itemCache[position + 1u], &s_itemCache[position], (s_itemCount - position) * sizeof(Item_t));
+    s_itemCount++;
+
+    Item_t *cache = &s_itemCache[position];
     cache->id = id;
+    cache->compactedBlock = 0x0000u;
+    cache->flags = 0u;
+    cache->age = 0u;
 
     return cache;
 }
 
 /** Removes the specified item from the cache array.
     \param id The id to delete the cache for
+    \note Pointers to the cache of other items are not valid any more
 */
 static void DeleteItemCache(uint16_t id)
 {
-    N_ERRH_ASSERT_FATAL(FindItemCache(id) != NULL);
-
-    // Overwrite specified item cache with the last one
     Item_t *cache = FindItemCache(id);
-    *cache = s_itemCache[--s_itemCount];
+
+    N_ERRH_ASSERT_FATAL(cache != NULL);
+
+    // the copy in the cold sector must not be loaded again after the delete record is dropped
+    if ( (cache->flags & ITEM_HAS_COLD_COPY) != 0u )
+    {
+        s_coldDeletePending = TRUE;
+    }
+
+    // the sector being compacted to must not contain deleted items, not even outdated copies.
+    // a compact operation of the active sector has to rewrite the cold sector first now
+    bool replan = (s_compaction.state != COMPACT_IDLE) &&
+                  (((cache->flags & ITEM_IN_DESTINATION) != 0u) || (s_compaction.itemId == id) ||
+                   (!s_compaction.cold && ((cache->flags & ITEM_HAS_COLD_COPY) != 0u)));
+
+    s_itemCount--;
+    memmove(cache, cache + 1, (uint16_t) ((&s_itemCache[s_itemCount] - cache) * sizeof(Item_t)));
+
+    if ( replan )
+    {
+        bool cold = PlanColdSector();
+        if ( cold != s_compaction.cold )
+        {
+            s_compaction.cold = cold;
+            SelectDestinationSector();
+        }
+        else
+        {
+            RestartCompaction();
+        }
+    }
+}
+
+/** Update the pointer to the last written block of a cached item.
+    \param cache The cache of the item
+    \param lastBlock The new last written block, in the active sector
+*/
+static void SetItemLastBlock(Item_t *cache, uint16_t lastBlock)
+{
+    cache->lastBlock = lastBlock;
+    // a copy made by a compact sector operation in progress is outdated now
+    cache->compactedBlock = 0x0000u;
+    cache->flags &= (uint8_t) ~(ITEM_IN_COLD_SECTOR | ITEM_MIGRATE);
+    cache->age = 0u;
+}
+
+/** Return the sector holding the last written block of a cached item.
+    \param cache The cache of the item
+    \returns The cold sector or the active sector
+*/
+static uint8_t ItemSector(const Item_t *cache)
+{
+    return ((cache->flags & ITEM_IN_COLD_SECTOR) != 0u) ? s_coldSector : s_sector;
 }
 
 /** Return a pointer to the last written block for the item.
@@ -706,6 +1009,51 @@ static bool GatherData(uint8_t sourceSector, uint16_t lastBlockPointer, uint16_t
     return TRUE;
 }
 
+/** Read the erase counter of a sector from its wear record.
+    \param sector The sector to read the wear record of
+    \param pEraseCount Returns the erase counter
+    \returns FALSE if the sector has no valid wear record
+*/
+static bool ReadSectorWear(uint8_t sector, uint32_t *pEraseCount)
+{
+    SectorWear_t sectorWear;
+    D_Nv_Read(sector, SECTOR_WEAR_OFFSET, (uint8_t*) &sectorWear, SECTOR_WEAR_SIZE);
+
+    if ( (sectorWear.eraseCount ^ sectorWear.eraseCountParity) != 0xFFFFFFFFuL )
+    {
+        return FALSE;
+    }
+    *pEraseCount = sectorWear.eraseCount;
+    return TRUE;
+}
+
+/** Increment the erase counter of a sector which first row has just been erased and write it to
+    the wear record. A failed write is not checked: the counter is estimated at the next init.
+    \param sector The erased sector
+*/
+static void WriteSectorWear(uint8_t sector)
+{
+    SectorWear_t sectorWear;
+    uint8_t index = sector - FIRST_SECTOR;
+
+    if ( s_eraseCount[index] != 0xFFFFFFFFuL )
+    {
+        s_eraseCount[index]++;
+    }
+    sectorWear.eraseCount = s_eraseCount[index];
+    sectorWear.eraseCountParity = sectorWear.eraseCount ^ 0xFFFFFFFFuL;
+    D_Nv_Write(sector, SECTOR_WEAR_OFFSET, (uint8_t*) &sectorWear, SECTOR_WEAR_SIZE);
+}
+
+/** Erase the first row of a sector, which invalidates the sector header, and update the wear record.
+    \param sector The sector to erase the first row of
+*/
+static void EraseHeaderPage(uint8_t sector)
+{
+    D_Nv_ErasePage(sector, 0u);
+    WriteSectorWear(sector);
+}
+
 static bool EraseSector(void)
 {
     // Erase the sector
@@ -715,12 +1063,13 @@ static bool EraseSector(void)
     {
         return FALSE;
     }
+    WriteSectorWear(s_sector);
     s_sectorHead =  ITEMS_AREA_START_ADDRESS;
 
     return TRUE;
 }
 
-static bool WriteSectorHeader(uint32_t sequenceNumber, uint16_t nextPageAddressAfterCompact)
+static bool WriteSectorHeader(uint8_t sector, uint32_t sequenceNumber, uint16_t nextPageAddressAfterCompact, bool cold)
 {
     // write sector header
     SectorHeader_t sectorHeader;
@@ -729,18 +1078,58 @@ static bool WriteSectorHeader(uint32_t sequenceNumber, uint16_t nextPageAddressA
     sectorHeader.signature[2] = (uint8_t) 'S';
     sectorHeader.signature[3] = (uint8_t) 'N';
     sectorHeader.signature[4] = (uint8_t) 'v';
-    sectorHeader.signature[5] = (uint8_t) '2';
+    sectorHeader.signature[5] = cold ? (uint8_t) 'C' : (uint8_t) '2';
     sectorHeader.sequenceNumber = sequenceNumber;
     sectorHeader.sequenceParity = sequenceNumber ^ 0xFFFFFFFFuL;
     sectorHeader.nextPageAddressAfterCompact = nextPageAddressAfterCompact;
     sectorHeader.headerCrc = ComputeSectorHeaderCrc(&sectorHeader);
-    if ( !WriteAndCheck(0u, (uint8_t*) &sectorHeader, SECTOR_HEADER_SIZE) )
+    D_Nv_Write(sector, 0u, (uint8_t*) &sectorHeader, SECTOR_HEADER_SIZE);
+    return D_Nv_IsEqual(sector, 0u, (uint8_t*) &sectorHeader, SECTOR_HEADER_SIZE);
+}
+
+
+/** Check the header of a sector.
+    \param sector The sector to check
+    \param pSequenceNumber Returns the sequence number of a valid sector
+    \returns The revision of a valid sector, SNV_REV_INVALID otherwise
+*/
+static SnvRevisioin_t ReadSectorRevision(uint8_t sector, uint32_t *pSequenceNumber)
+{
+    SectorHeader_t sectorHeader;
+    D_Nv_Read(sector, 0u, (uint8_t*) &sectorHeader, SECTOR_HEADER_SIZE);
+
+    if (((sectorHeader.sequenceNumber ^ sectorHeader.sequenceParity) != 0xFFFFFFFFuL) ||
+        (sectorHeader.signature[0] != (uint8_t) 'A') ||
+        (sectorHeader.signature[1] != (uint8_t) 'T') ||
+        (sectorHeader.signature[2] != (uint8_t) 'S') ||
+        (sectorHeader.signature[3] != (uint8_t) 'N') ||
+        (sectorHeader.signature[4] != (uint8_t) 'v') )
     {
-        return FALSE;
+        return SNV_REV_INVALID;
+    }
+    *pSequenceNumber = sectorHeader.sequenceNumber;
+
+    if ( sectorHeader.signature[5] == (uint8_t) '1' )
+    {
+        SectorHeaderSnv1_t* pSectorHeaderSnv1 = (SectorHeaderSnv1_t*)&sectorHeader;
+        return (pSectorHeaderSnv1->isActive == 0x0000u) ? SNV_REV_1 : SNV_REV_INVALID;
+    }
+
+    if ( ComputeSectorHeaderCrc(&sectorHeader) != sectorHeader.headerCrc )
+    {
+        return SNV_REV_INVALID;
     }
-    return TRUE;
-}
 
+    if ( sectorHeader.signature[5] == (uint8_t) '2' )
+    {
+        return SNV_REV_2;
+    }
+    if ( sectorHeader.signature[5] == (uint8_t) 'C' )
+    {
+        return SNV_REV_2_COLD;
+    }
+    return SNV_REV_INVALID;
+}
 
 static void LoadSector(SnvRevisioin_t revisionNumber)
 {
@@ -779,6 +1168,7 @@ static void LoadSector(SnvRevisioin_t revisionNumber)
                 }
 
                 cache->lastBlock = s_sectorHead;
+                cache->flags &= (uint8_t) ~ITEM_IN_COLD_SECTOR;
 
                 // If item length is zero, the item had been deleted -- remove the cache
                 if ( blockHeader.itemLength == 0u )
@@ -850,6 +1240,7 @@ static void LoadSector(SnvRevisioin_t revisionNumber)
                     }
 
                     cache->lastBlock = s_sectorHead;
+                    cache->flags &= (uint8_t) ~ITEM_IN_COLD_SECTOR;
 
                     // If item length is zero, the item had been deleted -- remove the cache
                     if ( blockHeader.itemLength == 0u )
@@ -865,198 +1256,583 @@ static void LoadSector(SnvRevisioin_t revisionNumber)
     }
 }
 
-/* Smart compacting is way of dumping data in to other sector as 256 byte chunks
- * without following any alignements as normal item updates.Items are filled into
-  256 byte buffer(= row size), committed in shot which takes 4 page writs maximum
- */
-
-static bool SmartCompacting(uint8_t* compactBlock, uint16_t curItemLength)
+/** Select a free sector, i.e. not the active sector, not the cold sector and not excluded.
+    Sectors with equal erase counters are selected in ring order after the active sector.
+    \param mostWorn TRUE to select the most worn sector, FALSE to select the least worn sector
+    \returns The selected sector, or 0xFF if there is no free sector
+*/
+static uint8_t SelectFreeSector(bool mostWorn)
 {
-    //manupulate the current compact length
-    currentCompactLength += curItemLength;
-
-    // if the complete buffer cannot be filled with the current item
-    if ( currentCompactLength < ROW_SIZE)
-    {
-        memcpy(compactBlock + compactBlockOffset, dataBlock, curItemLength);
-        compactBlockOffset += curItemLength;
-
-        return TRUE;
+    uint8_t selected = 0xFFu;
+    uint8_t sector = s_sector;
 
-    } //if with the current item, it cannot be fit into one buffer
-    else  //(currentCompactLength >= ROW_SIZE) cases
+    for ( uint8_t i = 1u; i < SECTOR_COUNT; i++ )
     {
-        uint16_t dataBlockOffset = 0;
+        sector++;
+        if ( sector >= (FIRST_SECTOR + SECTOR_COUNT) )
+        {
+            sector = FIRST_SECTOR;
+        }
 
+        if ( (sector == s_coldSector) || ((s_compaction.excludedSectors & (1uL << (sector - FIRST_SECTOR))) != 0uL) )
+        {
+            continue;
+        }
 
-        memcpy(compactBlock + compactBlockOffset, dataBlock, (ROW_SIZE - compactBlockOffset));
-        if ( !WriteAndCheck(s_sectorHead, compactBlock, ROW_SIZE ))
+        if ( selected == 0xFFu )
         {
-            return FALSE;
+            selected = sector;
         }
-        UpdateSectorHead(ROW_SIZE, ITEM_NO_ALIGNMENT);
-        dataBlockOffset += (ROW_SIZE - compactBlockOffset);
-        compactBlockOffset = 0;
-        currentCompactLength -= ROW_SIZE;
-        if (currentCompactLength)
+        else if ( mostWorn ? (s_eraseCount[sector - FIRST_SECTOR] > s_eraseCount[selected - FIRST_SECTOR])
+                           : (s_eraseCount[sector - FIRST_SECTOR] < s_eraseCount[selected - FIRST_SECTOR]) )
         {
-            memcpy(compactBlock, dataBlock + dataBlockOffset, currentCompactLength);
-            compactBlockOffset = currentCompactLength;
+            selected = sector;
         }
     }
 
-    return TRUE;
-
+    return selected;
 }
 
-/* Important: if CompactSector fails, the only fix is to reinitialize!
- * This is because the itemCache, sector head and sector selector will
- * be messed up.
- */
-
-static bool CompactSector(void)
+/** Select the destination sector of the compact sector operation and start copying to it from the beginning.
+    The cold sector is moved to the most worn free sector, the active sector to the least worn one.
+*/
+static void SelectDestinationSector(void)
 {
-#if defined(ENABLE_NV_COMPACT_LOGGING)
-    N_LOG_ALWAYS(("CompactSector(s=%hu)", s_sector));
-#endif
-    uint8_t compactBlock[ROW_SIZE];
-    
-    // stop timer for preemptive compact sector as this will not be needed any more
-    SYS_StopTimer(&compactSectorTimer);
+    s_compaction.sector = SelectFreeSector(s_compaction.cold);
 
-    // stop the compact item as a compact sector will compact all items
-    s_compactItemId = 0u;
-    s_compactItemLength = 0u;
+    if ( s_compaction.sector == 0xFFu )
+    {
+        // all sector failed to initialize
+        N_ERRH_FATAL();
+    }
 
-    compactBlockOffset = 0;
-    currentCompactLength = 0;
+    RestartCompaction();
+}
 
-    uint8_t sourceSector = s_sector;
+/** Start copying the items to the destination sector from the beginning. Items copied so far are discarded.
+*/
+static void RestartCompaction(void)
+{
+    s_compaction.state = COMPACT_ERASE;
+    s_compaction.eraseOffset = 0u;
+    s_compaction.rowStart = ITEMS_AREA_START_ADDRESS;
+    s_compaction.rowLength = 0u;
+    s_compaction.itemId = 0u;
 
-    // get the sector header for the source sector
-    SectorHeader_t sectorHeader;
-    D_Nv_Read(sourceSector, 0u, (uint8_t*) &sectorHeader, SECTOR_HEADER_SIZE);
+    for ( uint8_t cacheIndex = 0u; cacheIndex < s_itemCount; cacheIndex++ )
+    {
+        s_itemCache[cacheIndex].compactedBlock = 0x0000u;
+        s_itemCache[cacheIndex].flags &= (uint8_t) ~ITEM_IN_DESTINATION;
+    }
 
-    uint32_t nextSequenceNumber = sectorHeader.sequenceNumber - 1uL;
+    // a pending erase of the destination sector is done by the compact sector operation
+    if ( s_sectorToErase == s_compaction.sector )
+    {
+        HAL_StopAppTimer(&eraseSectorTimer);
+        s_sectorToErase = 0xFFu;
+    }
+}
 
-    // find and prepare a destination sector
-    do
+/** Return the size of the single block a compact sector operation copies a cached item to.
+    \param cache The cache of the item
+    \returns The size of the block header and the item data
+*/
+static uint32_t ItemSize(const Item_t *cache)
+{
+    BlockHeader_t blockHeader;
+    D_Nv_Read(ItemSector(cache), cache->lastBlock, (uint8_t*) &blockHeader, BLOCK_HEADER_SIZE);
+    return (uint32_t) BLOCK_HEADER_SIZE + blockHeader.itemLength;
+}
+
+/** Decide if the compact sector operation rewrites the cold sector before compacting the active
+    sector, and mark the cold items of the active sector to move to the cold sector.
+    The cold sector is rewritten when
+    - an item with a copy in it has been deleted,
+    - enough cold items are in the active sector, or
+    - it has been erased much less often than the free sector it would move to.
+    A cold sector which would be empty is invalidated instead.
+    \returns TRUE if the cold sector is rewritten first
+*/
+static bool PlanColdSector(void)
+{
+    uint32_t coldSize = 0uL;
+    uint32_t migrateSize = 0uL;
+    bool rewrite = s_coldDeletePending;
+
+    // items in the cold sector are always copied to the new cold sector
+    for ( uint8_t cacheIndex = 0u; cacheIndex < s_itemCount; cacheIndex++ )
     {
-        s_sector++;
-        if ( s_sector >= (FIRST_SECTOR + SECTOR_COUNT) )
-        {
-            s_sector = FIRST_SECTOR;
-        }
+        Item_t *cache = &s_itemCache[cacheIndex];
 
-        if ( s_sector == sourceSector )
+        cache->flags &= (uint8_t) ~ITEM_MIGRATE;
+        if ( (cache->flags & ITEM_IN_COLD_SECTOR) != 0u )
         {
-            // all sector failed to initialize
-            N_ERRH_FATAL();
+            coldSize += ItemSize(cache);
         }
     }
-    while ( !EraseSector());
 
-    // Traverse the item cache, writing all items to the new sector
-    for (uint8_t cacheIndex = 0; cacheIndex < s_itemCount; cacheIndex++) {
+#if S_NV_COLD_SECTOR == 1
+    for ( uint8_t cacheIndex = 0u; cacheIndex < s_itemCount; cacheIndex++ )
+    {
         Item_t *cache = &s_itemCache[cacheIndex];
 
-
-        uint16_t lastBlockPointer = cache->lastBlock;
-        uint8_t  dataBlockOffset = BLOCK_HEADER_SIZE;
-        // Start by reading out header of last block
-        //this could be old or new block header, but used new block header
-        //as except first field(old isActive and new-dtatCrc),
-        //all other fileds are same and first field has not been used 
-        //directly form the read header
-
-        BlockHeader_t blockHeader;
-        D_Nv_Read(sourceSector, lastBlockPointer, (uint8_t*) &blockHeader, BLOCK_HEADER_SIZE);
-
-        // Construct header for a single block with contiguous data
-        blockHeader.blockOffset = 0x0000u;
-        blockHeader.blockLength = blockHeader.itemLength;
-        blockHeader.previousBlock = 0x0000u;
-        blockHeader.writeCount = 0u;
-
-        uint16_t currLength = BLOCK_HEADER_SIZE + blockHeader.itemLength;
-
-        blockHeader.dataCrc =  ComputeDataCrc(sourceSector, lastBlockPointer, &blockHeader);
-
-        blockHeader.headerCrc = ComputeHeaderCrc(&blockHeader);
-
-        memset(dataBlock, 0xFF, sizeof(dataBlock));
-
-        memcpy(dataBlock, &blockHeader, BLOCK_HEADER_SIZE);
-
-        cache->lastBlock = s_sectorHead  + compactBlockOffset;
-
-        if (currLength <= ROW_SIZE)
+        if ( ((cache->flags & ITEM_IN_COLD_SECTOR) == 0u) && (cache->age >= S_NV_COLD_ITEM_AGE) )
         {
-            if (!GatherData(sourceSector, lastBlockPointer, 0u, blockHeader.itemLength, (dataBlock + BLOCK_HEADER_SIZE )))
+            uint32_t size = ItemSize(cache);
+            if ( (coldSize + migrateSize + size) <= (uint32_t) (SECTOR_SIZE - ITEMS_AREA_START_ADDRESS) )
             {
-                return FALSE;
-            }
-
-            cache->lastBlock = s_sectorHead  + compactBlockOffset;
-            if (!SmartCompacting(compactBlock, currLength))
-            {
-                return FALSE;
+                cache->flags |= ITEM_MIGRATE;
+                migrateSize += size;
             }
         }
-        else   //greater than 256 case
-        {
-            uint16_t bytesToGather;
-            uint16_t inDataOffset = 0;
-
-            do
-            {
-              bytesToGather =  (currLength > ROW_SIZE) ? ROW_SIZE : currLength; 
-              
-              if (!GatherData(sourceSector, lastBlockPointer, inDataOffset, (bytesToGather - dataBlockOffset) , (dataBlock + dataBlockOffset)))
-              {
-                  return FALSE;
-              }
+    }
 
-              if (!SmartCompacting(compactBlock, bytesToGather))
-              {
-                  return FALSE;
-              }
-              currLength -= bytesToGather;
-              inDataOffset += (bytesToGather - dataBlockOffset);
-              dataBlockOffset = 0;
+    if ( migrateSize >= S_NV_COLD_MIGRATE_THRESHOLD )
+    {
+        rewrite = TRUE;
+    }
+#endif
 
-            } while(currLength > 0);
+    if ( !rewrite && (s_coldSector != 0xFFu) )
+    {
+        uint8_t sector = SelectFreeSector(TRUE);
+        if ( (sector != 0xFFu) &&
+             (s_eraseCount[sector - FIRST_SECTOR] > s_eraseCount[s_coldSector - FIRST_SECTOR]) &&
+             ((s_eraseCount[sector - FIRST_SECTOR] - s_eraseCount[s_coldSector - FIRST_SECTOR]) >= S_NV_COLD_WEAR_DELTA) )
+        {
+            rewrite = TRUE;
         }
     }
-    // if some uncommitted data avaialble, committ it
-    if ( currentCompactLength)
+
+    if ( !rewrite )
     {
-        if ( !WriteAndCheck(s_sectorHead, compactBlock, currentCompactLength) )
+        for ( uint8_t cacheIndex = 0u; cacheIndex < s_itemCount; cacheIndex++ )
         {
-            return FALSE;
+            s_itemCache[cacheIndex].flags &= (uint8_t) ~ITEM_MIGRATE;
         }
+        return FALSE;
     }
-    // Just update sector header as per the the length of the data committed, no alignments
-    UpdateSectorHead(currentCompactLength, ITEM_NO_ALIGNMENT);
 
-    // update nextPageAddressAfterCompact in the sector header
-    // All items moved, so now we just need to Write the Sector Header with 
-    // nextPageAddressAfterCompact at the end of compact sector operation
-    if ( !WriteSectorHeader(nextSequenceNumber, s_sectorHead))
+    if ( (coldSize + migrateSize) == 0uL )
     {
+        // nothing left to keep in the cold sector
+        if ( s_coldSector != 0xFFu )
+        {
+            EraseHeaderPage(s_coldSector);
+            s_coldSector = 0xFFu;
+        }
+        for ( uint8_t cacheIndex = 0u; cacheIndex < s_itemCount; cacheIndex++ )
+        {
+            s_itemCache[cacheIndex].flags &= (uint8_t) ~ITEM_HAS_COLD_COPY;
+        }
+        s_coldDeletePending = FALSE;
         return FALSE;
     }
-    // Done with compact sector opration, Set the Sector Head to next page address for normal item update 
+
+    return TRUE;
+}
+
+/** Start a compact sector operation. The operation is performed by \ref CompactSectorStep.
+*/
+static void StartCompaction(void)
+{
+#if defined(ENABLE_NV_COMPACT_LOGGING)
+    N_LOG_ALWAYS(("CompactSector(s=%hu)", s_sector));
+#endif
+
+    // stop timer for preemptive compact sector as this will not be needed any more
+    SYS_StopTimer(&compactSectorTimer);
+
+    // stop the compact item as a compact sector will compact all items
+    s_compactItemId = 0u;
+    s_compactItemLength = 0u;
+
+    s_compaction.blocking = FALSE;
+    s_compaction.excludedSectors = 0uL;
+    s_compaction.cold = PlanColdSector();
+
+    SelectDestinationSector();
+}
+
+/** Check if a page of the destination sector is erased. A wear record in the first page is allowed.
+    \param offset The offset of the page
+    \returns TRUE if the page is erased
+*/
+static bool IsPageErased(uint16_t offset)
+{
+    uint8_t sector = s_compaction.sector;
+    uint32_t eraseCount;
+
+    if ( offset != 0u )
+    {
+        return D_Nv_IsEmpty(sector, offset, D_NV_PAGE_SIZE);
+    }
+
+    if ( !D_Nv_IsEmpty(sector, 0u, SECTOR_WEAR_OFFSET) ||
+         !D_Nv_IsEmpty(sector, SECTOR_WEAR_OFFSET + SECTOR_WEAR_SIZE, D_NV_PAGE_SIZE - (SECTOR_WEAR_OFFSET + SECTOR_WEAR_SIZE)) )
+    {
+        return FALSE;
+    }
+
+    if ( ReadSectorWear(sector, &eraseCount) )
+    {
+        return TRUE;
+    }
+    if ( D_Nv_IsEmpty(sector, SECTOR_WEAR_OFFSET, SECTOR_WEAR_SIZE) )
+    {
+        // erased without writing the wear record, e.g. by an older version or due to a reset
+        WriteSectorWear(sector);
+        return TRUE;
+    }
+    return FALSE;
+}
+
+/** Erase the pages of the destination sector that are not empty.
+    \returns TRUE if the sector is erased, FALSE if more steps are needed
+*/
+static bool EraseDestinationSector(void)
+{
+    uint8_t erasedPages = 0u;
+
+    for ( ; s_compaction.eraseOffset < SECTOR_SIZE; s_compaction.eraseOffset += D_NV_PAGE_SIZE )
+    {
+        if ( IsPageErased(s_compaction.eraseOffset) )
+        {
+            continue;
+        }
+
+        if ( erasedPages == S_NV_ERASE_PAGES_PER_STEP )
+        {
+            return FALSE;
+        }
+
+        if ( s_compaction.eraseOffset == 0u )
+        {
+            EraseHeaderPage(s_compaction.sector);
+        }
+        else
+        {
+            D_Nv_ErasePage(s_compaction.sector, s_compaction.eraseOffset);
+        }
+        erasedPages++;
+
+        // check if the erase succeeded
+        if ( !IsPageErased(s_compaction.eraseOffset) )
+        {
+            s_compaction.excludedSectors |= 1uL << (s_compaction.sector - FIRST_SECTOR);
+            SelectDestinationSector();
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/** Select the next item to copy to the destination sector and prepare its block header.
+    Items in or moving to the cold sector are copied when the cold sector is rewritten,
+    the other items when the active sector is compacted.
+    \returns FALSE if all items are copied
+*/
+static bool StartCopyItem(void)
+{
+    Item_t *cache = NULL;
+
+    for ( uint8_t cacheIndex = 0u; cacheIndex < s_itemCount; cacheIndex++ )
+    {
+        Item_t *item = &s_itemCache[cacheIndex];
+        bool cold = (item->flags & (ITEM_IN_COLD_SECTOR | ITEM_MIGRATE)) != 0u;
+
+        if ( (item->compactedBlock == 0x0000u) && (cold == s_compaction.cold) )
+        {
+            cache = item;
+            break;
+        }
+    }
+
+    if ( cache == NULL )
+    {
+        return FALSE;
+    }
+
+    // Start by reading out header of last block
+    //this could be old or new block header, but used new block header
+    //as except first field(old isActive and new-dtatCrc),
+    //all other fileds are same and first field has not been used
+    //directly form the read header
+    BlockHeader_t* pBlockHeader = &s_compaction.itemHeader;
+    s_compaction.itemSourceSector = ItemSector(cache);
+    D_Nv_Read(s_compaction.itemSourceSector, cache->lastBlock, (uint8_t*) pBlockHeader, BLOCK_HEADER_SIZE);
+
+    // Construct header for a single block with contiguous data
+    pBlockHeader->blockOffset = 0x0000u;
+    pBlockHeader->blockLength = pBlockHeader->itemLength;
+    pBlockHeader->previousBlock = 0x0000u;
+    pBlockHeader->writeCount = 0u;
+    pBlockHeader->dataCrc = ComputeDataCrc(s_compaction.itemSourceSector, cache->lastBlock, pBlockHeader);
+    pBlockHeader->headerCrc = ComputeHeaderCrc(pBlockHeader);
+
+    s_compaction.itemId = cache->id;
+    s_compaction.itemSourceBlock = cache->lastBlock;
+    s_compaction.itemBlock = s_compaction.rowStart + s_compaction.rowLength;
+    s_compaction.itemOffset = 0u;
+
+    return TRUE;
+}
+
+/** Finish copying the current item to the destination sector.
+*/
+static void FinishCopyItem(void)
+{
+    Item_t *cache = FindItemCache(s_compaction.itemId);
+
+    if ( cache != NULL )
+    {
+        // the destination contains a copy of the item, which is outdated if the item was written during the copy
+        cache->flags |= ITEM_IN_DESTINATION;
+
+        // an item written during the copy is copied again later
+        if ( (cache->lastBlock == s_compaction.itemSourceBlock) && (ItemSector(cache) == s_compaction.itemSourceSector) )
+        {
+            cache->compactedBlock = s_compaction.itemBlock;
+        }
+    }
+
+    s_compaction.itemId = 0u;
+}
+
+/** Write the row to the destination sector.
+    \returns FALSE if the write failed
+*/
+static bool WriteCompactRow(void)
+{
+    D_Nv_Write(s_compaction.sector, s_compaction.rowStart, s_compaction.row, s_compaction.rowLength);
+    return D_Nv_IsEqual(s_compaction.sector, s_compaction.rowStart, s_compaction.row, s_compaction.rowLength);
+}
+
+/** Make the destination sector the cold sector and continue with compacting the active sector.
+*/
+static void FinishColdSector(void)
+{
+    uint8_t oldColdSector = s_coldSector;
+
+    for ( uint8_t cacheIndex = 0u; cacheIndex < s_itemCount; cacheIndex++ )
+    {
+        Item_t *cache = &s_itemCache[cacheIndex];
+
+        if ( cache->compactedBlock != 0x0000u )
+        {
+            cache->lastBlock = cache->compactedBlock;
+            cache->flags = ITEM_IN_COLD_SECTOR | ITEM_HAS_COLD_COPY;
+        }
+        else
+        {
+            // the new cold sector may still contain an outdated copy of an item written during the copy
+            cache->flags = ((cache->flags & ITEM_IN_DESTINATION) != 0u) ? ITEM_HAS_COLD_COPY : 0u;
+        }
+        cache->compactedBlock = 0x0000u;
+    }
+
+    s_coldSector = s_compaction.sector;
+    s_coldDeletePending = FALSE;
+
+    // the old cold sector contains copies of deleted items
+    if ( oldColdSector != 0xFFu )
+    {
+        EraseHeaderPage(oldColdSector);
+    }
+
+    s_compaction.cold = FALSE;
+    SelectDestinationSector();
+}
+
+/** Make the destination sector the active sector.
+    \returns FALSE if writing to the destination sector failed
+*/
+static bool FinishCompaction(void)
+{
+    // if some uncommitted data avaialble, committ it
+    if ( s_compaction.rowLength != 0u )
+    {
+        if ( !WriteCompactRow() )
+        {
+            return FALSE;
+        }
+    }
+    uint16_t nextPageAddressAfterCompact = s_compaction.rowStart + s_compaction.rowLength;
+
+    // All items moved, so now we just need to Write the Sector Header with
+    // nextPageAddressAfterCompact at the end of compact sector operation.
+    // The destination sector is the valid one from now on
+    if ( !WriteSectorHeader(s_compaction.sector, s_sequenceNumber - 1uL, nextPageAddressAfterCompact, s_compaction.cold) )
+    {
+        return FALSE;
+    }
+    s_sequenceNumber--;
+
+    if ( s_compaction.cold )
+    {
+        FinishColdSector();
+        return TRUE;
+    }
+
+    // the delete records are dropped, so no deleted item may have a copy in the cold sector
+    N_ERRH_ASSERT_FATAL(!s_coldDeletePending);
+
+    for ( uint8_t cacheIndex = 0u; cacheIndex < s_itemCount; cacheIndex++ )
+    {
+        Item_t *cache = &s_itemCache[cacheIndex];
+
+        if ( (cache->flags & ITEM_IN_COLD_SECTOR) == 0u )
+        {
+            cache->lastBlock = cache->compactedBlock;
+            if ( cache->age != 0xFFu )
+            {
+                cache->age++;
+            }
+        }
+        cache->compactedBlock = 0x0000u;
+        cache->flags &= (uint8_t) ~ITEM_IN_DESTINATION;
+    }
+
+    // Done with compact sector opration, Set the Sector Head to next page address for normal item update
+    uint8_t sourceSector = s_sector;
+    s_sector = s_compaction.sector;
+    s_sectorHead = nextPageAddressAfterCompact;
     UpdateSectorHead(0, ITEM_64BYTE_ALIGNMENT);
+    s_compaction.state = COMPACT_IDLE;
 
     // schedule an erase of the source sector,Restart the timer if it is already running.
     s_sectorToErase = sourceSector;
+    s_eraseOffset = 0u;
     HAL_StopAppTimer(&eraseSectorTimer);
+    eraseSectorTimer.interval = ERASE_SECTOR_DELAY_MS;
     HAL_StartAppTimer(&eraseSectorTimer);
 
     return TRUE;
 }
 
+/** Copy items to the destination sector. Items are written in rows of ROW_SIZE bytes
+    without following any alignments as normal item updates.
+    \returns TRUE if the step is done, FALSE if writing to the destination sector failed
+*/
+static bool CopyItems(void)
+{
+    uint8_t rows = 0u;
+
+    while ( rows < S_NV_COMPACT_ROWS_PER_STEP )
+    {
+        if ( s_compaction.itemId == 0u )
+        {
+            if ( !StartCopyItem() )
+            {
+                return FinishCompaction();
+            }
+
+            if ( ((uint32_t) s_compaction.itemBlock + BLOCK_HEADER_SIZE + s_compaction.itemHeader.blockLength) > SECTOR_SIZE )
+            {
+                // items written during the compact sector operation were copied
+                // again too often. Start over without giving control to other tasks
+                if ( s_compaction.blocking )
+                {
+                    return FALSE;
+                }
+                RestartCompaction();
+                s_compaction.blocking = TRUE;
+                return TRUE;
+            }
+        }
+
+        uint16_t blockSize = BLOCK_HEADER_SIZE + s_compaction.itemHeader.blockLength;
+        uint16_t count = MIN((uint16_t) (blockSize - s_compaction.itemOffset), (uint16_t) (ROW_SIZE - s_compaction.rowLength));
+        uint8_t *pDestination = s_compaction.row + s_compaction.rowLength;
+
+        if ( s_compaction.itemOffset < BLOCK_HEADER_SIZE )
+        {
+            count = MIN(count, (uint16_t) (BLOCK_HEADER_SIZE - s_compaction.itemOffset));
+            memcpy(pDestination, (uint8_t*) &s_compaction.itemHeader + s_compaction.itemOffset, count);
+        }
+        else
+        {
+            // the source blocks of the item are not changed by writes: new blocks are appended
+            if ( !GatherData(s_compaction.itemSourceSector, s_compaction.itemSourceBlock,
+                             s_compaction.itemOffset - BLOCK_HEADER_SIZE, count, pDestination) )
+            {
+                return FALSE;
+            }
+        }
+        s_compaction.itemOffset += count;
+        s_compaction.rowLength += count;
+
+        if ( s_compaction.itemOffset == blockSize )
+        {
+            FinishCopyItem();
+        }
+
+        if ( s_compaction.rowLength == ROW_SIZE )
+        {
+            if ( !WriteCompactRow() )
+            {
+                return FALSE;
+            }
+            s_compaction.rowStart += ROW_SIZE;
+            s_compaction.rowLength = 0u;
+            rows++;
+        }
+    }
+
+    return TRUE;
+}
+
+/** Perform one step of the compact sector operation: erase a few pages of the destination
+    sector or copy a few rows of items to it. The flash content is consistent after each step.
+    \returns FALSE if the operation failed
+*/
+static bool CompactSectorStep(void)
+{
+    switch ( s_compaction.state )
+    {
+        case COMPACT_ERASE:
+            if ( EraseDestinationSector() )
+            {
+                s_compaction.state = COMPACT_COPY;
+            }
+            return TRUE;
+
+        case COMPACT_COPY:
+            return CopyItems();
+
+        default:
+            return TRUE;
+    }
+}
+
+/* Important: if CompactSector fails, the only fix is to reinitialize!
+ * This is because the itemCache, sector head and sector selector will
+ * be messed up.
+ */
+
+/** Start a compact sector operation, or continue the one in progress, and finish it
+    without giving control to other tasks.
+*/
+static bool CompactSector(void)
+{
+    if ( s_compaction.state == COMPACT_IDLE )
+    {
+        StartCompaction();
+    }
+    s_compaction.blocking = TRUE;
+
+    while ( s_compaction.state != COMPACT_IDLE )
+    {
+        if ( !CompactSectorStep() )
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
 static void CompactSectorIfNeeded(uint16_t immediateThreshold)
 {
     uint16_t freeSpace = SECTOR_SIZE - s_sectorHead;
@@ -1071,15 +1847,20 @@ static void CompactSectorIfNeeded(uint16_t immediateThreshold)
     }
     if ( freeSpace < PREEMPTIVE_COMPACT_SECTOR_THRESHOLD )
     {
-        if (SYS_TIMER_STOPPED == compactSectorTimer.state)
-            SYS_InitTimer(&compactSectorTimer, TIMER_ONE_SHOT_MODE, COMPACT_SECTOR_DELAY_MS, compactSectorTimerFired);
+        if ( (s_compaction.state == COMPACT_IDLE) && (SYS_TIMER_STOPPED == compactSectorTimer.state) )
+            StartTimer(&compactSectorTimer, COMPACT_SECTOR_DELAY_MS, compactSectorTimerFired);
     }
 }
 
-static S_Nv_ReturnValue_t CompactItem(void)
+/** Write an item as a single block to the active sector. Moves an item out of the cold sector.
+    \param id The item to compact
+    \param newLength The new length of the item, or 0 to keep the length
+    \returns S_Nv_ReturnValue_Ok, also if the item does not exist, or an error
+*/
+static S_Nv_ReturnValue_t CompactItem(uint16_t id, uint16_t newLength)
 {
 #if defined(ENABLE_NV_COMPACT_LOGGING)
-    N_LOG_ALWAYS(("CompactItem(id=%Xh)", s_compactItemId));
+    N_LOG_ALWAYS(("CompactItem(id=%Xh)", id));
 #endif
 
     if ( PowerSupplyTooLow() )
@@ -1087,7 +1868,7 @@ static S_Nv_ReturnValue_t CompactItem(void)
         return S_Nv_ReturnValue_PowerSupplyTooLow;
     }
 
-    if ( (s_compactItemLength == 0u) && ( s_compactItemId == 0u ) )
+    if ( (newLength == 0u) && ( id == 0u ) )
     {
         // compact sector was performed since the compact item was
         // scheduled, so there is no need for another compact item unless
@@ -1095,10 +1876,10 @@ static S_Nv_ReturnValue_t CompactItem(void)
         return S_Nv_ReturnValue_Ok;
     }
 
-    if (s_compactItemLength != 0)
-        CompactSectorIfNeeded(s_compactItemLength + BLOCK_HEADER_SIZE);
+    if (newLength != 0)
+        CompactSectorIfNeeded(newLength + BLOCK_HEADER_SIZE);
 
-    Item_t *cache = FindItemCache(s_compactItemId);
+    Item_t *cache = FindItemCache(id);
     if ( cache == NULL )
     {
         // trying to compact a non-existing item (item may have been deleted)
@@ -1109,29 +1890,32 @@ static S_Nv_ReturnValue_t CompactItem(void)
 
     BlockHeader_t blockHeader;
     // read last written item block header
-    D_Nv_Read(s_sector, blockPointer, (uint8_t*) &blockHeader, BLOCK_HEADER_SIZE);
+    D_Nv_Read(ItemSector(cache), blockPointer, (uint8_t*) &blockHeader, BLOCK_HEADER_SIZE);
 
-    if (s_compactItemLength == 0)
+    if (newLength == 0)
     {
         CompactSectorIfNeeded(blockHeader.itemLength + BLOCK_HEADER_SIZE);
 
-        cache = FindItemCache(s_compactItemId);
+        cache = FindItemCache(id);
         N_ERRH_ASSERT_FATAL(cache != NULL);
         blockPointer = cache->lastBlock;
         // read last written item block header
-        D_Nv_Read(s_sector, blockPointer, (uint8_t*) &blockHeader, BLOCK_HEADER_SIZE);
+        D_Nv_Read(ItemSector(cache), blockPointer, (uint8_t*) &blockHeader, BLOCK_HEADER_SIZE);
     }
 
+    // the item is gathered from the cold sector when it is moved out of it
+    uint8_t sourceSector = ItemSector(cache);
+
     uint16_t lastBlock = s_sectorHead;
 
     // write the block header to the destination sector. all data will be merged into one block
     uint16_t bytesToGather = blockHeader.itemLength;
-    if ( s_compactItemLength != 0u )
+    if ( newLength != 0u )
     {
-        N_LOG_ALWAYS(("Resizing NV item (id=%hu) from %hu to %hu", s_compactItemId, blockHeader.itemLength, s_compactItemLength));
+        N_LOG_ALWAYS(("Resizing NV item (id=%hu) from %hu to %hu", id, blockHeader.itemLength, newLength));
 
         // Change the length of the item
-        blockHeader.itemLength = s_compactItemLength;
+        blockHeader.itemLength = newLength;
 
         if ( bytesToGather > blockHeader.itemLength )
         {
@@ -1141,61 +1925,55 @@ static S_Nv_ReturnValue_t CompactItem(void)
     }
 
     blockHeader.blockOffset = 0u;
-    blockHeader.blockLength = blockHeader.itemLength;
     blockHeader.previousBlock = 0x0000u;
     blockHeader.writeCount = 0u;
 
+    // bytes added by a resize are left erased. The block must be valid after a reset, so the CRCs
+    // of the merged data and of the modified header are computed before the first row is written
+    blockHeader.blockLength = bytesToGather;
+    uint16_t crc = ComputeDataCrc(sourceSector, blockPointer, &blockHeader);
+    blockHeader.blockLength = blockHeader.itemLength;
+    blockHeader.dataCrc = ComputeCrc(NULL, blockHeader.itemLength - bytesToGather, crc);
+    blockHeader.headerCrc = ComputeHeaderCrc(&blockHeader);
+
     //manipulate data buffer and then commit
-    uint16_t currLength = BLOCK_HEADER_SIZE + bytesToGather;
+    uint16_t currLength = BLOCK_HEADER_SIZE + blockHeader.blockLength;
+    uint16_t dataBlockOffset = BLOCK_HEADER_SIZE;
+    uint16_t inDataOffset = 0u;
 
     memcpy(dataBlock, &blockHeader, BLOCK_HEADER_SIZE);
 
-    uint16_t dataBlockOffset = BLOCK_HEADER_SIZE;
-
-    if (currLength <= ROW_SIZE)
+    do
     {
-        if (!GatherData(s_sector, blockPointer, 0u, bytesToGather, (dataBlock + BLOCK_HEADER_SIZE )))
+        uint16_t bytesToCommit = (currLength > ROW_SIZE) ? ROW_SIZE : currLength;
+        uint16_t count = bytesToCommit - dataBlockOffset;
+        uint16_t gatherCount = (inDataOffset < bytesToGather) ? MIN(count, (uint16_t) (bytesToGather - inDataOffset)) : 0u;
+
+        if ( (gatherCount != 0u) && !GatherData(sourceSector, blockPointer, inDataOffset, gatherCount, (dataBlock + dataBlockOffset)) )
         {
             N_LOG_NONFATAL();
             return S_Nv_ReturnValue_Failure;
         }
+        memset(dataBlock + dataBlockOffset + gatherCount, 0xFF, count - gatherCount);
 
-        memcpy(dataBlock, &blockHeader, BLOCK_HEADER_SIZE);
-        if ( !WriteAndCheck(s_sectorHead, dataBlock, blockHeader.blockLength + BLOCK_HEADER_SIZE) )
+        if ( !WriteAndCheck(s_sectorHead, dataBlock, bytesToCommit) )
         {
-            return FALSE;
+            return S_Nv_ReturnValue_Failure;
         }
-        UpdateSectorHead((BLOCK_HEADER_SIZE + blockHeader.blockLength), ITEM_64BYTE_ALIGNMENT);
-    }
-    else
+        UpdateSectorHead(bytesToCommit, ITEM_64BYTE_ALIGNMENT);
+        currLength -= bytesToCommit;
+        inDataOffset += count;
+        dataBlockOffset = 0u;
+    } while ( currLength > 0u );
+
+    // a scheduled compact item operation for the item is done now
+    if ( s_compactItemId == id )
     {
-        uint16_t bytesToGatherAndCommit;
-        uint16_t inDataOffset = 0;
-
-        do
-        {
-            bytesToGatherAndCommit = (currLength > ROW_SIZE) ? ROW_SIZE : currLength;
-            if (!GatherData(s_sector, blockPointer, inDataOffset, bytesToGatherAndCommit - dataBlockOffset , (dataBlock + dataBlockOffset)))
-            {
-                N_LOG_NONFATAL();
-                return S_Nv_ReturnValue_Failure;
-            }
-
-            if ( !WriteAndCheck(s_sectorHead, dataBlock, bytesToGatherAndCommit) )
-            {
-                return FALSE;
-            }
-            UpdateSectorHead(bytesToGatherAndCommit, ITEM_64BYTE_ALIGNMENT);
-            currLength -= bytesToGatherAndCommit;
-            inDataOffset += (bytesToGatherAndCommit - dataBlockOffset);
-            dataBlockOffset = 0;
-        } while(currLength > 0);
+        s_compactItemId = 0u;
+        s_compactItemLength = 0u;
     }
 
-    s_compactItemId = 0u;
-    s_compactItemLength = 0u;
-
-    cache->lastBlock = lastBlock;
+    SetItemLastBlock(cache, lastBlock);
 
     return S_Nv_ReturnValue_Ok;
 }
@@ -1206,56 +1984,92 @@ static S_Nv_ReturnValue_t CompactItem(void)
 
 void S_Nv_EarlyInit(void)
 {
-    SnvRevisioin_t revisionNumber;
+    SnvRevisioin_t revisionNumber = SNV_REV_INVALID;
     s_itemCount = 0u;
-
-    SectorHeader_t sectorHeader;
+    s_compaction.state = COMPACT_IDLE;
+    s_compaction.cold = FALSE;
+    s_compaction.excludedSectors = 0uL;
+    s_coldSector = 0xFFu;
+    s_coldDeletePending = FALSE;
+    s_sequenceNumber = INITIAL_SECTOR_SEQUENCE_NUMBER + 1uL;
 
     uint8_t lastSector = 0xFFu;
     uint32_t lastSectorSequence = 0xFFFFFFFFuL;
+    uint8_t coldSector = 0xFFu;
+    uint32_t coldSectorSequence = 0xFFFFFFFFuL;
+    uint32_t sectorsWithWear = 0uL;
+    uint32_t maxEraseCount = 0uL;
 
     for ( uint8_t sector = FIRST_SECTOR; sector < (FIRST_SECTOR + SECTOR_COUNT); sector++ )
     {
-        D_Nv_Read(sector, 0u, (uint8_t*) &sectorHeader, SECTOR_HEADER_SIZE);
-        if (((sectorHeader.sequenceNumber ^ sectorHeader.sequenceParity) == 0xFFFFFFFFuL) &&
-            (sectorHeader.signature[0] == (uint8_t) 'A') &&
-            (sectorHeader.signature[1] == (uint8_t) 'T') &&
-            (sectorHeader.signature[2] == (uint8_t) 'S') &&
-            (sectorHeader.signature[3] == (uint8_t) 'N') &&
-            (sectorHeader.signature[4] == (uint8_t) 'v') )
+        uint32_t sequenceNumber;
+        SnvRevisioin_t revision = ReadSectorRevision(sector, &sequenceNumber);
+
+        // the first row of an Snv rev 1 sector contains items
+        if ( (revision != SNV_REV_1) && ReadSectorWear(sector, &s_eraseCount[sector - FIRST_SECTOR]) )
         {
-            if ( sectorHeader.signature[5] == (uint8_t) '1')
-            {
-                SectorHeaderSnv1_t* pSectorHeaderSnv1 = (SectorHeaderSnv1_t*)&sectorHeader;
-                if (pSectorHeaderSnv1->isActive == 0x0000u)
+            sectorsWithWear |= 1uL << (sector - FIRST_SECTOR);
+            maxEraseCount = MAX(maxEraseCount, s_eraseCount[sector - FIRST_SECTOR]);
+        }
 
-                {
-                    revisionNumber = SNV_REV_1;
-                }
-                else
-                  continue;
-            }
-            else if (sectorHeader.signature[5] == (uint8_t) '2') 
-            {
-              uint16_t headerCrc = ComputeSectorHeaderCrc(&sectorHeader);
-              if (headerCrc == sectorHeader.headerCrc)
-              {
-                  revisionNumber = SNV_REV_2;
-              }
-              else
-                continue;
-            }
-            else
+        if ( revision == SNV_REV_INVALID )
+        {
+            continue;
+        }
+
+        // the active and the cold sectors take their sequence numbers from the same counter
+        if ( sequenceNumber < s_sequenceNumber )
+        {
+            s_sequenceNumber = sequenceNumber;
+        }
+
+        if ( revision == SNV_REV_2_COLD )
+        {
+            if ( sequenceNumber < coldSectorSequence )
             {
-                 continue;
+                coldSector = sector;
+                coldSectorSequence = sequenceNumber;
             }
+        }
+        else if ( sequenceNumber < lastSectorSequence )
+        {
             // active sector
-            if ( sectorHeader.sequenceNumber < lastSectorSequence )
+            lastSector = sector;
+            lastSectorSequence = sequenceNumber;
+            revisionNumber = revision;
+        }
+    }
+
+    // sectors erased by older versions have no wear record. Assume the worst
+    for ( uint8_t sector = FIRST_SECTOR; sector < (FIRST_SECTOR + SECTOR_COUNT); sector++ )
+    {
+        if ( (sectorsWithWear & (1uL << (sector - FIRST_SECTOR))) == 0uL )
+        {
+            s_eraseCount[sector - FIRST_SECTOR] = maxEraseCount;
+        }
+    }
+
+    if ( coldSector != 0xFFu )
+    {
+        // a reset occurred before an outdated cold sector was invalidated
+        for ( uint8_t sector = FIRST_SECTOR; sector < (FIRST_SECTOR + SECTOR_COUNT); sector++ )
+        {
+            uint32_t sequenceNumber;
+            if ( (sector != coldSector) && (ReadSectorRevision(sector, &sequenceNumber) == SNV_REV_2_COLD) )
             {
-                lastSector = sector;
-                lastSectorSequence = sectorHeader.sequenceNumber;
+                EraseHeaderPage(sector);
             }
         }
+
+        // load the cold sector first, items written to the active sector afterwards override it
+        s_sector = coldSector;
+        LoadSector(SNV_REV_2);
+        s_coldSector = coldSector;
+
+        for ( uint8_t cacheIndex = 0u; cacheIndex < s_itemCount; cacheIndex++ )
+        {
+            s_itemCache[cacheIndex].flags = ITEM_IN_COLD_SECTOR | ITEM_HAS_COLD_COPY;
+        }
     }
 
     if ( lastSector == 0xFFu )
@@ -1265,10 +2079,11 @@ void S_Nv_EarlyInit(void)
 
         for ( ;; )
         {
-            if ( EraseSector())
+            if ( (s_sector != s_coldSector) && EraseSector() )
             {
-                if ( WriteSectorHeader(INITIAL_SECTOR_SEQUENCE_NUMBER, 0xFFFFu) )
+                if ( WriteSectorHeader(s_sector, s_sequenceNumber - 1uL, 0xFFFFu, FALSE) )
                 {
+                    s_sequenceNumber--;
                     break;
                 }
             }
@@ -1280,8 +2095,6 @@ void S_Nv_EarlyInit(void)
                 N_ERRH_FATAL();
             }
         }
-
-        s_itemCount = 0u;
     }
     else
     {
@@ -1322,10 +2135,7 @@ S_Nv_ReturnValue_t S_Nv_ItemInit_Impl(S_Nv_ItemId_t id, uint16_t itemLength, voi
         if ( oldItemLength != itemLength )
         {
             // Resize this item to the new length
-            s_compactItemId = id;
-            s_compactItemLength = itemLength;
-
-            S_Nv_ReturnValue_t resizeResult = CompactItem();
+            S_Nv_ReturnValue_t resizeResult = CompactItem(id, itemLength);
             if ( resizeResult != S_Nv_ReturnValue_Ok )
             {
                 return resizeResult;
@@ -1399,6 +2209,26 @@ S_Nv_ReturnValue_t S_Nv_Write_Impl(S_Nv_ItemId_t id, uint16_t offset, uint16_t d
         return S_Nv_ReturnValue_DoesNotExist;
     }
 
+    if ( (cache->flags & ITEM_IN_COLD_SECTOR) != 0u )
+    {
+        // blocks in the active sector cannot refer to blocks in the cold sector,
+        // so move the item to the active sector first
+        S_Nv_ReturnValue_t result = CompactItem(id, 0u);
+        if ( result != S_Nv_ReturnValue_Ok )
+        {
+            return result;
+        }
+
+        CompactSectorIfNeeded(BLOCK_HEADER_SIZE + dataLength);
+
+        cache = FindItemCache(id);
+        N_ERRH_ASSERT_FATAL(cache != NULL);
+        if ( (cache->flags & ITEM_IN_COLD_SECTOR) != 0u )
+        {
+            return S_Nv_ReturnValue_Failure;
+        }
+    }
+
     uint16_t blockPointer = cache->lastBlock;
 
     BlockHeader_t blockHeader;
@@ -1436,7 +2266,7 @@ S_Nv_ReturnValue_t S_Nv_Write_Impl(S_Nv_ItemId_t id, uint16_t offset, uint16_t d
     }
 
     // Write succeeded, so update the cache
-    cache->lastBlock = newBlockPointer;
+    SetItemLastBlock(cache, newBlockPointer);
 
     if ( blockHeader.writeCount > COMPACT_ITEM_THRESHOLD )
     {
@@ -1450,7 +2280,7 @@ S_Nv_ReturnValue_t S_Nv_Write_Impl(S_Nv_ItemId_t id, uint16_t offset, uint16_t d
         // ignore the error if a timer cannot be started: the operation
         // is not required for a correct operation of the component
         if (SYS_TIMER_STOPPED == compactItemTimer.state)
-            SYS_InitTimer(&compactItemTimer, TIMER_ONE_SHOT_MODE, COMPACT_ITEM_DELAY_MS, compactItemTimerFired);
+            StartTimer(&compactItemTimer, COMPACT_ITEM_DELAY_MS, compactItemTimerFired);
     }
 
     return S_Nv_ReturnValue_Ok;
@@ -1466,8 +2296,8 @@ S_Nv_ReturnValue_t S_Nv_Read_Impl(S_Nv_ItemId_t id, uint16_t offset, uint16_t da
     N_ERRH_ASSERT_FATAL((id != 0u) && (pData != NULL));
 
     // get the pointer to the last written block for the item
-    uint16_t lastBlockPointer = FindItem(id);
-    if ( lastBlockPointer == 0x0000u )
+    Item_t *cache = FindItemCache(id);
+    if ( cache == NULL )
     {
         // item does not exist
         return S_Nv_ReturnValue_DoesNotExist;
@@ -1481,7 +2311,7 @@ S_Nv_ReturnValue_t S_Nv_Read_Impl(S_Nv_ItemId_t id, uint16_t offset, uint16_t da
 
     // gather the data into the destination buffer
 
-    if ( !GatherData(s_sector, lastBlockPointer, offset, dataLength, pData ))
+    if ( !GatherData(ItemSector(cache), cache->lastBlock, offset, dataLength, pData ))
     {
         return S_Nv_ReturnValue_BeyondEnd;
     }
@@ -1494,8 +2324,8 @@ uint16_t S_Nv_ItemLength_Impl(S_Nv_ItemId_t id)
 {
     N_ERRH_ASSERT_FATAL(id != 0u);
 
-    uint16_t blockPointer = FindItem(id);
-    if ( blockPointer == 0x0000u )
+    Item_t *cache = FindItemCache(id);
+    if ( cache == NULL )
     {
         // item does not exist
         return 0u;
@@ -1503,7 +2333,7 @@ uint16_t S_Nv_ItemLength_Impl(S_Nv_ItemId_t id)
 
     // read last written item block header
     BlockHeader_t blockHeader;
-    D_Nv_Read(s_sector, blockPointer, (uint8_t*) &blockHeader, BLOCK_HEADER_SIZE);
+    D_Nv_Read(ItemSector(cache), cache->lastBlock, (uint8_t*) &blockHeader, BLOCK_HEADER_SIZE);
     return blockHeader.itemLength;
 }
 
@@ -1561,26 +2391,48 @@ S_Nv_ReturnValue_t S_Nv_EraseAll_Impl(bool includingPersistentItems)
 
     if ( includingPersistentItems )
     {
+        SYS_StopTimer(&compactSectorTimer);
+        HAL_StopAppTimer(&eraseSectorTimer);
+        s_compaction.state = COMPACT_IDLE;
+        s_sectorToErase = 0xFFu;
+
+        // the cold sector first, so that a reset cannot bring back its items
+        if ( s_coldSector != 0xFFu )
+        {
+            D_Nv_EraseSector(s_coldSector);
+            WriteSectorWear(s_coldSector);
+        }
         for ( uint8_t sector = FIRST_SECTOR; sector < (FIRST_SECTOR + SECTOR_COUNT); sector++ )
         {
-            D_Nv_EraseSector(sector);
+            if ( sector != s_coldSector )
+            {
+                D_Nv_EraseSector(sector);
+                WriteSectorWear(sector);
+            }
         }
+        s_coldSector = 0xFFu;
+        s_coldDeletePending = FALSE;
     }
     else
     {
         uint8_t deletedItems = 0;
-        uint8_t totalItems = s_itemCount;
+        uint8_t cacheIndex = 0;
 
         // Traverse the item cache, removing all the non-persistent
-        for ( uint8_t cacheIndex = 0; cacheIndex < totalItems; cacheIndex++ )
+        while ( cacheIndex < s_itemCount )
         {
             uint16_t id = s_itemCache[cacheIndex].id;
 
             if ( !IsPersistent(id) )
             {
+                // the next item moves to this position
                 DeleteItemCache(id);
                 deletedItems++;
             }
+            else
+            {
+                cacheIndex++;
+            }
         }
 
         // Were any items deleted? If so, do sector compaction!
@@ -1610,6 +2462,20 @@ bool S_Nv_IsItemAvailable_Impl(S_Nv_ItemId_t id)
 {
   return ( FindItem(id) != 0x0000u );
 }
+
+#if defined(S_NV_CACHE_STATISTICS)
+/** Interface function, see \ref S_Nv_GetCacheStatistics. */
+void S_Nv_GetCacheStatistics_Impl(S_Nv_CacheStatistics_t* pStatistics, bool reset)
+{
+    s_cacheStatistics.itemCount = s_itemCount;
+    *pStatistics = s_cacheStatistics;
+
+    if ( reset )
+    {
+        memset(&s_cacheStatistics, 0, sizeof(s_cacheStatistics));
+    }
+}
+#endif
 #if defined(S_XNV_LOGGING)
 
 S_Nv_ReturnValue_t S_Nv_ItemInit_Impl(S_Nv_ItemId_t id, uint16_t itemLength, void* pDefaultData)
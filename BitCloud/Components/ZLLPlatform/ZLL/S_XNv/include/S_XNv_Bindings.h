@@ -17,6 +17,8 @@
 #define D_XNv_EraseSector D_XNv_Stub_EraseSector
 #define D_XNv_IsEmpty D_XNv_Stub_IsEmpty
 #define D_XNv_IsEqual D_XNv_Stub_IsEqual
+#define D_XNv_IsBusy D_XNv_Stub_IsBusy
+#define D_XNv_EraseSectorAsync D_XNv_Stub_EraseSectorAsync
 
 // Use actual timers
 #define N_Timer_Stop N_Timer_Stop_Impl
@@ -30,6 +32,8 @@
 #define D_XNv_EraseSector D_XNv_EraseSector_Impl
 #define D_XNv_IsEmpty D_XNv_IsEmpty_Impl
 #define D_XNv_IsEqual D_XNv_IsEqual_Impl
+#define D_XNv_IsBusy D_XNv_IsBusy_Impl
+#define D_XNv_EraseSectorAsync D_XNv_EraseSectorAsync_Impl
 
 #define N_Timer_Stop N_Timer_Stop_Impl
 #define N_Timer_Start16 N_Timer_Start16_Impl
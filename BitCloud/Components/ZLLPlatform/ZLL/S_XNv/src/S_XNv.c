@@ -72,6 +72,9 @@ $Id: S_XNv.c 24615 2013-02-27 05:14:24Z mahendranp $
 /** Delay before performing a compact item operation. */
 #define COMPACT_ITEM_DELAY_MS 3000u
 
+/** Delay before retrying a background operation postponed because the external NV is busy. */
+#define BUSY_RETRY_DELAY_MS 100u
+
 /** Perform a compact item operation if the number of partial writes is larger than this. */
 #define COMPACT_ITEM_THRESHOLD 100u
 
@@ -113,6 +116,12 @@ $Id: S_XNv.c 24615 2013-02-27 05:14:24Z mahendranp $
 #define S_XNV_SECTOR_COUNT 4u
 #endif
 
+/** The number of items the RAM copy of the meta block can hold, 4 bytes of RAM each. If there are more
+    items, or if set to 0, items are looked up by scanning the meta block in the external flash. */
+#if !defined(S_XNV_META_INDEX_SIZE)
+#define S_XNV_META_INDEX_SIZE 64u
+#endif
+
 /***************************************************************************************************
 * LOCAL TYPES
 ***************************************************************************************************/
@@ -195,6 +204,13 @@ static uint8_t s_itemCount = 0u;
 static uint16_t s_cachedItemId = 0u;
 static uint16_t s_cachedItemPointer;
 
+#if S_XNV_META_INDEX_SIZE > 0u
+/** Content of the last written meta block, sorted by item id. Only used if s_metaIndexValid is set. */
+static Item_t s_metaIndex[S_XNV_META_INDEX_SIZE];
+static uint8_t s_metaIndexCount = 0u;
+static bool s_metaIndexValid = FALSE;
+#endif
+
 /** The sector to erase in the EVENT_ERASE_SECTOR handler. */
 static uint8_t s_sectorToErase = 0xFFu;
 
@@ -236,14 +252,41 @@ static S_XNv_ReturnValue_t CompactItem(void);
 */
 static void eraseSectorTimerFired(void)
 {
-    if (!PowerSupplyTooLow())
-        D_XNv_EraseSector(s_sectorToErase);
+    if (PowerSupplyTooLow())
+        return;
+
+    if (D_XNv_IsBusy())
+    {
+        eraseSectorTimer.interval = BUSY_RETRY_DELAY_MS;
+        HAL_StartAppTimer(&eraseSectorTimer);
+        return;
+    }
+
+    // the erase completes in background, S_XNv requests issued meanwhile wait for it
+    D_XNv_EraseSectorAsync(s_sectorToErase, NULL);
+}
+
+/** Starts a one-shot system timer.
+*/
+static void StartTimer(SYS_Timer_t* pTimer, uint32_t interval, void (*handler)(void))
+{
+    SYS_InitTimer(pTimer, TIMER_ONE_SHOT_MODE, interval, handler);
+    SYS_StartTimer(pTimer);
 }
 
 /** Compact sector timer callback.
 */
 static void compactSectorTimerFired(void)
 {
+    SYS_StopTimer(&compactSectorTimer);
+
+    // do not block the scheduler until the external NV finishes an erase
+    if (D_XNv_IsBusy())
+    {
+        StartTimer(&compactSectorTimer, BUSY_RETRY_DELAY_MS, compactSectorTimerFired);
+        return;
+    }
+
     if (!PowerSupplyTooLow())
         if (!CompactSector())
             N_ERRH_FATAL();
@@ -253,6 +296,15 @@ static void compactSectorTimerFired(void)
 */
 static void compactItemTimerFired(void)
 {
+    SYS_StopTimer(&compactItemTimer);
+
+    // do not block the scheduler until the external NV finishes an erase
+    if (D_XNv_IsBusy())
+    {
+        StartTimer(&compactItemTimer, BUSY_RETRY_DELAY_MS, compactItemTimerFired);
+        return;
+    }
+
     (void)CompactItem();
 }
 
@@ -309,6 +361,101 @@ static void UpdateSectorHead(uint16_t increment)
     s_sectorHead = (s_sectorHead + increment + 0x000Fu) & 0xFFF0u;
 }
 
+#if S_XNV_META_INDEX_SIZE > 0u
+/** Return the position of the item in the meta index.
+    \param id The id to find
+    \returns The position of the item, or the position to insert it at if the item is not indexed
+*/
+static uint8_t MetaIndexFind(uint16_t id)
+{
+    uint8_t low = 0u;
+    uint8_t high = s_metaIndexCount;
+
+    while ( low < high )
+    {
+        uint8_t middle = (uint8_t) ((low + high) / 2u);
+        if ( s_metaIndex[middle].id < id )
+        {
+            low = middle + 1u;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+/** Fill the meta index from the last written meta block. The index is disabled if the
+    items do not fit in it.
+*/
+static void BuildMetaIndex(void)
+{
+    s_metaIndexValid = FALSE;
+    s_metaIndexCount = 0u;
+
+    if ( s_itemCount > S_XNV_META_INDEX_SIZE )
+    {
+        return;
+    }
+
+    if ( s_itemCount != 0u )
+    {
+        D_XNv_Read(s_sector, s_metaPointer + BLOCK_HEADER_SIZE, (uint8_t*) s_metaIndex, (uint16_t) (s_itemCount * META_ITEM_SIZE));
+    }
+
+    // insertion sort, the meta block is in order of item creation
+    for ( s_metaIndexCount = 0u; s_metaIndexCount < s_itemCount; s_metaIndexCount++ )
+    {
+        Item_t item = s_metaIndex[s_metaIndexCount];
+        uint8_t position = MetaIndexFind(item.id);
+
+        memmove(&s_metaIndex[position + 1u], &s_metaIndex[position], (s_metaIndexCount - position) * sizeof(Item_t));
+        s_metaIndex[position] = item;
+    }
+
+    s_metaIndexValid = TRUE;
+}
+
+/** Update the location of an indexed item, or add the item to the meta index.
+    \param id The item id
+    \param lastBlock Pointer to the last written block for the item
+    \param add TRUE to add the item if it is not indexed yet
+*/
+static void UpdateMetaIndex(uint16_t id, uint16_t lastBlock, bool add)
+{
+    if ( !s_metaIndexValid )
+    {
+        return;
+    }
+
+    uint8_t position = MetaIndexFind(id);
+
+    if ( (position < s_metaIndexCount) && (s_metaIndex[position].id == id) )
+    {
+        s_metaIndex[position].lastBlock = lastBlock;
+    }
+    else if ( add )
+    {
+        if ( s_metaIndexCount >= S_XNV_META_INDEX_SIZE )
+        {
+            // out of budget, fall back to scanning the meta block
+            s_metaIndexValid = FALSE;
+            return;
+        }
+
+        memmove(&s_metaIndex[position + 1u], &s_metaIndex[position], (s_metaIndexCount - position) * sizeof(Item_t));
+        s_metaIndex[position].id = id;
+        s_metaIndex[position].lastBlock = lastBlock;
+        s_metaIndexCount++;
+    }
+}
+#else
+#define BuildMetaIndex()
+#define UpdateMetaIndex(id, lastBlock, add)
+#endif
+
 /** Return a pointer to the last written block for the item.
     \param id The id to find
     \returns A pointer to the last written block, or 0x0000u if the item was not found
@@ -321,6 +468,19 @@ static uint16_t FindItem(uint16_t id)
         return s_cachedItemPointer;
     }
 
+#if S_XNV_META_INDEX_SIZE > 0u
+    if ( s_metaIndexValid )
+    {
+        uint8_t position = MetaIndexFind(id);
+
+        if ( (position < s_metaIndexCount) && (s_metaIndex[position].id == id) )
+        {
+            return s_metaIndex[position].lastBlock;
+        }
+        return 0x0000u;
+    }
+#endif
+
     // item not cached, read the meta block
     Item_t itemBuffer[ITEM_BUFFER_LENGTH];
 
@@ -540,6 +700,16 @@ static bool WriteMetaBlock(BlockHeader_t* pBlockHeader, uint16_t newItemId, uint
 
     s_metaPointer = blockPointer;
 
+    // the meta block now holds the cached item location and the new item
+    if ( s_cachedItemId != 0u )
+    {
+        UpdateMetaIndex(s_cachedItemId, s_cachedItemPointer, FALSE);
+    }
+    if ( newItemId != 0u )
+    {
+        UpdateMetaIndex(newItemId, newItemPointer, TRUE);
+    }
+
     // There is always one pointer in the meta pointer block
     UpdateMetaPointerBlock(blockPointer);
 
@@ -882,6 +1052,8 @@ static void LoadSector(void)
         }
     }
 
+    BuildMetaIndex();
+
     // initialize the cache, but only if the item is in the last written
     // meta block (it may have been deleted).
     // FindItem can be used here because the cache has not been initialized yet
@@ -1008,6 +1180,7 @@ static bool CompactSector(void)
         return FALSE;
     }
     s_metaPointer = newMetaPointer;
+    BuildMetaIndex();
 
     // Update the meta pointer block
     s_metaPointerBlockIndex = 0u;
@@ -1025,6 +1198,7 @@ static bool CompactSector(void)
     // no problem if a task not yet active: the sector will be erased the next time it will be used.
     // Restart the timer if it is already running.
     HAL_StopAppTimer(&eraseSectorTimer);
+    eraseSectorTimer.interval = ERASE_SECTOR_DELAY_MS;
     HAL_StartAppTimer(&eraseSectorTimer);
 
     return TRUE;
@@ -1042,7 +1216,7 @@ static void CompactSectorIfNeeded(void)
     if ( s_sectorHead > PREEMPTIVE_COMPACT_SECTOR_THRESHOLD )
     {
         if (SYS_TIMER_STOPPED == compactSectorTimer.state)
-            SYS_InitTimer(&compactSectorTimer, TIMER_ONE_SHOT_MODE, COMPACT_SECTOR_DELAY_MS, compactSectorTimerFired);
+            StartTimer(&compactSectorTimer, COMPACT_SECTOR_DELAY_MS, compactSectorTimerFired);
 
     }
 }
@@ -1155,6 +1329,9 @@ void S_XNv_EarlyInit(void)
     s_itemCount = 0u;
     s_cachedItemId = 0u;
     s_cachedItemPointer = 0x0000u;
+#if S_XNV_META_INDEX_SIZE > 0u
+    s_metaIndexValid = FALSE;
+#endif
 
     SectorHeader_t sectorHeader;
 
@@ -1206,6 +1383,7 @@ void S_XNv_EarlyInit(void)
         }
 
         s_itemCount = 0u;
+        BuildMetaIndex();
     }
     else
     {
@@ -1232,7 +1410,7 @@ void S_XNv_Init(void)
     if(!s_foundValidMetaPointerBlock)
     {
         // Have not found a valid meta pointer block. Schedule a compact page to create one.
-        SYS_InitTimer(&compactSectorTimer, TIMER_ONE_SHOT_MODE, COMPACT_SECTOR_DELAY_MS, compactSectorTimerFired);
+        StartTimer(&compactSectorTimer, COMPACT_SECTOR_DELAY_MS, compactSectorTimerFired);
     }
 }
 
@@ -1391,7 +1569,7 @@ S_XNv_ReturnValue_t S_XNv_Write_Impl(S_XNv_ItemId_t id, uint16_t offset, uint16_
         // if a timer cannot be started (S_XNv_Init() not done) - the operation
         // is not required for a correct operation of the component
         if (SYS_TIMER_STOPPED == compactItemTimer.state)
-            SYS_InitTimer(&compactItemTimer, TIMER_ONE_SHOT_MODE, COMPACT_ITEM_DELAY_MS, compactItemTimerFired);
+            StartTimer(&compactItemTimer, COMPACT_ITEM_DELAY_MS, compactItemTimerFired);
     }
 
     s_cachedItemId = blockHeader.id;
@@ -1525,6 +1703,7 @@ S_XNv_ReturnValue_t S_XNv_Delete_Impl(S_XNv_ItemId_t id)
     }
 
     s_itemCount = newItemCount;
+    BuildMetaIndex();
 
     return S_XNv_ReturnValue_Ok;
 }
@@ -1543,6 +1722,9 @@ S_XNv_ReturnValue_t S_XNv_EraseAll_Impl(bool includingPersistentItems)
         {
             D_XNv_EraseSector(sector);
         }
+#if S_XNV_META_INDEX_SIZE > 0u
+        s_metaIndexValid = FALSE;
+#endif
     }
     else
     {
@@ -1613,6 +1795,7 @@ S_XNv_ReturnValue_t S_XNv_EraseAll_Impl(bool includingPersistentItems)
         s_cachedItemPointer = 0x0000u;
 
         s_itemCount = newItemCount;
+        BuildMetaIndex();
     }
 
     return S_XNv_ReturnValue_Ok;